@@ -23,9 +23,15 @@ constexpr auto window_title  = "Joysticks";
 constexpr auto window_width  = 800;
 constexpr auto window_height = 600;
 
+/// \brief Frames drawn after the last change in idle mode so the GUI can settle.
+constexpr auto settle_frame_count = 3;
+
 } // namespace
 
-MainWindow::MainWindow( ) = default;
+MainWindow::MainWindow( Settings settings )
+    : settings_( std::move( settings ) )
+{
+}
 
 auto MainWindow::run( ) -> utils::Expected< MainWindow* >
 {
@@ -94,6 +100,39 @@ auto MainWindow::init_window( ) -> utils::Expected< MainWindow* >
     // Enable vsync
     glfwSwapInterval( 1 );
 
+    // Track window events so idle mode knows when to redraw. These are installed before
+    // ImGui so its GLFW backend chains to them instead of replacing them.
+    glfwSetWindowUserPointer( window( ), this );
+    glfwSetCursorPosCallback( window( ), []( GLFWwindow* w, double, double ) { on_window_event( w ); } );
+    glfwSetMouseButtonCallback( window( ), []( GLFWwindow* w, int, int, int ) { on_window_event( w ); } );
+    glfwSetScrollCallback( window( ), []( GLFWwindow* w, double, double ) { on_window_event( w ); } );
+    glfwSetKeyCallback( window( ), []( GLFWwindow* w, int, int, int, int ) { on_window_event( w ); } );
+    glfwSetCharCallback( window( ), []( GLFWwindow* w, unsigned int ) { on_window_event( w ); } );
+    glfwSetCursorEnterCallback( window( ), []( GLFWwindow* w, int ) { on_window_event( w ); } );
+    glfwSetWindowFocusCallback( window( ), []( GLFWwindow* w, int ) { on_window_event( w ); } );
+    glfwSetFramebufferSizeCallback( window( ), []( GLFWwindow* w, int, int ) { on_window_event( w ); } );
+    glfwSetWindowRefreshCallback( window( ), []( GLFWwindow* w ) { on_window_event( w ); } );
+
+    // Budget and pace frames by the refresh rate of the display we are synced to.
+    auto        refresh_rate_hz = 60;
+    auto const* video_mode      = glfwGetVideoMode( glfwGetPrimaryMonitor( ) );
+    if ( video_mode != nullptr && video_mode->refreshRate > 0 )
+    {
+        refresh_rate_hz = video_mode->refreshRate;
+    }
+    spdlog::debug( "Pacing frames for a {}Hz display", refresh_rate_hz );
+
+    refresh_rate_hz_ = refresh_rate_hz;
+    frame_budget_    = FrameBudget( refresh_rate_hz );
+    if ( settings_.late_latch )
+    {
+        frame_pacer_ = FramePacer( refresh_rate_hz );
+    }
+    if ( settings_.predict )
+    {
+        predictor_ = AxisPredictor( );
+    }
+
     return this;
 }
 
@@ -150,36 +189,149 @@ auto MainWindow::init_imgui( ) -> utils::Expected< MainWindow* >
 
 auto MainWindow::main_loop( ) -> utils::Expected< MainWindow* >
 {
+    auto input = InputProcessor::create( settings_ );
+    if ( !input )
+    {
+        return tl::make_unexpected( input.error( ) );
+    }
+    input_ = std::move( *input );
+
+    // Replays advance one poll's worth of recorded time per frame when not idling.
+    if ( auto* replay = input_->replay( ); replay && !settings_.idle_mode )
+    {
+        replay->set_step_us( static_cast< std::int64_t >( 1'000'000.0 / refresh_rate_hz_ ) );
+    }
+
+    auto const poll_period_seconds = 1.0 / settings_.capture_rate_hz;
+
     while ( !glfwWindowShouldClose( window( ) ) )
     {
-        auto framebuffer_width  = 0;
-        auto framebuffer_height = 0;
-        glfwGetFramebufferSize( window( ), &framebuffer_width, &framebuffer_height );
-        glViewport( 0, 0, framebuffer_width, framebuffer_height );
+        if ( settings_.idle_mode )
+        {
+            // Sleep until something happens, but wake up often enough to keep polling input.
+            glfwWaitEventsTimeout( poll_period_seconds );
+        }
+        else
+        {
+            if ( frame_pacer_ )
+            {
+                // Input is as old as the moment polling starts, and polling is part of the work.
+                frame_pacer_->wait_for_latch( );
+                frame_pacer_->input_sampled( );
+            }
+            glfwPollEvents( );
+        }
 
-        // Update GUI state
-        ImGui_ImplOpenGL3_NewFrame( );
-        ImGui_ImplGlfw_NewFrame( );
-        ImGui::NewFrame( );
+        // Polling and the pipeline grow with the device count, so they count against the
+        // frame's budget too. The frame only begins once it is known to be drawn, so skipped
+        // idle wakeups are not counted as frames.
+        auto const frame_start = FrameBudget::Clock::now( );
 
         // Gather all available joystick info
-        auto joysticks = poll_joystick_info( );
+        auto joysticks = input_->poll( );
+        if ( predictor_ )
+        {
+            // Paced frames measure how long input takes to reach the screen. Otherwise the
+            // swap waits for the next vsync, about a refresh interval away.
+            auto const lead_ms = frame_pacer_ ? frame_pacer_->input_age_ms( ) : 1000.0 / refresh_rate_hz_;
+            predictor_->process( joysticks, input_->display_time_us( lead_ms ) );
+        }
+
+        if ( settings_.idle_mode && !needs_render( joysticks ) )
+        {
+            ++idle_stats_.skipped_wakeups;
+            continue;
+        }
+        ++idle_stats_.rendered_frames;
+        frame_budget_.begin_frame( frame_start );
 
-        // Configure joysticks GUI
-        configure_gui_window( joysticks );
+        render_frame( joysticks );
 
-        // Render GUI
-        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-        ImGui::Render( );
-        ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData( ) );
+        if ( frame_pacer_ )
+        {
+            frame_pacer_->work_done( );
+            glfwSwapBuffers( window( ) );
+            frame_pacer_->presented( );
+        }
+        else
+        {
+            glfwSwapBuffers( window( ) );
+        }
 
-        glfwSwapBuffers( window( ) );
-        glfwPollEvents( );
+        last_rendered_ = std::move( joysticks );
     }
 
     return this;
 }
 
+auto MainWindow::render_frame( std::vector< Joystick > const& joysticks ) -> void
+{
+    auto framebuffer_width  = 0;
+    auto framebuffer_height = 0;
+    glfwGetFramebufferSize( window( ), &framebuffer_width, &framebuffer_height );
+    glViewport( 0, 0, framebuffer_width, framebuffer_height );
+
+    // Update GUI state
+    ImGui_ImplOpenGL3_NewFrame( );
+    ImGui_ImplGlfw_NewFrame( );
+    ImGui::NewFrame( );
+
+    // Configure joysticks GUI
+    configure_gui_window( joysticks, frame_budget_, [ this ] { configure_status_gui( ); } );
+
+    // Render GUI
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    ImGui::Render( );
+    ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData( ) );
+}
+
+auto MainWindow::needs_render( std::vector< Joystick > const& joysticks ) -> bool
+{
+    if ( window_event_received_ || !same_inputs( joysticks, last_rendered_ ) )
+    {
+        // ImGui needs a few frames after a change for hover states and the like to settle.
+        frames_to_render_ = settle_frame_count;
+    }
+    window_event_received_ = false;
+
+    if ( frames_to_render_ == 0 )
+    {
+        return false;
+    }
+    --frames_to_render_;
+    return true;
+}
+
+auto MainWindow::on_window_event( GLFWwindow* window ) -> void
+{
+    static_cast< MainWindow* >( glfwGetWindowUserPointer( window ) )->window_event_received_ = true;
+}
+
+auto MainWindow::configure_status_gui( ) -> void
+{
+    configure_frame_budget_gui( frame_budget_ );
+
+    if ( frame_pacer_ )
+    {
+        configure_frame_pacer_gui( *frame_pacer_ );
+    }
+    if ( predictor_ )
+    {
+        configure_predictor_gui( *predictor_ );
+    }
+
+    if ( settings_.idle_mode )
+    {
+        ImGui::Text(
+            "Idle: %llu frames rendered, %llu wakeups without changes",
+            static_cast< unsigned long long >( idle_stats_.rendered_frames ),
+            static_cast< unsigned long long >( idle_stats_.skipped_wakeups )
+        );
+    }
+
+    input_->configure_status_gui( frame_budget_ );
+}
+
 auto MainWindow::window( ) const -> GLFWwindow*
 {
     return window_.get( );
@@ -4,10 +4,16 @@
 #pragma once
 
 // project
+#include "ltb/joy/axis_predictor.hpp"
+#include "ltb/joy/frame_budget.hpp"
+#include "ltb/joy/frame_pacer.hpp"
+#include "ltb/joy/input_processor.hpp"
+#include "ltb/joy/settings.hpp"
 #include "ltb/utils/expected.hpp"
 
 // standard
 #include <memory>
+#include <optional>
 
 struct GLFWwindow;
 struct ImGuiContext;
@@ -18,11 +24,46 @@ namespace ltb::joy
 class MainWindow
 {
 public:
-    explicit MainWindow( );
+    explicit MainWindow( Settings settings );
 
     auto run( ) -> utils::Expected< MainWindow* >;
 
 private:
+    /// \brief Options passed in from the command line.
+    Settings settings_;
+
+    /// \brief Sheds optional GUI work when a frame is at risk of missing vsync.
+    FrameBudget frame_budget_ = FrameBudget( 60.0 );
+
+    /// \brief Delays input sampling until just before the frame deadline, if enabled.
+    std::optional< FramePacer > frame_pacer_ = std::nullopt;
+
+    /// \brief Extrapolates input to when each frame is displayed, if enabled.
+    std::optional< AxisPredictor > predictor_ = std::nullopt;
+
+    /// \brief Refresh rate of the display the window is synced to.
+    double refresh_rate_hz_ = 60.0;
+
+    /// \brief Reads, processes, and records every device each frame.
+    std::unique_ptr< InputProcessor > input_ = nullptr;
+
+    /// \brief What was shown in the last rendered frame, used to detect changes in idle mode.
+    std::vector< Joystick > last_rendered_ = { };
+
+    /// \brief Set by GLFW callbacks whenever the user interacts with the window.
+    bool window_event_received_ = false;
+
+    /// \brief Frames left to draw before idle mode stops rendering.
+    int frames_to_render_ = 1;
+
+    struct IdleStats
+    {
+        std::uint64_t rendered_frames = 0;
+        std::uint64_t skipped_wakeups = 0;
+    };
+
+    IdleStats idle_stats_ = { };
+
     /// \brief RAII object to handle a GLFW context.
     std::shared_ptr< int > glfw_ = nullptr;
 
@@ -44,7 +85,13 @@ private:
     auto init_imgui( ) -> utils::Expected< MainWindow* >;
     auto main_loop( ) -> utils::Expected< MainWindow* >;
 
+    auto render_frame( std::vector< Joystick > const& joysticks ) -> void;
+    auto needs_render( std::vector< Joystick > const& joysticks ) -> bool;
+    auto configure_status_gui( ) -> void;
+
     [[nodiscard]] auto window( ) const -> GLFWwindow*;
+
+    static auto on_window_event( GLFWwindow* window ) -> void;
 };
 
 } // namespace ltb::joy
@@ -0,0 +1,522 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_calibration.hpp"
+
+// project
+#include "ltb/utils/mapped_file.hpp"
+
+// external
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+constexpr auto fast_time_constant_s = 0.05f; ///< Of the moving mean and variance used to detect rest
+constexpr auto rest_threshold       = 0.02f; ///< Largest moving standard deviation of an axis at rest
+constexpr auto rest_window          = 0.2f; ///< Farthest from the rest center the axis can be at rest
+constexpr auto rest_settle_s        = 0.25f; ///< How long an axis has to be still before it is at rest
+constexpr auto rest_time_constant_s = 2.f; ///< Averages of the rest center and noise become exponential after this
+constexpr auto rest_seconds_cap     = 60.f;
+constexpr auto max_step_s           = 0.1f; ///< Longer gaps between samples count as this long
+
+constexpr auto min_rest_seconds     = 1.f;
+constexpr auto min_span             = 1.f; ///< Half the nominal range of an axis
+constexpr auto one_sided_fraction   = 0.1f; ///< Of the range, between the center and the nearest end
+constexpr auto noise_deadzone_sigma = 4.f;
+constexpr auto max_auto_deadzone    = 0.25f;
+constexpr auto deadzone_tolerance   = 0.005f; ///< Smaller deadzone changes are not published
+
+constexpr auto check_interval_us = std::int64_t( 1'000'000 ); ///< Between looking for new deadzones
+constexpr auto save_interval_us  = std::int64_t( 30'000'000 );
+
+auto step_of( float seconds, float time_constant_s ) -> float
+{
+    auto const w = seconds / time_constant_s;
+    return w / ( 1.f + w );
+}
+
+/// \brief Fold `value` into an exponentially weighted mean and variance with weight `alpha`.
+auto accumulate( float value, float alpha, float& mean, float& variance ) -> void
+{
+    auto const difference = value - mean;
+    mean += alpha * difference;
+    variance = ( 1.f - alpha ) * ( variance + alpha * difference * difference );
+}
+
+template < typename T >
+auto read_table( std::byte const* data, std::size_t count ) -> std::vector< T >
+{
+    auto table = std::vector< T >( count );
+    std::memcpy( table.data( ), data, sizeof( T ) * count );
+    return table;
+}
+
+} // namespace
+
+auto AxisCalibration::is_calibrated( ) const -> bool
+{
+    return rest_seconds >= min_rest_seconds && maximum - minimum >= min_span;
+}
+
+auto AxisCalibration::is_one_sided( ) const -> bool
+{
+    auto const edge = one_sided_fraction * ( maximum - minimum );
+    return center - minimum < edge || maximum - center < edge;
+}
+
+auto AxisCalibration::normalize( float value ) const -> float
+{
+    if ( is_one_sided( ) )
+    {
+        return std::clamp( 2.f * ( value - minimum ) / ( maximum - minimum ) - 1.f, -1.f, 1.f );
+    }
+    auto const range = ( value < center ) ? center - minimum : maximum - center;
+    return std::clamp( ( value - center ) / range, -1.f, 1.f );
+}
+
+auto AxisCalibration::deadzone( ) const -> float
+{
+    if ( !is_calibrated( ) || is_one_sided( ) )
+    {
+        return 0.f;
+    }
+    auto const range = std::min( center - minimum, maximum - center );
+    return std::min( noise_deadzone_sigma * noise / range, max_auto_deadzone );
+}
+
+auto AxisCalibrator::load( std::filesystem::path path ) -> utils::Expected< void >
+{
+    path_ = std::move( path );
+
+    auto error_code = std::error_code{ };
+    if ( !std::filesystem::exists( path_, error_code ) )
+    {
+        return { };
+    }
+
+    auto file = utils::MappedFile::open( path_ );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    auto const* data = file->data( );
+    auto const  size = file->size( );
+
+    auto header = CalibrationFileHeader{ };
+    if ( size >= sizeof( header ) )
+    {
+        std::memcpy( &header, data, sizeof( header ) );
+    }
+    if ( size < sizeof( header ) || header.magic != calibration_magic || header.version != calibration_format_version
+         || header.header_size != sizeof( CalibrationFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is not a supported calibration file", path_.string( ) );
+    }
+
+    // Checking each count first keeps the total size from overflowing.
+    auto valid = header.device_count <= size / sizeof( CalibrationDevice )
+              && header.axis_count <= size / sizeof( AxisCalibration ) && header.strings_size <= size
+              && sizeof( header ) + sizeof( CalibrationDevice ) * header.device_count
+                         + sizeof( AxisCalibration ) * header.axis_count + header.strings_size
+                     == size;
+    if ( !valid )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is corrupt", path_.string( ) );
+    }
+
+    auto const axes_offset    = sizeof( header ) + sizeof( CalibrationDevice ) * header.device_count;
+    auto const strings_offset = axes_offset + sizeof( AxisCalibration ) * header.axis_count;
+    auto const devices        = read_table< CalibrationDevice >( data + sizeof( header ), header.device_count );
+    auto const axes           = read_table< AxisCalibration >( data + axes_offset, header.axis_count );
+    auto const strings        = reinterpret_cast< char const* >( data + strings_offset );
+
+    for ( auto const& device : devices )
+    {
+        if ( device.guid_offset + device.guid_size > header.strings_size
+             || device.first_axis + device.axis_count > header.axis_count )
+        {
+            stored_.clear( );
+            return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is corrupt", path_.string( ) );
+        }
+        auto const first = axes.begin( ) + static_cast< long >( device.first_axis );
+        stored_[ std::string( strings + device.guid_offset, device.guid_size ) ]
+            = std::vector< AxisCalibration >( first, first + device.axis_count );
+    }
+    stats_.stored_count = stored_.size( );
+    return { };
+}
+
+auto AxisCalibrator::save( ) -> utils::Expected< void >
+{
+    if ( path_.empty( ) )
+    {
+        return { };
+    }
+    store_devices( );
+
+    auto header         = CalibrationFileHeader{ };
+    header.device_count = stored_.size( );
+
+    auto devices = std::vector< CalibrationDevice >{ };
+    auto axes    = std::vector< AxisCalibration >{ };
+    auto strings = std::string{ };
+    for ( auto const& [ guid, calibration ] : stored_ )
+    {
+        auto& device       = devices.emplace_back( );
+        device.guid_offset = strings.size( );
+        device.guid_size   = static_cast< std::uint32_t >( guid.size( ) );
+        device.axis_count  = static_cast< std::uint32_t >( calibration.size( ) );
+        device.first_axis  = axes.size( );
+        strings += guid;
+        axes.insert( axes.end( ), calibration.begin( ), calibration.end( ) );
+    }
+    header.axis_count   = axes.size( );
+    header.strings_size = strings.size( );
+
+    auto const axes_offset    = sizeof( header ) + sizeof( CalibrationDevice ) * devices.size( );
+    auto const strings_offset = axes_offset + sizeof( AxisCalibration ) * axes.size( );
+
+    auto temp_path = path_;
+    temp_path += ".tmp";
+    {
+        auto file = utils::WritableMappedFile::create( temp_path, strings_offset + strings.size( ) );
+        if ( !file )
+        {
+            return tl::make_unexpected( file.error( ) );
+        }
+        auto* output = file->data( );
+
+        std::memcpy( output, &header, sizeof( header ) );
+        std::memcpy( output + sizeof( header ), devices.data( ), sizeof( CalibrationDevice ) * devices.size( ) );
+        std::memcpy( output + axes_offset, axes.data( ), sizeof( AxisCalibration ) * axes.size( ) );
+        std::memcpy( output + strings_offset, strings.data( ), strings.size( ) );
+    }
+
+    auto error_code = std::error_code{ };
+    std::filesystem::rename( temp_path, path_, error_code );
+    if ( error_code )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to replace '{}': {}", path_.string( ), error_code.message( ) );
+    }
+    unsaved_ = false;
+    return { };
+}
+
+auto AxisCalibrator::reset( std::string const& guid ) -> void
+{
+    stored_.erase( guid );
+    stats_.stored_count = stored_.size( );
+
+    for ( auto d = 0UL; d < devices_.size( ); ++d )
+    {
+        if ( devices_[ d ].guid == guid )
+        {
+            std::fill( devices_[ d ].axes.begin( ), devices_[ d ].axes.end( ), AxisCalibration{ } );
+            std::fill( state_[ d ].begin( ), state_[ d ].end( ), AxisState{ } );
+        }
+    }
+    check_deadzones( );
+    unsaved_ = true;
+}
+
+auto AxisCalibrator::devices( ) const -> std::vector< CalibratedDevice > const&
+{
+    return devices_;
+}
+
+auto AxisCalibrator::process( std::vector< Joystick >& joysticks ) -> void
+{
+    auto const start = Clock::now( );
+
+    if ( !layout_matches( joysticks ) )
+    {
+        rebuild( joysticks );
+    }
+
+    auto latest_us        = std::int64_t( 0 );
+    auto axis_count       = 0UL;
+    auto calibrated_count = 0UL;
+    for ( auto d = 0UL; d < joysticks.size( ); ++d )
+    {
+        auto& joystick = joysticks[ d ];
+        auto& device   = devices_[ d ];
+        auto& states   = state_[ d ];
+
+        // The first sample of a device only seeds its estimates.
+        auto const dt_us = ( device.last_sample_us > 0 ) ? joystick.timestamp_us - device.last_sample_us : 0;
+        auto const dt    = std::clamp( static_cast< float >( dt_us ) * 1e-6f, 0.f, max_step_s );
+        device.last_sample_us = joystick.timestamp_us;
+        latest_us             = std::max( latest_us, joystick.timestamp_us );
+
+        auto const fast_alpha = step_of( dt, fast_time_constant_s );
+        auto const rest_alpha = step_of( dt, rest_time_constant_s );
+
+        joystick.processed_axes.resize( joystick.axes.size( ) );
+        for ( auto a = 0UL; a < joystick.axes.size( ); ++a )
+        {
+            auto const value       = joystick.axes[ a ];
+            auto&      calibration = device.axes[ a ];
+            auto&      state       = states[ a ];
+
+            if ( calibration.minimum > calibration.maximum )
+            {
+                calibration.minimum = calibration.maximum = value;
+                state.fast_mean                           = value;
+            }
+            calibration.minimum = std::min( calibration.minimum, value );
+            calibration.maximum = std::max( calibration.maximum, value );
+
+            accumulate( value, fast_alpha, state.fast_mean, state.fast_variance );
+            auto const still = state.fast_variance < rest_threshold * rest_threshold;
+            auto const near_rest
+                = calibration.rest_seconds == 0.f || std::abs( state.fast_mean - calibration.center ) < rest_window;
+            state.still_seconds = ( still && near_rest ) ? state.still_seconds + dt : 0.f;
+
+            if ( state.still_seconds >= rest_settle_s && dt > 0.f )
+            {
+                if ( calibration.rest_seconds == 0.f )
+                {
+                    calibration.center  = state.fast_mean;
+                    state.rest_variance = state.fast_variance;
+                }
+
+                // A cumulative average until there is enough rest to average exponentially over.
+                calibration.rest_seconds = std::min( calibration.rest_seconds + dt, rest_seconds_cap );
+                auto const alpha         = std::max( rest_alpha, dt / calibration.rest_seconds );
+                accumulate( value, alpha, calibration.center, state.rest_variance );
+                calibration.noise = std::sqrt( state.rest_variance );
+                unsaved_          = true;
+            }
+
+            auto const calibrated        = calibration.is_calibrated( );
+            joystick.processed_axes[ a ] = calibrated ? calibration.normalize( value ) : value;
+            calibrated_count += calibrated ? 1UL : 0UL;
+        }
+        axis_count += joystick.axes.size( );
+    }
+
+    // Deadzones and the file only need to follow the slowly settling estimates.
+    if ( latest_us >= next_check_us_ )
+    {
+        next_check_us_ = latest_us + check_interval_us;
+        check_deadzones( );
+    }
+    if ( unsaved_ && !path_.empty( ) && latest_us >= next_save_us_ )
+    {
+        next_save_us_ = latest_us + save_interval_us;
+        if ( auto result = save( ); !result )
+        {
+            spdlog::warn( "Calibration not saved: {}", result.error( ).error_message( ) );
+        }
+    }
+
+    stats_.axis_count       = axis_count;
+    stats_.calibrated_count = calibrated_count;
+    stats_.last_us          = Microseconds( Clock::now( ) - start ).count( );
+    stats_.max_us           = std::max( stats_.max_us, stats_.last_us );
+}
+
+auto AxisCalibrator::take_deadzone_updates( ) -> std::vector< DeadzoneUpdate >
+{
+    return std::exchange( deadzone_updates_, { } );
+}
+
+auto AxisCalibrator::stats( ) const -> CalibrationStats const&
+{
+    return stats_;
+}
+
+auto AxisCalibrator::layout_matches( std::vector< Joystick > const& joysticks ) const -> bool
+{
+    return std::equal(
+        devices_.begin( ),
+        devices_.end( ),
+        joysticks.begin( ),
+        joysticks.end( ),
+        []( CalibratedDevice const& device, Joystick const& joystick ) {
+            return device.device_id == joystick.device_id && device.axes.size( ) == joystick.axes.size( )
+                && device.guid == joystick.guid;
+        }
+    );
+}
+
+auto AxisCalibrator::rebuild( std::vector< Joystick > const& joysticks ) -> void
+{
+    // Keep what was learned about devices that are still connected, and store the rest.
+    store_devices( );
+    auto previous       = std::move( devices_ );
+    auto previous_state = std::move( state_ );
+    devices_.clear( );
+    state_.clear( );
+    published_deadzones_.clear( );
+
+    auto disconnected = previous.size( );
+    for ( auto const& joystick : joysticks )
+    {
+        auto const axis_count = joystick.axes.size( );
+        auto const same_device = [ &joystick, axis_count ]( CalibratedDevice const& device ) {
+            return device.device_id == joystick.device_id && device.guid == joystick.guid
+                && device.axes.size( ) == axis_count;
+        };
+        auto const kept = std::find_if( previous.begin( ), previous.end( ), same_device );
+
+        if ( kept != previous.end( ) && !kept->guid.empty( ) )
+        {
+            state_.push_back( std::move( previous_state[ static_cast< std::size_t >( kept - previous.begin( ) ) ] ) );
+            devices_.push_back( std::move( *kept ) );
+            kept->guid.clear( ); // Taken
+            --disconnected;
+        }
+        else
+        {
+            auto device      = CalibratedDevice{ joystick.device_id, joystick.name, joystick.guid };
+            auto const known = stored_.find( joystick.guid );
+            if ( known != stored_.end( ) )
+            {
+                device.axes = known->second;
+            }
+            device.axes.resize( axis_count );
+
+            auto states = std::vector< AxisState >( axis_count );
+            for ( auto a = 0UL; a < axis_count; ++a )
+            {
+                states[ a ].fast_mean     = device.axes[ a ].center;
+                states[ a ].rest_variance = device.axes[ a ].noise * device.axes[ a ].noise;
+            }
+            devices_.push_back( std::move( device ) );
+            state_.push_back( std::move( states ) );
+        }
+        published_deadzones_.emplace_back( );
+    }
+
+    // Stored calibrations are published right away instead of after the next check.
+    check_deadzones( );
+
+    if ( disconnected > 0UL && unsaved_ )
+    {
+        if ( auto result = save( ); !result )
+        {
+            spdlog::warn( "Calibration not saved: {}", result.error( ).error_message( ) );
+        }
+    }
+}
+
+auto AxisCalibrator::store_devices( ) -> void
+{
+    for ( auto const& device : devices_ )
+    {
+        auto const polled = std::any_of( device.axes.begin( ), device.axes.end( ), []( auto const& axis ) {
+            return axis.minimum <= axis.maximum;
+        } );
+        if ( polled )
+        {
+            stored_[ device.guid ] = device.axes;
+        }
+    }
+    stats_.stored_count = stored_.size( );
+}
+
+auto AxisCalibrator::check_deadzones( ) -> void
+{
+    for ( auto d = 0UL; d < devices_.size( ); ++d )
+    {
+        auto const& device    = devices_[ d ];
+        auto&       published = published_deadzones_[ d ];
+
+        auto deadzones = std::vector< float >( device.axes.size( ) );
+        std::transform( device.axes.begin( ), device.axes.end( ), deadzones.begin( ), []( auto const& axis ) {
+            return axis.deadzone( );
+        } );
+
+        auto const close   = []( float a, float b ) { return std::abs( a - b ) <= deadzone_tolerance; };
+        auto const changed
+            = !std::equal( deadzones.begin( ), deadzones.end( ), published.begin( ), published.end( ), close );
+        if ( changed )
+        {
+            published = deadzones;
+            deadzone_updates_.push_back( { device.guid, std::move( deadzones ) } );
+        }
+    }
+}
+
+auto configure_calibration_gui( AxisCalibrator& calibrator ) -> void
+{
+    auto const& stats = calibrator.stats( );
+    ImGui::Text(
+        "Calibration: %zu of %zu axes calibrated, %zu models stored | %.1f us/frame (max %.1f)",
+        stats.calibrated_count,
+        stats.axis_count,
+        stats.stored_count,
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( !ImGui::TreeNode( "Axis calibration" ) )
+    {
+        return;
+    }
+
+    auto forget = std::string{ };
+    for ( auto const& device : calibrator.devices( ) )
+    {
+        ImGui::PushID( device.device_id );
+        if ( ImGui::TreeNode( "device", "%s (%s)", device.name.c_str( ), device.guid.c_str( ) ) )
+        {
+            if ( ImGui::BeginTable( "calibration", 7 ) )
+            {
+                for ( auto const* column : { "Axis", "Min", "Center", "Max", "Noise", "Deadzone", "Status" } )
+                {
+                    ImGui::TableSetupColumn( column );
+                }
+                ImGui::TableHeadersRow( );
+
+                for ( auto a = 0UL; a < device.axes.size( ); ++a )
+                {
+                    auto const& axis = device.axes[ a ];
+                    ImGui::TableNextRow( );
+                    ImGui::TableNextColumn( );
+                    ImGui::Text( "%zu", a );
+                    for ( auto const value : { axis.minimum, axis.center, axis.maximum, axis.noise, axis.deadzone( ) } )
+                    {
+                        ImGui::TableNextColumn( );
+                        ImGui::Text( "%.4f", static_cast< double >( value ) );
+                    }
+                    ImGui::TableNextColumn( );
+                    ImGui::TextUnformatted(
+                        !axis.is_calibrated( ) ? "Learning" : ( axis.is_one_sided( ) ? "One-sided" : "Centered" )
+                    );
+                }
+                ImGui::EndTable( );
+            }
+            if ( ImGui::Button( "Forget" ) )
+            {
+                forget = device.guid;
+            }
+            ImGui::TreePop( );
+        }
+        ImGui::PopID( );
+    }
+    ImGui::TreePop( );
+
+    if ( !forget.empty( ) )
+    {
+        calibrator.reset( forget );
+    }
+}
+
+} // namespace ltb::joy
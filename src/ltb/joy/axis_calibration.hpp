@@ -0,0 +1,173 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Calibration files hold what was learned about the axes of every device model, so
+///        a device that reconnects starts out calibrated:
+///
+///     CalibrationFileHeader
+///     CalibrationDevice[ device_count ]
+///     AxisCalibration[ axis_count ]     // Grouped by device
+///     char guids[ strings_size ]
+///
+/// Written in native byte order like recordings (see `recording_magic`), so a file only moves
+/// between machines of the same endianness.
+constexpr auto calibration_magic          = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'C', 'A', 'L', '\0' };
+constexpr auto calibration_format_version = std::uint32_t( 1 );
+
+struct CalibrationFileHeader
+{
+    std::array< char, 8 > magic        = calibration_magic;
+    std::uint32_t         version      = calibration_format_version;
+    std::uint32_t         header_size  = sizeof( CalibrationFileHeader );
+    std::uint64_t         device_count = 0;
+    std::uint64_t         axis_count   = 0;
+    std::uint64_t         strings_size = 0;
+};
+
+struct CalibrationDevice
+{
+    std::uint64_t guid_offset = 0;
+    std::uint32_t guid_size   = 0;
+    std::uint32_t axis_count  = 0;
+    std::uint64_t first_axis  = 0;
+};
+
+/// \brief What has been learned about one axis. Each field is a constant-size streaming
+///        estimate that is updated with every sample.
+struct AxisCalibration
+{
+    float minimum      = 1.f; ///< Smallest value seen. Greater than `maximum` until the axis is sampled
+    float maximum      = -1.f;
+    float center       = 0.f; ///< Mean value at rest
+    float noise        = 0.f; ///< Standard deviation at rest
+    float rest_seconds = 0.f; ///< How long the axis has been seen at rest, up to a cap
+
+    /// \brief The range and rest position are known well enough to normalize with.
+    [[nodiscard]] auto is_calibrated( ) const -> bool;
+
+    /// \brief Rests at one end of its range, like a trigger.
+    [[nodiscard]] auto is_one_sided( ) const -> bool;
+
+    /// \brief `value` scaled so `minimum`, `center` and `maximum` read -1, 0 and 1. One-sided
+    ///        axes are scaled linearly from -1 to 1 instead.
+    [[nodiscard]] auto normalize( float value ) const -> float;
+
+    /// \brief A deadzone, in normalized units, wide enough to hide the noise at rest. Zero for
+    ///        one-sided or uncalibrated axes.
+    [[nodiscard]] auto deadzone( ) const -> float;
+};
+
+static_assert( sizeof( CalibrationFileHeader ) == 40 );
+static_assert( sizeof( CalibrationDevice ) == 24 );
+static_assert( sizeof( AxisCalibration ) == 20 );
+
+/// \brief A connected device and what has been learned about it.
+struct CalibratedDevice
+{
+    int                            device_id      = -1;
+    std::string                    name           = { };
+    std::string                    guid           = { };
+    std::int64_t                   last_sample_us = 0;
+    std::vector< AxisCalibration > axes           = { };
+};
+
+/// \brief New automatic deadzones for every axis of devices with `guid`.
+struct DeadzoneUpdate
+{
+    std::string          guid      = { };
+    std::vector< float > deadzones = { };
+};
+
+struct CalibrationStats
+{
+    std::size_t axis_count       = 0; ///< Across every connected device
+    std::size_t calibrated_count = 0;
+    std::size_t stored_count     = 0; ///< Device models with a stored calibration
+    double      last_us          = 0.0;
+    double      max_us           = 0.0;
+};
+
+/// \brief The pipeline's calibration stage, which runs first: learns the range, rest center
+///        and rest noise of every axis from the input itself, and writes each calibrated axis
+///        normalized to `Joystick::processed_axes` (uncalibrated axes pass through).
+///
+/// An axis is at rest while a short moving standard deviation stays below a threshold near
+/// where it was last at rest. Only then do `center` and `noise` move, as averages that start
+/// out cumulative and become exponential once they have settled, so a stick held still at
+/// full deflection does not move the center.
+///
+/// Calibrations are stored per device GUID. Devices seen before start from the stored
+/// calibration, which is written back to the file periodically, when a device disconnects,
+/// and on `save`.
+class AxisCalibrator
+{
+public:
+    /// \brief Start from the calibrations in `path` and save back to it. A missing file is
+    ///        not an error. If the file cannot be read, calibration starts over and the file
+    ///        is replaced on the next save.
+    auto load( std::filesystem::path path ) -> utils::Expected< void >;
+
+    /// \brief Write every calibration to the loaded path, if there is one.
+    auto save( ) -> utils::Expected< void >;
+
+    /// \brief Forget what was learned about devices with `guid`.
+    auto reset( std::string const& guid ) -> void;
+
+    [[nodiscard]] auto devices( ) const -> std::vector< CalibratedDevice > const&;
+
+    auto process( std::vector< Joystick >& joysticks ) -> void;
+
+    /// \brief Devices whose automatic deadzones changed noticeably since they were last taken.
+    auto take_deadzone_updates( ) -> std::vector< DeadzoneUpdate >;
+
+    [[nodiscard]] auto stats( ) const -> CalibrationStats const&;
+
+private:
+    /// \brief The short-term estimates used to tell when an axis is at rest.
+    struct AxisState
+    {
+        float fast_mean     = 0.f;
+        float fast_variance = 0.f;
+        float still_seconds = 0.f;
+        float rest_variance = 0.f; ///< `noise` squared, to avoid a square root per sample
+    };
+
+    std::filesystem::path                                             path_                = { };
+    std::unordered_map< std::string, std::vector< AxisCalibration > > stored_               = { };
+    std::vector< CalibratedDevice >                                   devices_             = { };
+    std::vector< std::vector< AxisState > >                           state_               = { }; ///< Per device
+    std::vector< std::vector< float > >                               published_deadzones_ = { }; ///< Per device
+    std::vector< DeadzoneUpdate >                                     deadzone_updates_    = { };
+    std::int64_t                                                      next_check_us_       = 0;
+    std::int64_t                                                      next_save_us_        = 0;
+    bool                                                              unsaved_             = false;
+
+    CalibrationStats stats_ = { };
+
+    [[nodiscard]] auto layout_matches( std::vector< Joystick > const& joysticks ) const -> bool;
+    auto               rebuild( std::vector< Joystick > const& joysticks ) -> void;
+    auto               store_devices( ) -> void;
+    auto               check_deadzones( ) -> void;
+};
+
+/// \brief Show what has been learned about each connected device, and let it be forgotten.
+auto configure_calibration_gui( AxisCalibrator& calibrator ) -> void;
+
+} // namespace ltb::joy
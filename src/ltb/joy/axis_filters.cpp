@@ -0,0 +1,566 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_filters.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+constexpr auto two_pi = 6.283185307179586;
+
+/// \brief Biquads are redesigned once the measured sample rate is this far from the rate
+///        they were designed for.
+constexpr auto redesign_tolerance = 0.1;
+
+/// \brief Assumed until a device has been sampled twice.
+constexpr auto initial_sample_rate_hz = 1000.0;
+
+/// \brief The filter type of `slot` in a layout with the given lane ranges.
+auto lane_type( std::size_t slot, std::size_t one_euro_begin, std::size_t biquad_begin, std::size_t filtered_end )
+    -> FilterType
+{
+    if ( slot < one_euro_begin )
+    {
+        return FilterType::Ema;
+    }
+    if ( slot < biquad_begin )
+    {
+        return FilterType::OneEuro;
+    }
+    return ( slot < filtered_end ) ? FilterType::Biquad : FilterType::None;
+}
+
+auto configure_axis_filter_gui( AxisFilter& filter ) -> bool
+{
+    auto changed = false;
+
+    auto type = static_cast< int >( filter.type );
+    if ( ImGui::Combo( "Filter", &type, "None\0EMA\0One-Euro\0Biquad\0" ) )
+    {
+        filter.type = static_cast< FilterType >( type );
+        changed     = true;
+    }
+
+    switch ( filter.type )
+    {
+        case FilterType::None:
+            break;
+        case FilterType::Ema:
+            changed |= ImGui::SliderFloat(
+                "Cutoff",
+                &filter.cutoff_hz,
+                0.1f,
+                100.f,
+                "%.2f Hz",
+                ImGuiSliderFlags_Logarithmic
+            );
+            break;
+        case FilterType::OneEuro:
+            changed |= ImGui::SliderFloat(
+                "Min cutoff",
+                &filter.min_cutoff_hz,
+                0.01f,
+                10.f,
+                "%.3f Hz",
+                ImGuiSliderFlags_Logarithmic
+            );
+            changed |= ImGui::SliderFloat( "Beta", &filter.beta, 0.f, 10.f, "%.4f", ImGuiSliderFlags_Logarithmic );
+            changed |= ImGui::SliderFloat(
+                "Speed cutoff",
+                &filter.derivative_cutoff_hz,
+                0.1f,
+                10.f,
+                "%.2f Hz",
+                ImGuiSliderFlags_Logarithmic
+            );
+            break;
+        case FilterType::Biquad:
+            changed |= ImGui::SliderFloat(
+                "Cutoff",
+                &filter.cutoff_hz,
+                0.1f,
+                100.f,
+                "%.2f Hz",
+                ImGuiSliderFlags_Logarithmic
+            );
+            changed |= ImGui::SliderFloat( "Q", &filter.q, 0.3f, 5.f, "%.3f" );
+            break;
+    }
+    return changed;
+}
+
+} // namespace
+
+auto parse_filter_type( std::string_view text ) -> utils::Expected< FilterType >
+{
+    if ( text == "none" )
+    {
+        return FilterType::None;
+    }
+    if ( text == "ema" )
+    {
+        return FilterType::Ema;
+    }
+    if ( text == "one-euro" )
+    {
+        return FilterType::OneEuro;
+    }
+    if ( text == "biquad" )
+    {
+        return FilterType::Biquad;
+    }
+    return LTB_MAKE_UNEXPECTED_ERROR( "Unknown filter '{}', expected 'none', 'ema', 'one-euro' or 'biquad'", text );
+}
+
+auto FilterBank::filters( std::string const& guid ) const -> DeviceFilters const&
+{
+    static auto const none = DeviceFilters{ };
+
+    auto const iter = filters_.find( guid );
+    return ( iter != filters_.end( ) ) ? iter->second : none;
+}
+
+auto FilterBank::set_filters( std::string const& guid, DeviceFilters filters ) -> void
+{
+    filters_[ guid ] = std::move( filters );
+    changed_guids_.insert( guid );
+}
+
+auto FilterBank::default_filter( ) const -> AxisFilter const&
+{
+    return default_filter_;
+}
+
+auto FilterBank::set_default_filter( AxisFilter filter ) -> void
+{
+    default_filter_  = filter;
+    default_changed_ = true;
+}
+
+auto FilterBank::devices( ) const -> std::vector< Joystick > const&
+{
+    return devices_;
+}
+
+auto FilterBank::process( std::vector< Joystick >& joysticks ) -> void
+{
+    auto const start        = Clock::now( );
+    auto const record_stats = [ this, start ] {
+        stats_.sample_rate_hz = ( measured_dt_ > 0.0 ) ? 1.0 / measured_dt_ : 0.0;
+        stats_.last_us        = Microseconds( Clock::now( ) - start ).count( );
+        stats_.max_us         = std::max( stats_.max_us, stats_.last_us );
+    };
+
+    if ( !layout_matches( joysticks ) )
+    {
+        rebuild( joysticks, false );
+    }
+    else if ( default_changed_ || !changed_guids_.empty( ) )
+    {
+        update( joysticks );
+    }
+    changed_guids_.clear( );
+    default_changed_ = false;
+
+    if ( filtered_end_ == 0UL )
+    {
+        record_stats( );
+        return;
+    }
+
+    auto lane        = 0UL;
+    auto dt_sum      = 0.0;
+    auto dt_count    = 0UL;
+    for ( auto d = 0UL; d < joysticks.size( ); ++d )
+    {
+        auto const& joystick = joysticks[ d ];
+        auto const  dt_us    = joystick.timestamp_us - last_sample_us_[ d ];
+        last_sample_us_[ d ] = joystick.timestamp_us;
+        if ( !reset_ && dt_us > 0 )
+        {
+            dt_sum += static_cast< double >( dt_us ) * 1e-6;
+            ++dt_count;
+        }
+
+        // A device polled twice without a new sample barely moves its filters.
+        auto const dt = static_cast< float >( static_cast< double >( std::max( dt_us, std::int64_t( 1 ) ) ) * 1e-6 );
+
+        // Filter the calibrated values when the calibration stage produced them.
+        auto const& input = ( joystick.processed_axes.size( ) == joystick.axes.size( ) ) ? joystick.processed_axes
+                                                                                         : joystick.axes;
+        for ( auto a = 0UL; a < input.size( ); ++a, ++lane )
+        {
+            values_[ slot_[ lane ] ] = input[ a ];
+            dt_[ slot_[ lane ] ]     = dt;
+        }
+    }
+
+    if ( dt_count > 0UL )
+    {
+        auto const dt = dt_sum / static_cast< double >( dt_count );
+        measured_dt_  = ( measured_dt_ > 0.0 ) ? measured_dt_ + 0.05 * ( dt - measured_dt_ ) : dt;
+
+        auto const rate_hz = 1.0 / measured_dt_;
+        if ( std::abs( rate_hz - design_rate_hz_ ) > redesign_tolerance * design_rate_hz_ )
+        {
+            design_biquads( rate_hz );
+        }
+    }
+    if ( reset_ )
+    {
+        reset_state( );
+        reset_ = false;
+    }
+    for ( auto const slot : reset_slots_ )
+    {
+        reset_lane( slot );
+    }
+    reset_slots_.clear( );
+
+    auto const& kernels = numeric_kernels( );
+    kernels.ema_lanes( one_euro_begin_, values_.data( ), previous_.data( ), dt_.data( ), omega_.data( ) );
+
+    auto const one_euro = one_euro_begin_;
+    kernels.one_euro_lanes(
+        biquad_begin_ - one_euro,
+        values_.data( ) + one_euro,
+        previous_.data( ) + one_euro,
+        derivative_.data( ) + one_euro,
+        dt_.data( ) + one_euro,
+        omega_.data( ) + one_euro,
+        beta_.data( ) + one_euro,
+        derivative_omega_.data( ) + one_euro
+    );
+
+    kernels.biquad_lanes(
+        filtered_end_ - biquad_begin_,
+        values_.data( ) + biquad_begin_,
+        z1_.data( ),
+        z2_.data( ),
+        b0_.data( ),
+        b1_.data( ),
+        b2_.data( ),
+        a1_.data( ),
+        a2_.data( )
+    );
+
+    lane = 0UL;
+    for ( auto& joystick : joysticks )
+    {
+        joystick.processed_axes.resize( joystick.axes.size( ) );
+        for ( auto& value : joystick.processed_axes )
+        {
+            value = values_[ slot_[ lane++ ] ];
+        }
+    }
+
+    record_stats( );
+}
+
+auto FilterBank::stats( ) const -> FilterStats const&
+{
+    return stats_;
+}
+
+auto FilterBank::layout_matches( std::vector< Joystick > const& joysticks ) const -> bool
+{
+    return std::equal(
+        layout_.begin( ),
+        layout_.end( ),
+        joysticks.begin( ),
+        joysticks.end( ),
+        []( DeviceLayout const& layout, Joystick const& joystick ) {
+            return layout.device_id == joystick.device_id && layout.axis_count == joystick.axes.size( )
+                && layout.guid == joystick.guid;
+        }
+    );
+}
+
+auto FilterBank::axis_filter( DeviceFilters const& filters, std::size_t axis ) const -> AxisFilter const&
+{
+    return ( axis < filters.axes.size( ) ) ? filters.axes[ axis ] : default_filter_;
+}
+
+auto FilterBank::update( std::vector< Joystick > const& joysticks ) -> void
+{
+    auto lane = 0UL;
+    for ( auto const& joystick : joysticks )
+    {
+        if ( !default_changed_ && changed_guids_.find( joystick.guid ) == changed_guids_.end( ) )
+        {
+            lane += joystick.axes.size( );
+            continue;
+        }
+
+        auto const& device_filters = filters( joystick.guid );
+        for ( auto a = 0UL; a < joystick.axes.size( ); ++a, ++lane )
+        {
+            auto const& filter = axis_filter( device_filters, a );
+            auto const  slot   = std::size_t( slot_[ lane ] );
+            if ( lane_type( slot, one_euro_begin_, biquad_begin_, filtered_end_ ) != filter.type )
+            {
+                rebuild( joysticks, true );
+                return;
+            }
+            set_lane( slot, filter );
+        }
+    }
+}
+
+auto FilterBank::rebuild( std::vector< Joystick > const& joysticks, bool keep_state ) -> void
+{
+    auto const old_slot           = std::move( slot_ );
+    auto const old_previous       = std::move( previous_ );
+    auto const old_derivative     = std::move( derivative_ );
+    auto const old_z1             = std::move( z1_ );
+    auto const old_z2             = std::move( z2_ );
+    auto const old_one_euro_begin = one_euro_begin_;
+    auto const old_biquad_begin   = biquad_begin_;
+    auto const old_filtered_end   = filtered_end_;
+
+    layout_.clear( );
+    devices_.clear( );
+    reset_slots_.clear( );
+
+    // Every axis' filter in device order, to be counted by type before slots are given out.
+    auto axis_filters = std::vector< AxisFilter const* >{ };
+    for ( auto const& joystick : joysticks )
+    {
+        layout_.push_back( { joystick.device_id, joystick.axes.size( ), joystick.guid } );
+
+        auto const seen = std::any_of( devices_.begin( ), devices_.end( ), [ &joystick ]( auto const& device ) {
+            return device.guid == joystick.guid;
+        } );
+        if ( !seen )
+        {
+            devices_.push_back( joystick );
+        }
+
+        auto const& device_filters = filters( joystick.guid );
+        for ( auto a = 0UL; a < joystick.axes.size( ); ++a )
+        {
+            axis_filters.push_back( &axis_filter( device_filters, a ) );
+        }
+    }
+
+    auto count_of = [ &axis_filters ]( FilterType type ) {
+        auto const is_type = [ type ]( AxisFilter const* filter ) { return filter->type == type; };
+        return static_cast< std::size_t >( std::count_if( axis_filters.begin( ), axis_filters.end( ), is_type ) );
+    };
+    stats_.ema_count      = count_of( FilterType::Ema );
+    stats_.one_euro_count = count_of( FilterType::OneEuro );
+    stats_.biquad_count   = count_of( FilterType::Biquad );
+    one_euro_begin_       = stats_.ema_count;
+    biquad_begin_         = one_euro_begin_ + stats_.one_euro_count;
+    filtered_end_         = biquad_begin_ + stats_.biquad_count;
+
+    auto const lane_count = axis_filters.size( );
+    slot_.resize( lane_count );
+    values_.resize( lane_count );
+    dt_.resize( lane_count );
+    if ( !keep_state )
+    {
+        last_sample_us_.assign( joysticks.size( ), 0 );
+    }
+
+    for ( auto* lanes : { &omega_, &beta_, &derivative_omega_, &previous_, &derivative_ } )
+    {
+        lanes->assign( biquad_begin_, 0.f );
+    }
+    for ( auto* lanes : { &b0_, &b1_, &b2_, &a1_, &a2_, &z1_, &z2_ } )
+    {
+        lanes->assign( stats_.biquad_count, 0.f );
+    }
+    biquad_filter_.resize( stats_.biquad_count );
+
+    if ( design_rate_hz_ <= 0.0 )
+    {
+        design_rate_hz_ = initial_sample_rate_hz;
+    }
+
+    auto next_slot = std::array< std::size_t, 4 >{ filtered_end_, 0UL, one_euro_begin_, biquad_begin_ };
+    for ( auto lane = 0UL; lane < lane_count; ++lane )
+    {
+        auto const& filter = *axis_filters[ lane ];
+        auto const  slot   = next_slot[ static_cast< std::size_t >( filter.type ) ]++;
+        slot_[ lane ]      = static_cast< std::uint32_t >( slot );
+        set_lane( slot, filter );
+
+        if ( !keep_state || filter.type == FilterType::None )
+        {
+            continue;
+        }
+
+        auto const old = std::size_t( old_slot[ lane ] );
+        if ( lane_type( old, old_one_euro_begin, old_biquad_begin, old_filtered_end ) != filter.type )
+        {
+            reset_slots_.push_back( static_cast< std::uint32_t >( slot ) );
+        }
+        else if ( filter.type == FilterType::Biquad )
+        {
+            z1_[ slot - biquad_begin_ ] = old_z1[ old - old_biquad_begin ];
+            z2_[ slot - biquad_begin_ ] = old_z2[ old - old_biquad_begin ];
+        }
+        else
+        {
+            previous_[ slot ]   = old_previous[ old ];
+            derivative_[ slot ] = old_derivative[ old ];
+        }
+    }
+
+    reset_ = reset_ || !keep_state;
+}
+
+auto FilterBank::set_lane( std::size_t slot, AxisFilter const& filter ) -> void
+{
+    switch ( filter.type )
+    {
+        case FilterType::None:
+            break;
+        case FilterType::Ema:
+            omega_[ slot ] = static_cast< float >( two_pi * filter.cutoff_hz );
+            break;
+        case FilterType::OneEuro:
+            omega_[ slot ]            = static_cast< float >( two_pi * filter.min_cutoff_hz );
+            beta_[ slot ]             = static_cast< float >( two_pi * filter.beta );
+            derivative_omega_[ slot ] = static_cast< float >( two_pi * filter.derivative_cutoff_hz );
+            break;
+        case FilterType::Biquad:
+            biquad_filter_[ slot - biquad_begin_ ] = filter;
+            design_biquad( slot - biquad_begin_ );
+            break;
+    }
+}
+
+auto FilterBank::design_biquads( double sample_rate_hz ) -> void
+{
+    design_rate_hz_ = sample_rate_hz;
+
+    for ( auto i = 0UL; i < biquad_filter_.size( ); ++i )
+    {
+        design_biquad( i );
+    }
+}
+
+auto FilterBank::design_biquad( std::size_t index ) -> void
+{
+    // The low-pass from Robert Bristow-Johnson's "Audio EQ Cookbook".
+    auto const& filter = biquad_filter_[ index ];
+    auto const  cutoff = std::min( static_cast< double >( filter.cutoff_hz ), 0.45 * design_rate_hz_ );
+    auto const  w0     = two_pi * cutoff / design_rate_hz_;
+    auto const  cos_w0 = std::cos( w0 );
+    auto const  alpha  = std::sin( w0 ) / ( 2.0 * std::max( static_cast< double >( filter.q ), 0.1 ) );
+    auto const  a0     = 1.0 + alpha;
+
+    b0_[ index ] = static_cast< float >( ( 1.0 - cos_w0 ) * 0.5 / a0 );
+    b1_[ index ] = static_cast< float >( ( 1.0 - cos_w0 ) / a0 );
+    b2_[ index ] = b0_[ index ];
+    a1_[ index ] = static_cast< float >( -2.0 * cos_w0 / a0 );
+    a2_[ index ] = static_cast< float >( ( 1.0 - alpha ) / a0 );
+}
+
+auto FilterBank::reset_state( ) -> void
+{
+    std::copy( values_.begin( ), values_.begin( ) + static_cast< long >( biquad_begin_ ), previous_.begin( ) );
+    std::fill( derivative_.begin( ), derivative_.end( ), 0.f );
+
+    for ( auto slot = biquad_begin_; slot < filtered_end_; ++slot )
+    {
+        reset_lane( slot );
+    }
+}
+
+auto FilterBank::reset_lane( std::size_t slot ) -> void
+{
+    if ( slot < biquad_begin_ )
+    {
+        previous_[ slot ]   = values_[ slot ];
+        derivative_[ slot ] = 0.f;
+        return;
+    }
+
+    // The state a biquad reaches after holding its current input forever.
+    auto const i     = slot - biquad_begin_;
+    auto const input = values_[ slot ];
+    z1_[ i ]         = input * ( 1.f - b0_[ i ] );
+    z2_[ i ]         = input * ( b2_[ i ] - a2_[ i ] );
+}
+
+auto configure_filter_gui( FilterBank& bank ) -> void
+{
+    auto const& stats = bank.stats( );
+    ImGui::Text(
+        "Filtering: %zu EMA, %zu One-Euro, %zu biquad at %.0f Hz | %.1f us/frame (max %.1f)",
+        stats.ema_count,
+        stats.one_euro_count,
+        stats.biquad_count,
+        stats.sample_rate_hz,
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( !ImGui::TreeNode( "Axis filters" ) )
+    {
+        return;
+    }
+
+    if ( ImGui::TreeNode( "Default" ) )
+    {
+        auto filter = bank.default_filter( );
+        if ( configure_axis_filter_gui( filter ) )
+        {
+            bank.set_default_filter( filter );
+        }
+        ImGui::TreePop( );
+    }
+
+    for ( auto const& device : bank.devices( ) )
+    {
+        ImGui::PushID( device.guid.c_str( ) );
+        if ( ImGui::TreeNode( "device", "%s (%s)", device.name.c_str( ), device.guid.c_str( ) ) )
+        {
+            auto filters = bank.filters( device.guid );
+            auto changed = false;
+
+            // Axes without their own filter start from the default.
+            filters.axes.resize( std::max( filters.axes.size( ), device.axes.size( ) ), bank.default_filter( ) );
+            for ( auto a = 0UL; a < device.axes.size( ); ++a )
+            {
+                ImGui::PushID( static_cast< int >( a ) );
+                if ( ImGui::TreeNode( "axis", "Axis %zu", a ) )
+                {
+                    changed |= configure_axis_filter_gui( filters.axes[ a ] );
+                    ImGui::TreePop( );
+                }
+                ImGui::PopID( );
+            }
+
+            if ( changed )
+            {
+                bank.set_filters( device.guid, std::move( filters ) );
+            }
+            ImGui::TreePop( );
+        }
+        ImGui::PopID( );
+    }
+    ImGui::TreePop( );
+}
+
+} // namespace ltb::joy
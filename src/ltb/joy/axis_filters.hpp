@@ -0,0 +1,154 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ltb::joy
+{
+
+enum class FilterType
+{
+    None,
+    Ema,     ///< Exponential moving average
+    OneEuro, ///< Smooths slow movement heavily and fast movement lightly (Casiez et al. 2012)
+    Biquad,  ///< Second-order Butterworth-style low-pass
+};
+
+struct AxisFilter
+{
+    FilterType type                 = FilterType::None;
+    float      cutoff_hz            = 10.f; ///< `Ema` and `Biquad`
+    float      q                    = 0.7071f; ///< `Biquad` resonance. 1/sqrt(2) is maximally flat
+    float      min_cutoff_hz        = 1.f; ///< `OneEuro` cutoff when the axis is still
+    float      beta                 = 0.05f; ///< `OneEuro` cutoff increase per unit/s of speed
+    float      derivative_cutoff_hz = 1.f; ///< `OneEuro` smoothing of the speed estimate
+};
+
+auto parse_filter_type( std::string_view text ) -> utils::Expected< FilterType >;
+
+struct DeviceFilters
+{
+    std::vector< AxisFilter > axes = { }; ///< Axes past the end use the bank's default filter
+};
+
+struct FilterStats
+{
+    std::size_t ema_count      = 0; ///< Axes per filter type, across every device
+    std::size_t one_euro_count = 0;
+    std::size_t biquad_count   = 0;
+    double      sample_rate_hz = 0.0; ///< Measured, and used to design the biquads
+    double      last_us        = 0.0;
+    double      max_us         = 0.0;
+};
+
+/// \brief The pipeline's filtering stage: smooths every axis of every device with its own
+///        filter, writing `Joystick::processed_axes`.
+///
+/// Filter parameters and state are stored as structures of arrays with the axes of each
+/// filter type next to each other, so each type is one `numeric_kernels( )` loop over
+/// consecutive lanes. Axes are scattered into that order as they are gathered, and back as
+/// the results are written, so no lane indexes another.
+///
+/// Devices are sampled at whatever rate they are polled, so EMA and One-Euro use each
+/// device's measured time step. The biquads are designed for the measured sample rate
+/// and redesigned (keeping their state) if it drifts.
+///
+/// Editing a device's filters only updates that device's lanes. If an axis changes filter
+/// type the lanes are laid out again, but every axis keeping its type keeps its state.
+class FilterBank
+{
+public:
+    /// \brief Filters of devices with `guid`, or none if they were never set.
+    [[nodiscard]] auto filters( std::string const& guid ) const -> DeviceFilters const&;
+    auto               set_filters( std::string const& guid, DeviceFilters filters ) -> void;
+
+    /// \brief The filter of every axis without its own.
+    [[nodiscard]] auto default_filter( ) const -> AxisFilter const&;
+    auto               set_default_filter( AxisFilter filter ) -> void;
+
+    /// \brief One device of every GUID seen by the last `process`, for choosing what to edit.
+    [[nodiscard]] auto devices( ) const -> std::vector< Joystick > const&;
+
+    auto process( std::vector< Joystick >& joysticks ) -> void;
+
+    [[nodiscard]] auto stats( ) const -> FilterStats const&;
+
+private:
+    struct DeviceLayout
+    {
+        int         device_id  = -1;
+        std::size_t axis_count = 0;
+        std::string guid       = { };
+    };
+
+    std::unordered_map< std::string, DeviceFilters > filters_         = { };
+    AxisFilter                                       default_filter_  = { };
+    std::vector< DeviceLayout >                      layout_          = { };
+    std::vector< Joystick >                          devices_         = { };
+    std::unordered_set< std::string >                changed_guids_   = { }; ///< Set since the last `process`
+    bool                                             default_changed_ = false;
+    bool                                             reset_           = true; ///< Start every filter at its input
+
+    std::vector< std::uint32_t > slot_           = { }; ///< Where each axis, in device order, is filtered
+    std::vector< std::uint32_t > reset_slots_    = { }; ///< Filters to start at their next input
+    std::vector< std::int64_t >  last_sample_us_ = { }; ///< Per device
+    std::vector< float >         values_         = { }; ///< Every axis, grouped by filter type
+    std::vector< float >         dt_             = { }; ///< Seconds since each axis' device was last sampled
+    std::size_t                  one_euro_begin_ = 0; ///< EMA lanes come first
+    std::size_t                  biquad_begin_   = 0;
+    std::size_t                  filtered_end_   = 0; ///< Lanes from here on are not filtered
+    double                       measured_dt_    = 0.0;
+    double                       design_rate_hz_ = 0.0; ///< Sample rate the biquads were designed for
+
+    // EMA and One-Euro lanes. Cutoffs are stored as angular frequencies (`2 pi cutoff`).
+    std::vector< float > omega_            = { }; ///< The EMA cutoff, or the One-Euro minimum cutoff
+    std::vector< float > beta_             = { }; ///< Scaled by `2 pi` like the cutoffs
+    std::vector< float > derivative_omega_ = { };
+    std::vector< float > previous_         = { }; ///< Last filtered value
+    std::vector< float > derivative_       = { }; ///< Last filtered speed
+
+    // Biquad lanes (transposed direct form II), indexed from `biquad_begin_`.
+    std::vector< AxisFilter > biquad_filter_ = { }; ///< Kept to redesign the coefficients
+    std::vector< float >      b0_            = { };
+    std::vector< float >      b1_            = { };
+    std::vector< float >      b2_            = { };
+    std::vector< float >      a1_            = { };
+    std::vector< float >      a2_            = { };
+    std::vector< float >      z1_            = { };
+    std::vector< float >      z2_            = { };
+
+    FilterStats stats_ = { };
+
+    [[nodiscard]] auto layout_matches( std::vector< Joystick > const& joysticks ) const -> bool;
+    [[nodiscard]] auto axis_filter( DeviceFilters const& filters, std::size_t axis ) const -> AxisFilter const&;
+
+    /// \brief Update the lanes of devices whose filters changed, laying every lane out again
+    ///        only if one of them changed type.
+    auto update( std::vector< Joystick > const& joysticks ) -> void;
+
+    /// \brief Lay every lane out again. With `keep_state`, the layout must match and lanes
+    ///        that keep their filter type keep their state.
+    auto rebuild( std::vector< Joystick > const& joysticks, bool keep_state ) -> void;
+    auto set_lane( std::size_t slot, AxisFilter const& filter ) -> void;
+    auto design_biquads( double sample_rate_hz ) -> void;
+    auto design_biquad( std::size_t index ) -> void;
+    auto reset_state( ) -> void;
+    auto reset_lane( std::size_t slot ) -> void;
+};
+
+/// \brief Edit the default filter and the filters of any device seen so far.
+auto configure_filter_gui( FilterBank& bank ) -> void;
+
+} // namespace ltb::joy
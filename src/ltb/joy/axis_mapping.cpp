@@ -0,0 +1,428 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_mapping.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+auto identity_mapping( ) -> AxisMapping const&
+{
+    static auto const identity = AxisMapping{ };
+    return identity;
+}
+
+/// \brief True if both mappings produce the same curve table.
+auto same_curve( AxisMapping const& lhs, AxisMapping const& rhs ) -> bool
+{
+    if ( lhs.curve != rhs.curve )
+    {
+        return false;
+    }
+    switch ( lhs.curve )
+    {
+        case ResponseCurve::Linear:
+            return true;
+        case ResponseCurve::Power:
+            return lhs.exponent == rhs.exponent;
+        case ResponseCurve::Table:
+            return lhs.table == rhs.table;
+    }
+    return false;
+}
+
+/// \brief Sample the curve of `mapping` at `curve_table_segments + 1` evenly spaced inputs.
+auto append_curve_table( AxisMapping const& mapping, std::vector< float >& tables ) -> void
+{
+    for ( auto s = 0UL; s <= curve_table_segments; ++s )
+    {
+        auto const input  = static_cast< float >( s ) / static_cast< float >( curve_table_segments );
+        auto       output = input;
+
+        if ( mapping.curve == ResponseCurve::Power )
+        {
+            output = std::pow( input, std::max( mapping.exponent, 0.01f ) );
+        }
+        else if ( mapping.curve == ResponseCurve::Table && mapping.table.size( ) >= 2UL )
+        {
+            auto const position = input * static_cast< float >( mapping.table.size( ) - 1UL );
+            auto const index    = std::min( static_cast< std::size_t >( position ), mapping.table.size( ) - 2UL );
+            auto const fraction = position - static_cast< float >( index );
+            output = mapping.table[ index ] + fraction * ( mapping.table[ index + 1UL ] - mapping.table[ index ] );
+        }
+
+        tables.push_back( std::clamp( output, 0.f, 1.f ) );
+    }
+}
+
+auto configure_axis_mapping_gui( AxisMapping& mapping ) -> bool
+{
+    auto changed = false;
+    changed |= ImGui::SliderFloat( "Deadzone", &mapping.deadzone, 0.f, 0.9f, "%.3f" );
+    changed |= ImGui::SliderFloat( "Outer deadzone", &mapping.outer_deadzone, 0.f, 0.9f, "%.3f" );
+    changed |= ImGui::SliderFloat( "Anti-deadzone", &mapping.anti_deadzone, 0.f, 0.9f, "%.3f" );
+
+    auto curve = static_cast< int >( mapping.curve );
+    if ( ImGui::Combo( "Curve", &curve, "Linear\0Power\0Table\0" ) )
+    {
+        mapping.curve = static_cast< ResponseCurve >( curve );
+        changed       = true;
+    }
+
+    if ( mapping.curve == ResponseCurve::Power )
+    {
+        changed |= ImGui::SliderFloat( "Exponent", &mapping.exponent, 0.2f, 5.f, "%.2f", ImGuiSliderFlags_Logarithmic );
+    }
+    else if ( mapping.curve == ResponseCurve::Table )
+    {
+        constexpr auto default_point_count = std::size_t( 9 );
+        if ( mapping.table.size( ) < 2UL )
+        {
+            mapping.table.resize( default_point_count );
+            for ( auto p = 0UL; p < default_point_count; ++p )
+            {
+                mapping.table[ p ] = static_cast< float >( p ) / static_cast< float >( default_point_count - 1UL );
+            }
+            changed = true;
+        }
+
+        for ( auto p = 0UL; p < mapping.table.size( ); ++p )
+        {
+            ImGui::PushID( static_cast< int >( p ) );
+            if ( p > 0UL )
+            {
+                ImGui::SameLine( );
+            }
+            changed |= ImGui::VSliderFloat( "##point", { 24.f, 96.f }, &mapping.table[ p ], 0.f, 1.f, "" );
+            ImGui::PopID( );
+        }
+    }
+
+    // Degenerate ranges would divide by zero when the batch is built.
+    mapping.outer_deadzone = std::min( mapping.outer_deadzone, 0.99f - mapping.deadzone );
+    return changed;
+}
+
+} // namespace
+
+auto AxisMapping::is_identity( ) const -> bool
+{
+    return deadzone == 0.f && outer_deadzone == 0.f && anti_deadzone == 0.f && curve == ResponseCurve::Linear;
+}
+
+auto AxisMapper::mapping( std::string const& guid ) const -> DeviceMapping const&
+{
+    static auto const identity = DeviceMapping{ };
+
+    auto const iter = mappings_.find( guid );
+    return ( iter != mappings_.end( ) ) ? iter->second : identity;
+}
+
+auto AxisMapper::set_mapping( std::string const& guid, DeviceMapping mapping ) -> void
+{
+    mappings_[ guid ] = std::move( mapping );
+    dirty_            = true;
+}
+
+auto AxisMapper::set_auto_deadzones( std::string const& guid, std::vector< float > deadzones ) -> void
+{
+    auto_deadzones_[ guid ] = std::move( deadzones );
+    dirty_                  = true;
+}
+
+auto AxisMapper::devices( ) const -> std::vector< Joystick > const&
+{
+    return devices_;
+}
+
+auto AxisMapper::process( std::vector< Joystick >& joysticks ) -> void
+{
+    auto const start = Clock::now( );
+
+    if ( dirty_ || !layout_matches( joysticks ) )
+    {
+        rebuild( joysticks );
+        dirty_ = false;
+    }
+
+    // Map the calibrated and filtered values when earlier stages produced them.
+    auto lane = 0UL;
+    for ( auto const& joystick : joysticks )
+    {
+        auto const& input = ( joystick.processed_axes.size( ) == joystick.axes.size( ) ) ? joystick.processed_axes
+                                                                                         : joystick.axes;
+        std::copy( input.begin( ), input.end( ), values_.begin( ) + static_cast< long >( lane ) );
+        lane += input.size( );
+    }
+
+    // Until a mapping is set, the processed values are the raw values.
+    if ( !identity_ )
+    {
+        map_lanes( );
+    }
+
+    lane = 0UL;
+    for ( auto& joystick : joysticks )
+    {
+        auto const first = values_.begin( ) + static_cast< long >( lane );
+        joystick.processed_axes.assign( first, first + static_cast< long >( joystick.axes.size( ) ) );
+        lane += joystick.axes.size( );
+    }
+
+    stats_.last_us = Microseconds( Clock::now( ) - start ).count( );
+    stats_.max_us  = std::max( stats_.max_us, stats_.last_us );
+}
+
+auto AxisMapper::stats( ) const -> MappingStats const&
+{
+    return stats_;
+}
+
+auto AxisMapper::map_lanes( ) -> void
+{
+    for ( auto s = 0UL; s < stick_x_.size( ); ++s )
+    {
+        stick_x_[ s ] = values_[ stick_x_lane_[ s ] ];
+        stick_y_[ s ] = values_[ stick_y_lane_[ s ] ];
+    }
+
+    auto const& kernels = numeric_kernels( );
+    kernels.map_axis_lanes(
+        values_.size( ),
+        values_.data( ),
+        deadzone_.data( ),
+        inverse_range_.data( ),
+        anti_deadzone_.data( ),
+        table_offset_.data( ),
+        tables_.data( )
+    );
+    kernels.map_stick_lanes(
+        stick_x_.size( ),
+        stick_x_.data( ),
+        stick_y_.data( ),
+        stick_deadzone_.data( ),
+        stick_inverse_range_.data( ),
+        stick_anti_deadzone_.data( ),
+        stick_table_offset_.data( ),
+        tables_.data( )
+    );
+
+    for ( auto s = 0UL; s < stick_x_.size( ); ++s )
+    {
+        values_[ stick_x_lane_[ s ] ] = stick_x_[ s ];
+        values_[ stick_y_lane_[ s ] ] = stick_y_[ s ];
+    }
+}
+
+auto AxisMapper::layout_matches( std::vector< Joystick > const& joysticks ) const -> bool
+{
+    return std::equal(
+        layout_.begin( ),
+        layout_.end( ),
+        joysticks.begin( ),
+        joysticks.end( ),
+        []( DeviceLayout const& layout, Joystick const& joystick ) {
+            return layout.device_id == joystick.device_id && layout.axis_count == joystick.axes.size( )
+                && layout.guid == joystick.guid;
+        }
+    );
+}
+
+auto AxisMapper::rebuild( std::vector< Joystick > const& joysticks ) -> void
+{
+    layout_.clear( );
+    devices_.clear( );
+    for ( auto* lanes : { &deadzone_, &inverse_range_, &anti_deadzone_ } )
+    {
+        lanes->clear( );
+    }
+    for ( auto* lanes : { &stick_deadzone_, &stick_inverse_range_, &stick_anti_deadzone_ } )
+    {
+        lanes->clear( );
+    }
+    table_offset_.clear( );
+    stick_x_lane_.clear( );
+    stick_y_lane_.clear( );
+    stick_table_offset_.clear( );
+    tables_.clear( );
+
+    // Most axes share a handful of curves, so each distinct curve gets one table.
+    auto curves   = std::vector< AxisMapping const* >{ };
+    auto table_of = [ this, &curves ]( AxisMapping const& mapping ) -> std::uint32_t {
+        auto const known = std::find_if( curves.begin( ), curves.end( ), [ &mapping ]( auto const* curve ) {
+            return same_curve( *curve, mapping );
+        } );
+        auto const index = static_cast< std::size_t >( known - curves.begin( ) );
+        if ( known == curves.end( ) )
+        {
+            curves.push_back( &mapping );
+            append_curve_table( mapping, tables_ );
+        }
+        return static_cast< std::uint32_t >( index * ( curve_table_segments + 1UL ) );
+    };
+    auto inverse_range_of = []( float deadzone, AxisMapping const& mapping ) {
+        return 1.f / std::max( 1.f - deadzone - mapping.outer_deadzone, 1e-6f );
+    };
+
+    identity_ = true;
+    for ( auto const& joystick : joysticks )
+    {
+        layout_.push_back( { joystick.device_id, joystick.axes.size( ), joystick.guid } );
+
+        auto const seen = std::any_of( devices_.begin( ), devices_.end( ), [ &joystick ]( auto const& device ) {
+            return device.guid == joystick.guid;
+        } );
+        if ( !seen )
+        {
+            devices_.push_back( joystick );
+        }
+
+        auto const& device_mapping = mapping( joystick.guid );
+        auto const  first_lane     = deadzone_.size( );
+        auto        in_stick       = std::vector< bool >( joystick.axes.size( ), false );
+
+        // Automatic deadzones only ever widen the configured ones.
+        auto const auto_deadzones = auto_deadzones_.find( joystick.guid );
+        auto       deadzone_of    = [ this, &auto_deadzones ]( AxisMapping const& axis_mapping, std::size_t axis ) {
+            auto const has_auto = auto_deadzones != auto_deadzones_.end( ) && axis < auto_deadzones->second.size( );
+            return std::max( axis_mapping.deadzone, has_auto ? auto_deadzones->second[ axis ] : 0.f );
+        };
+
+        for ( auto const& stick : device_mapping.sticks )
+        {
+            auto const axis_count = joystick.axes.size( );
+            if ( stick.x_axis >= axis_count || stick.y_axis >= axis_count || stick.x_axis == stick.y_axis )
+            {
+                continue;
+            }
+            in_stick[ stick.x_axis ] = in_stick[ stick.y_axis ] = true;
+            stick_x_lane_.push_back( static_cast< std::uint32_t >( first_lane + stick.x_axis ) );
+            stick_y_lane_.push_back( static_cast< std::uint32_t >( first_lane + stick.y_axis ) );
+            auto const deadzone
+                = std::max( deadzone_of( stick.mapping, stick.x_axis ), deadzone_of( stick.mapping, stick.y_axis ) );
+            stick_deadzone_.push_back( deadzone );
+            stick_inverse_range_.push_back( inverse_range_of( deadzone, stick.mapping ) );
+            stick_anti_deadzone_.push_back( stick.mapping.anti_deadzone );
+            stick_table_offset_.push_back( table_of( stick.mapping ) );
+            identity_ = false;
+        }
+
+        for ( auto a = 0UL; a < joystick.axes.size( ); ++a )
+        {
+            // Stick axes pass through the axis loop unchanged and are mapped as a pair after it.
+            auto const& axis_mapping = ( a < device_mapping.axes.size( ) && !in_stick[ a ] ) ? device_mapping.axes[ a ]
+                                                                                             : identity_mapping( );
+            auto const deadzone = in_stick[ a ] ? 0.f : deadzone_of( axis_mapping, a );
+            deadzone_.push_back( deadzone );
+            inverse_range_.push_back( inverse_range_of( deadzone, axis_mapping ) );
+            anti_deadzone_.push_back( axis_mapping.anti_deadzone );
+            table_offset_.push_back( table_of( axis_mapping ) );
+            identity_ = identity_ && axis_mapping.is_identity( ) && deadzone == 0.f;
+        }
+    }
+
+    values_.resize( deadzone_.size( ) );
+    stick_x_.resize( stick_deadzone_.size( ) );
+    stick_y_.resize( stick_deadzone_.size( ) );
+
+    stats_.axis_count  = values_.size( );
+    stats_.stick_count = stick_x_.size( );
+    stats_.table_count = curves.size( );
+}
+
+auto configure_mapping_gui( AxisMapper& mapper ) -> void
+{
+    auto const& stats = mapper.stats( );
+    ImGui::Text(
+        "Mapping: %zu axes, %zu sticks, %zu curves | %.1f us/frame (max %.1f)",
+        stats.axis_count,
+        stats.stick_count,
+        stats.table_count,
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( !ImGui::TreeNode( "Axis mapping" ) )
+    {
+        return;
+    }
+
+    for ( auto const& device : mapper.devices( ) )
+    {
+        ImGui::PushID( device.guid.c_str( ) );
+        if ( ImGui::TreeNode( "device", "%s (%s)", device.name.c_str( ), device.guid.c_str( ) ) )
+        {
+            auto mapping = mapper.mapping( device.guid );
+            auto changed = false;
+
+            mapping.axes.resize( std::max( mapping.axes.size( ), device.axes.size( ) ) );
+            for ( auto a = 0UL; a < device.axes.size( ); ++a )
+            {
+                ImGui::PushID( static_cast< int >( a ) );
+                if ( ImGui::TreeNode( "axis", "Axis %zu", a ) )
+                {
+                    changed |= configure_axis_mapping_gui( mapping.axes[ a ] );
+                    ImGui::TreePop( );
+                }
+                ImGui::PopID( );
+            }
+
+            for ( auto s = 0UL; s < mapping.sticks.size( ); ++s )
+            {
+                auto& stick = mapping.sticks[ s ];
+                ImGui::PushID( static_cast< int >( device.axes.size( ) + s ) );
+                if ( ImGui::TreeNode( "stick", "Stick (axes %zu, %zu)", stick.x_axis, stick.y_axis ) )
+                {
+                    auto const last_axis = static_cast< int >( device.axes.size( ) ) - 1;
+                    auto       x_axis    = static_cast< int >( stick.x_axis );
+                    auto       y_axis    = static_cast< int >( stick.y_axis );
+                    changed |= ImGui::SliderInt( "X axis", &x_axis, 0, last_axis );
+                    changed |= ImGui::SliderInt( "Y axis", &y_axis, 0, last_axis );
+                    stick.x_axis = static_cast< std::size_t >( std::max( x_axis, 0 ) );
+                    stick.y_axis = static_cast< std::size_t >( std::max( y_axis, 0 ) );
+
+                    changed |= configure_axis_mapping_gui( stick.mapping );
+                    if ( ImGui::Button( "Remove stick" ) )
+                    {
+                        mapping.sticks.erase( mapping.sticks.begin( ) + static_cast< long >( s ) );
+                        changed = true;
+                    }
+                    ImGui::TreePop( );
+                }
+                ImGui::PopID( );
+            }
+
+            if ( device.axes.size( ) >= 2UL && ImGui::Button( "Add stick" ) )
+            {
+                mapping.sticks.emplace_back( );
+                changed = true;
+            }
+
+            if ( changed )
+            {
+                mapper.set_mapping( device.guid, std::move( mapping ) );
+            }
+            ImGui::TreePop( );
+        }
+        ImGui::PopID( );
+    }
+    ImGui::TreePop( );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,142 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+
+// standard
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::joy
+{
+
+enum class ResponseCurve
+{
+    Linear,
+    Power, ///< `input ^ exponent`
+    Table, ///< Linear interpolation between user-defined points
+};
+
+/// \brief Every curve is sampled into a table with this many segments when the mapping
+///        changes, so the per-frame work is the same interpolation for every curve.
+constexpr auto curve_table_segments = std::size_t( 256 );
+
+/// \brief How one axis, or the magnitude of one stick, is turned into its processed value.
+///
+/// Deadzones are measured from zero on either side, so the input range left after them
+/// (`deadzone` to `1 - outer_deadzone`) is stretched back to the full output range before
+/// the curve is applied. The sign of the input is always preserved.
+struct AxisMapping
+{
+    float                deadzone       = 0.f; ///< Inputs closer to zero than this read as zero
+    float                outer_deadzone = 0.f; ///< Inputs this close to full deflection read as full deflection
+    float                anti_deadzone  = 0.f; ///< Smallest output outside the deadzone, to overcome a game's own
+    ResponseCurve        curve          = ResponseCurve::Linear;
+    float                exponent       = 2.f; ///< Only used by `ResponseCurve::Power`
+    std::vector< float > table          = { }; ///< Outputs at evenly spaced inputs from 0 to 1 (`Table` only)
+
+    [[nodiscard]] auto is_identity( ) const -> bool;
+};
+
+/// \brief Two axes processed together by the distance of the stick from its center, so
+///        the deadzone is round instead of a cross and diagonals keep their direction.
+struct StickPair
+{
+    std::size_t x_axis  = 0;
+    std::size_t y_axis  = 1;
+    AxisMapping mapping = { };
+};
+
+struct DeviceMapping
+{
+    std::vector< AxisMapping > axes   = { }; ///< Axes past the end are passed through unchanged
+    std::vector< StickPair >   sticks = { }; ///< Replace the per-axis mappings of their axes
+};
+
+struct MappingStats
+{
+    std::size_t axis_count  = 0; ///< Axes processed per frame, across every device
+    std::size_t stick_count = 0;
+    std::size_t table_count = 0; ///< Distinct curve tables shared by the axes and sticks
+    double      last_us     = 0.0;
+    double      max_us      = 0.0;
+};
+
+/// \brief The pipeline's mapping stage: applies deadzones, anti-deadzones and response
+///        curves to every axis of every device, writing `Joystick::processed_axes`. Axes
+///        already calibrated or filtered by earlier stages are mapped from those values.
+///
+/// Mappings are keyed by device GUID so every device of the same model is mapped the same
+/// way. Axes are gathered into one structure-of-arrays batch with their parameters and
+/// processed by a single branch-free loop from `numeric_kernels( )`, followed by a second
+/// loop over every stick pair. The parameter arrays are only rebuilt when a mapping or the
+/// set of devices changes.
+class AxisMapper
+{
+public:
+    /// \brief The mapping of devices with `guid`, or the identity mapping if none was set.
+    [[nodiscard]] auto mapping( std::string const& guid ) const -> DeviceMapping const&;
+    auto               set_mapping( std::string const& guid, DeviceMapping mapping ) -> void;
+
+    /// \brief Smallest deadzone of each axis of devices with `guid`, usually measured by
+    ///        calibration. Wider deadzones in the mapping take precedence.
+    auto set_auto_deadzones( std::string const& guid, std::vector< float > deadzones ) -> void;
+
+    /// \brief One device of every GUID seen by the last `process`, for choosing what to edit.
+    [[nodiscard]] auto devices( ) const -> std::vector< Joystick > const&;
+
+    auto process( std::vector< Joystick >& joysticks ) -> void;
+
+    [[nodiscard]] auto stats( ) const -> MappingStats const&;
+
+private:
+    /// \brief What the batch was built for, to tell when it must be rebuilt.
+    struct DeviceLayout
+    {
+        int         device_id  = -1;
+        std::size_t axis_count = 0;
+        std::string guid       = { };
+    };
+
+    std::unordered_map< std::string, DeviceMapping >        mappings_       = { };
+    std::unordered_map< std::string, std::vector< float > > auto_deadzones_ = { };
+    std::vector< DeviceLayout >                             layout_         = { };
+    std::vector< Joystick >                                 devices_        = { };
+    bool                                                    dirty_          = true;
+    bool                                                    identity_       = true; ///< No lane changes its value
+
+    // One lane per axis of every device, in device order.
+    std::vector< float >         values_        = { };
+    std::vector< float >         deadzone_      = { };
+    std::vector< float >         inverse_range_ = { }; ///< `1 / ( 1 - deadzone - outer_deadzone )`
+    std::vector< float >         anti_deadzone_ = { };
+    std::vector< std::uint32_t > table_offset_  = { }; ///< Start of the lane's curve in `tables_`
+
+    // One lane per stick pair, indexing into the axis lanes.
+    std::vector< std::uint32_t > stick_x_lane_        = { };
+    std::vector< std::uint32_t > stick_y_lane_        = { };
+    std::vector< float >         stick_x_             = { };
+    std::vector< float >         stick_y_             = { };
+    std::vector< float >         stick_deadzone_      = { };
+    std::vector< float >         stick_inverse_range_ = { };
+    std::vector< float >         stick_anti_deadzone_ = { };
+    std::vector< std::uint32_t > stick_table_offset_  = { };
+
+    std::vector< float > tables_ = { }; ///< `curve_table_segments + 1` samples per distinct curve
+
+    MappingStats stats_ = { };
+
+    [[nodiscard]] auto layout_matches( std::vector< Joystick > const& joysticks ) const -> bool;
+    auto               rebuild( std::vector< Joystick > const& joysticks ) -> void;
+    auto               map_lanes( ) -> void;
+};
+
+/// \brief Edit the mapping of any device seen so far and show how long mapping takes.
+auto configure_mapping_gui( AxisMapper& mapper ) -> void;
+
+} // namespace ltb::joy
@@ -0,0 +1,282 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_predictor.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+/// \brief How quickly the motion estimates follow their raw differences. Differences of
+///        noisy samples a millisecond apart are mostly noise, and acceleration, a difference
+///        of differences, more so.
+constexpr auto velocity_time_constant_s     = 0.01f;
+constexpr auto acceleration_time_constant_s = 0.03f;
+
+/// \brief A device that sends nothing for this long (or whose replay was seeked) is assumed to
+///        have stopped, so its motion is estimated afresh from the next samples.
+constexpr auto max_sample_gap_us = std::int64_t( 100'000 );
+
+/// \brief Move `estimate` toward `raw` by the fraction an exponential moving average with
+///        `time_constant_s` would after `dt_s`.
+auto smooth( float estimate, float raw, float dt_s, float time_constant_s ) -> float
+{
+    return estimate + ( raw - estimate ) * dt_s / ( dt_s + time_constant_s );
+}
+
+} // namespace
+
+auto PredictionError::add( float predicted, float held, float actual ) -> void
+{
+    auto const predicted_error = static_cast< double >( predicted - actual );
+    auto const held_error      = static_cast< double >( held - actual );
+
+    ++sample_count;
+    predicted_squares += predicted_error * predicted_error;
+    held_squares += held_error * held_error;
+}
+
+auto PredictionError::predicted_rms( ) const -> double
+{
+    return ( sample_count > 0UL ) ? std::sqrt( predicted_squares / static_cast< double >( sample_count ) ) : 0.0;
+}
+
+auto PredictionError::held_rms( ) const -> double
+{
+    return ( sample_count > 0UL ) ? std::sqrt( held_squares / static_cast< double >( sample_count ) ) : 0.0;
+}
+
+auto AxisPredictor::process( std::vector< Joystick >& joysticks, std::int64_t display_us ) -> void
+{
+    auto const start = Clock::now( );
+
+    stats_.horizon_ms = 0.0;
+    for ( auto& joystick : joysticks )
+    {
+        // Predict what is shown, which is what the pipeline produced if anything.
+        auto const  processed = joystick.processed_axes.size( ) == joystick.axes.size( );
+        auto const& values    = processed ? joystick.processed_axes : joystick.axes;
+        auto const  count     = values.size( );
+
+        auto& device = devices_[ joystick.device_id ];
+        auto& error  = errors_[ joystick.device_id ];
+
+        // Motion and errors measured on whatever last had this ID say nothing about this device.
+        if ( device.guid != joystick.guid || device.axes.size( ) != count )
+        {
+            device         = DeviceState{ joystick.guid };
+            device.axes    = std::vector< AxisMotion >( count );
+            device.pending = std::vector< PendingPrediction >(
+                prediction_history,
+                { 0, std::vector< float >( count ), std::vector< float >( count ) }
+            );
+            error = DevicePredictionError{ joystick.name, { }, std::vector< PredictionError >( count ) };
+        }
+
+        if ( joystick.timestamp_us != device.last_sample_us )
+        {
+            auto const gap_us = joystick.timestamp_us - device.last_sample_us;
+            if ( device.sample_count > 0UL && ( gap_us < 0 || gap_us > max_sample_gap_us ) )
+            {
+                device.sample_count  = 0UL;
+                device.pending_count = 0UL;
+            }
+            if ( device.sample_count > 0UL )
+            {
+                resolve_pending( device, error, values, joystick.timestamp_us );
+            }
+            update_motion( device, values, joystick.timestamp_us );
+        }
+
+        auto const horizon_us = std::clamp( display_us - device.last_sample_us, std::int64_t( 0 ), max_prediction_us );
+        auto const horizon_s  = static_cast< float >( horizon_us ) * 1e-6f;
+        stats_.horizon_ms     = std::max( stats_.horizon_ms, static_cast< double >( horizon_us ) * 1e-3 );
+
+        joystick.predicted_axes.resize( count );
+        for ( auto a = 0UL; a < count; ++a )
+        {
+            auto const& motion = device.axes[ a ];
+            auto const  change = ( motion.velocity + 0.5f * motion.acceleration * horizon_s ) * horizon_s;
+
+            joystick.predicted_axes[ a ] = std::clamp( motion.value + change, -1.f, 1.f );
+        }
+
+        // Kept to be scored once the device has been sampled past the display time. Polls
+        // that repeat both the sample and the display time would only score it twice.
+        auto const target_us = device.last_sample_us + horizon_us;
+        auto const last      = ( device.pending_first + device.pending_count + prediction_history - 1UL );
+        auto const repeated  = device.pending_count > 0UL
+                           && device.pending[ last % prediction_history ].target_us == target_us;
+        if ( horizon_us > 0 && !repeated )
+        {
+            if ( device.pending_count == prediction_history )
+            {
+                device.pending_first = ( device.pending_first + 1UL ) % prediction_history;
+                --device.pending_count;
+            }
+            auto& pending = device.pending[ ( device.pending_first + device.pending_count ) % prediction_history ];
+            pending.target_us = target_us;
+            std::copy( joystick.predicted_axes.begin( ), joystick.predicted_axes.end( ), pending.predicted.begin( ) );
+            std::copy( values.begin( ), values.end( ), pending.held.begin( ) );
+            ++device.pending_count;
+        }
+    }
+
+    stats_.device_count = devices_.size( );
+    stats_.last_us      = Microseconds( Clock::now( ) - start ).count( );
+    stats_.max_us       = std::max( stats_.max_us, stats_.last_us );
+}
+
+auto AxisPredictor::reset( ) -> void
+{
+    for ( auto& [ device_id, error ] : errors_ )
+    {
+        error.overall = { };
+        std::fill( error.axes.begin( ), error.axes.end( ), PredictionError{ } );
+    }
+    stats_.overall = { };
+    stats_.max_us  = 0.0;
+}
+
+auto AxisPredictor::errors( ) const -> std::map< int, DevicePredictionError > const&
+{
+    return errors_;
+}
+
+auto AxisPredictor::stats( ) const -> PredictionStats const&
+{
+    return stats_;
+}
+
+auto AxisPredictor::resolve_pending(
+    DeviceState&                device,
+    DevicePredictionError&      error,
+    std::vector< float > const& values,
+    std::int64_t                sample_us
+) -> void
+{
+    auto const previous_us = device.last_sample_us;
+    auto const interval    = static_cast< double >( sample_us - previous_us );
+
+    while ( device.pending_count > 0UL )
+    {
+        auto const& pending = device.pending[ device.pending_first ];
+        if ( pending.target_us > sample_us )
+        {
+            break;
+        }
+
+        // Where the axis was at the target time, assuming it moved steadily between samples.
+        auto const fraction = static_cast< float >(
+            std::clamp( static_cast< double >( pending.target_us - previous_us ) / interval, 0.0, 1.0 )
+        );
+        for ( auto a = 0UL; a < values.size( ); ++a )
+        {
+            auto const previous = device.axes[ a ].value;
+            auto const actual   = previous + ( values[ a ] - previous ) * fraction;
+
+            error.axes[ a ].add( pending.predicted[ a ], pending.held[ a ], actual );
+            error.overall.add( pending.predicted[ a ], pending.held[ a ], actual );
+            stats_.overall.add( pending.predicted[ a ], pending.held[ a ], actual );
+        }
+
+        device.pending_first = ( device.pending_first + 1UL ) % prediction_history;
+        --device.pending_count;
+    }
+}
+
+auto AxisPredictor::update_motion( DeviceState& device, std::vector< float > const& values, std::int64_t sample_us )
+    -> void
+{
+    auto const dt_s = static_cast< float >( sample_us - device.last_sample_us ) * 1e-6f;
+
+    for ( auto a = 0UL; a < values.size( ); ++a )
+    {
+        auto& motion = device.axes[ a ];
+        if ( device.sample_count == 0UL )
+        {
+            motion = { values[ a ], 0.f, 0.f };
+            continue;
+        }
+
+        // The first difference of a fresh estimate is taken as is rather than smoothed from zero.
+        auto const velocity     = ( values[ a ] - motion.value ) / dt_s;
+        auto const acceleration = ( velocity - motion.velocity ) / dt_s;
+        if ( device.sample_count == 1UL )
+        {
+            motion.velocity = velocity;
+        }
+        else
+        {
+            auto const smoothed_velocity = smooth( motion.velocity, velocity, dt_s, velocity_time_constant_s );
+            auto const smoothed_change   = ( smoothed_velocity - motion.velocity ) / dt_s;
+            motion.acceleration
+                = ( device.sample_count == 2UL )
+                    ? acceleration
+                    : smooth( motion.acceleration, smoothed_change, dt_s, acceleration_time_constant_s );
+            motion.velocity = smoothed_velocity;
+        }
+        motion.value = values[ a ];
+    }
+
+    device.last_sample_us = sample_us;
+    ++device.sample_count;
+}
+
+auto configure_predictor_gui( AxisPredictor& predictor ) -> void
+{
+    auto const& stats = predictor.stats( );
+    ImGui::Text(
+        "Prediction: %.1f ms ahead | RMS error %.4f (%.4f unpredicted) | %.1f us/frame (max %.1f)",
+        stats.horizon_ms,
+        stats.overall.predicted_rms( ),
+        stats.overall.held_rms( ),
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( !ImGui::TreeNode( "Prediction error" ) )
+    {
+        return;
+    }
+    if ( ImGui::Button( "Reset prediction error" ) )
+    {
+        predictor.reset( );
+    }
+
+    for ( auto const& [ device_id, error ] : predictor.errors( ) )
+    {
+        ImGui::Text(
+            "%s: %.4f (%.4f unpredicted) over %llu samples",
+            error.name.c_str( ),
+            error.overall.predicted_rms( ),
+            error.overall.held_rms( ),
+            static_cast< unsigned long long >( error.overall.sample_count )
+        );
+        for ( auto a = 0UL; a < error.axes.size( ); ++a )
+        {
+            ImGui::Text(
+                "  (%zu) %.4f (%.4f unpredicted)",
+                a,
+                error.axes[ a ].predicted_rms( ),
+                error.axes[ a ].held_rms( )
+            );
+        }
+    }
+
+    ImGui::TreePop( );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,130 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+
+// standard
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief The furthest ahead of the last sample an axis is extrapolated. The error of the
+///        acceleration term grows with the square of the horizon, so anything longer than a
+///        few frames is guesswork.
+constexpr auto max_prediction_us = std::int64_t( 50'000 );
+
+/// \brief Predictions per device awaiting the sample that shows how far off they were, enough
+///        for a 1kHz device polled every sample at the longest horizon. Beyond that, the oldest
+///        is dropped unmeasured.
+constexpr auto prediction_history = std::size_t( 64 );
+
+/// \brief Error of predicted axis values against what actually arrived at the time they were
+///        predicted for, beside the error of showing the last sample as is.
+struct PredictionError
+{
+    std::uint64_t sample_count      = 0;
+    double        predicted_squares = 0.0; ///< Sum of the squared errors of the predicted values
+    double        held_squares      = 0.0; ///< Sum of the squared errors of the last sample, unpredicted
+
+    auto add( float predicted, float held, float actual ) -> void;
+
+    [[nodiscard]] auto predicted_rms( ) const -> double;
+    [[nodiscard]] auto held_rms( ) const -> double;
+};
+
+struct DevicePredictionError
+{
+    std::string                    name    = { };
+    PredictionError                overall = { };
+    std::vector< PredictionError > axes    = { };
+};
+
+struct PredictionStats
+{
+    std::size_t     device_count = 0;
+    double          horizon_ms   = 0.0; ///< The longest extrapolation this frame
+    PredictionError overall      = { }; ///< Every axis of every device
+    double          last_us      = 0.0;
+    double          max_us       = 0.0;
+};
+
+/// \brief Extrapolates every axis to when the current frame will be displayed, so the GUI
+///        leads rather than lags the device by the time it takes a frame to reach the screen.
+///
+/// Each new sample updates a velocity and an acceleration estimate per axis, both smoothed
+/// with a time constant so sensor noise is not amplified by the differences. The prediction
+/// is `x + v h + a h^2 / 2` for a horizon `h` from the last sample to the display time,
+/// written to `Joystick::predicted_axes`. What is predicted is `processed_axes` if the
+/// pipeline produced them, and `axes` otherwise.
+///
+/// Every prediction is kept until samples arrive on both sides of the time it was made for,
+/// then scored against the value interpolated between them. Holding the last sample is
+/// scored the same way, so the GUI shows whether prediction is actually an improvement.
+class AxisPredictor
+{
+public:
+    /// \brief Predict every axis of `joysticks` at `display_us`, in the time base of their
+    ///        timestamps.
+    auto process( std::vector< Joystick >& joysticks, std::int64_t display_us ) -> void;
+
+    /// \brief Forget every measured error. The motion estimates are kept.
+    auto reset( ) -> void;
+
+    [[nodiscard]] auto errors( ) const -> std::map< int, DevicePredictionError > const&;
+    [[nodiscard]] auto stats( ) const -> PredictionStats const&;
+
+private:
+    struct AxisMotion
+    {
+        float value        = 0.f; ///< At the last sample
+        float velocity     = 0.f; ///< Per second
+        float acceleration = 0.f; ///< Per second squared
+    };
+
+    struct PendingPrediction
+    {
+        std::int64_t         target_us = 0;
+        std::vector< float > predicted = { };
+        std::vector< float > held      = { };
+    };
+
+    struct DeviceState
+    {
+        std::string                      guid           = { };
+        std::int64_t                     last_sample_us = -1;
+        std::uint64_t                    sample_count   = 0; ///< Since the motion estimates restarted
+        std::vector< AxisMotion >        axes           = { };
+        std::vector< PendingPrediction > pending        = { }; ///< A ring of `prediction_history`
+        std::size_t                      pending_first  = 0;
+        std::size_t                      pending_count  = 0;
+    };
+
+    std::map< int, DeviceState >           devices_ = { };
+    std::map< int, DevicePredictionError > errors_  = { }; ///< By device ID, like `devices_`
+    PredictionStats                        stats_   = { };
+
+    /// \brief Score the pending predictions made for times up to the sample just taken.
+    auto resolve_pending(
+        DeviceState&                device,
+        DevicePredictionError&      error,
+        std::vector< float > const& values,
+        std::int64_t                sample_us
+    ) -> void;
+
+    /// \brief Fold a new sample into the velocity and acceleration estimates.
+    static auto update_motion( DeviceState& device, std::vector< float > const& values, std::int64_t sample_us )
+        -> void;
+};
+
+/// \brief Show how far ahead axes are predicted and how much closer the predictions come than
+///        the last sample, in total and per axis.
+auto configure_predictor_gui( AxisPredictor& predictor ) -> void;
+
+} // namespace ltb::joy
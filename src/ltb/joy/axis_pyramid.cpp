@@ -0,0 +1,629 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_pyramid.hpp"
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// external
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration< double, std::milli >;
+
+constexpr auto plot_height = 48.f;
+
+template < typename T >
+auto view_as( std::byte const* data ) -> T const*
+{
+    // Every structure is written at an offset aligned for it in a page-aligned mapping.
+    return reinterpret_cast< T const* >( data );
+}
+
+auto align_8( std::uint64_t offset ) -> std::uint64_t
+{
+    return ( offset + 7UL ) / 8UL * 8UL;
+}
+
+auto empty_summary( ) -> AxisSummary
+{
+    return { std::numeric_limits< float >::infinity( ), -std::numeric_limits< float >::infinity( ), 0.f };
+}
+
+/// \brief Buckets in level `level` of a device with `base_count` level 0 buckets.
+auto level_buckets( std::uint64_t base_count, std::size_t level ) -> std::uint64_t
+{
+    return ( base_count + ( std::uint64_t( 1 ) << level ) - 1UL ) >> level;
+}
+
+/// \brief Snapshots covered by bucket `bucket` of level `level`, which is fewer than the
+///        level's span only for the last bucket.
+auto bucket_samples( std::uint64_t sample_count, std::size_t level, std::uint64_t bucket ) -> std::uint64_t
+{
+    auto const span  = std::uint64_t( pyramid_base_samples ) << level;
+    auto const first = bucket * span;
+    return std::min( span, sample_count - first );
+}
+
+/// \brief Summarizes one device's snapshots as they are read, in recorded order.
+struct DeviceBuilder
+{
+    int                                       device_id    = 0;
+    std::string                               name         = { };
+    std::string                               guid         = { };
+    std::size_t                               axis_count   = 0; ///< Set by the device's first snapshot
+    std::uint64_t                             sample_count = 0;
+    std::int64_t                              last_time_us = 0;
+    std::vector< std::int64_t >               times_us     = { };
+    std::vector< std::vector< AxisSummary > > base         = { }; ///< `base[ axis ][ bucket ]`
+
+    // The level 0 bucket being filled.
+    std::vector< AxisSummary > open_bucket = { };
+    std::vector< double >      open_sums   = { };
+    std::uint32_t              open_count  = 0U;
+
+    /// \brief Add a snapshot whose axis `a` is `axes[ a * stride ]`. Axes missing from the
+    ///        snapshot count as centered and extra ones are ignored.
+    auto add( std::int64_t timestamp_us, float const* axes, std::size_t count, std::size_t stride ) -> void
+    {
+        if ( sample_count == 0UL )
+        {
+            axis_count = count;
+            base.resize( axis_count );
+            open_bucket.resize( axis_count );
+            open_sums.resize( axis_count );
+        }
+        if ( open_count == 0U )
+        {
+            times_us.push_back( timestamp_us );
+            std::fill( open_bucket.begin( ), open_bucket.end( ), empty_summary( ) );
+            std::fill( open_sums.begin( ), open_sums.end( ), 0.0 );
+        }
+
+        for ( auto a = 0UL; a < axis_count; ++a )
+        {
+            auto const value = ( a < count ) ? axes[ a * stride ] : 0.f;
+            auto&      open  = open_bucket[ a ];
+            open.min         = std::min( open.min, value );
+            open.max         = std::max( open.max, value );
+            open_sums[ a ] += static_cast< double >( value );
+        }
+
+        ++sample_count;
+        last_time_us = timestamp_us;
+        if ( ++open_count == pyramid_base_samples )
+        {
+            close_bucket( );
+        }
+    }
+
+    auto close_bucket( ) -> void
+    {
+        if ( open_count == 0U )
+        {
+            return;
+        }
+        for ( auto a = 0UL; a < axis_count; ++a )
+        {
+            auto summary = open_bucket[ a ];
+            summary.mean = static_cast< float >( open_sums[ a ] / static_cast< double >( open_count ) );
+            base[ a ].push_back( summary );
+        }
+        open_count = 0U;
+    }
+
+    /// \brief Every level, coarsest last: `levels[ level ][ axis ][ bucket ]`.
+    [[nodiscard]] auto build_levels( ) -> std::vector< std::vector< std::vector< AxisSummary > > >
+    {
+        auto levels = std::vector< std::vector< std::vector< AxisSummary > > >{ };
+        levels.emplace_back( std::move( base ) );
+
+        for ( auto bucket_count = times_us.size( ); bucket_count > 1UL; bucket_count = ( bucket_count + 1UL ) / 2UL )
+        {
+            auto const  level = levels.size( ) - 1UL;
+            auto const& finer = levels.back( );
+            auto        next  = std::vector< std::vector< AxisSummary > >( axis_count );
+
+            for ( auto a = 0UL; a < axis_count; ++a )
+            {
+                auto const& from = finer[ a ];
+                next[ a ].reserve( ( from.size( ) + 1UL ) / 2UL );
+
+                for ( auto b = 0UL; b < from.size( ); b += 2UL )
+                {
+                    auto merged = from[ b ];
+                    if ( b + 1UL < from.size( ) )
+                    {
+                        auto const& second = from[ b + 1UL ];
+                        auto const  first_weight
+                            = static_cast< double >( bucket_samples( sample_count, level, b ) );
+                        auto const second_weight
+                            = static_cast< double >( bucket_samples( sample_count, level, b + 1UL ) );
+
+                        merged.min  = std::min( merged.min, second.min );
+                        merged.max  = std::max( merged.max, second.max );
+                        merged.mean = static_cast< float >(
+                            ( merged.mean * first_weight + second.mean * second_weight )
+                            / ( first_weight + second_weight )
+                        );
+                    }
+                    next[ a ].push_back( merged );
+                }
+            }
+            levels.emplace_back( std::move( next ) );
+        }
+        return levels;
+    }
+};
+
+} // namespace
+
+auto pyramid_path( std::filesystem::path const& recording_path ) -> std::filesystem::path
+{
+    auto path = recording_path;
+    path += ".pyramid";
+    return path;
+}
+
+auto build_axis_pyramid( std::filesystem::path const& recording_path ) -> utils::Expected< void >
+{
+    auto const start = Clock::now( );
+
+    auto reader = RecordingReader::open( recording_path );
+    if ( !reader )
+    {
+        return tl::make_unexpected( reader.error( ) );
+    }
+
+    auto devices = std::vector< DeviceBuilder >{ };
+    auto slots   = std::unordered_map< int, std::size_t >{ };
+    auto block   = SnapshotBlock{ };
+    auto scratch = std::vector< float >{ };
+
+    auto device_at = [ &devices, &slots ]( int device_id ) -> DeviceBuilder& {
+        auto const [ iter, inserted ] = slots.emplace( device_id, devices.size( ) );
+        if ( inserted )
+        {
+            devices.emplace_back( ).device_id = device_id;
+        }
+        return devices[ iter->second ];
+    };
+
+    for ( auto const record : *reader )
+    {
+        switch ( record.type( ) )
+        {
+            case RecordType::Device:
+            {
+                auto const view   = record.device( );
+                auto&      device = device_at( record.device_id( ) );
+                device.name       = std::string( view.name );
+                device.guid       = std::string( view.guid );
+                break;
+            }
+            case RecordType::Snapshot:
+            case RecordType::FixedSnapshot:
+            {
+                auto const  snapshot = record.snapshot( );
+                auto const* values   = snapshot.float_axes( scratch );
+                device_at( record.device_id( ) ).add( record.timestamp_us( ), values, snapshot.axis_count, 1UL );
+                break;
+            }
+            case RecordType::SnapshotBlock:
+            {
+                if ( !decode_snapshot_block( record, block ) )
+                {
+                    break; // Corrupt, so its snapshots are left out
+                }
+                auto& device = device_at( record.device_id( ) );
+                for ( auto s = 0UL; s < block.sample_count; ++s )
+                {
+                    auto const* axes = block.axes.data( ) + s;
+                    device.add( block.timestamps_us[ s ], axes, block.axis_count, block.sample_count );
+                }
+                break;
+            }
+            case RecordType::Event:
+                break; // Already reflected in the snapshots that follow
+            case RecordType::Keyframe:
+                break; // Repeats snapshots recorded before it
+        }
+    }
+
+    // Devices that were described but never polled have nothing to plot.
+    devices.erase(
+        std::remove_if( devices.begin( ), devices.end( ), []( auto const& d ) { return d.sample_count == 0UL; } ),
+        devices.end( )
+    );
+
+    // Lay out every device's strings, timestamps, levels, and summaries after the device table.
+    auto entries = std::vector< PyramidDevice >( devices.size( ) );
+    auto levels  = std::vector< std::vector< std::vector< std::vector< AxisSummary > > > >{ };
+    auto offset  = sizeof( PyramidFileHeader ) + sizeof( PyramidDevice ) * entries.size( );
+
+    for ( auto d = 0UL; d < devices.size( ); ++d )
+    {
+        auto& device = devices[ d ];
+        auto& entry  = entries[ d ];
+        device.close_bucket( );
+
+        auto const& device_levels = levels.emplace_back( device.build_levels( ) );
+
+        entry.device_id      = device.device_id;
+        entry.axis_count     = static_cast< std::uint16_t >( device.axis_count );
+        entry.level_count    = static_cast< std::uint16_t >( device_levels.size( ) );
+        entry.name_size      = static_cast< std::uint16_t >( device.name.size( ) );
+        entry.guid_size      = static_cast< std::uint16_t >( device.guid.size( ) );
+        entry.strings_offset = offset;
+        entry.sample_count   = device.sample_count;
+        entry.last_time_us   = device.last_time_us;
+        entry.times_offset   = align_8( entry.strings_offset + entry.name_size + entry.guid_size );
+        entry.levels_offset  = entry.times_offset + sizeof( std::int64_t ) * device.times_us.size( );
+
+        offset = entry.levels_offset + sizeof( PyramidLevel ) * device_levels.size( );
+        for ( auto l = 0UL; l < device_levels.size( ); ++l )
+        {
+            offset += sizeof( AxisSummary ) * device.axis_count * level_buckets( device.times_us.size( ), l );
+        }
+        offset = align_8( offset );
+    }
+
+    auto const output_path = pyramid_path( recording_path );
+    auto       temp_path   = output_path;
+    temp_path += ".tmp";
+
+    {
+        auto file = utils::WritableMappedFile::create( temp_path, offset );
+        if ( !file )
+        {
+            return tl::make_unexpected( file.error( ) );
+        }
+        auto* output = file->data( );
+
+        auto header         = PyramidFileHeader{ };
+        header.source_size   = reader->file( ).size( );
+        header.start_time_us = reader->header( ).start_time_us;
+        header.device_count  = static_cast< std::uint32_t >( entries.size( ) );
+        std::memcpy( output, &header, sizeof( header ) );
+        std::memcpy( output + sizeof( header ), entries.data( ), sizeof( PyramidDevice ) * entries.size( ) );
+
+        for ( auto d = 0UL; d < devices.size( ); ++d )
+        {
+            auto const& device = devices[ d ];
+            auto const& entry  = entries[ d ];
+
+            std::memcpy( output + entry.strings_offset, device.name.data( ), entry.name_size );
+            std::memcpy( output + entry.strings_offset + entry.name_size, device.guid.data( ), entry.guid_size );
+            std::memcpy(
+                output + entry.times_offset,
+                device.times_us.data( ),
+                sizeof( std::int64_t ) * device.times_us.size( )
+            );
+
+            auto summaries_offset = entry.levels_offset + sizeof( PyramidLevel ) * entry.level_count;
+            for ( auto l = 0UL; l < levels[ d ].size( ); ++l )
+            {
+                auto const& level = levels[ d ][ l ];
+
+                auto const entry_level = PyramidLevel{ summaries_offset, level_buckets( device.times_us.size( ), l ) };
+                auto* const level_entry = output + entry.levels_offset + sizeof( entry_level ) * l;
+                std::memcpy( level_entry, &entry_level, sizeof( entry_level ) );
+
+                for ( auto const& axis : level )
+                {
+                    std::memcpy( output + summaries_offset, axis.data( ), sizeof( AxisSummary ) * axis.size( ) );
+                    summaries_offset += sizeof( AxisSummary ) * axis.size( );
+                }
+            }
+        }
+    }
+
+    auto error_code = std::error_code{ };
+    std::filesystem::rename( temp_path, output_path, error_code );
+    if ( error_code )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to replace '{}': {}", output_path.string( ), error_code.message( ) );
+    }
+
+    spdlog::info(
+        "Built pyramid of {} devices ({:.1f} MiB) for '{}' in {:.1f} ms",
+        entries.size( ),
+        static_cast< double >( offset ) / ( 1024.0 * 1024.0 ),
+        recording_path.string( ),
+        Milliseconds( Clock::now( ) - start ).count( )
+    );
+    return { };
+}
+
+auto AxisPyramid::open( std::filesystem::path const& recording_path ) -> utils::Expected< AxisPyramid >
+{
+    auto const path = pyramid_path( recording_path );
+
+    auto file = utils::MappedFile::open( path );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    auto const* data = file->data( );
+    auto const  size = file->size( );
+
+    if ( size < sizeof( PyramidFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is too small to be a pyramid", path.string( ) );
+    }
+
+    auto const* header = view_as< PyramidFileHeader >( data );
+    if ( header->magic != pyramid_magic || header->version != pyramid_format_version
+         || header->header_size != sizeof( PyramidFileHeader ) || header->base_samples != pyramid_base_samples )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is not a supported pyramid", path.string( ) );
+    }
+
+    auto error_code  = std::error_code{ };
+    auto source_size = std::filesystem::file_size( recording_path, error_code );
+    if ( error_code || source_size != header->source_size )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is out of date", path.string( ) );
+    }
+
+    // Everything `summarize` reads has to be inside the file.
+    auto const* devices = view_as< PyramidDevice >( data + sizeof( PyramidFileHeader ) );
+    auto        valid   = sizeof( PyramidFileHeader ) + sizeof( PyramidDevice ) * header->device_count <= size;
+
+    for ( auto d = 0UL; valid && d < header->device_count; ++d )
+    {
+        auto const& device      = devices[ d ];
+        auto const  time_count  = ( device.sample_count + pyramid_base_samples - 1UL ) / pyramid_base_samples;
+        auto const  levels_size = sizeof( PyramidLevel ) * device.level_count;
+
+        valid = device.level_count > 0U && device.sample_count > 0UL
+             && device.strings_offset + device.name_size + device.guid_size <= size
+             && device.times_offset + sizeof( std::int64_t ) * time_count <= size
+             && device.levels_offset % 8UL == 0UL && device.levels_offset + levels_size <= size;
+
+        for ( auto l = 0UL; valid && l < device.level_count; ++l )
+        {
+            auto const& level = view_as< PyramidLevel >( data + device.levels_offset )[ l ];
+            valid             = level.bucket_count == level_buckets( time_count, l )
+                 && level.offset + sizeof( AxisSummary ) * device.axis_count * level.bucket_count <= size;
+        }
+    }
+    if ( !valid )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is corrupt", path.string( ) );
+    }
+
+    return AxisPyramid( std::move( *file ) );
+}
+
+auto AxisPyramid::open_or_build( std::filesystem::path const& recording_path ) -> utils::Expected< AxisPyramid >
+{
+    if ( auto pyramid = open( recording_path ) )
+    {
+        return pyramid;
+    }
+
+    auto built = build_axis_pyramid( recording_path );
+    if ( !built )
+    {
+        return tl::make_unexpected( built.error( ) );
+    }
+    return open( recording_path );
+}
+
+AxisPyramid::AxisPyramid( utils::MappedFile file )
+    : file_( std::move( file ) )
+{
+}
+
+auto AxisPyramid::header( ) const -> PyramidFileHeader const&
+{
+    return *view_as< PyramidFileHeader >( file_.data( ) );
+}
+
+auto AxisPyramid::device_count( ) const -> std::size_t
+{
+    return header( ).device_count;
+}
+
+auto AxisPyramid::device( std::size_t index ) const -> PyramidDevice const&
+{
+    return view_as< PyramidDevice >( file_.data( ) + sizeof( PyramidFileHeader ) )[ index ];
+}
+
+auto AxisPyramid::device_name( std::size_t index ) const -> std::string_view
+{
+    auto const& entry = device( index );
+    return { reinterpret_cast< char const* >( file_.data( ) + entry.strings_offset ), entry.name_size };
+}
+
+auto AxisPyramid::begin_time_us( ) const -> std::int64_t
+{
+    auto begin_us = std::numeric_limits< std::int64_t >::max( );
+    for ( auto d = 0UL; d < device_count( ); ++d )
+    {
+        begin_us = std::min( begin_us, *view_as< std::int64_t >( file_.data( ) + device( d ).times_offset ) );
+    }
+    return ( device_count( ) > 0UL ) ? begin_us : header( ).start_time_us;
+}
+
+auto AxisPyramid::end_time_us( ) const -> std::int64_t
+{
+    auto end_us = header( ).start_time_us;
+    for ( auto d = 0UL; d < device_count( ); ++d )
+    {
+        end_us = std::max( end_us, device( d ).last_time_us );
+    }
+    return end_us;
+}
+
+auto AxisPyramid::summarize(
+    std::size_t                 index,
+    std::size_t                 axis,
+    std::int64_t                begin_us,
+    std::int64_t                end_us,
+    std::vector< AxisSummary >& buckets
+) const -> void
+{
+    std::fill( buckets.begin( ), buckets.end( ), empty_summary( ) );
+
+    auto const& entry = device( index );
+    if ( axis >= entry.axis_count || end_us <= begin_us || buckets.empty( ) )
+    {
+        return;
+    }
+
+    // The level 0 buckets overlapping the range: the one holding `begin_us` up to the last
+    // one starting before `end_us`.
+    auto const* times      = view_as< std::int64_t >( file_.data( ) + entry.times_offset );
+    auto const  time_count = ( entry.sample_count + pyramid_base_samples - 1UL ) / pyramid_base_samples;
+    auto const  first_base = static_cast< std::uint64_t >(
+        std::max< std::ptrdiff_t >( std::upper_bound( times, times + time_count, begin_us ) - times - 1, 0 )
+    );
+    auto const end_base = static_cast< std::uint64_t >( std::lower_bound( times, times + time_count, end_us ) - times );
+    if ( end_base <= first_base )
+    {
+        return;
+    }
+
+    // The coarsest level that still has at least one summary per output bucket.
+    auto const span  = end_base - first_base;
+    auto       level = 0UL;
+    while ( level + 1UL < entry.level_count && ( span >> ( level + 1UL ) ) >= buckets.size( ) )
+    {
+        ++level;
+    }
+
+    auto const& source    = this->level( index, level );
+    auto const* summaries = view_as< AxisSummary >( file_.data( ) + source.offset ) + axis * source.bucket_count;
+    auto const  scale     = static_cast< double >( buckets.size( ) ) / static_cast< double >( end_us - begin_us );
+    auto const  last      = buckets.size( ) - 1UL;
+
+    auto weights = std::vector< double >( buckets.size( ), 0.0 );
+
+    for ( auto b = first_base >> level; b <= ( end_base - 1UL ) >> level; ++b )
+    {
+        auto const  start  = static_cast< double >( times[ b << level ] - begin_us ) * scale;
+        auto const  slot   = std::min( static_cast< std::size_t >( std::max( start, 0.0 ) ), last );
+        auto const& from   = summaries[ b ];
+        auto&       into   = buckets[ slot ];
+        auto const  weight = static_cast< double >( bucket_samples( entry.sample_count, level, b ) );
+
+        into.min  = std::min( into.min, from.min );
+        into.max  = std::max( into.max, from.max );
+        into.mean = static_cast< float >(
+            ( into.mean * weights[ slot ] + from.mean * weight ) / ( weights[ slot ] + weight )
+        );
+        weights[ slot ] += weight;
+    }
+}
+
+auto AxisPyramid::level( std::size_t index, std::size_t level ) const -> PyramidLevel const&
+{
+    return view_as< PyramidLevel >( file_.data( ) + device( index ).levels_offset )[ level ];
+}
+
+auto configure_pyramid_gui( AxisPyramid const& pyramid, std::int64_t cursor_us, PyramidView& view ) -> void
+{
+    auto const recording_begin_us = pyramid.begin_time_us( );
+    auto const recording_end_us   = std::max( pyramid.end_time_us( ), recording_begin_us + 1 );
+    auto const length_s           = static_cast< float >( recording_end_us - recording_begin_us ) * 1e-6f;
+
+    ImGui::SliderFloat(
+        "Visible seconds",
+        &view.visible_seconds,
+        0.f,
+        length_s,
+        ( view.visible_seconds <= 0.f ) ? "whole recording" : "%.3f s",
+        ImGuiSliderFlags_Logarithmic
+    );
+
+    // Follow the cursor, keeping the view inside the recording.
+    auto begin_us = recording_begin_us;
+    auto end_us   = recording_end_us;
+    if ( view.visible_seconds > 0.f && view.visible_seconds < length_s )
+    {
+        auto const visible_us = std::max< std::int64_t >( std::llround( view.visible_seconds * 1e6f ), 1 );
+        begin_us = std::clamp( cursor_us - visible_us / 2, recording_begin_us, recording_end_us - visible_us );
+        end_us   = begin_us + visible_us;
+    }
+
+    auto const width   = std::max( ImGui::GetContentRegionAvail( ).x, 1.f );
+    auto       buckets = std::vector< AxisSummary >( static_cast< std::size_t >( width ) );
+    auto*      draw    = ImGui::GetWindowDrawList( );
+
+    auto const background = IM_COL32( 32, 32, 32, 255 );
+    auto const range      = IM_COL32( 80, 140, 220, 160 );
+    auto const mean       = IM_COL32( 230, 230, 230, 255 );
+    auto const cursor     = IM_COL32( 230, 80, 60, 255 );
+
+    for ( auto d = 0UL; d < pyramid.device_count( ); ++d )
+    {
+        auto const label = fmt::format( "{}##pyramid{}", pyramid.device_name( d ), d );
+        if ( !ImGui::TreeNode( label.c_str( ) ) )
+        {
+            continue;
+        }
+
+        for ( auto a = 0UL; a < pyramid.device( d ).axis_count; ++a )
+        {
+            pyramid.summarize( d, a, begin_us, end_us, buckets );
+
+            auto const origin = ImGui::GetCursorScreenPos( );
+            auto const to_y   = [ &origin ]( float value ) {
+                return origin.y + ( 1.f - ( std::clamp( value, -1.f, 1.f ) + 1.f ) * 0.5f ) * plot_height;
+            };
+            ImGui::Dummy( { width, plot_height } );
+
+            draw->AddRectFilled( origin, { origin.x + width, origin.y + plot_height }, background );
+            for ( auto x = 0UL; x < buckets.size( ); ++x )
+            {
+                auto const& bucket = buckets[ x ];
+                if ( bucket.min > bucket.max )
+                {
+                    continue;
+                }
+                auto const px = origin.x + static_cast< float >( x ) + 0.5f;
+                draw->AddLine( { px, to_y( bucket.max ) }, { px, to_y( bucket.min ) + 1.f }, range );
+
+                if ( x > 0UL && buckets[ x - 1UL ].min <= buckets[ x - 1UL ].max )
+                {
+                    draw->AddLine( { px - 1.f, to_y( buckets[ x - 1UL ].mean ) }, { px, to_y( bucket.mean ) }, mean );
+                }
+            }
+
+            auto const cursor_fraction
+                = static_cast< float >( cursor_us - begin_us ) / static_cast< float >( end_us - begin_us );
+            auto const cursor_x = origin.x + cursor_fraction * width;
+            if ( cursor_x >= origin.x && cursor_x <= origin.x + width )
+            {
+                draw->AddLine( { cursor_x, origin.y }, { cursor_x, origin.y + plot_height }, cursor );
+            }
+
+            auto const axis_label = fmt::format( "({})", a );
+            draw->AddText( { origin.x + 4.f, origin.y + 2.f }, mean, axis_label.c_str( ) );
+        }
+
+        ImGui::TreePop( );
+    }
+}
+
+} // namespace ltb::joy
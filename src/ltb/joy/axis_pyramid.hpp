@@ -0,0 +1,144 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// standard
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Pyramid files are sidecar indices that summarize every axis of a recording at
+///        power-of-two resolutions, so any stretch of it can be drawn without decoding it:
+///
+///     PyramidFileHeader
+///     PyramidDevice[ device_count ]
+///     per device:
+///         names and GUIDs                 // Referenced by `PyramidDevice::strings_offset`
+///         std::int64_t[ level 0 buckets ] // Timestamp of each level 0 bucket's first sample
+///         PyramidLevel[ level_count ]
+///         AxisSummary[ axis ][ bucket ]   // One run per level, axis by axis
+///
+/// Level 0 buckets summarize `pyramid_base_samples` consecutive snapshots of a device and
+/// each level above merges pairs of buckets from the one below, up to a single bucket.
+/// Byte order is that of the recording it indexes (see `recording_magic`).
+constexpr auto pyramid_magic          = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'P', 'Y', 'R', '\0' };
+constexpr auto pyramid_format_version = std::uint32_t( 1 );
+constexpr auto pyramid_base_samples   = std::uint32_t( 16 );
+
+struct PyramidFileHeader
+{
+    std::array< char, 8 > magic         = pyramid_magic;
+    std::uint32_t         version       = pyramid_format_version;
+    std::uint32_t         header_size   = sizeof( PyramidFileHeader );
+    std::uint64_t         source_size   = 0; ///< Size of the recording, to tell when the index is stale
+    std::int64_t          start_time_us = 0; ///< Copied from the recording
+    std::uint32_t         base_samples  = pyramid_base_samples;
+    std::uint32_t         device_count  = 0;
+};
+
+struct PyramidDevice
+{
+    std::int32_t  device_id      = 0;
+    std::uint16_t axis_count     = 0;
+    std::uint16_t level_count    = 0;
+    std::uint16_t name_size      = 0;
+    std::uint16_t guid_size      = 0;
+    std::uint32_t reserved       = 0;
+    std::uint64_t strings_offset = 0; ///< The name followed immediately by the GUID
+    std::uint64_t sample_count   = 0;
+    std::int64_t  last_time_us   = 0; ///< Timestamp of the device's last snapshot
+    std::uint64_t times_offset   = 0;
+    std::uint64_t levels_offset  = 0;
+};
+
+struct PyramidLevel
+{
+    std::uint64_t offset       = 0; ///< Byte offset of the level's first summary from the start of the file
+    std::uint64_t bucket_count = 0;
+};
+
+/// \brief The range and mean of an axis over a run of snapshots.
+struct AxisSummary
+{
+    float min  = 0.f;
+    float max  = 0.f;
+    float mean = 0.f;
+};
+
+static_assert( sizeof( PyramidFileHeader ) == 40 );
+static_assert( sizeof( PyramidDevice ) == 56 );
+static_assert( sizeof( PyramidLevel ) == 16 );
+static_assert( sizeof( AxisSummary ) == 12 );
+
+/// \brief `<recording>.pyramid`, where the pyramid of the recording at `recording_path` is kept.
+auto pyramid_path( std::filesystem::path const& recording_path ) -> std::filesystem::path;
+
+/// \brief Decode the recording at `recording_path` once and write its pyramid next to it.
+///
+/// The pyramid is written to a temporary file that replaces any existing one when it is
+/// complete, so readers never see a partial index.
+auto build_axis_pyramid( std::filesystem::path const& recording_path ) -> utils::Expected< void >;
+
+/// \brief A memory-mapped pyramid file.
+///
+/// `summarize` resamples an axis into any number of buckets from the coarsest level that
+/// still has at least one summary per bucket, so it reads fewer than two summaries per
+/// bucket however much of the recording the buckets cover.
+class AxisPyramid
+{
+public:
+    /// \brief Open the pyramid of the recording at `recording_path`, failing if it is
+    ///        missing or was built from a different version of the recording.
+    static auto open( std::filesystem::path const& recording_path ) -> utils::Expected< AxisPyramid >;
+
+    /// \brief Open the recording's pyramid, building it first if it is missing or stale.
+    static auto open_or_build( std::filesystem::path const& recording_path ) -> utils::Expected< AxisPyramid >;
+
+    [[nodiscard]] auto header( ) const -> PyramidFileHeader const&;
+    [[nodiscard]] auto device_count( ) const -> std::size_t;
+    [[nodiscard]] auto device( std::size_t index ) const -> PyramidDevice const&;
+    [[nodiscard]] auto device_name( std::size_t index ) const -> std::string_view;
+
+    /// \brief Timestamps of the first and last snapshot of any device.
+    [[nodiscard]] auto begin_time_us( ) const -> std::int64_t;
+    [[nodiscard]] auto end_time_us( ) const -> std::int64_t;
+
+    /// \brief Split [`begin_us`, `end_us`) into `buckets.size( )` equal spans of time and
+    ///        summarize `axis` of device `index` over each. Spans without any snapshots
+    ///        have `min > max`.
+    auto summarize(
+        std::size_t                 index,
+        std::size_t                 axis,
+        std::int64_t                begin_us,
+        std::int64_t                end_us,
+        std::vector< AxisSummary >& buckets
+    ) const -> void;
+
+private:
+    utils::MappedFile file_;
+
+    explicit AxisPyramid( utils::MappedFile file );
+
+    [[nodiscard]] auto level( std::size_t index, std::size_t level ) const -> PyramidLevel const&;
+};
+
+/// \brief What part of the recording the overview plots show.
+struct PyramidView
+{
+    float visible_seconds = 0.f; ///< Zero shows the whole recording
+};
+
+/// \brief Plot the range and mean of every axis around `cursor_us`, with a marker at the cursor.
+auto configure_pyramid_gui( AxisPyramid const& pyramid, std::int64_t cursor_us, PyramidView& view ) -> void;
+
+} // namespace ltb::joy
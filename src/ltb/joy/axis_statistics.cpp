@@ -0,0 +1,218 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/axis_statistics.hpp"
+
+// project
+#include "ltb/utils/file_writer.hpp"
+
+// external
+#include <fmt/format.h>
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+/// \brief Double any quotes and surround with quotes, so names with commas stay one field.
+auto csv_quoted( std::string const& text ) -> std::string
+{
+    auto quoted = std::string( "\"" );
+    for ( auto const c : text )
+    {
+        quoted += ( c == '"' ) ? std::string( "\"\"" ) : std::string( 1, c );
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+template < typename Keeps >
+auto AxisStatisticsTracker::MonotonicWindow::push( std::uint32_t index, float value, Keeps keeps ) -> float
+{
+    auto mask = static_cast< std::uint32_t >( ring.size( ) ) - 1U;
+    while ( size > 0U && !keeps( ring[ ( head + size - 1U ) & mask ].value, value ) )
+    {
+        --size;
+    }
+
+    // Only a window that keeps rising or falling grows this far, up to the window length.
+    if ( size == ring.size( ) )
+    {
+        auto grown = std::vector< WindowSample >( std::max( ring.size( ) * 2UL, 4UL ) );
+        for ( auto i = 0U; i < size; ++i )
+        {
+            grown[ i ] = ring[ ( head + i ) & mask ];
+        }
+        ring = std::move( grown );
+        head = 0U;
+        mask = static_cast< std::uint32_t >( ring.size( ) ) - 1U;
+    }
+    ring[ ( head + size ) & mask ] = { index, value };
+    ++size;
+
+    // The sample just pushed is always in the window, so this stops before emptying it.
+    while ( index - ring[ head ].index >= statistics_window_samples )
+    {
+        head = ( head + 1U ) & mask;
+        --size;
+    }
+    return ring[ head ].value;
+}
+
+auto AxisStatisticsTracker::process( std::vector< Joystick >& joysticks ) -> void
+{
+    auto const start = Clock::now( );
+
+    for ( auto& joystick : joysticks )
+    {
+        auto& device = devices_[ joystick.device_id ];
+
+        // Another device (or the same one with different axes) reconnected with this ID.
+        if ( device.guid != joystick.guid || device.axes.size( ) != joystick.axes.size( ) )
+        {
+            device      = DeviceState{ joystick.name, joystick.guid };
+            device.axes = std::vector< AxisState >( joystick.axes.size( ) );
+        }
+
+        if ( joystick.timestamp_us != device.last_sample_us )
+        {
+            device.last_sample_us = joystick.timestamp_us;
+
+            for ( auto a = 0UL; a < joystick.axes.size( ); ++a )
+            {
+                auto const value      = joystick.axes[ a ];
+                auto&      axis       = device.axes[ a ];
+                auto&      statistics = axis.statistics;
+                auto const index      = static_cast< std::uint32_t >( statistics.sample_count++ );
+                auto const count      = static_cast< double >( statistics.sample_count );
+
+                // Welford's update, which stays accurate where the sum of squares would not.
+                auto const difference = static_cast< double >( value ) - statistics.mean;
+                statistics.mean += difference / count;
+                axis.value_m2 += difference * ( static_cast< double >( value ) - statistics.mean );
+
+                if ( count > 1.0 )
+                {
+                    auto const change            = static_cast< double >( value - axis.previous_value );
+                    auto const change_difference = change - axis.change_mean;
+                    axis.change_mean += change_difference / ( count - 1.0 );
+                    axis.change_m2 += change_difference * ( change - axis.change_mean );
+                }
+                axis.previous_value = value;
+
+                statistics.window_min = axis.window_minima.push( index, value, std::less<>{ } );
+                statistics.window_max = axis.window_maxima.push( index, value, std::greater<>{ } );
+            }
+        }
+
+        joystick.axis_statistics.resize( device.axes.size( ) );
+        std::transform( device.axes.begin( ), device.axes.end( ), joystick.axis_statistics.begin( ), summarize );
+    }
+
+    stats_.device_count = devices_.size( );
+    stats_.last_us      = Microseconds( Clock::now( ) - start ).count( );
+    stats_.max_us       = std::max( stats_.max_us, stats_.last_us );
+}
+
+auto AxisStatisticsTracker::reset( ) -> void
+{
+    devices_.clear( );
+    stats_ = { };
+}
+
+auto AxisStatisticsTracker::export_csv( std::filesystem::path const& path ) const -> utils::Expected< void >
+{
+    auto csv = std::string( "device_id,name,guid,axis,samples,mean,standard_deviation,jitter,window_min,window_max\n" );
+    for ( auto const& [ device_id, device ] : devices_ )
+    {
+        for ( auto a = 0UL; a < device.axes.size( ); ++a )
+        {
+            auto const statistics = summarize( device.axes[ a ] );
+            csv += fmt::format(
+                "{},{},{},{},{},{:.6f},{:.6f},{:.6f},{:.6f},{:.6f}\n",
+                device_id,
+                csv_quoted( device.name ),
+                csv_quoted( device.guid ),
+                a,
+                statistics.sample_count,
+                statistics.mean,
+                statistics.standard_deviation,
+                statistics.jitter,
+                statistics.window_min,
+                statistics.window_max
+            );
+        }
+    }
+
+    auto file = utils::FileWriter::create( path, utils::WriteBackend::Stdio );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+    auto const ok = file->append( csv.data( ), csv.size( ) );
+    if ( !file->close( ) || !ok )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Writing '{}' failed", path.string( ) );
+    }
+    return { };
+}
+
+auto AxisStatisticsTracker::stats( ) const -> StatisticsStats const&
+{
+    return stats_;
+}
+
+auto AxisStatisticsTracker::summarize( AxisState const& axis ) -> AxisStatistics
+{
+    // Sample variances: there is one fewer change than there are samples.
+    auto       statistics         = axis.statistics;
+    auto const count              = static_cast< double >( statistics.sample_count );
+    statistics.standard_deviation = ( count > 1.0 ) ? std::sqrt( axis.value_m2 / ( count - 1.0 ) ) : 0.0;
+    statistics.jitter             = ( count > 2.0 ) ? std::sqrt( axis.change_m2 / ( count - 2.0 ) ) : 0.0;
+    return statistics;
+}
+
+auto configure_statistics_gui( AxisStatisticsTracker& tracker, std::filesystem::path const& export_path ) -> void
+{
+    auto const& stats = tracker.stats( );
+    ImGui::Text(
+        "Statistics: %zu devices | %.1f us/frame (max %.1f)",
+        stats.device_count,
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( ImGui::Button( "Reset statistics" ) )
+    {
+        tracker.reset( );
+    }
+    if ( !export_path.empty( ) )
+    {
+        ImGui::SameLine( );
+        if ( ImGui::Button( "Export statistics" ) )
+        {
+            if ( auto exported = tracker.export_csv( export_path ) )
+            {
+                spdlog::info( "Exported axis statistics to '{}'", export_path.string( ) );
+            }
+            else
+            {
+                spdlog::error( "Axis statistics not exported: {}", exported.error( ).error_message( ) );
+            }
+        }
+    }
+}
+
+} // namespace ltb::joy
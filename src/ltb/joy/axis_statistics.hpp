@@ -0,0 +1,105 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ltb::joy
+{
+
+struct StatisticsStats
+{
+    std::size_t device_count = 0; ///< Every device seen since the last reset
+    double      last_us      = 0.0;
+    double      max_us       = 0.0;
+};
+
+/// \brief The pipeline's statistics stage: keeps running statistics of every raw axis for
+///        quality checks and writes them to `Joystick::axis_statistics`.
+///
+/// Each sample is O(1) work. The mean and variance of each axis, and of the change between
+/// consecutive samples, are updated with Welford's algorithm. The window minimum and maximum
+/// are the fronts of monotonic deques, which drop samples that can no longer be an extreme
+/// or have left the window, so each sample is pushed and popped at most once. The deques are
+/// ring buffers that only grow as large as they need to, since a `std::deque` allocates
+/// over half a kilobyte up front and there are two per axis.
+///
+/// Polls that repeat a device's last sample (same timestamp) are not counted again, so
+/// the GUI polling faster than a device does not dilute its jitter.
+class AxisStatisticsTracker
+{
+public:
+    auto process( std::vector< Joystick >& joysticks ) -> void;
+
+    /// \brief Forget every sample seen so far.
+    auto reset( ) -> void;
+
+    /// \brief Write the statistics of every axis of every device seen since the last reset
+    ///        as CSV, one row per axis.
+    [[nodiscard]] auto export_csv( std::filesystem::path const& path ) const -> utils::Expected< void >;
+
+    [[nodiscard]] auto stats( ) const -> StatisticsStats const&;
+
+private:
+    struct WindowSample
+    {
+        std::uint32_t index = 0; ///< Wraps around, which only matters for differences
+        float         value = 0.f;
+    };
+
+    /// \brief A monotonic deque whose front is the extreme of the window.
+    struct MonotonicWindow
+    {
+        std::vector< WindowSample > ring = { }; ///< A power-of-two size
+        std::uint32_t               head = 0;
+        std::uint32_t               size = 0;
+
+        /// \brief Add the sample at `index` and return the extreme of the window.
+        ///
+        /// `keeps( older, newer )` is true when an older value can still be the extreme after a
+        /// newer one arrives. Older values that cannot are popped from the back.
+        template < typename Keeps >
+        auto push( std::uint32_t index, float value, Keeps keeps ) -> float;
+    };
+
+    struct AxisState
+    {
+        AxisStatistics  statistics     = { };
+        double          value_m2       = 0.0; ///< Sum of squared differences from the mean
+        double          change_mean    = 0.0;
+        double          change_m2      = 0.0;
+        float           previous_value = 0.f;
+        MonotonicWindow window_minima  = { }; ///< Increasing values, oldest first
+        MonotonicWindow window_maxima  = { }; ///< Decreasing values, oldest first
+    };
+
+    struct DeviceState
+    {
+        std::string              name           = { };
+        std::string              guid           = { };
+        std::int64_t             last_sample_us = -1;
+        std::vector< AxisState > axes           = { };
+    };
+
+    std::map< int, DeviceState > devices_ = { }; ///< By device ID, so exports are in a stable order
+    StatisticsStats              stats_   = { };
+
+    /// \brief The statistics of `axis` with its standard deviations filled in.
+    static auto summarize( AxisState const& axis ) -> AxisStatistics;
+};
+
+/// \brief Show how long the statistics take, with buttons to reset them and, if
+///        `export_path` is set, to export them there.
+auto configure_statistics_gui( AxisStatisticsTracker& tracker, std::filesystem::path const& export_path ) -> void;
+
+} // namespace ltb::joy
@@ -0,0 +1,190 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/capture.hpp"
+
+// project
+#include "ltb/utils/clock.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Enough room for roughly a second of every control changing at 1kHz on a few devices.
+constexpr auto queue_capacity = std::size_t( 1 ) << 16U;
+
+} // namespace
+
+TimestampMerger::TimestampMerger( std::int64_t reorder_window_us )
+    : reorder_window_us_( reorder_window_us )
+{
+}
+
+auto TimestampMerger::Later::operator( )( InputEvent const& lhs, InputEvent const& rhs ) const -> bool
+{
+    // Break timestamp ties deterministically so the merged stream does not depend on thread timing.
+    return std::tie( lhs.timestamp_us, lhs.device_id, lhs.type, lhs.control )
+         > std::tie( rhs.timestamp_us, rhs.device_id, rhs.type, rhs.control );
+}
+
+auto TimestampMerger::push( InputEvent const& event, CaptureStats& stats ) -> void
+{
+    if ( event.timestamp_us < last_released_us_ )
+    {
+        ++stats.late_events;
+    }
+    pending_.push( event );
+    stats.max_pending = std::max( stats.max_pending, pending_.size( ) );
+}
+
+auto TimestampMerger::release( std::int64_t now_us, std::vector< InputEvent >& events, CaptureStats& stats ) -> void
+{
+    auto const cutoff_us = now_us - reorder_window_us_;
+
+    while ( !pending_.empty( ) && pending_.top( ).timestamp_us <= cutoff_us )
+    {
+        events.emplace_back( pending_.top( ) );
+        last_released_us_ = std::max( last_released_us_, pending_.top( ).timestamp_us );
+        pending_.pop( );
+        ++stats.events_emitted;
+    }
+}
+
+CaptureThreads::CaptureThreads( int simulated_device_count, double capture_rate_hz, std::int64_t reorder_window_us )
+    : capture_rate_hz_( capture_rate_hz )
+    , queue_( queue_capacity )
+    , merger_( reorder_window_us )
+{
+    for ( auto device = 0; device < simulated_device_count; ++device )
+    {
+        auto* simulated   = simulated_.emplace_back( std::make_unique< SimulatedDevice >( ) ).get( );
+        simulated->thread = std::thread( [ this, device, simulated ] { capture_loop( device, *simulated ); } );
+    }
+}
+
+CaptureThreads::~CaptureThreads( )
+{
+    running_ = false;
+    for ( auto& simulated : simulated_ )
+    {
+        simulated->thread.join( );
+    }
+}
+
+auto CaptureThreads::submit( std::vector< Joystick > const& joysticks ) -> void
+{
+    scratch_.clear( );
+
+    for ( auto const& joystick : joysticks )
+    {
+        auto previous = std::find_if( submitted_.begin( ), submitted_.end( ), [ & ]( auto const& submitted ) {
+            return submitted.device_id == joystick.device_id;
+        } );
+
+        if ( previous == submitted_.end( ) )
+        {
+            append_input_events( Joystick{ }, joystick, scratch_ );
+            submitted_.emplace_back( joystick );
+        }
+        else
+        {
+            append_input_events( *previous, joystick, scratch_ );
+            *previous = joystick;
+        }
+    }
+
+    push_events( scratch_ );
+}
+
+auto CaptureThreads::latest_snapshots( ) const -> std::vector< Joystick >
+{
+    auto snapshots = std::vector< Joystick >{ };
+    snapshots.reserve( simulated_.size( ) );
+
+    for ( auto const& simulated : simulated_ )
+    {
+        auto lock = std::lock_guard( simulated->mutex );
+        snapshots.emplace_back( simulated->snapshot );
+    }
+
+    return snapshots;
+}
+
+auto CaptureThreads::drain( std::int64_t now_us, std::vector< InputEvent >& events ) -> void
+{
+    while ( auto event = queue_.try_pop( ) )
+    {
+        merger_.push( *event, stats_ );
+    }
+    merger_.release( now_us, events, stats_ );
+}
+
+auto CaptureThreads::stats( ) const -> CaptureStats
+{
+    auto stats           = stats_;
+    stats.events_dropped = events_dropped_.load( std::memory_order_relaxed );
+    return stats;
+}
+
+auto CaptureThreads::capture_loop( int device, SimulatedDevice& simulated ) -> void
+{
+    using namespace std::chrono;
+
+    auto const period   = duration_cast< steady_clock::duration >( duration< double >( 1.0 / capture_rate_hz_ ) );
+    auto const start    = steady_clock::now( );
+    auto       next     = start;
+    auto       previous = Joystick{ };
+    auto       events   = std::vector< InputEvent >{ };
+
+    while ( running_ )
+    {
+        auto const time_seconds = duration< double >( steady_clock::now( ) - start ).count( );
+        auto       current      = simulate_joystick( device, time_seconds );
+
+        events.clear( );
+        append_input_events( previous, current, events );
+        push_events( events );
+
+        {
+            auto lock          = std::lock_guard( simulated.mutex );
+            simulated.snapshot = current;
+        }
+        previous = std::move( current );
+
+        next += period;
+        std::this_thread::sleep_until( next );
+    }
+}
+
+auto CaptureThreads::push_events( std::vector< InputEvent > const& events ) -> void
+{
+    for ( auto const& event : events )
+    {
+        if ( !queue_.try_push( event ) )
+        {
+            events_dropped_.fetch_add( 1UL, std::memory_order_relaxed );
+        }
+    }
+}
+
+auto configure_capture_gui( CaptureStats const& stats ) -> void
+{
+    ImGui::Text(
+        "Capture: %llu events merged, %llu dropped, %llu late, %zu max pending",
+        static_cast< unsigned long long >( stats.events_emitted ),
+        static_cast< unsigned long long >( stats.events_dropped ),
+        static_cast< unsigned long long >( stats.late_events ),
+        stats.max_pending
+    );
+}
+
+} // namespace ltb::joy
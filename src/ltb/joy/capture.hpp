@@ -0,0 +1,101 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/input_event.hpp"
+#include "ltb/utils/mpsc_queue.hpp"
+
+// standard
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace ltb::joy
+{
+
+struct CaptureStats
+{
+    std::uint64_t events_emitted = 0; ///< Events released by the merger in timestamp order
+    std::uint64_t events_dropped = 0; ///< Events lost because the queue was full
+    std::uint64_t late_events    = 0; ///< Events that arrived after the reorder window had already passed them
+    std::size_t   max_pending    = 0; ///< Most events held back by the merger at once
+};
+
+/// \brief Re-orders events from many producers into a single stream sorted by timestamp.
+///
+/// Events are held until they are older than the reorder window, which bounds both the
+/// added latency and how late a producer may be before its events are reported out of order.
+class TimestampMerger
+{
+public:
+    explicit TimestampMerger( std::int64_t reorder_window_us );
+
+    auto push( InputEvent const& event, CaptureStats& stats ) -> void;
+
+    /// \brief Move every event that can no longer be preceded by a later push into `events`.
+    auto release( std::int64_t now_us, std::vector< InputEvent >& events, CaptureStats& stats ) -> void;
+
+private:
+    struct Later
+    {
+        auto operator( )( InputEvent const& lhs, InputEvent const& rhs ) const -> bool;
+    };
+
+    std::int64_t                                                        reorder_window_us_;
+    std::int64_t                                                        last_released_us_ = 0;
+    std::priority_queue< InputEvent, std::vector< InputEvent >, Later > pending_          = { };
+};
+
+/// \brief Captures simulated devices on one thread each and merges their events, along
+///        with events from devices polled on the main thread, into one ordered stream.
+///
+/// GLFW only allows joysticks to be read from the main thread, so connected hardware is
+/// handed in through `submit` while every simulated device gets its own capture thread.
+class CaptureThreads
+{
+public:
+    explicit CaptureThreads( int simulated_device_count, double capture_rate_hz, std::int64_t reorder_window_us );
+    ~CaptureThreads( );
+
+    CaptureThreads( CaptureThreads const& )                    = delete;
+    auto operator=( CaptureThreads const& ) -> CaptureThreads& = delete;
+
+    /// \brief Diff devices that were polled on the calling thread against their last submission.
+    auto submit( std::vector< Joystick > const& joysticks ) -> void;
+
+    /// \brief The most recent state of every simulated device.
+    [[nodiscard]] auto latest_snapshots( ) const -> std::vector< Joystick >;
+
+    /// \brief Pull everything queued so far and append the events that are ready, in order.
+    auto drain( std::int64_t now_us, std::vector< InputEvent >& events ) -> void;
+
+    [[nodiscard]] auto stats( ) const -> CaptureStats;
+
+private:
+    struct SimulatedDevice
+    {
+        mutable std::mutex mutex    = { };
+        Joystick           snapshot = { };
+        std::thread        thread   = { };
+    };
+
+    double                                            capture_rate_hz_;
+    utils::BoundedMpscQueue< InputEvent >             queue_;
+    std::atomic< std::uint64_t >                      events_dropped_ = { 0UL };
+    std::atomic< bool >                               running_        = { true };
+    std::vector< std::unique_ptr< SimulatedDevice > > simulated_      = { };
+    std::vector< Joystick >                           submitted_      = { };
+    std::vector< InputEvent >                         scratch_        = { };
+    TimestampMerger                                   merger_;
+    CaptureStats                                      stats_ = { };
+
+    auto capture_loop( int device, SimulatedDevice& simulated ) -> void;
+    auto push_events( std::vector< InputEvent > const& events ) -> void;
+};
+
+auto configure_capture_gui( CaptureStats const& stats ) -> void;
+
+} // namespace ltb::joy
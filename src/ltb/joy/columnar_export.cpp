@@ -0,0 +1,387 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/columnar_export.hpp"
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// external
+#include <spdlog/spdlog.h>
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration< double, std::milli >;
+
+/// \brief Bytes of records decoded by each parallel task. Measured in bytes rather than
+///        records because one snapshot block can hold as many rows as a hundred records.
+constexpr auto export_chunk_bytes = std::uint64_t( 256UL * 1024UL );
+
+constexpr auto buttons_per_mask = std::size_t( 32 );
+
+auto align_column( std::uint64_t offset ) -> std::uint64_t
+{
+    return ( offset + column_alignment - 1UL ) / column_alignment * column_alignment;
+}
+
+/// \brief Where one device's rows go in the output file.
+struct DeviceLayout
+{
+    int                          device_id         = 0;
+    std::string                  name              = { };
+    std::string                  guid              = { };
+    std::uint64_t                row_count         = 0;
+    std::size_t                  axis_count        = 0; ///< Most axes in any of the device's snapshots
+    std::size_t                  button_count      = 0; ///< Most buttons in any of the device's snapshots
+    std::uint64_t                timestamps_offset = 0;
+    std::vector< std::uint64_t > axis_offsets      = { };
+    std::vector< std::uint64_t > button_offsets    = { };
+};
+
+/// \brief A run of records decoded by one task, and the row each device's first snapshot
+///        in the run lands on.
+struct ExportChunk
+{
+    RecordingReader::Iterator    begin      = { };
+    RecordingReader::Iterator    end        = { };
+    std::vector< std::uint64_t > first_rows = { }; ///< Indexed like the device layouts
+};
+
+template < typename T >
+auto column( std::byte* output, std::uint64_t offset ) -> T*
+{
+    // Columns are aligned well beyond `alignof( T )` in a page-aligned mapping.
+    return reinterpret_cast< T* >( output + offset );
+}
+
+auto write_snapshot(
+    std::byte*            output,
+    DeviceLayout const&   device,
+    std::uint64_t         row,
+    std::int64_t          timestamp_us,
+    SnapshotView const&   snapshot,
+    std::vector< float >& scratch
+) -> void
+{
+    column< std::int64_t >( output, device.timestamps_offset )[ row ] = timestamp_us;
+
+    auto const* axes = snapshot.float_axes( scratch );
+    for ( auto a = 0UL; a < snapshot.axis_count; ++a )
+    {
+        column< float >( output, device.axis_offsets[ a ] )[ row ] = axes[ a ];
+    }
+    for ( auto b = 0UL; b < snapshot.button_count; ++b )
+    {
+        if ( snapshot.buttons[ b ] != 0U )
+        {
+            column< std::uint32_t >( output, device.button_offsets[ b / buttons_per_mask ] )[ row ]
+                |= 1U << ( b % buttons_per_mask );
+        }
+    }
+}
+
+auto write_block( std::byte* output, DeviceLayout const& device, std::uint64_t row, SnapshotBlock const& block )
+    -> void
+{
+    // Blocks are already stored a control at a time, so most of this is one copy per column.
+    auto const sample_count = block.sample_count;
+
+    std::memcpy(
+        column< std::int64_t >( output, device.timestamps_offset ) + row,
+        block.timestamps_us.data( ),
+        sample_count * sizeof( std::int64_t )
+    );
+
+    for ( auto a = 0UL; a < block.axis_count; ++a )
+    {
+        std::memcpy(
+            column< float >( output, device.axis_offsets[ a ] ) + row,
+            block.axes.data( ) + a * sample_count,
+            sample_count * sizeof( float )
+        );
+    }
+    for ( auto b = 0UL; b < block.button_count; ++b )
+    {
+        auto*       masks   = column< std::uint32_t >( output, device.button_offsets[ b / buttons_per_mask ] ) + row;
+        auto const* buttons = block.buttons.data( ) + b * sample_count;
+        auto const  shift   = static_cast< std::uint32_t >( b % buttons_per_mask );
+
+        for ( auto s = 0UL; s < sample_count; ++s )
+        {
+            masks[ s ] |= static_cast< std::uint32_t >( buttons[ s ] != 0U ) << shift;
+        }
+    }
+}
+
+} // namespace
+
+auto export_columns( std::filesystem::path const& session_path, std::filesystem::path const& output_path )
+    -> utils::Expected< void >
+{
+    auto const start = Clock::now( );
+
+    auto reader = RecordingReader::open( session_path );
+    if ( !reader )
+    {
+        return tl::make_unexpected( reader.error( ) );
+    }
+
+    // Assign every snapshot its row. Only headers and payload counts are read here.
+    auto devices = std::vector< DeviceLayout >{ };
+    auto slots   = std::unordered_map< int, std::size_t >{ };
+    auto chunks  = std::vector< ExportChunk >{ };
+
+    auto device_at = [ &devices, &slots ]( int device_id ) -> DeviceLayout& {
+        auto [ slot, inserted ] = slots.try_emplace( device_id, devices.size( ) );
+        if ( inserted )
+        {
+            devices.emplace_back( ).device_id = device_id;
+        }
+        return devices[ slot->second ];
+    };
+
+    auto next_chunk          = std::uint64_t( 0 );
+    auto corrupt_block_count = std::uint64_t( 0 );
+    for ( auto iter = reader->begin( ); iter != reader->end( ); ++iter )
+    {
+        auto const offset = reader->offset_of( iter );
+        if ( offset >= next_chunk )
+        {
+            next_chunk = offset + export_chunk_bytes;
+            if ( !chunks.empty( ) )
+            {
+                chunks.back( ).end = iter;
+            }
+            auto& chunk = chunks.emplace_back( );
+            chunk.begin = iter;
+            chunk.end   = reader->end( );
+            for ( auto const& device : devices )
+            {
+                chunk.first_rows.push_back( device.row_count );
+            }
+        }
+
+        auto const record = *iter;
+        switch ( record.type( ) )
+        {
+            case RecordType::Device:
+            {
+                auto const view   = record.device( );
+                auto&      device = device_at( record.device_id( ) );
+                device.name       = std::string( view.name );
+                device.guid       = std::string( view.guid );
+                break;
+            }
+            case RecordType::Snapshot:
+            case RecordType::FixedSnapshot:
+            {
+                auto const snapshot = record.snapshot( );
+                auto&      device   = device_at( record.device_id( ) );
+                device.row_count += 1UL;
+                device.axis_count   = std::max< std::size_t >( device.axis_count, snapshot.axis_count );
+                device.button_count = std::max< std::size_t >( device.button_count, snapshot.button_count );
+                break;
+            }
+            case RecordType::SnapshotBlock:
+            {
+                // Corrupt blocks get no rows, and are skipped again when the columns are filled.
+                if ( !validate_snapshot_block( record ) )
+                {
+                    ++corrupt_block_count;
+                    break;
+                }
+                auto const payload = record.snapshot_block( ).payload;
+                auto&      device  = device_at( record.device_id( ) );
+                device.row_count += payload.sample_count;
+                device.axis_count   = std::max< std::size_t >( device.axis_count, payload.axis_count );
+                device.button_count = std::max< std::size_t >( device.button_count, payload.button_count );
+                break;
+            }
+            case RecordType::Event:
+                break; // Already reflected in the snapshots that follow
+            case RecordType::Keyframe:
+                break; // Repeats snapshots recorded before it
+        }
+    }
+
+    // Lay out the columns of every device that has rows.
+    auto columns        = std::vector< ColumnDescriptor >{ };
+    auto device_entries = std::vector< ColumnarDevice >{ };
+    auto offset         = align_column( sizeof( ColumnarFileHeader ) );
+
+    auto add_column = [ &columns, &offset ]( DeviceLayout const& device, ColumnType type, std::size_t index ) {
+        auto const value_size = ( type == ColumnType::Timestamps ) ? sizeof( std::int64_t ) : sizeof( float );
+
+        auto& descriptor     = columns.emplace_back( );
+        descriptor.offset    = offset;
+        descriptor.row_count = device.row_count;
+        descriptor.device_id = device.device_id;
+        descriptor.type      = type;
+        descriptor.index     = static_cast< std::uint16_t >( index );
+
+        offset = align_column( offset + device.row_count * value_size );
+        return descriptor.offset;
+    };
+
+    for ( auto& device : devices )
+    {
+        if ( device.row_count == 0UL )
+        {
+            continue;
+        }
+
+        auto& entry        = device_entries.emplace_back( );
+        entry.device_id    = device.device_id;
+        entry.name_size    = static_cast< std::uint16_t >( device.name.size( ) );
+        entry.guid_size    = static_cast< std::uint16_t >( device.guid.size( ) );
+        entry.row_count    = device.row_count;
+        entry.first_column = static_cast< std::uint32_t >( columns.size( ) );
+
+        device.timestamps_offset = add_column( device, ColumnType::Timestamps, 0UL );
+        for ( auto a = 0UL; a < device.axis_count; ++a )
+        {
+            device.axis_offsets.push_back( add_column( device, ColumnType::Axis, a ) );
+        }
+        for ( auto m = 0UL; m * buttons_per_mask < device.button_count; ++m )
+        {
+            device.button_offsets.push_back( add_column( device, ColumnType::Buttons, m ) );
+        }
+
+        entry.column_count = static_cast< std::uint32_t >( columns.size( ) ) - entry.first_column;
+    }
+
+    auto footer           = ColumnarFooter{ };
+    footer.devices_offset = offset;
+    footer.device_count   = device_entries.size( );
+
+    auto strings_offset = footer.devices_offset + sizeof( ColumnarDevice ) * device_entries.size( );
+    for ( auto& entry : device_entries )
+    {
+        entry.strings_offset = strings_offset;
+        strings_offset += entry.name_size + entry.guid_size;
+    }
+
+    footer.columns_offset = ( strings_offset + 7UL ) / 8UL * 8UL;
+    footer.column_count   = columns.size( );
+
+    auto const file_size = footer.columns_offset + sizeof( ColumnDescriptor ) * columns.size( ) + sizeof( footer );
+
+    auto file = utils::WritableMappedFile::create( output_path, static_cast< std::size_t >( file_size ) );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+    auto* output = file->data( );
+
+    // Fill the (zeroed) columns. Every chunk writes its own rows, so no task waits on another.
+    auto decode_chunk = [ output, &devices, &slots ]( ExportChunk const& chunk ) {
+        auto rows    = chunk.first_rows;
+        auto block   = SnapshotBlock{ };
+        auto scratch = std::vector< float >{ };
+        rows.resize( devices.size( ), 0UL );
+
+        for ( auto iter = chunk.begin; iter != chunk.end; ++iter )
+        {
+            auto const record = *iter;
+            auto const type = record.type( );
+            if ( type != RecordType::Snapshot && type != RecordType::FixedSnapshot
+                 && type != RecordType::SnapshotBlock )
+            {
+                continue;
+            }
+            if ( type == RecordType::SnapshotBlock && !decode_snapshot_block( record, block ) )
+            {
+                continue; // Corrupt, so it was given no rows or even a device
+            }
+
+            auto const  slot   = slots.find( record.device_id( ) )->second;
+            auto const& device = devices[ slot ];
+
+            if ( type != RecordType::SnapshotBlock )
+            {
+                write_snapshot( output, device, rows[ slot ], record.timestamp_us( ), record.snapshot( ), scratch );
+                rows[ slot ] += 1UL;
+            }
+            else
+            {
+                write_block( output, device, rows[ slot ], block );
+                rows[ slot ] += block.sample_count;
+            }
+        }
+    };
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0UL, chunks.size( ), 1UL ), [ & ]( auto const& range ) {
+        for ( auto i = range.begin( ); i != range.end( ); ++i )
+        {
+            decode_chunk( chunks[ i ] );
+        }
+    } );
+#else
+    for ( auto const& chunk : chunks )
+    {
+        decode_chunk( chunk );
+    }
+#endif
+
+    auto header          = ColumnarFileHeader{ };
+    header.start_time_us = reader->header( ).start_time_us;
+    std::memcpy( output, &header, sizeof( header ) );
+
+    std::memcpy(
+        output + footer.devices_offset,
+        device_entries.data( ),
+        sizeof( ColumnarDevice ) * device_entries.size( )
+    );
+    for ( auto const& entry : device_entries )
+    {
+        auto const& device = devices[ slots.find( entry.device_id )->second ];
+        std::memcpy( output + entry.strings_offset, device.name.data( ), entry.name_size );
+        std::memcpy( output + entry.strings_offset + entry.name_size, device.guid.data( ), entry.guid_size );
+    }
+    std::memcpy( output + footer.columns_offset, columns.data( ), sizeof( ColumnDescriptor ) * columns.size( ) );
+    std::memcpy( output + file_size - sizeof( footer ), &footer, sizeof( footer ) );
+
+    auto row_count = std::uint64_t( 0 );
+    for ( auto const& entry : device_entries )
+    {
+        row_count += entry.row_count;
+    }
+
+    spdlog::info(
+        "Exported {} rows of {} devices ({} columns, {:.1f} MiB) to '{}' in {:.1f} ms using {} chunks",
+        row_count,
+        device_entries.size( ),
+        columns.size( ),
+        static_cast< double >( file_size ) / ( 1024.0 * 1024.0 ),
+        output_path.string( ),
+        Milliseconds( Clock::now( ) - start ).count( ),
+        chunks.size( )
+    );
+    if ( corrupt_block_count > 0UL )
+    {
+        spdlog::warn( "Skipped {} corrupt snapshot blocks", corrupt_block_count );
+    }
+    return { };
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,93 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <array>
+#include <cstdint>
+#include <filesystem>
+
+namespace ltb::joy
+{
+
+/// \brief Columnar files hold every snapshot of a session as one row per poll of a device,
+///        with each device's values stored column by column so they can be mapped directly
+///        (a NumPy `memmap`, say) and sliced without parsing:
+///
+///     ColumnarFileHeader
+///     column data             // Each column starts at a multiple of `column_alignment`
+///     ColumnarDevice[ ... ]
+///     names and GUIDs         // Referenced by `ColumnarDevice::strings_offset`
+///     ColumnDescriptor[ ... ] // Grouped by device, timestamps first
+///     ColumnarFooter
+///
+/// Columns are raw arrays in native byte order (see `recording_magic`), which is what lets a
+/// `memmap` use them without conversion.
+constexpr auto columnar_magic          = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'C', 'O', 'L', '\0' };
+constexpr auto columnar_footer_magic   = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'C', 'E', 'N', 'D' };
+constexpr auto columnar_format_version = std::uint32_t( 1 );
+constexpr auto column_alignment        = std::uint64_t( 64 );
+
+struct ColumnarFileHeader
+{
+    std::array< char, 8 > magic         = columnar_magic;
+    std::uint32_t         version       = columnar_format_version;
+    std::uint32_t         header_size   = sizeof( ColumnarFileHeader );
+    std::int64_t          start_time_us = 0; ///< Copied from the session
+};
+
+enum class ColumnType : std::uint16_t
+{
+    Timestamps = 1, ///< `std::int64_t` microseconds on the session's clock
+    Axis       = 2, ///< `float` in [-1, 1]
+    Buttons    = 3, ///< `std::uint32_t` bitmask, bit `b` is button `32 * index + b`
+};
+
+struct ColumnDescriptor
+{
+    std::uint64_t offset    = 0; ///< Byte offset of the first value from the start of the file
+    std::uint64_t row_count = 0;
+    std::int32_t  device_id = 0;
+    ColumnType    type      = ColumnType::Timestamps;
+    std::uint16_t index     = 0; ///< Axis number, or which 32 buttons a bitmask holds
+};
+
+struct ColumnarDevice
+{
+    std::int32_t  device_id      = 0;
+    std::uint16_t name_size      = 0;
+    std::uint16_t guid_size      = 0;
+    std::uint64_t strings_offset = 0; ///< The name followed immediately by the GUID
+    std::uint64_t row_count      = 0;
+    std::uint32_t first_column   = 0; ///< Index of the device's timestamp column
+    std::uint32_t column_count   = 0;
+};
+
+/// \brief The last bytes of a columnar file. New fields are added to the front.
+struct ColumnarFooter
+{
+    std::uint64_t         devices_offset = 0;
+    std::uint64_t         device_count   = 0;
+    std::uint64_t         columns_offset = 0;
+    std::uint64_t         column_count   = 0;
+    std::uint64_t         footer_size    = sizeof( ColumnarFooter );
+    std::array< char, 8 > magic          = columnar_footer_magic;
+};
+
+static_assert( sizeof( ColumnarFileHeader ) % 8 == 0 );
+static_assert( sizeof( ColumnDescriptor ) == 24 );
+static_assert( sizeof( ColumnarDevice ) == 32 );
+static_assert( sizeof( ColumnarFooter ) == 48 );
+
+/// \brief Convert the snapshots of the session at `session_path` into a columnar file.
+///
+/// One pass over the record headers assigns every snapshot its row, then chunks of records
+/// are decoded in parallel straight into the mapped output.
+auto export_columns( std::filesystem::path const& session_path, std::filesystem::path const& output_path )
+    -> utils::Expected< void >;
+
+} // namespace ltb::joy
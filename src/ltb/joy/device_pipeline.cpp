@@ -0,0 +1,94 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/device_pipeline.hpp"
+
+// external
+#if defined( LTB_JOYSTICKS_USE_TBB )
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+// standard
+#include <algorithm>
+
+namespace ltb::joy
+{
+
+auto DevicePipeline::set_stage( PipelineStage stage, StageFunction function ) -> DevicePipeline&
+{
+    stages_[ static_cast< std::size_t >( stage ) ]       = std::move( function );
+    batch_stages_[ static_cast< std::size_t >( stage ) ] = nullptr;
+    return *this;
+}
+
+auto DevicePipeline::set_batch_stage( PipelineStage stage, BatchFunction function ) -> DevicePipeline&
+{
+    stages_[ static_cast< std::size_t >( stage ) ]       = nullptr;
+    batch_stages_[ static_cast< std::size_t >( stage ) ] = std::move( function );
+    return *this;
+}
+
+auto DevicePipeline::process( std::vector< Joystick >& joysticks ) const -> void
+{
+    auto first = 0UL;
+    for ( auto stage = 0UL; stage < stage_count; ++stage )
+    {
+        if ( batch_stages_[ stage ] )
+        {
+            process_devices( first, stage, joysticks );
+            batch_stages_[ stage ]( joysticks );
+            first = stage + 1UL;
+        }
+    }
+    process_devices( first, stage_count, joysticks );
+}
+
+auto DevicePipeline::process_devices( std::size_t first, std::size_t last, std::vector< Joystick >& joysticks ) const
+    -> void
+{
+    auto const has_stages = std::any_of( stages_.begin( ) + first, stages_.begin( ) + last, []( auto const& stage ) {
+        return static_cast< bool >( stage );
+    } );
+
+    if ( !has_stages )
+    {
+        return;
+    }
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+    if ( joysticks.size( ) > serial_device_limit )
+    {
+        tbb::parallel_for( tbb::blocked_range< std::size_t >( 0UL, joysticks.size( ) ), [ & ]( auto const& range ) {
+            for ( auto i = range.begin( ); i != range.end( ); ++i )
+            {
+                process_device( first, last, i, joysticks[ i ] );
+            }
+        } );
+        return;
+    }
+#endif
+
+    for ( auto i = 0UL; i < joysticks.size( ); ++i )
+    {
+        process_device( first, last, i, joysticks[ i ] );
+    }
+}
+
+auto DevicePipeline::process_device(
+    std::size_t first,
+    std::size_t last,
+    std::size_t device_index,
+    Joystick&   joystick
+) const -> void
+{
+    for ( auto stage = first; stage < last; ++stage )
+    {
+        if ( stages_[ stage ] )
+        {
+            stages_[ stage ]( device_index, joystick );
+        }
+    }
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,66 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+
+// standard
+#include <array>
+#include <functional>
+
+namespace ltb::joy
+{
+
+/// \brief The per-device processing steps, in the order they are applied.
+enum class PipelineStage
+{
+    Calibration,
+    Filtering,
+    Mapping,
+    Statistics,
+    Serialization,
+};
+
+/// \brief Runs every configured stage over each polled device.
+///
+/// A handful of devices is processed serially on the calling thread. Large (usually
+/// simulated) device counts are spread across TBB worker threads, one device per task,
+/// so stage functions must only touch state belonging to the device they are given.
+///
+/// A stage may instead be a batch stage, which is given every device at once on the
+/// calling thread so it can process them all in one vectorized pass. The per-device
+/// stages before and after it run as separate passes.
+///
+/// The input processor registers calibration, filtering, mapping and statistics as batch
+/// stages, because they share per-GUID state across devices. Only serialization is a
+/// per-device stage, so it is the only one that runs on TBB worker threads.
+class DevicePipeline
+{
+public:
+    using StageFunction = std::function< void( std::size_t device_index, Joystick& joystick ) >;
+    using BatchFunction = std::function< void( std::vector< Joystick >& joysticks ) >;
+
+    /// \brief Device counts at or below this are processed without any threading overhead.
+    static constexpr auto serial_device_limit = std::size_t( 4 );
+
+    /// \brief Replaces the per-device or batch function of `stage`.
+    auto set_stage( PipelineStage stage, StageFunction function ) -> DevicePipeline&;
+    auto set_batch_stage( PipelineStage stage, BatchFunction function ) -> DevicePipeline&;
+
+    auto process( std::vector< Joystick >& joysticks ) const -> void;
+
+private:
+    static constexpr auto stage_count = std::size_t( 5 );
+
+    std::array< StageFunction, stage_count > stages_       = { };
+    std::array< BatchFunction, stage_count > batch_stages_ = { };
+
+    /// \brief Run the per-device stages in [first, last) over every device.
+    auto process_devices( std::size_t first, std::size_t last, std::vector< Joystick >& joysticks ) const -> void;
+    auto process_device( std::size_t first, std::size_t last, std::size_t device_index, Joystick& joystick ) const
+        -> void;
+};
+
+} // namespace ltb::joy
@@ -0,0 +1,29 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/fixed_point.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+namespace ltb::joy
+{
+
+auto to_fixed_axes( float const* axes, std::size_t count, std::int16_t* fixed ) -> void
+{
+    numeric_kernels( ).to_fixed_axes( axes, count, fixed );
+}
+
+auto from_fixed_axes( std::int16_t const* fixed, std::size_t count, float* axes ) -> void
+{
+    numeric_kernels( ).from_fixed_axes( fixed, count, axes );
+}
+
+auto round_to_fixed_axes( std::vector< float >& axes ) -> void
+{
+    auto fixed = std::vector< std::int16_t >( axes.size( ) );
+    to_fixed_axes( axes.data( ), axes.size( ), fixed.data( ) );
+    from_fixed_axes( fixed.data( ), fixed.size( ), axes.data( ) );
+}
+
+} // namespace ltb::joy
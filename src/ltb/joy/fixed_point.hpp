@@ -0,0 +1,28 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Clamp `count` axes to [-1, 1] and convert them to fixed point. NaNs become -1.
+///
+/// Fixed-point axes use the same Q15 scale as block-encoded axes (`axis_quantization_scale`),
+/// which is at least as fine as the 16-bit reports joysticks produce in half the space of
+/// a float. Both conversions run the `numeric_kernels( )` for the active SIMD level, which
+/// all round the same way (to nearest, ties to even).
+auto to_fixed_axes( float const* axes, std::size_t count, std::int16_t* fixed ) -> void;
+
+/// \brief Convert `count` fixed-point axes back to floats.
+auto from_fixed_axes( std::int16_t const* fixed, std::size_t count, float* axes ) -> void;
+
+/// \brief Round `axes` to the values a fixed-point round trip would give them.
+auto round_to_fixed_axes( std::vector< float >& axes ) -> void;
+
+} // namespace ltb::joy
@@ -0,0 +1,574 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/flight_recorder.hpp"
+
+// project
+#include "ltb/utils/clock.hpp"
+
+// external
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+/// \brief Small rings would spend most of their space re-describing devices.
+constexpr auto minimum_capacity = std::uint64_t( 64UL * 1024UL );
+
+/// \brief A complete event record, built in place so it is copied into the ring once.
+struct EventRecord
+{
+    RecordHeader header  = { };
+    EventPayload payload = { };
+};
+
+static_assert( sizeof( EventRecord ) % record_alignment == 0 );
+
+/// \brief The tail, commit, and device table sequence fields of a mapped header, which are
+///        shared with readers in other processes.
+auto shared_offset( std::uint64_t const& field ) -> std::atomic< std::uint64_t >&
+{
+    static_assert( sizeof( std::atomic< std::uint64_t > ) == sizeof( std::uint64_t ) );
+    static_assert( std::atomic< std::uint64_t >::is_always_lock_free );
+    return *reinterpret_cast< std::atomic< std::uint64_t >* >( const_cast< std::uint64_t* >( &field ) );
+}
+
+auto copy_from_ring(
+    std::byte const* ring,
+    std::uint64_t    capacity,
+    std::uint64_t    stream_offset,
+    void*            data,
+    std::size_t      size
+) -> void
+{
+    auto const start = stream_offset % capacity;
+    auto const first = static_cast< std::size_t >( std::min< std::uint64_t >( size, capacity - start ) );
+    std::memcpy( data, ring + start, first );
+    std::memcpy( static_cast< std::byte* >( data ) + first, ring, size - first );
+}
+
+auto copy_to_ring(
+    std::byte*    ring,
+    std::uint64_t capacity,
+    std::uint64_t stream_offset,
+    void const*   data,
+    std::size_t   size
+) -> void
+{
+    auto const start = stream_offset % capacity;
+    auto const first = static_cast< std::size_t >( std::min< std::uint64_t >( size, capacity - start ) );
+    std::memcpy( ring + start, data, first );
+    std::memcpy( ring, static_cast< std::byte const* >( data ) + first, size - first );
+}
+
+/// \brief A rewrite of the device table only copies a few records, so a reader that keeps
+///        colliding with them for this many attempts is facing a corrupt sequence.
+constexpr auto device_table_attempts = 1'000;
+
+/// \brief True if `table` holds whole, well-formed `Device` records and nothing else.
+auto device_table_valid( std::vector< std::byte > const& table ) -> bool
+{
+    for ( auto offset = 0UL; offset < table.size( ); )
+    {
+        auto record = RecordHeader{ };
+        if ( table.size( ) - offset < sizeof( record ) + sizeof( DevicePayload ) )
+        {
+            return false;
+        }
+        std::memcpy( &record, table.data( ) + offset, sizeof( record ) );
+
+        auto device = DevicePayload{ };
+        std::memcpy( &device, table.data( ) + offset + sizeof( record ), sizeof( device ) );
+        if ( record.type != RecordType::Device || record.size % record_alignment != 0UL
+             || record.size > table.size( ) - offset
+             || sizeof( record ) + sizeof( device ) + device.name_size + device.guid_size > record.size )
+        {
+            return false;
+        }
+        offset += record.size;
+    }
+    return true;
+}
+
+/// \brief Copy the records out of a device table the recorder may be rewriting.
+auto read_device_table( FlightRecordingHeader const& shared_header, std::byte const* device_table )
+    -> utils::Expected< std::vector< std::byte > >
+{
+    auto& sequence = shared_offset( shared_header.devices_sequence );
+    for ( auto attempt = 0; attempt < device_table_attempts; ++attempt )
+    {
+        auto const before = sequence.load( std::memory_order_acquire );
+        if ( before % 2UL != 0UL )
+        {
+            continue;
+        }
+
+        auto size = std::uint64_t{ 0 };
+        std::memcpy( &size, device_table, sizeof( size ) );
+        size = std::clamp( size, std::uint64_t( sizeof( size ) ), flight_device_table_size );
+
+        auto table = std::vector< std::byte >( static_cast< std::size_t >( size - sizeof( size ) ) );
+        std::memcpy( table.data( ), device_table + sizeof( size ), table.size( ) );
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if ( sequence.load( std::memory_order_relaxed ) != before )
+        {
+            continue;
+        }
+        if ( !device_table_valid( table ) )
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR( "The device table is corrupt" );
+        }
+        return table;
+    }
+    return LTB_MAKE_UNEXPECTED_ERROR( "The device table never stopped changing" );
+}
+
+} // namespace
+
+auto flight_recording_checksum( FlightRecordingHeader const& header ) -> std::uint64_t
+{
+    auto const* bytes = reinterpret_cast< unsigned char const* >( &header );
+
+    auto hash = std::uint64_t( 14695981039346656037ULL );
+    for ( auto i = 0UL; i < offsetof( FlightRecordingHeader, checksum ); ++i )
+    {
+        hash = ( hash ^ bytes[ i ] ) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+auto FlightRecorder::create( std::filesystem::path const& path, std::size_t capacity, SnapshotEncoding encoding )
+    -> utils::Expected< std::unique_ptr< FlightRecorder > >
+{
+    auto const ring_capacity = std::uint64_t( capacity / record_alignment * record_alignment );
+    if ( ring_capacity < minimum_capacity )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Flight recordings need at least {} bytes", minimum_capacity );
+    }
+
+    auto error_code = std::error_code{ };
+    if ( std::filesystem::exists( path, error_code ) )
+    {
+        auto previous = path;
+        previous += ".previous";
+        std::filesystem::rename( path, previous, error_code );
+        if ( error_code )
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR(
+                "Failed to move '{}' aside: {}",
+                path.string( ),
+                error_code.message( )
+            );
+        }
+        spdlog::info( "Kept the previous flight recording as '{}'", previous.string( ) );
+    }
+
+    auto file = utils::WritableMappedFile::create(
+        path,
+        sizeof( FlightRecordingHeader ) + ring_capacity + flight_device_table_size
+    );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    spdlog::info(
+        "Flight recording the last {:.1f} MiB of input to '{}'",
+        static_cast< double >( ring_capacity ) / ( 1024.0 * 1024.0 ),
+        path.string( )
+    );
+    auto const fixed_axes = ( encoding == SnapshotEncoding::Fixed16 );
+    return std::unique_ptr< FlightRecorder >( new FlightRecorder( std::move( *file ), ring_capacity, fixed_axes ) );
+}
+
+FlightRecorder::FlightRecorder( utils::WritableMappedFile file, std::uint64_t capacity, bool fixed_axes )
+    : file_( std::move( file ) )
+    , header_( reinterpret_cast< FlightRecordingHeader* >( file_.data( ) ) )
+    , ring_( file_.data( ) + sizeof( FlightRecordingHeader ) )
+    , capacity_( capacity )
+    , device_table_( ring_ + capacity_ )
+    , fixed_axes_( fixed_axes )
+{
+    auto header          = FlightRecordingHeader{ };
+    header.capacity      = capacity_;
+    header.start_time_us = utils::steady_time_us( );
+    header.checksum      = flight_recording_checksum( header );
+    std::memcpy( file_.data( ), &header, sizeof( header ) );
+
+    stats_.capacity = capacity_;
+}
+
+FlightRecorder::~FlightRecorder( )
+{
+    auto const flushed = file_.flush( );
+    if ( !flushed )
+    {
+        spdlog::warn( "{}", flushed.error( ).error_message( ) );
+    }
+
+    spdlog::info(
+        "Flight recorder committed {} records, dropped {}",
+        stats_.records_committed,
+        stats_.records_dropped
+    );
+}
+
+auto FlightRecorder::record( std::vector< Joystick > const& joysticks, std::vector< InputEvent > const& events )
+    -> void
+{
+    auto const start = Clock::now( );
+
+    // Describe every device again each half lap so whatever part of the ring is retained
+    // still names the devices its snapshots belong to.
+    auto const half_lap = commit_ / ( capacity_ / 2UL );
+
+    for ( auto const& joystick : joysticks )
+    {
+        scratch_.clear( );
+        auto record_count = std::uint64_t( 1 );
+
+        auto const [ known, added ] = known_devices_.try_emplace( joystick.device_id );
+        if ( added || known->second.half_lap != half_lap || !same_device( known->second.identity, joystick ) )
+        {
+            append_device_record( joystick, scratch_ );
+            set_device_identity( joystick, known->second.identity );
+            known->second.half_lap = half_lap;
+            ++record_count;
+        }
+        if ( fixed_axes_ )
+        {
+            append_fixed_snapshot_record( joystick, scratch_ );
+        }
+        else
+        {
+            append_snapshot_record( joystick, scratch_ );
+        }
+
+        append( scratch_.data( ), scratch_.size( ), record_count );
+        newest_timestamp_us_ = std::max( newest_timestamp_us_, joystick.timestamp_us );
+    }
+
+    for ( auto const& event : events )
+    {
+        auto record                = EventRecord{ };
+        record.header.type         = RecordType::Event;
+        record.header.device_id    = static_cast< std::uint16_t >( event.device_id );
+        record.header.size         = sizeof( EventRecord );
+        record.header.timestamp_us = event.timestamp_us;
+        record.payload.control     = event.control;
+        record.payload.type        = event.type;
+        record.payload.value       = event.value;
+
+        append( &record, sizeof( record ), 1UL );
+        newest_timestamp_us_ = std::max( newest_timestamp_us_, event.timestamp_us );
+    }
+
+    ++frame_count_;
+    auto const cost_us = Microseconds( Clock::now( ) - start ).count( );
+    stats_.mean_frame_cost_us += ( cost_us - stats_.mean_frame_cost_us ) / static_cast< double >( frame_count_ );
+    stats_.max_frame_cost_us = std::max( stats_.max_frame_cost_us, cost_us );
+}
+
+auto FlightRecorder::stats( ) const -> FlightRecorderStats
+{
+    auto stats           = stats_;
+    stats.bytes_retained = commit_ - tail_;
+
+    if ( commit_ > tail_ )
+    {
+        auto oldest = RecordHeader{ };
+        copy_from_ring( ring_, capacity_, tail_, &oldest, sizeof( oldest ) );
+        stats.retained_us = newest_timestamp_us_ - oldest.timestamp_us;
+    }
+    return stats;
+}
+
+auto FlightRecorder::append( void const* records, std::size_t size, std::uint64_t record_count ) -> void
+{
+    if ( size > capacity_ )
+    {
+        stats_.records_dropped += record_count;
+        return;
+    }
+
+    if ( commit_ + size - tail_ > capacity_ )
+    {
+        // Retire the oldest records before any of their bytes are overwritten. Device
+        // records move to the device table first, so a reader that sees the new tail also
+        // sees the descriptions it moved past.
+        auto devices_retired = false;
+        while ( commit_ + size - tail_ > capacity_ )
+        {
+            auto oldest = RecordHeader{ };
+            copy_from_ring( ring_, capacity_, tail_, &oldest, sizeof( oldest ) );
+            if ( oldest.type == RecordType::Device )
+            {
+                auto& retired = retired_devices_[ oldest.device_id ];
+                retired.resize( oldest.size );
+                copy_from_ring( ring_, capacity_, tail_, retired.data( ), retired.size( ) );
+                devices_retired = true;
+            }
+            tail_ += oldest.size;
+        }
+        if ( devices_retired )
+        {
+            write_device_table( );
+        }
+        shared_offset( header_->tail ).store( tail_, std::memory_order_release );
+
+        // Keep the copy below from being reordered ahead of the new tail (the writer
+        // half of a sequence lock).
+        std::atomic_thread_fence( std::memory_order_release );
+    }
+
+    copy_to_ring( ring_, capacity_, commit_, records, size );
+    commit_ += size;
+    shared_offset( header_->commit ).store( commit_, std::memory_order_release );
+
+    stats_.records_committed += record_count;
+    stats_.bytes_committed += size;
+}
+
+auto FlightRecorder::write_device_table( ) -> void
+{
+    auto& sequence = shared_offset( header_->devices_sequence );
+    sequence.store( sequence.load( std::memory_order_relaxed ) + 1UL, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    // A table that overflows keeps the lowest device IDs, so every device that fits is whole.
+    auto used = std::uint64_t( sizeof( std::uint64_t ) );
+    for ( auto const& [ device_id, record ] : retired_devices_ )
+    {
+        if ( used + record.size( ) > flight_device_table_size )
+        {
+            break;
+        }
+        std::memcpy( device_table_ + used, record.data( ), record.size( ) );
+        used += record.size( );
+    }
+    std::memcpy( device_table_, &used, sizeof( used ) );
+
+    sequence.store( sequence.load( std::memory_order_relaxed ) + 1UL, std::memory_order_release );
+}
+
+auto configure_flight_recorder_gui( FlightRecorderStats const& stats ) -> void
+{
+    ImGui::Text(
+        "Flight recorder: last %.1f s (%.1f of %.1f MiB) | %llu records, %llu dropped | %.1f us/frame (max %.1f)",
+        static_cast< double >( stats.retained_us ) * 1e-6,
+        static_cast< double >( stats.bytes_retained ) / ( 1024.0 * 1024.0 ),
+        static_cast< double >( stats.capacity ) / ( 1024.0 * 1024.0 ),
+        static_cast< unsigned long long >( stats.records_committed ),
+        static_cast< unsigned long long >( stats.records_dropped ),
+        stats.mean_frame_cost_us,
+        stats.max_frame_cost_us
+    );
+}
+
+auto extract_flight_recording( std::filesystem::path const& ring_path, std::filesystem::path const& output_path )
+    -> utils::Expected< void >
+{
+    auto ring_file = utils::MappedFile::open( ring_path );
+    if ( !ring_file )
+    {
+        return tl::make_unexpected( ring_file.error( ) );
+    }
+
+    auto header = FlightRecordingHeader{ };
+    if ( ring_file->size( ) < sizeof( header ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is too small to be a flight recording", ring_path.string( ) );
+    }
+    std::memcpy( &header, ring_file->data( ), sizeof( header ) );
+
+    if ( header.magic != flight_recording_magic || header.header_size != sizeof( header ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is not a flight recording", ring_path.string( ) );
+    }
+    if ( header.version != flight_recording_version )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "'{}' has unsupported flight recording version {}",
+            ring_path.string( ),
+            header.version
+        );
+    }
+    if ( header.checksum != flight_recording_checksum( header ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' has a corrupt header", ring_path.string( ) );
+    }
+    if ( header.capacity == 0UL || header.capacity % record_alignment != 0UL
+         || ring_file->size( ) - sizeof( header ) < header.capacity + flight_device_table_size )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is truncated", ring_path.string( ) );
+    }
+
+    auto const& shared_header = *reinterpret_cast< FlightRecordingHeader const* >( ring_file->data( ) );
+    auto const* ring          = ring_file->data( ) + sizeof( header );
+    auto const* device_table  = ring + header.capacity;
+
+    // Everything the recorder wrote before this commit (including the tail) is visible.
+    auto const commit = shared_offset( shared_header.commit ).load( std::memory_order_acquire );
+    auto const tail   = shared_offset( shared_header.tail ).load( std::memory_order_relaxed );
+    if ( tail > commit || commit - tail > header.capacity || tail % record_alignment != 0UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' has an invalid commit index", ring_path.string( ) );
+    }
+
+    auto records = std::vector< std::byte >( static_cast< std::size_t >( commit - tail ) );
+    copy_from_ring( ring, header.capacity, tail, records.data( ), records.size( ) );
+
+    // If the recorder is still running it may have retired records while they were being
+    // copied. The retired ones are skipped; everything after the new tail is intact, and
+    // the device table already holds any device description that was retired with them.
+    std::atomic_thread_fence( std::memory_order_acquire );
+    auto const new_tail = shared_offset( shared_header.tail ).load( std::memory_order_acquire );
+    auto const first    = static_cast< std::size_t >( std::min( new_tail, commit ) - tail );
+
+    auto end       = first;
+    auto first_us  = std::numeric_limits< std::int64_t >::max( );
+    auto described = std::set< std::uint16_t >{ };
+    auto undefined = std::set< std::uint16_t >{ }; ///< Devices with records before their description
+    while ( records.size( ) - end >= sizeof( RecordHeader ) )
+    {
+        auto record = RecordHeader{ };
+        std::memcpy( &record, records.data( ) + end, sizeof( record ) );
+        if ( record.size < sizeof( RecordHeader ) || record.size % record_alignment != 0UL
+             || record.size > records.size( ) - end )
+        {
+            spdlog::warn(
+                "Ignoring {} corrupt bytes at the end of '{}'",
+                records.size( ) - end,
+                ring_path.string( )
+            );
+            break;
+        }
+        if ( record.type == RecordType::Device )
+        {
+            described.insert( record.device_id );
+        }
+        else if ( described.count( record.device_id ) == 0UL )
+        {
+            undefined.insert( record.device_id );
+        }
+        first_us = std::min( first_us, record.timestamp_us );
+        end += record.size;
+    }
+
+    auto table = read_device_table( shared_header, device_table );
+    if ( !table )
+    {
+        spdlog::warn(
+            "Devices described before '{}' wrapped are left unnamed: {}",
+            ring_path.string( ),
+            table.error( ).error_message( )
+        );
+        table = std::vector< std::byte >{ };
+    }
+
+    // Re-describe those devices at the start of what was kept, so they are known before
+    // their first snapshot.
+    auto descriptions = std::vector< std::byte >{ };
+    for ( auto offset = 0UL; offset < table->size( ); )
+    {
+        auto record = RecordHeader{ };
+        std::memcpy( &record, table->data( ) + offset, sizeof( record ) );
+        if ( undefined.count( record.device_id ) > 0UL )
+        {
+            record.timestamp_us = first_us;
+
+            auto const start = descriptions.size( );
+            descriptions.resize( start + record.size );
+            std::memcpy( descriptions.data( ) + start, table->data( ) + offset, record.size );
+            std::memcpy( descriptions.data( ) + start, &record, sizeof( record ) );
+        }
+        offset += record.size;
+    }
+
+    // Indexed in the order they are written: the descriptions, then the kept records.
+    auto       index        = RecordIndexBuilder{ };
+    auto       file_offset  = std::uint64_t( sizeof( RecordingFileHeader ) );
+    auto const add_to_index = [ &index, &file_offset ]( std::byte const* bytes, std::size_t size ) {
+        for ( auto offset = 0UL; offset < size; )
+        {
+            auto record = RecordHeader{ };
+            std::memcpy( &record, bytes + offset, sizeof( record ) );
+            index.add( record, file_offset + offset );
+            offset += record.size;
+        }
+        file_offset += size;
+    };
+    add_to_index( descriptions.data( ), descriptions.size( ) );
+    add_to_index( records.data( ) + first, end - first );
+
+    auto file = std::shared_ptr< std::FILE >( std::fopen( output_path.string( ).c_str( ), "wb" ), []( auto* p ) {
+        if ( p )
+        {
+            std::fclose( p );
+        }
+    } );
+    if ( file == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}': {}", output_path.string( ), std::strerror( errno ) );
+    }
+
+    auto file_header          = RecordingFileHeader{ };
+    file_header.start_time_us = header.start_time_us;
+
+    auto const  records_size = end - first;
+    auto const& entries      = index.entries( );
+    auto const& keyframes    = index.keyframes( );
+
+    auto checksum_builder = ChecksumBuilder{ };
+    checksum_builder.add( &file_header, sizeof( file_header ) );
+    checksum_builder.add( descriptions.data( ), descriptions.size( ) );
+    checksum_builder.add( records.data( ) + first, records_size );
+    checksum_builder.add( entries.data( ), sizeof( RecordIndexEntry ) * entries.size( ) );
+    checksum_builder.add( keyframes.data( ), sizeof( RecordIndexEntry ) * keyframes.size( ) );
+
+    auto const& checksums = checksum_builder.finish( );
+    auto const  footer    = index.footer( file_offset, checksums );
+
+    if ( std::fwrite( &file_header, sizeof( file_header ), 1UL, file.get( ) ) != 1UL
+         || std::fwrite( descriptions.data( ), 1UL, descriptions.size( ), file.get( ) ) != descriptions.size( )
+         || std::fwrite( records.data( ) + first, 1UL, records_size, file.get( ) ) != records_size
+         || std::fwrite( entries.data( ), sizeof( RecordIndexEntry ), entries.size( ), file.get( ) ) != entries.size( )
+         || std::fwrite( keyframes.data( ), sizeof( RecordIndexEntry ), keyframes.size( ), file.get( ) )
+                != keyframes.size( )
+         || std::fwrite( checksums.data( ), sizeof( std::uint32_t ), checksums.size( ), file.get( ) )
+                != checksums.size( )
+         || std::fwrite( &footer, sizeof( footer ), 1UL, file.get( ) ) != 1UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to write '{}'", output_path.string( ) );
+    }
+
+    spdlog::info(
+        "Extracted {} records covering {:.3f} s from '{}' to '{}'",
+        footer.record_count,
+        ( footer.record_count > 0UL ) ? static_cast< double >( footer.end_time_us - first_us ) * 1e-6 : 0.0,
+        ring_path.string( ),
+        output_path.string( )
+    );
+    return { };
+}
+
+} // namespace ltb::joy
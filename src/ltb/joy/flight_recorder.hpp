@@ -0,0 +1,143 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// standard
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Flight recordings are a `FlightRecordingHeader` followed by `capacity` bytes
+///        of ring storage holding the most recent records of a session, then a table of
+///        `flight_device_table_size` bytes describing devices whose records left the ring.
+///
+/// Records use the session file layout (see `recording_format.hpp`) and are addressed by
+/// "stream offsets" that only ever grow; a record at stream offset `s` starts at ring
+/// byte `s % capacity` and may wrap around the end of the ring. Every record in
+/// `[tail, commit)` is complete, whether or not the recording process is still alive.
+///
+/// The device table is a `std::uint64_t` byte count followed by the newest `Device` record
+/// of each device that has been moved past the tail, so the snapshots left in the ring can
+/// still be named.
+constexpr auto flight_recording_magic   = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'R', 'N', 'G', '\0' };
+constexpr auto flight_recording_version = std::uint32_t( 2 ); ///< 2 added the device table
+constexpr auto flight_device_table_size = std::uint64_t( 64UL * 1024UL );
+
+struct FlightRecordingHeader
+{
+    // Written once when the ring is created.
+    std::array< char, 8 > magic         = flight_recording_magic;
+    std::uint32_t         version       = flight_recording_version;
+    std::uint32_t         header_size   = sizeof( FlightRecordingHeader );
+    std::uint64_t         capacity      = 0; ///< Bytes of ring storage, a multiple of `record_alignment`
+    std::int64_t          start_time_us = 0;
+    std::uint64_t         checksum      = 0; ///< FNV-1a of every field above
+
+    // Updated atomically as records are committed.
+    std::uint64_t tail             = 0; ///< Stream offset of the oldest complete record
+    std::uint64_t commit           = 0; ///< Stream offset just past the newest complete record
+    std::uint64_t devices_sequence = 0; ///< Odd while the device table is being rewritten
+};
+
+static_assert( sizeof( FlightRecordingHeader ) == 64 );
+
+/// \brief Checksum stored in `FlightRecordingHeader::checksum`.
+auto flight_recording_checksum( FlightRecordingHeader const& header ) -> std::uint64_t;
+
+struct FlightRecorderStats
+{
+    std::uint64_t capacity           = 0;
+    std::uint64_t records_committed  = 0;
+    std::uint64_t records_dropped    = 0; ///< Records too large to ever fit in the ring
+    std::uint64_t bytes_committed    = 0;
+    std::uint64_t bytes_retained     = 0; ///< Bytes between the tail and the commit index
+    std::int64_t  retained_us        = 0; ///< Time covered by the retained records
+    double        mean_frame_cost_us = 0.0;
+    double        max_frame_cost_us  = 0.0;
+};
+
+/// \brief Always-on recorder that keeps the most recent input in a fixed-size,
+///        memory-mapped ring file that survives the process crashing or being killed.
+///
+/// Appending a record is a copy into the mapping followed by a release store of the
+/// commit index. When the ring is full the tail is first moved past the oldest records,
+/// so a reader never sees a partially overwritten record between the tail and the commit.
+class FlightRecorder
+{
+public:
+    /// \brief Create a ring holding `capacity` bytes of records at `path`. An existing
+    ///        file is moved aside to `<path>.previous` so a crashed session is kept.
+    ///
+    /// Snapshots are stored as `RecordType::FixedSnapshot`s with `SnapshotEncoding::Fixed16`,
+    /// which fits twice the axis history in the same ring, and raw otherwise (snapshot
+    /// blocks span many frames, so they are never written to the ring).
+    static auto create(
+        std::filesystem::path const& path,
+        std::size_t                  capacity,
+        SnapshotEncoding             encoding = SnapshotEncoding::Raw
+    ) -> utils::Expected< std::unique_ptr< FlightRecorder > >;
+
+    ~FlightRecorder( );
+
+    FlightRecorder( FlightRecorder const& )                    = delete;
+    auto operator=( FlightRecorder const& ) -> FlightRecorder& = delete;
+
+    /// \brief Append one frame's snapshots and events.
+    auto record( std::vector< Joystick > const& joysticks, std::vector< InputEvent > const& events ) -> void;
+
+    [[nodiscard]] auto stats( ) const -> FlightRecorderStats;
+
+private:
+    struct KnownDevice
+    {
+        DeviceIdentity identity = { };
+        std::uint64_t  half_lap = 0; ///< When it was last described
+    };
+
+    utils::WritableMappedFile                 file_;
+    FlightRecordingHeader*                    header_;       ///< The start of the mapped file
+    std::byte*                                ring_;         ///< Just past `header_`
+    std::uint64_t                             capacity_;     ///< Bytes in `ring_`
+    std::byte*                                device_table_; ///< Just past `ring_`
+    bool                                      fixed_axes_;
+    std::uint64_t                             tail_                = 0;
+    std::uint64_t                             commit_              = 0;
+    std::int64_t                              newest_timestamp_us_ = 0;
+    std::unordered_map< int, KnownDevice >    known_devices_       = { };
+    std::map< int, std::vector< std::byte > > retired_devices_     = { }; ///< What the device table holds
+    std::vector< std::byte >                  scratch_             = { };
+    FlightRecorderStats                       stats_               = { };
+    std::uint64_t                             frame_count_         = 0;
+
+    FlightRecorder( utils::WritableMappedFile file, std::uint64_t capacity, bool fixed_axes );
+
+    /// \brief Copy complete records into the ring and commit them.
+    auto append( void const* records, std::size_t size, std::uint64_t record_count ) -> void;
+
+    /// \brief Rewrite the device table from `retired_devices_`.
+    auto write_device_table( ) -> void;
+};
+
+auto configure_flight_recorder_gui( FlightRecorderStats const& stats ) -> void;
+
+/// \brief Copy the records retained by the flight recording at `ring_path` into a
+///        regular session file at `output_path` that can be replayed.
+///
+/// The ring may still be in use by a running session; records overwritten while they are
+/// copied are left out. Devices whose description has already left the ring are described
+/// again from the device table, ahead of the retained records.
+auto extract_flight_recording( std::filesystem::path const& ring_path, std::filesystem::path const& output_path )
+    -> utils::Expected< void >;
+
+} // namespace ltb::joy
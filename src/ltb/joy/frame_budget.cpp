@@ -0,0 +1,96 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/frame_budget.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Milliseconds = std::chrono::duration< double, std::milli >;
+
+/// \brief Weight of the newest sample in each exponential moving cost estimate.
+constexpr auto cost_smoothing = 0.2;
+
+/// \brief Applied to the estimate of shed work so it gets retried.
+constexpr auto shed_decay = 0.9;
+
+auto index( OptionalWork work ) -> std::size_t
+{
+    return static_cast< std::size_t >( work );
+}
+
+} // namespace
+
+FrameBudget::FrameBudget( double refresh_rate_hz )
+    : budget_ms_( 1000.0 / std::max( refresh_rate_hz, 1.0 ) )
+{
+}
+
+auto FrameBudget::begin_frame( Clock::time_point start ) -> void
+{
+    last_frame_ms_ = Milliseconds( start - frame_start_ ).count( );
+    frame_start_   = start;
+}
+
+auto FrameBudget::budget_ms( ) const -> double
+{
+    return budget_ms_;
+}
+
+auto FrameBudget::last_frame_ms( ) const -> double
+{
+    return last_frame_ms_;
+}
+
+auto FrameBudget::counters( OptionalWork work ) const -> OptionalWorkCounters const&
+{
+    return counters_[ index( work ) ];
+}
+
+auto FrameBudget::should_run( OptionalWork work ) -> bool
+{
+    auto const elapsed_ms = Milliseconds( Clock::now( ) - frame_start_ ).count( );
+    auto&      estimate   = estimated_cost_ms_[ index( work ) ];
+
+    if ( elapsed_ms + estimate > budget_ms_ * usable_fraction )
+    {
+        estimate *= shed_decay;
+        ++counters_[ index( work ) ].shed;
+        return false;
+    }
+
+    ++counters_[ index( work ) ].ran;
+    return true;
+}
+
+auto FrameBudget::record_cost( OptionalWork work, Clock::duration cost ) -> void
+{
+    auto& estimate = estimated_cost_ms_[ index( work ) ];
+    estimate       = ( 1.0 - cost_smoothing ) * estimate + cost_smoothing * Milliseconds( cost ).count( );
+}
+
+auto configure_frame_budget_gui( FrameBudget const& frame_budget ) -> void
+{
+    auto shed = [ & ]( OptionalWork work ) {
+        return static_cast< unsigned long long >( frame_budget.counters( work ).shed );
+    };
+
+    ImGui::Text(
+        "Frame: %.2f / %.2f ms | Shed: %llu plots, %llu statistics panels, %llu tables",
+        frame_budget.last_frame_ms( ),
+        frame_budget.budget_ms( ),
+        shed( OptionalWork::Plots ),
+        shed( OptionalWork::StatisticsPanels ),
+        shed( OptionalWork::Tables )
+    );
+}
+
+} // namespace ltb::joy
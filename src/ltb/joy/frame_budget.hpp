@@ -0,0 +1,88 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace ltb::joy
+{
+
+/// \brief GUI work that may be dropped for a frame to keep frame pacing steady.
+enum class OptionalWork
+{
+    Plots,
+    StatisticsPanels,
+    Tables,
+};
+
+struct OptionalWorkCounters
+{
+    std::uint64_t ran  = 0;
+    std::uint64_t shed = 0;
+};
+
+/// \brief Tracks how much of the current frame has been used and sheds optional work
+///        that is not expected to fit in what is left.
+///
+/// Shed work is simply not drawn that frame, so it is deferred to the next frame that has
+/// room. The cost estimate of shed work decays each time it is skipped, which guarantees
+/// it is retried instead of being starved forever by one slow frame.
+class FrameBudget
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameBudget( double refresh_rate_hz );
+
+    /// \brief Start a frame whose work began at `start`, which may be before the caller knew
+    ///        the frame would be drawn.
+    auto begin_frame( Clock::time_point start = Clock::now( ) ) -> void;
+
+    /// \brief Run `function` if `work` is expected to fit in the remaining budget.
+    template < typename Function >
+    auto run_optional( OptionalWork work, Function&& function ) -> bool;
+
+    [[nodiscard]] auto budget_ms( ) const -> double;
+    [[nodiscard]] auto last_frame_ms( ) const -> double;
+    [[nodiscard]] auto counters( OptionalWork work ) const -> OptionalWorkCounters const&;
+
+private:
+    static constexpr auto work_count = std::size_t( 3 );
+
+    /// \brief Fraction of the frame available to GUI construction. The rest is left for
+    ///        rendering, the buffer swap, and scheduling noise.
+    static constexpr auto usable_fraction = 0.75;
+
+    double            budget_ms_;
+    double            last_frame_ms_ = 0.0;
+    Clock::time_point frame_start_   = Clock::now( );
+
+    std::array< double, work_count >               estimated_cost_ms_ = { };
+    std::array< OptionalWorkCounters, work_count > counters_          = { };
+
+    auto should_run( OptionalWork work ) -> bool;
+    auto record_cost( OptionalWork work, Clock::duration cost ) -> void;
+};
+
+template < typename Function >
+auto FrameBudget::run_optional( OptionalWork work, Function&& function ) -> bool
+{
+    if ( !should_run( work ) )
+    {
+        return false;
+    }
+
+    auto const start = Clock::now( );
+    function( );
+    record_cost( work, Clock::now( ) - start );
+    return true;
+}
+
+/// \brief Show the frame budget and how much of each kind of optional work was shed.
+auto configure_frame_budget_gui( FrameBudget const& frame_budget ) -> void;
+
+} // namespace ltb::joy
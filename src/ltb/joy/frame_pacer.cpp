@@ -0,0 +1,123 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/frame_pacer.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Milliseconds = std::chrono::duration< double, std::milli >;
+
+/// \brief Weight of the newest sample in each moving average.
+constexpr auto smoothing = 0.1;
+
+/// \brief Fixed slack added to the work estimate to absorb scheduler and driver noise.
+constexpr auto safety_margin_ms = 1.0;
+
+/// \brief How many mean deviations of the work time to keep in reserve.
+constexpr auto deviation_margin = 3.0;
+
+/// \brief Swap intervals this many times the nominal interval are treated as missed frames.
+constexpr auto missed_frame_ratio = 1.5;
+
+/// \brief OS sleeps can overshoot, so the last stretch before the latch is spent yielding.
+constexpr auto spin_threshold = Milliseconds( 0.5 );
+
+auto blend( double average, double sample ) -> double
+{
+    return ( 1.0 - smoothing ) * average + smoothing * sample;
+}
+
+} // namespace
+
+FramePacer::FramePacer( double refresh_rate_hz )
+    : nominal_interval_ms_( 1000.0 / std::max( refresh_rate_hz, 1.0 ) )
+    , refresh_interval_ms_( nominal_interval_ms_ )
+{
+}
+
+auto FramePacer::wait_for_latch( ) -> void
+{
+    auto const delay_ms = std::max( 0.0, refresh_interval_ms_ - latch_lead_ms( ) );
+    auto const latch    = last_presented_ + std::chrono::duration_cast< Clock::duration >( Milliseconds( delay_ms ) );
+
+    std::this_thread::sleep_until( latch - std::chrono::duration_cast< Clock::duration >( spin_threshold ) );
+    while ( Clock::now( ) < latch )
+    {
+        std::this_thread::yield( );
+    }
+}
+
+auto FramePacer::input_sampled( ) -> void
+{
+    input_sampled_ = Clock::now( );
+}
+
+auto FramePacer::work_done( ) -> void
+{
+    auto const work_ms = Milliseconds( Clock::now( ) - input_sampled_ ).count( );
+    work_deviation_ms_ = blend( work_deviation_ms_, std::abs( work_ms - work_ms_ ) );
+    work_ms_           = blend( work_ms_, work_ms );
+}
+
+auto FramePacer::presented( ) -> void
+{
+    auto const now         = Clock::now( );
+    auto const interval_ms = Milliseconds( now - last_presented_ ).count( );
+
+    // Swap-to-swap time tracks the real refresh interval better than the advertised rate,
+    // but missed frames must not stretch it or every later latch would be late too.
+    if ( interval_ms < missed_frame_ratio * nominal_interval_ms_ )
+    {
+        refresh_interval_ms_ = blend( refresh_interval_ms_, interval_ms );
+    }
+
+    // Unpaced, input is sampled as soon as the previous swap returns and is therefore a
+    // full refresh interval old when it is displayed.
+    auto const age_ms = Milliseconds( now - input_sampled_ ).count( );
+    input_age_ms_     = blend( input_age_ms_, age_ms );
+    reduction_ms_     = blend( reduction_ms_, refresh_interval_ms_ - age_ms );
+    last_presented_   = now;
+}
+
+auto FramePacer::input_age_ms( ) const -> double
+{
+    return input_age_ms_;
+}
+
+auto FramePacer::input_age_reduction_ms( ) const -> double
+{
+    return reduction_ms_;
+}
+
+auto FramePacer::work_estimate_ms( ) const -> double
+{
+    return work_ms_;
+}
+
+auto FramePacer::latch_lead_ms( ) const -> double
+{
+    return work_ms_ + deviation_margin * work_deviation_ms_ + safety_margin_ms;
+}
+
+auto configure_frame_pacer_gui( FramePacer const& frame_pacer ) -> void
+{
+    ImGui::Text(
+        "Late latch: input age %.2f ms (%.2f ms younger), frame work %.2f ms",
+        frame_pacer.input_age_ms( ),
+        frame_pacer.input_age_reduction_ms( ),
+        frame_pacer.work_estimate_ms( )
+    );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,61 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <chrono>
+
+namespace ltb::joy
+{
+
+/// \brief Delays the start of each frame so input is sampled as close as possible to the
+///        buffer swap that will show it.
+///
+/// Without pacing, input is read right after the previous swap returns and then sits
+/// for most of a refresh interval before it reaches the screen. The pacer learns how long
+/// building and rendering a frame takes, and sleeps until just enough time is left
+/// before the next vsync to do that work.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer( double refresh_rate_hz );
+
+    /// \brief Block until the latest point input can be sampled and still make the next vsync.
+    auto wait_for_latch( ) -> void;
+
+    /// \brief Call immediately before polling events and input.
+    auto input_sampled( ) -> void;
+
+    /// \brief Call when the frame is built and rendered, just before swapping buffers.
+    auto work_done( ) -> void;
+
+    /// \brief Call once the buffer swap returns.
+    auto presented( ) -> void;
+
+    /// \brief Average time from sampling input to the swap that displayed it.
+    [[nodiscard]] auto input_age_ms( ) const -> double;
+
+    /// \brief How much younger input is than if it had been sampled right after the previous swap.
+    [[nodiscard]] auto input_age_reduction_ms( ) const -> double;
+
+    [[nodiscard]] auto work_estimate_ms( ) const -> double;
+
+private:
+    double            nominal_interval_ms_;
+    double            refresh_interval_ms_;
+    double            work_ms_           = 0.0; ///< Moving average of frame construction and render time
+    double            work_deviation_ms_ = 0.0; ///< Moving average of the absolute error in `work_ms_`
+    double            input_age_ms_      = 0.0;
+    double            reduction_ms_      = 0.0;
+    Clock::time_point last_presented_    = Clock::now( );
+    Clock::time_point input_sampled_     = Clock::now( );
+
+    [[nodiscard]] auto latch_lead_ms( ) const -> double;
+};
+
+auto configure_frame_pacer_gui( FramePacer const& frame_pacer ) -> void;
+
+} // namespace ltb::joy
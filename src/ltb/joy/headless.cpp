@@ -0,0 +1,247 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/headless.hpp"
+
+// project
+#include "ltb/joy/input_processor.hpp"
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/utils/file_writer.hpp"
+
+// external
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief 64-bit FNV-1a, folded over the raw bytes of every processed value.
+class Digest
+{
+public:
+    auto add( void const* data, std::size_t size ) -> void
+    {
+        auto const* bytes = static_cast< unsigned char const* >( data );
+        for ( auto i = 0UL; i < size; ++i )
+        {
+            hash_ = ( hash_ ^ bytes[ i ] ) * 0x100000001b3ULL;
+        }
+    }
+
+    auto add( Joystick const& joystick ) -> void
+    {
+        add( &joystick.device_id, sizeof( joystick.device_id ) );
+        add( &joystick.timestamp_us, sizeof( joystick.timestamp_us ) );
+        add( joystick.axes.data( ), joystick.axes.size( ) * sizeof( float ) );
+        add( joystick.buttons.data( ), joystick.buttons.size( ) );
+        add( joystick.processed_axes.data( ), joystick.processed_axes.size( ) * sizeof( float ) );
+    }
+
+    [[nodiscard]] auto value( ) const -> std::uint64_t { return hash_; }
+
+private:
+    std::uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+/// \brief How long frames are appended at the capture rate for each backend.
+constexpr auto writer_benchmark_duration = std::chrono::seconds( 5 );
+
+/// \brief How much is appended as fast as possible for each backend.
+constexpr auto writer_benchmark_bytes = std::uint64_t( 512UL * 1024UL * 1024UL );
+
+/// \brief Serialized frames are reused round-robin so generating them is not measured.
+constexpr auto writer_benchmark_frames = 64;
+
+auto percentile_us( std::vector< double > const& sorted, double fraction ) -> double
+{
+    if ( sorted.empty( ) )
+    {
+        return 0.0;
+    }
+    auto const index = static_cast< std::size_t >( fraction * static_cast< double >( sorted.size( ) - 1UL ) );
+    return sorted[ index ];
+}
+
+auto benchmark_writer(
+    std::filesystem::path const&                   path,
+    utils::WriteBackend                            backend,
+    std::vector< std::vector< std::byte > > const& frames,
+    double                                         rate_hz
+) -> utils::Expected< void >
+{
+    using Clock        = std::chrono::steady_clock;
+    using Microseconds = std::chrono::duration< double, std::micro >;
+    using Seconds      = std::chrono::duration< double >;
+
+    auto file = utils::FileWriter::create( path, backend );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+    auto const name = ( file->backend( ) == utils::WriteBackend::IoUring ) ? "io_uring" : "stdio";
+
+    // Sustained rate: the latency of each append is what the recorder's writer thread waits.
+    auto       ok           = true;
+    auto       latencies_us = std::vector< double >{ };
+    auto       frame        = 0UL;
+    auto const period       = std::chrono::duration_cast< Clock::duration >( Seconds( 1.0 / rate_hz ) );
+    auto       next         = Clock::now( );
+    auto const paced_end    = next + writer_benchmark_duration;
+
+    for ( ; next < paced_end && ok; next += period, ++frame )
+    {
+        std::this_thread::sleep_until( next );
+
+        auto const& bytes = frames[ frame % frames.size( ) ];
+        auto const  start = Clock::now( );
+        ok                = file->append( bytes.data( ), bytes.size( ) );
+        latencies_us.push_back( Microseconds( Clock::now( ) - start ).count( ) );
+    }
+    std::sort( latencies_us.begin( ), latencies_us.end( ) );
+
+    // Throughput: as fast as possible, including the final flush.
+    auto       written = std::uint64_t( 0 );
+    auto const start   = Clock::now( );
+    for ( ; written < writer_benchmark_bytes && ok; ++frame )
+    {
+        auto const& bytes = frames[ frame % frames.size( ) ];
+        ok                = file->append( bytes.data( ), bytes.size( ) );
+        written += bytes.size( );
+    }
+    ok = file->close( ) && ok;
+
+    auto const elapsed = Seconds( Clock::now( ) - start ).count( );
+
+    auto error_code = std::error_code{ };
+    std::filesystem::remove( path, error_code );
+
+    if ( !ok )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Writing '{}' with {} failed", path.string( ), name );
+    }
+
+    spdlog::info(
+        "{:>8}: append latency at {} Hz p50 {:.1f} us, p99 {:.1f} us, p99.9 {:.1f} us, max {:.1f} us | "
+        "{:.0f} MiB/s flat out",
+        name,
+        rate_hz,
+        percentile_us( latencies_us, 0.5 ),
+        percentile_us( latencies_us, 0.99 ),
+        percentile_us( latencies_us, 0.999 ),
+        latencies_us.empty( ) ? 0.0 : latencies_us.back( ),
+        static_cast< double >( written ) / ( 1024.0 * 1024.0 ) / elapsed
+    );
+    return { };
+}
+
+} // namespace
+
+auto run_headless( Settings const& settings ) -> utils::Expected< void >
+{
+    auto processor = InputProcessor::create( settings );
+    if ( !processor )
+    {
+        return tl::make_unexpected( processor.error( ) );
+    }
+    auto& replay = *( *processor )->replay( );
+
+    // Finite speeds poll at the capture rate in wall time, just as the replay steps it in
+    // recorded time, so 1x takes as long as the recording did.
+    auto const wall_step = std::chrono::microseconds( std::llround( 1'000'000.0 / settings.capture_rate_hz ) );
+
+    auto       digest    = Digest{ };
+    auto       polls     = std::uint64_t{ 0 };
+    auto       events    = std::uint64_t{ 0 };
+    auto const start     = std::chrono::steady_clock::now( );
+    auto       next_poll = start;
+
+    while ( !replay.finished( ) )
+    {
+        if ( replay.speed( ) != ReplaySource::as_fast_as_possible )
+        {
+            next_poll += wall_step;
+            std::this_thread::sleep_until( next_poll );
+        }
+
+        for ( auto const& joystick : ( *processor )->poll( ) )
+        {
+            digest.add( joystick );
+        }
+        events += ( *processor )->events( ).size( );
+        ++polls;
+    }
+
+    auto const elapsed_s    = std::chrono::duration< double >( std::chrono::steady_clock::now( ) - start ).count( );
+    auto const recorded_s   = static_cast< double >( replay.clock( ).now_us( ) - replay.start_us( ) ) * 1e-6;
+    auto const record_count = replay.reader( ).record_count( );
+
+    spdlog::info(
+        "Replayed {} records ({} events) in {} polls: {:.3f} s recorded in {:.3f} s wall, {:.0f} records/s",
+        record_count,
+        events,
+        polls,
+        recorded_s,
+        elapsed_s,
+        static_cast< double >( record_count ) / std::max( elapsed_s, 1e-9 )
+    );
+    spdlog::info( "Replay digest: {:016x}", digest.value( ) );
+    if ( replay.corrupt_block_count( ) > 0UL )
+    {
+        spdlog::warn( "Skipped {} corrupt snapshot blocks", replay.corrupt_block_count( ) );
+    }
+
+    return { };
+}
+
+auto run_writer_benchmark( Settings const& settings ) -> utils::Expected< void >
+{
+    auto const device_count = std::max( settings.simulated_device_count, 1 );
+
+    auto frames = std::vector< std::vector< std::byte > >( writer_benchmark_frames );
+    for ( auto f = 0UL; f < frames.size( ); ++f )
+    {
+        for ( auto const& joystick : poll_simulated_joystick_info( device_count, static_cast< double >( f ) * 1e-3 ) )
+        {
+            if ( settings.record_encoding == SnapshotEncoding::Fixed16 )
+            {
+                append_fixed_snapshot_record( joystick, frames[ f ] );
+            }
+            else
+            {
+                append_snapshot_record( joystick, frames[ f ] );
+            }
+        }
+    }
+
+    spdlog::info(
+        "Benchmarking recording writers with {} devices ({} bytes per frame)",
+        device_count,
+        frames.front( ).size( )
+    );
+
+    for ( auto backend : { utils::WriteBackend::Stdio, utils::WriteBackend::IoUring } )
+    {
+        auto const suffix = ( backend == utils::WriteBackend::IoUring ) ? ".io_uring" : ".stdio";
+
+        auto path = settings.record_path;
+        path.replace_filename( path.stem( ).string( ) + suffix + path.extension( ).string( ) );
+
+        auto const result = benchmark_writer( path, backend, frames, settings.capture_rate_hz );
+        if ( !result )
+        {
+            return result;
+        }
+    }
+    return { };
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,27 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/settings.hpp"
+
+namespace ltb::joy
+{
+
+/// \brief Replay `settings.replay_path` through the input pipeline without a window.
+///
+/// Logs the throughput and a digest of every processed device state. The digest only
+/// depends on the recording and the pipeline, so two runs can be compared directly.
+auto run_headless( Settings const& settings ) -> utils::Expected< void >;
+
+/// \brief Write simulated recordings next to `settings.record_path` with each available
+///        `utils::WriteBackend` and log how they compare.
+///
+/// Frames of `settings.simulated_device_count` snapshots (fixed point with
+/// `SnapshotEncoding::Fixed16`, raw otherwise) are first appended at
+/// `settings.capture_rate_hz` to measure the latency the writer thread sees at a sustained
+/// rate, then as fast as possible to measure throughput. The files are deleted afterwards.
+auto run_writer_benchmark( Settings const& settings ) -> utils::Expected< void >;
+
+} // namespace ltb::joy
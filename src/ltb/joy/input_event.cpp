@@ -0,0 +1,79 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/input_event.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+// external
+#include <GLFW/glfw3.h>
+
+// standard
+#include <algorithm>
+#include <array>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Controls compared per kernel call, which bounds the indices kept on the stack.
+constexpr auto diff_chunk_size = std::size_t( 64 );
+
+/// \brief Call `emit` with the index of every value of `current` that differs from
+///        `previous` or has no previous value, in order.
+template < typename T, typename Emit >
+auto for_each_changed(
+    std::vector< T > const& previous,
+    std::vector< T > const& current,
+    ChangedLanes< T >*      changed_lanes,
+    Emit                    emit
+) -> void
+{
+    auto const common  = std::min( previous.size( ), current.size( ) );
+    auto       changed = std::array< std::uint32_t, diff_chunk_size >{ };
+
+    for ( auto first = 0UL; first < common; first += diff_chunk_size )
+    {
+        auto const count = std::min( diff_chunk_size, common - first );
+        auto const found = changed_lanes( count, previous.data( ) + first, current.data( ) + first, changed.data( ) );
+        for ( auto c = 0UL; c < found; ++c )
+        {
+            emit( first + changed[ c ] );
+        }
+    }
+    for ( auto i = common; i < current.size( ); ++i )
+    {
+        emit( i );
+    }
+}
+
+} // namespace
+
+auto append_input_events( Joystick const& previous, Joystick const& current, std::vector< InputEvent >& events )
+    -> void
+{
+    auto make_event = [ & ]( std::size_t control, InputEventType type, float value ) {
+        auto event         = InputEvent{ };
+        event.timestamp_us = current.timestamp_us;
+        event.device_id    = static_cast< std::uint16_t >( current.device_id );
+        event.control      = static_cast< std::uint16_t >( control );
+        event.type         = type;
+        event.value        = value;
+        return event;
+    };
+
+    auto const& kernels = numeric_kernels( );
+
+    for_each_changed( previous.axes, current.axes, kernels.changed_axes, [ & ]( std::size_t i ) {
+        events.emplace_back( make_event( i, InputEventType::Axis, current.axes[ i ] ) );
+    } );
+
+    for_each_changed( previous.buttons, current.buttons, kernels.changed_buttons, [ & ]( std::size_t i ) {
+        auto const pressed = ( current.buttons[ i ] == GLFW_PRESS ) ? 1.f : 0.f;
+        events.emplace_back( make_event( i, InputEventType::Button, pressed ) );
+    } );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,36 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/joysticks.hpp"
+
+// standard
+#include <cstdint>
+
+namespace ltb::joy
+{
+
+enum class InputEventType : std::uint8_t
+{
+    Axis,
+    Button,
+};
+
+/// \brief A single control changing value on a single device.
+struct InputEvent
+{
+    std::int64_t   timestamp_us = 0;
+    std::uint16_t  device_id    = 0;
+    std::uint16_t  control      = 0; ///< Axis or button index
+    InputEventType type         = InputEventType::Axis;
+    float          value        = 0.f; ///< Axis position, or 1/0 for pressed/released buttons
+};
+
+/// \brief Append an event for every axis and button that differs between two snapshots
+///        of the same device. Controls that only exist in `current` are always reported.
+auto append_input_events( Joystick const& previous, Joystick const& current, std::vector< InputEvent >& events )
+    -> void;
+
+} // namespace ltb::joy
@@ -0,0 +1,320 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/input_processor.hpp"
+
+// project
+#include "ltb/utils/clock.hpp"
+
+// external
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <cmath>
+#include <iterator>
+
+namespace ltb::joy
+{
+
+auto InputProcessor::create( Settings const& settings ) -> utils::Expected< std::unique_ptr< InputProcessor > >
+{
+    auto processor = std::unique_ptr< InputProcessor >( new InputProcessor( settings ) );
+
+    if ( !settings.replay_path.empty( ) )
+    {
+        auto const step_us = static_cast< std::int64_t >( 1'000'000.0 / settings.capture_rate_hz );
+        auto       replay  = ReplaySource::open( settings.replay_path, settings.replay_speed, step_us );
+        if ( !replay )
+        {
+            return tl::make_unexpected( replay.error( ) );
+        }
+        processor->replay_ = std::move( *replay );
+        spdlog::info( "Replaying '{}'", settings.replay_path.string( ) );
+
+        // Only the window draws the overview, and it can do without one.
+        if ( !settings.headless )
+        {
+            if ( auto pyramid = AxisPyramid::open_or_build( settings.replay_path ) )
+            {
+                processor->replay_pyramid_ = std::move( *pyramid );
+            }
+            else
+            {
+                spdlog::warn( "No recording overview: {}", pyramid.error( ).error_message( ) );
+            }
+        }
+    }
+    else if ( settings.capture_threads )
+    {
+        processor->capture_ = std::make_unique< CaptureThreads >(
+            settings.simulated_device_count,
+            settings.capture_rate_hz,
+            settings.reorder_window_us
+        );
+        spdlog::info(
+            "Capturing {} simulated devices at {}Hz",
+            settings.simulated_device_count,
+            settings.capture_rate_hz
+        );
+    }
+
+    // A replay is calibrated from its own input so it processes the same way every time.
+    if ( settings.replay_path.empty( ) && !settings.calibration_path.empty( ) )
+    {
+        if ( auto loaded = processor->calibrator_.load( settings.calibration_path ); !loaded )
+        {
+            spdlog::warn( "Calibrating from scratch: {}", loaded.error( ).error_message( ) );
+        }
+    }
+
+    auto default_filter = AxisFilter{ };
+    default_filter.type = settings.filter_type;
+    processor->filters_.set_default_filter( default_filter );
+
+    auto* raw_processor = processor.get( );
+    processor->pipeline_.set_batch_stage( PipelineStage::Calibration, [ raw_processor ]( auto& joysticks ) {
+        raw_processor->calibrator_.process( joysticks );
+        for ( auto& update : raw_processor->calibrator_.take_deadzone_updates( ) )
+        {
+            raw_processor->mapper_.set_auto_deadzones( update.guid, std::move( update.deadzones ) );
+        }
+    } );
+    processor->pipeline_.set_batch_stage( PipelineStage::Filtering, [ raw_processor ]( auto& joysticks ) {
+        raw_processor->filters_.process( joysticks );
+    } );
+    processor->pipeline_.set_batch_stage( PipelineStage::Mapping, [ raw_processor ]( auto& joysticks ) {
+        raw_processor->mapper_.process( joysticks );
+    } );
+    processor->pipeline_.set_batch_stage( PipelineStage::Statistics, [ raw_processor ]( auto& joysticks ) {
+        raw_processor->statistics_.process( joysticks );
+        raw_processor->circularity_.process( joysticks, raw_processor->mapper_ );
+    } );
+
+    if ( !settings.record_path.empty( ) )
+    {
+        auto policy              = SegmentPolicy{ };
+        policy.max_segment_bytes = settings.record_segment_mib * 1024UL * 1024UL;
+        policy.max_segment_us    = std::llround( settings.record_segment_seconds * 1e6 );
+        policy.disk_budget_bytes = settings.record_budget_mib * 1024UL * 1024UL;
+
+        auto recorder = SessionRecorder::open(
+            settings.record_path,
+            settings.record_encoding,
+            policy,
+            settings.record_writer
+        );
+        if ( !recorder )
+        {
+            return tl::make_unexpected( recorder.error( ) );
+        }
+        processor->recorder_ = std::move( *recorder );
+
+        processor->pipeline_.set_stage(
+            PipelineStage::Serialization,
+            [ raw_processor ]( auto device_index, auto const& joystick ) {
+                raw_processor->recorder_->serialize_device( device_index, joystick );
+            }
+        );
+    }
+
+    if ( !settings.flight_recorder_path.empty( ) )
+    {
+        auto flight_recorder = FlightRecorder::create(
+            settings.flight_recorder_path,
+            settings.flight_recorder_mib * 1024UL * 1024UL,
+            settings.record_encoding
+        );
+        if ( !flight_recorder )
+        {
+            return tl::make_unexpected( flight_recorder.error( ) );
+        }
+        processor->flight_recorder_ = std::move( *flight_recorder );
+    }
+
+    return processor;
+}
+
+InputProcessor::InputProcessor( Settings settings )
+    : settings_( std::move( settings ) )
+{
+}
+
+InputProcessor::~InputProcessor( )
+{
+    if ( auto saved = calibrator_.save( ); !saved )
+    {
+        spdlog::warn( "Calibration not saved: {}", saved.error( ).error_message( ) );
+    }
+    if ( !settings_.statistics_path.empty( ) )
+    {
+        if ( auto exported = statistics_.export_csv( settings_.statistics_path ); !exported )
+        {
+            spdlog::error( "Axis statistics not exported: {}", exported.error( ).error_message( ) );
+        }
+    }
+}
+
+auto InputProcessor::poll( ) -> std::vector< Joystick >
+{
+    auto joysticks = poll_source( );
+
+    if ( recorder_ )
+    {
+        recorder_->begin_frame( joysticks.size( ) );
+    }
+    pipeline_.process( joysticks );
+    if ( recorder_ )
+    {
+        recorder_->record_events( events_ );
+        recorder_->end_frame( );
+    }
+    if ( flight_recorder_ )
+    {
+        flight_recorder_->record( joysticks, events_ );
+    }
+
+    return joysticks;
+}
+
+auto InputProcessor::events( ) const -> std::vector< InputEvent > const&
+{
+    return events_;
+}
+
+auto InputProcessor::capture( ) const -> CaptureThreads const*
+{
+    return capture_.get( );
+}
+
+auto InputProcessor::recorder( ) const -> SessionRecorder const*
+{
+    return recorder_.get( );
+}
+
+auto InputProcessor::replay( ) -> ReplaySource*
+{
+    return replay_ ? &*replay_ : nullptr;
+}
+
+auto InputProcessor::display_time_us( double lead_ms ) const -> std::int64_t
+{
+    if ( replay_ )
+    {
+        // Recorded time passes `speed` times faster than wall time.
+        return replay_->clock( ).now_us( ) + std::llround( lead_ms * 1e3 * replay_->speed( ) );
+    }
+    return utils::steady_time_us( ) + std::llround( lead_ms * 1e3 );
+}
+
+auto InputProcessor::configure_status_gui( FrameBudget& frame_budget ) -> void
+{
+    if ( replay_ )
+    {
+        auto const elapsed_us = replay_->clock( ).now_us( ) - replay_->start_us( );
+        auto const length_us  = replay_->reader( ).end_time_us( ) - replay_->start_us( );
+        ImGui::Text(
+            "Replay: %.3f s of %.3f s at %s%s",
+            static_cast< double >( elapsed_us ) * 1e-6,
+            static_cast< double >( length_us ) * 1e-6,
+            ( replay_->speed( ) == ReplaySource::as_fast_as_possible )
+                ? "max speed"
+                : fmt::format( "{}x", replay_->speed( ) ).c_str( ),
+            replay_->finished( ) ? " (finished)" : ""
+        );
+        if ( replay_->corrupt_block_count( ) > 0UL )
+        {
+            ImGui::Text(
+                "Skipped %llu corrupt snapshot blocks",
+                static_cast< unsigned long long >( replay_->corrupt_block_count( ) )
+            );
+        }
+
+        // Seeking starts from the nearest keyframe, so it is cheap enough to do while dragging.
+        auto seek_seconds = static_cast< float >( static_cast< double >( elapsed_us ) * 1e-6 );
+        if ( ImGui::SliderFloat(
+                 "Seek",
+                 &seek_seconds,
+                 0.f,
+                 static_cast< float >( static_cast< double >( length_us ) * 1e-6 ),
+                 "%.3f s"
+             ) )
+        {
+            replay_->seek( replay_->start_us( ) + std::llround( static_cast< double >( seek_seconds ) * 1e6 ) );
+        }
+
+        if ( replay_pyramid_ && ImGui::TreeNode( "Recording overview" ) )
+        {
+            frame_budget.run_optional( OptionalWork::Plots, [ this ] {
+                configure_pyramid_gui( *replay_pyramid_, replay_->clock( ).now_us( ), pyramid_view_ );
+            } );
+            ImGui::TreePop( );
+        }
+    }
+
+    // Never shed, since they hold controls that are being edited.
+    configure_calibration_gui( calibrator_ );
+    configure_filter_gui( filters_ );
+    configure_mapping_gui( mapper_ );
+    configure_statistics_gui( statistics_, settings_.statistics_path );
+    configure_circularity_gui( circularity_ );
+
+    if ( capture_ )
+    {
+        frame_budget.run_optional( OptionalWork::StatisticsPanels, [ this ] {
+            configure_capture_gui( capture_->stats( ) );
+        } );
+    }
+
+    if ( recorder_ )
+    {
+        frame_budget.run_optional( OptionalWork::StatisticsPanels, [ this ] {
+            configure_recorder_gui( recorder_->stats( ) );
+        } );
+    }
+
+    if ( flight_recorder_ )
+    {
+        frame_budget.run_optional( OptionalWork::StatisticsPanels, [ this ] {
+            configure_flight_recorder_gui( flight_recorder_->stats( ) );
+        } );
+    }
+}
+
+auto InputProcessor::poll_source( ) -> std::vector< Joystick >
+{
+    if ( replay_ )
+    {
+        auto joysticks = replay_->poll( );
+        events_        = replay_->events( );
+        return joysticks;
+    }
+
+    auto joysticks = poll_joystick_info( );
+
+    auto simulated = std::vector< Joystick >{ };
+    if ( capture_ )
+    {
+        // Connected devices can only be read here on the main thread, so feed them to the
+        // merger alongside the events coming from the simulated capture threads.
+        capture_->submit( joysticks );
+        simulated = capture_->latest_snapshots( );
+
+        events_.clear( );
+        capture_->drain( utils::steady_time_us( ), events_ );
+    }
+    else if ( settings_.simulated_device_count > 0 )
+    {
+        simulated = poll_simulated_joystick_info( settings_.simulated_device_count, glfwGetTime( ) );
+    }
+
+    joysticks.insert(
+        joysticks.end( ),
+        std::make_move_iterator( simulated.begin( ) ),
+        std::make_move_iterator( simulated.end( ) )
+    );
+    return joysticks;
+}
+
+} // namespace ltb::joy
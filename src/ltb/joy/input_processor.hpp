@@ -0,0 +1,82 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/axis_calibration.hpp"
+#include "ltb/joy/axis_filters.hpp"
+#include "ltb/joy/axis_mapping.hpp"
+#include "ltb/joy/axis_statistics.hpp"
+#include "ltb/joy/axis_pyramid.hpp"
+#include "ltb/joy/capture.hpp"
+#include "ltb/joy/device_pipeline.hpp"
+#include "ltb/joy/flight_recorder.hpp"
+#include "ltb/joy/frame_budget.hpp"
+#include "ltb/joy/replay.hpp"
+#include "ltb/joy/session_recorder.hpp"
+#include "ltb/joy/settings.hpp"
+#include "ltb/joy/stick_circularity.hpp"
+
+// standard
+#include <memory>
+#include <optional>
+
+namespace ltb::joy
+{
+
+/// \brief Everything between reading the devices and showing them: the input source
+///        (live, simulated, captured, or replayed), the processing pipeline, and recording.
+///
+/// Shared by the GUI and headless runs so both process input identically.
+class InputProcessor
+{
+public:
+    static auto create( Settings const& settings ) -> utils::Expected< std::unique_ptr< InputProcessor > >;
+
+    InputProcessor( InputProcessor const& )                    = delete;
+    auto operator=( InputProcessor const& ) -> InputProcessor& = delete;
+
+    /// \brief Saves what calibration has learned, and exports the axis statistics if asked to.
+    ~InputProcessor( );
+
+    /// \brief Read every device once and run the results through the pipeline.
+    auto poll( ) -> std::vector< Joystick >;
+
+    /// \brief Timestamp-ordered input events gathered by the last `poll`.
+    [[nodiscard]] auto events( ) const -> std::vector< InputEvent > const&;
+
+    [[nodiscard]] auto capture( ) const -> CaptureThreads const*;
+    [[nodiscard]] auto recorder( ) const -> SessionRecorder const*;
+    [[nodiscard]] auto replay( ) -> ReplaySource*;
+
+    /// \brief When input sampled now will be displayed, `lead_ms` of wall time from now, in the
+    ///        time base of the polled timestamps (recorded time, when replaying).
+    [[nodiscard]] auto display_time_us( double lead_ms ) const -> std::int64_t;
+
+    /// \brief Show statistics for whichever sources and sinks are active, and an overview
+    ///        of the recording being replayed.
+    auto configure_status_gui( FrameBudget& frame_budget ) -> void;
+
+private:
+    Settings                           settings_;
+    DevicePipeline                     pipeline_        = { };
+    AxisCalibrator                     calibrator_      = { };
+    FilterBank                         filters_         = { };
+    AxisMapper                         mapper_          = { };
+    AxisStatisticsTracker              statistics_      = { };
+    StickCircularityTracker            circularity_     = { };
+    std::unique_ptr< CaptureThreads >  capture_         = nullptr;
+    std::unique_ptr< SessionRecorder > recorder_        = nullptr;
+    std::unique_ptr< FlightRecorder >  flight_recorder_ = nullptr;
+    std::optional< ReplaySource >      replay_          = std::nullopt;
+    std::optional< AxisPyramid >       replay_pyramid_  = std::nullopt; ///< Summarizes the replayed recording
+    PyramidView                        pyramid_view_    = { };
+    std::vector< InputEvent >          events_          = { };
+
+    explicit InputProcessor( Settings settings );
+
+    auto poll_source( ) -> std::vector< Joystick >;
+};
+
+} // namespace ltb::joy
@@ -3,18 +3,27 @@
 // ///////////////////////////////////////////////////////////////////////////////////////
 #include "ltb/joy/joysticks.hpp"
 
+// project
+#include "ltb/utils/clock.hpp"
+
 // external
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 
 // standard
 #include <algorithm>
+#include <cmath>
 
 namespace ltb::joy
 {
 namespace
 {
 
+static_assert( simulated_device_id_offset == GLFW_JOYSTICK_LAST + 1 );
+
+constexpr auto simulated_axis_count   = 6;
+constexpr auto simulated_button_count = 12;
+
 auto configure_buttons_gui( Joystick const& joystick )
 {
     using size_type = std::decay_t< decltype( joystick.buttons.size( ) ) >;
@@ -49,16 +58,78 @@ auto configure_buttons_gui( Joystick const& joystick )
 
 auto configure_axis_gui( Joystick const& joystick )
 {
+    // Processed and predicted values and statistics are shown beside the raw ones so the
+    // effect of the pipeline and the quality of the device are visible.
+    auto const processed   = joystick.processed_axes.size( ) == joystick.axes.size( );
+    auto const predicted   = joystick.predicted_axes.size( ) == joystick.axes.size( );
+    auto const statistics  = joystick.axis_statistics.size( ) == joystick.axes.size( );
+    auto const extra_count = ( processed ? 1 : 0 ) + ( predicted ? 1 : 0 ) + ( statistics ? 1 : 0 );
+    auto const table       = extra_count > 0 && ImGui::BeginTable( "Axes", 1 + extra_count );
+    if ( table )
+    {
+        ImGui::TableSetupColumn( "Raw" );
+        if ( processed )
+        {
+            ImGui::TableSetupColumn( "Processed" );
+        }
+        if ( predicted )
+        {
+            ImGui::TableSetupColumn( "Predicted" );
+        }
+        if ( statistics )
+        {
+            ImGui::TableSetupColumn( "Mean / noise / jitter / window range" );
+        }
+        ImGui::TableHeadersRow( );
+    }
+
     for ( auto i = 0UL; i < joystick.axes.size( ); ++i )
     {
         ImGui::PushID( static_cast< int >( i ) );
 
         auto const label = fmt::format( "({})##axis", i );
         auto       axis  = joystick.axes[ i ];
+
+        if ( table )
+        {
+            ImGui::TableNextRow( );
+            ImGui::TableNextColumn( );
+        }
         ImGui::SliderFloat( label.c_str( ), &axis, -1.f, 1.f, "%.3f" );
 
+        if ( table && processed )
+        {
+            auto processed_axis = joystick.processed_axes[ i ];
+            ImGui::TableNextColumn( );
+            ImGui::SliderFloat( fmt::format( "({})##processed", i ).c_str( ), &processed_axis, -1.f, 1.f, "%.3f" );
+        }
+        if ( table && predicted )
+        {
+            auto predicted_axis = joystick.predicted_axes[ i ];
+            ImGui::TableNextColumn( );
+            ImGui::SliderFloat( fmt::format( "({})##predicted", i ).c_str( ), &predicted_axis, -1.f, 1.f, "%.3f" );
+        }
+        if ( table && statistics )
+        {
+            auto const& axis_statistics = joystick.axis_statistics[ i ];
+            ImGui::TableNextColumn( );
+            ImGui::Text(
+                "%+.4f / %.4f / %.4f / [%+.3f, %+.3f]",
+                axis_statistics.mean,
+                axis_statistics.standard_deviation,
+                axis_statistics.jitter,
+                static_cast< double >( axis_statistics.window_min ),
+                static_cast< double >( axis_statistics.window_max )
+            );
+        }
+
         ImGui::PopID( );
     }
+
+    if ( table )
+    {
+        ImGui::EndTable( );
+    }
 }
 
 } // namespace
@@ -74,6 +145,12 @@ auto poll_joystick_info( ) -> std::vector< Joystick >
             auto joystick       = Joystick{ };
             joystick.name       = glfwGetJoystickName( glfw_joystick_index );
             joystick.glfw_index = glfw_joystick_index;
+            joystick.device_id  = glfw_joystick_index;
+
+            if ( auto const* guid = glfwGetJoystickGUID( glfw_joystick_index ) )
+            {
+                joystick.guid = guid;
+            }
 
             // Copy all the pointer data so there is no concern about references disappearing.
             auto        count = 0;
@@ -83,6 +160,8 @@ auto poll_joystick_info( ) -> std::vector< Joystick >
             auto const* buttons = glfwGetJoystickButtons( glfw_joystick_index, &count );
             joystick.buttons    = { buttons, buttons + count };
 
+            joystick.timestamp_us = utils::steady_time_us( );
+
             joysticks.emplace_back( joystick );
         }
     }
@@ -90,25 +169,87 @@ auto poll_joystick_info( ) -> std::vector< Joystick >
     return joysticks;
 }
 
-auto configure_gui_window( std::vector< Joystick > const& joysticks ) -> void
+auto simulate_joystick( int device, double time_seconds ) -> Joystick
+{
+    auto joystick         = Joystick{ };
+    joystick.name         = fmt::format( "Simulated {}", device );
+    joystick.guid         = fmt::format( "{:032x}", device );
+    joystick.device_id    = simulated_device_id_offset + device;
+    joystick.timestamp_us = utils::steady_time_us( );
+
+    // Give each device and axis its own frequency and phase so the values are easy to tell apart.
+    joystick.axes.resize( simulated_axis_count );
+    for ( auto axis = 0; axis < simulated_axis_count; ++axis )
+    {
+        auto const frequency = 0.25 + 0.1 * axis + 0.01 * device;
+        auto const phase     = 0.5 * device;
+        joystick.axes[ static_cast< std::size_t >( axis ) ]
+            = static_cast< float >( std::sin( frequency * time_seconds + phase ) );
+    }
+
+    joystick.buttons.resize( simulated_button_count );
+    auto const step = static_cast< long >( time_seconds * 4.0 ) + device;
+    for ( auto button = 0; button < simulated_button_count; ++button )
+    {
+        joystick.buttons[ static_cast< std::size_t >( button ) ]
+            = ( step % simulated_button_count == button ) ? GLFW_PRESS : GLFW_RELEASE;
+    }
+
+    return joystick;
+}
+
+auto poll_simulated_joystick_info( int device_count, double time_seconds ) -> std::vector< Joystick >
+{
+    auto joysticks = std::vector< Joystick >{ };
+    joysticks.reserve( static_cast< std::size_t >( device_count ) );
+
+    for ( auto device = 0; device < device_count; ++device )
+    {
+        joysticks.emplace_back( simulate_joystick( device, time_seconds ) );
+    }
+
+    return joysticks;
+}
+
+auto same_inputs( std::vector< Joystick > const& lhs, std::vector< Joystick > const& rhs ) -> bool
+{
+    return std::equal( lhs.begin( ), lhs.end( ), rhs.begin( ), rhs.end( ), []( auto const& a, auto const& b ) {
+        return a.device_id == b.device_id && a.axes == b.axes && a.buttons == b.buttons;
+    } );
+}
+
+auto configure_gui_window(
+    std::vector< Joystick > const&  joysticks,
+    FrameBudget&                    frame_budget,
+    std::function< void( ) > const& configure_status_gui
+) -> void
 {
     ImGui::SetNextWindowPos( { 0.f, 0.f } );
     ImGui::SetNextWindowSize( ImGui::GetIO( ).DisplaySize );
     if ( ImGui::Begin( "Joysticks", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize ) )
     {
+        if ( configure_status_gui )
+        {
+            configure_status_gui( );
+            ImGui::Separator( );
+        }
+
         if ( joysticks.empty( ) )
         {
             ImGui::TextColored( { 1.f, 1.f, 0.f, 1.f }, "No joysticks detected" );
         }
         else
         {
-            for ( auto& joystick : joysticks )
+            for ( auto i = 0UL; i < joysticks.size( ); ++i )
             {
-                ImGui::PushID( joystick.glfw_index );
+                auto const& joystick = joysticks[ i ];
+
+                // Simulated devices have no GLFW index so use the list position instead.
+                ImGui::PushID( static_cast< int >( i ) );
 
                 if ( ImGui::CollapsingHeader( joystick.name.c_str( ), ImGuiTreeNodeFlags_DefaultOpen ) )
                 {
-                    configure_buttons_gui( joystick );
+                    frame_budget.run_optional( OptionalWork::Tables, [ & ] { configure_buttons_gui( joystick ); } );
                     configure_axis_gui( joystick );
                 }
 
@@ -4,24 +4,72 @@
 #pragma once
 
 // project
+#include "ltb/joy/frame_budget.hpp"
 #include "ltb/utils/expected.hpp"
 
 // standard
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace ltb::joy
 {
 
+/// \brief Simulated devices are numbered after the last possible GLFW joystick.
+constexpr auto simulated_device_id_offset = 16;
+
+/// \brief Samples in the sliding window of `AxisStatistics::window_min` and `window_max`.
+constexpr auto statistics_window_samples = std::uint64_t( 1000 );
+
+/// \brief Running statistics of one raw axis, kept by the statistics stage.
+struct AxisStatistics
+{
+    std::uint64_t sample_count       = 0; ///< Since the statistics were last reset
+    double        mean               = 0.0;
+    double        standard_deviation = 0.0; ///< Noise, when the axis is left alone
+    double        jitter             = 0.0; ///< Standard deviation of the change between consecutive samples
+    float         window_min         = 0.f; ///< Over the last `statistics_window_samples` samples
+    float         window_max         = 0.f;
+};
+
 struct Joystick
 {
-    std::string                  name       = "";
-    int                          glfw_index = -1;
-    std::vector< float >         axes       = { };
-    std::vector< unsigned char > buttons    = { };
+    std::string                  name         = "";
+    std::string                  guid         = ""; ///< SDL-style GUID identifying the device model
+    int                          glfw_index   = -1;
+    int                          device_id    = -1; ///< The GLFW index, or an id past any GLFW index if simulated
+    std::int64_t                 timestamp_us = 0; ///< When the inputs were sampled (`utils::steady_time_us`)
+    std::vector< float >         axes         = { }; ///< As read from the device. These are what is recorded
+    std::vector< unsigned char > buttons      = { };
+
+    /// \brief `axes` after the processing pipeline, or empty if nothing processed them.
+    std::vector< float > processed_axes = { };
+
+    /// \brief `processed_axes` (or `axes`, if unprocessed) extrapolated to when this frame is
+    ///        displayed, or empty if nothing predicted them.
+    std::vector< float > predicted_axes = { };
+
+    /// \brief Statistics of each of `axes`, or empty if nothing measured them.
+    std::vector< AxisStatistics > axis_statistics = { };
 };
 
 auto poll_joystick_info( ) -> std::vector< Joystick >;
 
-auto configure_gui_window( std::vector< Joystick > const& joysticks ) -> void;
+/// \brief Generate a deterministic fake device whose inputs are a function of `time_seconds`.
+auto simulate_joystick( int device, double time_seconds ) -> Joystick;
+
+/// \brief Generate deterministic fake devices whose inputs are a function of `time_seconds`.
+auto poll_simulated_joystick_info( int device_count, double time_seconds ) -> std::vector< Joystick >;
+
+/// \brief True if both lists hold the same devices with the same axis and button values.
+auto same_inputs( std::vector< Joystick > const& lhs, std::vector< Joystick > const& rhs ) -> bool;
+
+/// \brief Show every device. `configure_status_gui`, if set, is shown above the devices.
+///        Optional parts of the display are skipped when `frame_budget` runs low.
+auto configure_gui_window(
+    std::vector< Joystick > const&  joysticks,
+    FrameBudget&                    frame_budget,
+    std::function< void( ) > const& configure_status_gui = nullptr
+) -> void;
 
 } // namespace ltb::joy
@@ -0,0 +1,351 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/numeric_kernels.hpp"
+
+// project
+#include "ltb/joy/axis_mapping.hpp"
+#include "ltb/joy/recording_format.hpp"
+
+// standard
+#include <cmath>
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define LTB_JOYSTICKS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Each level is compiled for its own instruction set, like `crc32c_sse42`, so the rest of the
+// build still runs on any x86-64. GCC would also fuse multiplies and adds into FMAs wherever
+// AVX-512 allows it, which rounds differently from the other levels, so it is told not to.
+#if defined( __clang__ )
+#define LTB_JOYSTICKS_TARGET( isa ) __attribute__( ( target( isa ) ) )
+#define LTB_JOYSTICKS_SCALAR_TARGET
+#elif defined( __GNUC__ )
+#define LTB_JOYSTICKS_TARGET( isa ) __attribute__( ( target( isa ), optimize( "fp-contract=off" ) ) )
+#define LTB_JOYSTICKS_SCALAR_TARGET __attribute__( ( optimize( "fp-contract=off" ) ) )
+#else
+#define LTB_JOYSTICKS_TARGET( isa )
+#define LTB_JOYSTICKS_SCALAR_TARGET
+#endif
+
+namespace ltb::joy
+{
+namespace
+{
+
+namespace scalar
+{
+#define LTB_JOYSTICKS_KERNEL LTB_JOYSTICKS_SCALAR_TARGET
+
+struct Scalar;
+using Lanes = Scalar;
+
+constexpr auto level = utils::SimdLevel::Scalar;
+
+#include "ltb/joy/numeric_kernels.inl"
+
+#undef LTB_JOYSTICKS_KERNEL
+} // namespace scalar
+
+#if defined( LTB_JOYSTICKS_X86_KERNELS )
+
+namespace sse42
+{
+#define LTB_JOYSTICKS_KERNEL LTB_JOYSTICKS_TARGET( "sse4.2" )
+
+struct Lanes
+{
+    using Float = __m128;
+    using Int   = __m128i;
+    using Mask  = __m128;
+
+    static constexpr auto width      = std::size_t( 4 );
+    static constexpr auto byte_width = std::size_t( 16 );
+
+    LTB_JOYSTICKS_KERNEL static auto load( float const* values ) -> Float { return _mm_loadu_ps( values ); }
+    LTB_JOYSTICKS_KERNEL static auto store( float* values, Float value ) -> void { _mm_storeu_ps( values, value ); }
+    LTB_JOYSTICKS_KERNEL static auto broadcast( float value ) -> Float { return _mm_set1_ps( value ); }
+
+    LTB_JOYSTICKS_KERNEL static auto add( Float a, Float b ) -> Float { return _mm_add_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto sub( Float a, Float b ) -> Float { return _mm_sub_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto mul( Float a, Float b ) -> Float { return _mm_mul_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto div( Float a, Float b ) -> Float { return _mm_div_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto min( Float a, Float b ) -> Float { return _mm_min_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto max( Float a, Float b ) -> Float { return _mm_max_ps( a, b ); }
+
+    LTB_JOYSTICKS_KERNEL static auto sqrt( Float value ) -> Float { return _mm_sqrt_ps( value ); }
+    LTB_JOYSTICKS_KERNEL static auto abs( Float value ) -> Float { return _mm_andnot_ps( _mm_set1_ps( -0.f ), value ); }
+    LTB_JOYSTICKS_KERNEL static auto copy_sign( Float magnitude, Float sign ) -> Float
+    {
+        auto const sign_bit = _mm_set1_ps( -0.f );
+        return _mm_or_ps( _mm_andnot_ps( sign_bit, magnitude ), _mm_and_ps( sign_bit, sign ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto load_int( std::uint32_t const* values ) -> Int
+    {
+        return _mm_loadu_si128( reinterpret_cast< __m128i const* >( values ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto add_int( Int a, Int b ) -> Int { return _mm_add_epi32( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto truncate( Float value ) -> Int { return _mm_cvttps_epi32( value ); }
+    LTB_JOYSTICKS_KERNEL static auto to_float( Int value ) -> Float { return _mm_cvtepi32_ps( value ); }
+
+    /// \brief There is no gather before AVX2, so the lookups are done one lane at a time.
+    LTB_JOYSTICKS_KERNEL static auto gather( float const* table, Int index ) -> Float
+    {
+        alignas( 16 ) std::int32_t lanes[ width ];
+        _mm_store_si128( reinterpret_cast< __m128i* >( lanes ), index );
+        return _mm_setr_ps( table[ lanes[ 0 ] ], table[ lanes[ 1 ] ], table[ lanes[ 2 ] ], table[ lanes[ 3 ] ] );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto greater( Float a, Float b ) -> Mask { return _mm_cmpgt_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto keep( Float value, Mask mask ) -> Float { return _mm_and_ps( value, mask ); }
+    LTB_JOYSTICKS_KERNEL static auto select( Mask mask, Float if_true, Float if_false ) -> Float
+    {
+        return _mm_blendv_ps( if_false, if_true, mask );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto changed( Float a, Float b ) -> std::uint64_t
+    {
+        return static_cast< std::uint32_t >( _mm_movemask_ps( _mm_cmpneq_ps( a, b ) ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto changed_bytes( unsigned char const* a, unsigned char const* b ) -> std::uint64_t
+    {
+        auto const lhs = _mm_loadu_si128( reinterpret_cast< __m128i const* >( a ) );
+        auto const rhs = _mm_loadu_si128( reinterpret_cast< __m128i const* >( b ) );
+        return 0xffffU & ~static_cast< std::uint32_t >( _mm_movemask_epi8( _mm_cmpeq_epi8( lhs, rhs ) ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto store_fixed( std::int16_t* fixed, Float value ) -> void
+    {
+        auto const whole = _mm_cvtps_epi32( value );
+        _mm_storel_epi64( reinterpret_cast< __m128i* >( fixed ), _mm_packs_epi32( whole, whole ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto load_fixed( std::int16_t const* fixed ) -> Float
+    {
+        auto const values = _mm_loadl_epi64( reinterpret_cast< __m128i const* >( fixed ) );
+        return _mm_cvtepi32_ps( _mm_cvtepi16_epi32( values ) );
+    }
+};
+
+constexpr auto level = utils::SimdLevel::Sse42;
+
+#include "ltb/joy/numeric_kernels.inl"
+
+#undef LTB_JOYSTICKS_KERNEL
+} // namespace sse42
+
+namespace avx2
+{
+#define LTB_JOYSTICKS_KERNEL LTB_JOYSTICKS_TARGET( "avx2" )
+
+struct Lanes
+{
+    using Float = __m256;
+    using Int   = __m256i;
+    using Mask  = __m256;
+
+    static constexpr auto width      = std::size_t( 8 );
+    static constexpr auto byte_width = std::size_t( 32 );
+
+    LTB_JOYSTICKS_KERNEL static auto load( float const* values ) -> Float { return _mm256_loadu_ps( values ); }
+    LTB_JOYSTICKS_KERNEL static auto store( float* values, Float value ) -> void { _mm256_storeu_ps( values, value ); }
+    LTB_JOYSTICKS_KERNEL static auto broadcast( float value ) -> Float { return _mm256_set1_ps( value ); }
+
+    LTB_JOYSTICKS_KERNEL static auto add( Float a, Float b ) -> Float { return _mm256_add_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto sub( Float a, Float b ) -> Float { return _mm256_sub_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto mul( Float a, Float b ) -> Float { return _mm256_mul_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto div( Float a, Float b ) -> Float { return _mm256_div_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto min( Float a, Float b ) -> Float { return _mm256_min_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto max( Float a, Float b ) -> Float { return _mm256_max_ps( a, b ); }
+
+    LTB_JOYSTICKS_KERNEL static auto sqrt( Float value ) -> Float { return _mm256_sqrt_ps( value ); }
+    LTB_JOYSTICKS_KERNEL static auto abs( Float value ) -> Float
+    {
+        return _mm256_andnot_ps( _mm256_set1_ps( -0.f ), value );
+    }
+    LTB_JOYSTICKS_KERNEL static auto copy_sign( Float magnitude, Float sign ) -> Float
+    {
+        auto const sign_bit = _mm256_set1_ps( -0.f );
+        return _mm256_or_ps( _mm256_andnot_ps( sign_bit, magnitude ), _mm256_and_ps( sign_bit, sign ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto load_int( std::uint32_t const* values ) -> Int
+    {
+        return _mm256_loadu_si256( reinterpret_cast< __m256i const* >( values ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto add_int( Int a, Int b ) -> Int { return _mm256_add_epi32( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto truncate( Float value ) -> Int { return _mm256_cvttps_epi32( value ); }
+    LTB_JOYSTICKS_KERNEL static auto to_float( Int value ) -> Float { return _mm256_cvtepi32_ps( value ); }
+    LTB_JOYSTICKS_KERNEL static auto gather( float const* table, Int index ) -> Float
+    {
+        return _mm256_i32gather_ps( table, index, sizeof( float ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto greater( Float a, Float b ) -> Mask { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    LTB_JOYSTICKS_KERNEL static auto keep( Float value, Mask mask ) -> Float { return _mm256_and_ps( value, mask ); }
+    LTB_JOYSTICKS_KERNEL static auto select( Mask mask, Float if_true, Float if_false ) -> Float
+    {
+        return _mm256_blendv_ps( if_false, if_true, mask );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto changed( Float a, Float b ) -> std::uint64_t
+    {
+        return static_cast< std::uint32_t >( _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_NEQ_UQ ) ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto changed_bytes( unsigned char const* a, unsigned char const* b ) -> std::uint64_t
+    {
+        auto const lhs = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( a ) );
+        auto const rhs = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( b ) );
+        return ~static_cast< std::uint32_t >( _mm256_movemask_epi8( _mm256_cmpeq_epi8( lhs, rhs ) ) );
+    }
+
+    /// \brief The pack works within each 128-bit half, so the halves are packed together instead.
+    LTB_JOYSTICKS_KERNEL static auto store_fixed( std::int16_t* fixed, Float value ) -> void
+    {
+        auto const whole  = _mm256_cvtps_epi32( value );
+        auto const packed = _mm_packs_epi32( _mm256_castsi256_si128( whole ), _mm256_extracti128_si256( whole, 1 ) );
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( fixed ), packed );
+    }
+    LTB_JOYSTICKS_KERNEL static auto load_fixed( std::int16_t const* fixed ) -> Float
+    {
+        auto const values = _mm_loadu_si128( reinterpret_cast< __m128i const* >( fixed ) );
+        return _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( values ) );
+    }
+};
+
+constexpr auto level = utils::SimdLevel::Avx2;
+
+#include "ltb/joy/numeric_kernels.inl"
+
+#undef LTB_JOYSTICKS_KERNEL
+} // namespace avx2
+
+namespace avx512
+{
+#define LTB_JOYSTICKS_KERNEL LTB_JOYSTICKS_TARGET( "avx512f,avx512bw,avx512dq,avx512vl" )
+
+struct Lanes
+{
+    using Float = __m512;
+    using Int   = __m512i;
+    using Mask  = __mmask16;
+
+    static constexpr auto width      = std::size_t( 16 );
+    static constexpr auto byte_width = std::size_t( 64 );
+
+    // GCC 12's unmasked AVX-512 intrinsics merge into an `_mm512_undefined_*` value, which
+    // -Wmaybe-uninitialized reports once they are inlined at -O2 (GCC bug 105593). The
+    // zero-masked forms with every lane set compile to the same instructions without it.
+    static constexpr auto all        = Mask( 0xffff );
+    static constexpr auto all_halves = __mmask8( 0xff );
+
+    LTB_JOYSTICKS_KERNEL static auto load( float const* values ) -> Float { return _mm512_loadu_ps( values ); }
+    LTB_JOYSTICKS_KERNEL static auto store( float* values, Float value ) -> void { _mm512_storeu_ps( values, value ); }
+    LTB_JOYSTICKS_KERNEL static auto broadcast( float value ) -> Float { return _mm512_set1_ps( value ); }
+
+    LTB_JOYSTICKS_KERNEL static auto add( Float a, Float b ) -> Float { return _mm512_add_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto sub( Float a, Float b ) -> Float { return _mm512_sub_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto mul( Float a, Float b ) -> Float { return _mm512_mul_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto div( Float a, Float b ) -> Float { return _mm512_div_ps( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto min( Float a, Float b ) -> Float { return _mm512_maskz_min_ps( all, a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto max( Float a, Float b ) -> Float { return _mm512_maskz_max_ps( all, a, b ); }
+
+    LTB_JOYSTICKS_KERNEL static auto sqrt( Float value ) -> Float { return _mm512_maskz_sqrt_ps( all, value ); }
+    LTB_JOYSTICKS_KERNEL static auto abs( Float value ) -> Float { return _mm512_abs_ps( value ); }
+    LTB_JOYSTICKS_KERNEL static auto copy_sign( Float magnitude, Float sign ) -> Float
+    {
+        auto const sign_bit = _mm512_set1_ps( -0.f );
+        return _mm512_or_ps( _mm512_andnot_ps( sign_bit, magnitude ), _mm512_and_ps( sign_bit, sign ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto load_int( std::uint32_t const* values ) -> Int
+    {
+        return _mm512_loadu_si512( values );
+    }
+    LTB_JOYSTICKS_KERNEL static auto add_int( Int a, Int b ) -> Int { return _mm512_add_epi32( a, b ); }
+    LTB_JOYSTICKS_KERNEL static auto truncate( Float value ) -> Int { return _mm512_maskz_cvttps_epi32( all, value ); }
+    LTB_JOYSTICKS_KERNEL static auto to_float( Int value ) -> Float { return _mm512_maskz_cvtepi32_ps( all, value ); }
+    /// \brief Two 256-bit gathers, because GCC's unoptimized `_mm512_i32gather_ps` macro trips
+    ///        -Wsign-conversion on its own mask. Most CPUs split the 512-bit gather anyway.
+    LTB_JOYSTICKS_KERNEL static auto gather( float const* table, Int index ) -> Float
+    {
+        auto const low_index  = _mm512_maskz_extracti64x4_epi64( all_halves, index, 0 );
+        auto const high_index = _mm512_maskz_extracti64x4_epi64( all_halves, index, 1 );
+        auto const low        = _mm256_i32gather_ps( table, low_index, sizeof( float ) );
+        auto const high       = _mm256_i32gather_ps( table, high_index, sizeof( float ) );
+        return _mm512_insertf32x8( _mm512_castps256_ps512( low ), high, 1 );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto greater( Float a, Float b ) -> Mask
+    {
+        return _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ );
+    }
+    LTB_JOYSTICKS_KERNEL static auto keep( Float value, Mask mask ) -> Float
+    {
+        return _mm512_maskz_mov_ps( mask, value );
+    }
+    LTB_JOYSTICKS_KERNEL static auto select( Mask mask, Float if_true, Float if_false ) -> Float
+    {
+        return _mm512_mask_blend_ps( mask, if_false, if_true );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto changed( Float a, Float b ) -> std::uint64_t
+    {
+        return _mm512_cmp_ps_mask( a, b, _CMP_NEQ_UQ );
+    }
+    LTB_JOYSTICKS_KERNEL static auto changed_bytes( unsigned char const* a, unsigned char const* b ) -> std::uint64_t
+    {
+        return _mm512_cmpneq_epi8_mask( _mm512_loadu_si512( a ), _mm512_loadu_si512( b ) );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto store_fixed( std::int16_t* fixed, Float value ) -> void
+    {
+        auto const packed = _mm512_maskz_cvtsepi32_epi16( all, _mm512_maskz_cvtps_epi32( all, value ) );
+        _mm256_storeu_si256( reinterpret_cast< __m256i* >( fixed ), packed );
+    }
+    LTB_JOYSTICKS_KERNEL static auto load_fixed( std::int16_t const* fixed ) -> Float
+    {
+        auto const values = _mm256_loadu_si256( reinterpret_cast< __m256i const* >( fixed ) );
+        return _mm512_maskz_cvtepi32_ps( all, _mm512_maskz_cvtepi16_epi32( all, values ) );
+    }
+};
+
+constexpr auto level = utils::SimdLevel::Avx512;
+
+#include "ltb/joy/numeric_kernels.inl"
+
+#undef LTB_JOYSTICKS_KERNEL
+} // namespace avx512
+
+#endif
+
+} // namespace
+
+auto numeric_kernels( ) -> NumericKernels const&
+{
+    static auto const& kernels = numeric_kernels( utils::simd_level( ) );
+    return kernels;
+}
+
+auto numeric_kernels( utils::SimdLevel level ) -> NumericKernels const&
+{
+#if defined( LTB_JOYSTICKS_X86_KERNELS )
+    switch ( level )
+    {
+        case utils::SimdLevel::Scalar:
+            break;
+        case utils::SimdLevel::Sse42:
+            return sse42::kernels;
+        case utils::SimdLevel::Avx2:
+            return avx2::kernels;
+        case utils::SimdLevel::Avx512:
+            return avx512::kernels;
+    }
+#else
+    static_cast< void >( level );
+#endif
+    return scalar::kernels;
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,123 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/cpu_dispatch.hpp"
+
+// standard
+#include <cstddef>
+#include <cstdint>
+
+namespace ltb::joy
+{
+
+/// \brief Map each of `count` signed axis lanes through its deadzones and curve, keeping its sign.
+using MapAxisLanes = auto(
+    std::size_t          count,
+    float*               values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void;
+
+/// \brief Map the deflection of each of `count` sticks, scaling both axes to keep its direction.
+using MapStickLanes = auto(
+    std::size_t          count,
+    float*               x_values,
+    float*               y_values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void;
+
+/// \brief Convert each of `count` stick positions to its distance from the center and its
+///        angle counter-clockwise from +x, in [-pi, pi].
+using PolarLanes = auto(
+    std::size_t  count,
+    float const* x_values,
+    float const* y_values,
+    float*       magnitudes,
+    float*       angles
+) -> void;
+
+using EmaLanes = auto( std::size_t count, float* values, float* previous, float const* dt, float const* omega ) -> void;
+
+using OneEuroLanes = auto(
+    std::size_t  count,
+    float*       values,
+    float*       previous,
+    float*       derivative,
+    float const* dt,
+    float const* min_omega,
+    float const* beta,
+    float const* derivative_omega
+) -> void;
+
+using BiquadLanes = auto(
+    std::size_t  count,
+    float*       values,
+    float*       z1,
+    float*       z2,
+    float const* b0,
+    float const* b1,
+    float const* b2,
+    float const* a1,
+    float const* a2
+) -> void;
+
+/// \brief Write the index of every one of `count` values that differs between `previous` and
+///        `current` to `changed`, in order, and return how many there were.
+template < typename T >
+using ChangedLanes = auto( std::size_t count, T const* previous, T const* current, std::uint32_t* changed )
+    -> std::size_t;
+
+using ToFixedLanes   = auto( float const* axes, std::size_t count, std::int16_t* fixed ) -> void;
+using FromFixedLanes = auto( std::int16_t const* fixed, std::size_t count, float* axes ) -> void;
+
+/// \brief Convert `count` quantized axes (`axis_quantization_scale` steps) to floats.
+using DequantizeLanes = auto( std::uint32_t const* values, std::size_t count, float* axes ) -> void;
+
+/// \brief The hot numeric loops of the input pipeline, built once per `utils::SimdLevel`.
+///
+/// Every level computes exactly the same values as the scalar one, so the level can be
+/// switched (with `--simd`) to compare speed without changing any output. Each loop runs
+/// as many whole vectors as fit and finishes the remainder one lane at a time.
+struct NumericKernels
+{
+    utils::SimdLevel level = utils::SimdLevel::Scalar;
+
+    // Normalization (the mapping stage).
+    MapAxisLanes*  map_axis_lanes  = nullptr;
+    MapStickLanes* map_stick_lanes = nullptr;
+
+    // Stick analysis.
+    PolarLanes* polar_lanes = nullptr;
+
+    // Filtering.
+    EmaLanes*     ema_lanes      = nullptr;
+    OneEuroLanes* one_euro_lanes = nullptr;
+    BiquadLanes*  biquad_lanes   = nullptr;
+
+    // Diffing consecutive snapshots into events.
+    ChangedLanes< float >*         changed_axes    = nullptr;
+    ChangedLanes< unsigned char >* changed_buttons = nullptr;
+
+    // Encoding and decoding recorded axes.
+    ToFixedLanes*    to_fixed_axes   = nullptr;
+    FromFixedLanes*  from_fixed_axes = nullptr;
+    DequantizeLanes* dequantize_axes = nullptr;
+};
+
+/// \brief The kernels for `utils::simd_level( )`, chosen on the first call.
+auto numeric_kernels( ) -> NumericKernels const&;
+
+/// \brief The kernels built for `level`, which the CPU must support. For benchmarks.
+auto numeric_kernels( utils::SimdLevel level ) -> NumericKernels const&;
+
+} // namespace ltb::joy
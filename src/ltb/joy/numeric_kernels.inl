@@ -0,0 +1,536 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+
+// Included by numeric_kernels.cpp once per `utils::SimdLevel`, inside a namespace that
+// defines `Lanes` (that level's vector operations) and `level`, with `LTB_JOYSTICKS_KERNEL`
+// set to the attributes the level is compiled with. Lanes left over after the last whole
+// vector go through `Scalar`, which is defined here so it is compiled the same way.
+
+/// \brief One lane at a time, with the same rounding and NaN handling as the vector levels.
+struct Scalar
+{
+    using Float = float;
+    using Int   = std::int32_t;
+    using Mask  = bool;
+
+    static constexpr auto width      = std::size_t( 1 );
+    static constexpr auto byte_width = std::size_t( 1 );
+
+    LTB_JOYSTICKS_KERNEL static auto load( float const* values ) -> Float { return *values; }
+    LTB_JOYSTICKS_KERNEL static auto store( float* values, Float value ) -> void { *values = value; }
+    LTB_JOYSTICKS_KERNEL static auto broadcast( float value ) -> Float { return value; }
+
+    LTB_JOYSTICKS_KERNEL static auto add( Float a, Float b ) -> Float { return a + b; }
+    LTB_JOYSTICKS_KERNEL static auto sub( Float a, Float b ) -> Float { return a - b; }
+    LTB_JOYSTICKS_KERNEL static auto mul( Float a, Float b ) -> Float { return a * b; }
+    LTB_JOYSTICKS_KERNEL static auto div( Float a, Float b ) -> Float { return a / b; }
+
+    // Like `minps` and `maxps`, these return `b` when either value is NaN.
+    LTB_JOYSTICKS_KERNEL static auto min( Float a, Float b ) -> Float { return ( a < b ) ? a : b; }
+    LTB_JOYSTICKS_KERNEL static auto max( Float a, Float b ) -> Float { return ( a > b ) ? a : b; }
+
+    LTB_JOYSTICKS_KERNEL static auto sqrt( Float value ) -> Float { return std::sqrt( value ); }
+    LTB_JOYSTICKS_KERNEL static auto abs( Float value ) -> Float { return std::abs( value ); }
+    LTB_JOYSTICKS_KERNEL static auto copy_sign( Float magnitude, Float sign ) -> Float
+    {
+        return std::copysign( magnitude, sign );
+    }
+
+    LTB_JOYSTICKS_KERNEL static auto load_int( std::uint32_t const* values ) -> Int
+    {
+        return static_cast< Int >( *values );
+    }
+    LTB_JOYSTICKS_KERNEL static auto add_int( Int a, Int b ) -> Int { return a + b; }
+    LTB_JOYSTICKS_KERNEL static auto truncate( Float value ) -> Int { return static_cast< Int >( value ); }
+    LTB_JOYSTICKS_KERNEL static auto to_float( Int value ) -> Float { return static_cast< Float >( value ); }
+    LTB_JOYSTICKS_KERNEL static auto gather( float const* table, Int index ) -> Float { return table[ index ]; }
+
+    LTB_JOYSTICKS_KERNEL static auto greater( Float a, Float b ) -> Mask { return a > b; }
+    LTB_JOYSTICKS_KERNEL static auto keep( Float value, Mask mask ) -> Float { return mask ? value : 0.f; }
+    LTB_JOYSTICKS_KERNEL static auto select( Mask mask, Float if_true, Float if_false ) -> Float
+    {
+        return mask ? if_true : if_false;
+    }
+
+    /// \brief Bit `i` is set if lane `i` differs, NaNs included.
+    LTB_JOYSTICKS_KERNEL static auto changed( Float a, Float b ) -> std::uint64_t { return ( a != b ) ? 1U : 0U; }
+    LTB_JOYSTICKS_KERNEL static auto changed_bytes( unsigned char const* a, unsigned char const* b ) -> std::uint64_t
+    {
+        return ( *a != *b ) ? 1U : 0U;
+    }
+
+    /// \brief Round (to nearest, ties to even) and store values already within +-32767.
+    LTB_JOYSTICKS_KERNEL static auto store_fixed( std::int16_t* fixed, Float value ) -> void
+    {
+        *fixed = static_cast< std::int16_t >( std::nearbyint( value ) );
+    }
+    LTB_JOYSTICKS_KERNEL static auto load_fixed( std::int16_t const* fixed ) -> Float
+    {
+        return static_cast< Float >( *fixed );
+    }
+};
+
+// Normalization
+
+/// \brief Map the deflection `magnitude` (never negative) through deadzones and a curve.
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto map_magnitude(
+    typename L::Float magnitude,
+    typename L::Float deadzone,
+    typename L::Float inverse_range,
+    typename L::Float anti_deadzone,
+    typename L::Int   table_offset,
+    float const*      tables
+) -> typename L::Float
+{
+    auto const zero  = L::broadcast( 0.f );
+    auto const one   = L::broadcast( 1.f );
+    auto const input = L::min( L::max( L::mul( L::sub( magnitude, deadzone ), inverse_range ), zero ), one );
+
+    // Truncating is flooring because the position is never negative, and clamping first keeps
+    // an input of exactly 1 in the last segment.
+    auto const position = L::mul( input, L::broadcast( static_cast< float >( curve_table_segments ) ) );
+    auto const segment  = L::truncate( L::min( position, L::broadcast( float( curve_table_segments - 1UL ) ) ) );
+    auto const fraction = L::sub( position, L::to_float( segment ) );
+    auto const index    = L::add_int( segment, table_offset );
+
+    auto const low    = L::gather( tables, index );
+    auto const high   = L::gather( tables + 1, index );
+    auto const curve  = L::add( low, L::mul( fraction, L::sub( high, low ) ) );
+    auto const mapped = L::add( anti_deadzone, L::mul( L::sub( one, anti_deadzone ), curve ) );
+    return L::keep( mapped, L::greater( input, zero ) );
+}
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto map_axis(
+    std::size_t          i,
+    float*               values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void
+{
+    auto const value     = L::load( values + i );
+    auto const magnitude = map_magnitude< L >(
+        L::abs( value ),
+        L::load( deadzone + i ),
+        L::load( inverse_range + i ),
+        L::load( anti_deadzone + i ),
+        L::load_int( table_offset + i ),
+        tables
+    );
+    L::store( values + i, L::copy_sign( magnitude, value ) );
+}
+
+LTB_JOYSTICKS_KERNEL auto map_axis_lanes(
+    std::size_t          count,
+    float*               values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        map_axis< Lanes >( i, values, deadzone, inverse_range, anti_deadzone, table_offset, tables );
+    }
+    for ( ; i < count; ++i )
+    {
+        map_axis< Scalar >( i, values, deadzone, inverse_range, anti_deadzone, table_offset, tables );
+    }
+}
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto map_stick(
+    std::size_t          i,
+    float*               x_values,
+    float*               y_values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void
+{
+    // Scaling both axes by the same factor keeps the stick's direction.
+    constexpr auto min_distance = 1e-12f;
+
+    auto const x         = L::load( x_values + i );
+    auto const y         = L::load( y_values + i );
+    auto const distance  = L::sqrt( L::add( L::mul( x, x ), L::mul( y, y ) ) );
+    auto const magnitude = map_magnitude< L >(
+        distance,
+        L::load( deadzone + i ),
+        L::load( inverse_range + i ),
+        L::load( anti_deadzone + i ),
+        L::load_int( table_offset + i ),
+        tables
+    );
+    auto const scale = L::div( magnitude, L::max( distance, L::broadcast( min_distance ) ) );
+    L::store( x_values + i, L::mul( x, scale ) );
+    L::store( y_values + i, L::mul( y, scale ) );
+}
+
+LTB_JOYSTICKS_KERNEL auto map_stick_lanes(
+    std::size_t          count,
+    float*               x_values,
+    float*               y_values,
+    float const*         deadzone,
+    float const*         inverse_range,
+    float const*         anti_deadzone,
+    std::uint32_t const* table_offset,
+    float const*         tables
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        map_stick< Lanes >( i, x_values, y_values, deadzone, inverse_range, anti_deadzone, table_offset, tables );
+    }
+    for ( ; i < count; ++i )
+    {
+        map_stick< Scalar >( i, x_values, y_values, deadzone, inverse_range, anti_deadzone, table_offset, tables );
+    }
+}
+
+// Stick analysis
+
+/// \brief `atan2( y, x )` to within 2e-6 radians away from the center, from a minimax polynomial
+///        for `atan` on [0, 1].
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto angle_of( typename L::Float x, typename L::Float y ) -> typename L::Float
+{
+    constexpr auto pi           = 3.14159265f;
+    constexpr auto min_distance = 1e-12f;
+
+    // The smaller coordinate over the larger one is in [0, 1], and zero at the center.
+    auto const zero  = L::broadcast( 0.f );
+    auto const ax    = L::abs( x );
+    auto const ay    = L::abs( y );
+    auto const ratio = L::div( L::min( ax, ay ), L::max( L::max( ax, ay ), L::broadcast( min_distance ) ) );
+    auto const s     = L::mul( ratio, ratio );
+
+    auto poly = L::broadcast( -0.01172120f );
+    poly      = L::add( L::mul( poly, s ), L::broadcast( 0.05265332f ) );
+    poly      = L::add( L::mul( poly, s ), L::broadcast( -0.11643287f ) );
+    poly      = L::add( L::mul( poly, s ), L::broadcast( 0.19354346f ) );
+    poly      = L::add( L::mul( poly, s ), L::broadcast( -0.33262347f ) );
+    poly      = L::add( L::mul( poly, s ), L::broadcast( 0.99997726f ) );
+
+    // Unfold the first octant into the other seven.
+    auto angle = L::mul( poly, ratio );
+    angle      = L::select( L::greater( ay, ax ), L::sub( L::broadcast( 0.5f * pi ), angle ), angle );
+    angle      = L::select( L::greater( zero, x ), L::sub( L::broadcast( pi ), angle ), angle );
+    return L::copy_sign( angle, y );
+}
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto polar(
+    std::size_t  i,
+    float const* x_values,
+    float const* y_values,
+    float*       magnitudes,
+    float*       angles
+) -> void
+{
+    auto const x = L::load( x_values + i );
+    auto const y = L::load( y_values + i );
+    L::store( magnitudes + i, L::sqrt( L::add( L::mul( x, x ), L::mul( y, y ) ) ) );
+    L::store( angles + i, angle_of< L >( x, y ) );
+}
+
+LTB_JOYSTICKS_KERNEL auto polar_lanes(
+    std::size_t  count,
+    float const* x_values,
+    float const* y_values,
+    float*       magnitudes,
+    float*       angles
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        polar< Lanes >( i, x_values, y_values, magnitudes, angles );
+    }
+    for ( ; i < count; ++i )
+    {
+        polar< Scalar >( i, x_values, y_values, magnitudes, angles );
+    }
+}
+
+// Filtering
+
+/// \brief `previous + ( w / ( 1 + w ) ) * ( input - previous )`, one step of a first-order low-pass.
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto smooth( typename L::Float previous, typename L::Float input, typename L::Float w ) ->
+    typename L::Float
+{
+    auto const alpha = L::div( w, L::add( L::broadcast( 1.f ), w ) );
+    return L::add( previous, L::mul( alpha, L::sub( input, previous ) ) );
+}
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto ema(
+    std::size_t  i,
+    float*       values,
+    float*       previous,
+    float const* dt,
+    float const* omega
+) -> void
+{
+    auto const w     = L::mul( L::load( dt + i ), L::load( omega + i ) );
+    auto const value = smooth< L >( L::load( previous + i ), L::load( values + i ), w );
+    L::store( previous + i, value );
+    L::store( values + i, value );
+}
+
+LTB_JOYSTICKS_KERNEL auto ema_lanes(
+    std::size_t  count,
+    float*       values,
+    float*       previous,
+    float const* dt,
+    float const* omega
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        ema< Lanes >( i, values, previous, dt, omega );
+    }
+    for ( ; i < count; ++i )
+    {
+        ema< Scalar >( i, values, previous, dt, omega );
+    }
+}
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto one_euro(
+    std::size_t  i,
+    float*       values,
+    float*       previous,
+    float*       derivative,
+    float const* dt,
+    float const* min_omega,
+    float const* beta,
+    float const* derivative_omega
+) -> void
+{
+    // Smooth the speed first, then let it open up the cutoff of the value.
+    auto const input        = L::load( values + i );
+    auto const last         = L::load( previous + i );
+    auto const step         = L::load( dt + i );
+    auto const speed        = L::div( L::sub( input, last ), step );
+    auto const speed_w      = L::mul( step, L::load( derivative_omega + i ) );
+    auto const smooth_speed = smooth< L >( L::load( derivative + i ), speed, speed_w );
+    auto const speed_cutoff = L::mul( L::load( beta + i ), L::abs( smooth_speed ) );
+    auto const w            = L::mul( step, L::add( L::load( min_omega + i ), speed_cutoff ) );
+    auto const value        = smooth< L >( last, input, w );
+    L::store( derivative + i, smooth_speed );
+    L::store( previous + i, value );
+    L::store( values + i, value );
+}
+
+LTB_JOYSTICKS_KERNEL auto one_euro_lanes(
+    std::size_t  count,
+    float*       values,
+    float*       previous,
+    float*       derivative,
+    float const* dt,
+    float const* min_omega,
+    float const* beta,
+    float const* derivative_omega
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        one_euro< Lanes >( i, values, previous, derivative, dt, min_omega, beta, derivative_omega );
+    }
+    for ( ; i < count; ++i )
+    {
+        one_euro< Scalar >( i, values, previous, derivative, dt, min_omega, beta, derivative_omega );
+    }
+}
+
+/// \brief One step of a biquad in transposed direct form II.
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto biquad(
+    std::size_t  i,
+    float*       values,
+    float*       z1,
+    float*       z2,
+    float const* b0,
+    float const* b1,
+    float const* b2,
+    float const* a1,
+    float const* a2
+) -> void
+{
+    auto const input   = L::load( values + i );
+    auto const output  = L::add( L::mul( L::load( b0 + i ), input ), L::load( z1 + i ) );
+    auto const next_z1 = L::add(
+        L::sub( L::mul( L::load( b1 + i ), input ), L::mul( L::load( a1 + i ), output ) ),
+        L::load( z2 + i )
+    );
+    auto const next_z2 = L::sub( L::mul( L::load( b2 + i ), input ), L::mul( L::load( a2 + i ), output ) );
+    L::store( z1 + i, next_z1 );
+    L::store( z2 + i, next_z2 );
+    L::store( values + i, output );
+}
+
+LTB_JOYSTICKS_KERNEL auto biquad_lanes(
+    std::size_t  count,
+    float*       values,
+    float*       z1,
+    float*       z2,
+    float const* b0,
+    float const* b1,
+    float const* b2,
+    float const* a1,
+    float const* a2
+) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        biquad< Lanes >( i, values, z1, z2, b0, b1, b2, a1, a2 );
+    }
+    for ( ; i < count; ++i )
+    {
+        biquad< Scalar >( i, values, z1, z2, b0, b1, b2, a1, a2 );
+    }
+}
+
+// Diffing
+
+/// \brief Append `first + lane` for every set bit of `bits`, lowest first.
+LTB_JOYSTICKS_KERNEL inline auto append_lanes( std::uint64_t bits, std::size_t first, std::uint32_t* changed )
+    -> std::size_t
+{
+    auto count = 0UL;
+    for ( auto lane = first; bits != 0U; bits >>= 1U, ++lane )
+    {
+        if ( ( bits & 1U ) != 0U )
+        {
+            changed[ count++ ] = static_cast< std::uint32_t >( lane );
+        }
+    }
+    return count;
+}
+
+LTB_JOYSTICKS_KERNEL auto changed_axes(
+    std::size_t    count,
+    float const*   previous,
+    float const*   current,
+    std::uint32_t* changed
+) -> std::size_t
+{
+    auto found = 0UL;
+    auto i     = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        auto const bits = Lanes::changed( Lanes::load( previous + i ), Lanes::load( current + i ) );
+        found += append_lanes( bits, i, changed + found );
+    }
+    for ( ; i < count; ++i )
+    {
+        found += append_lanes( Scalar::changed( previous[ i ], current[ i ] ), i, changed + found );
+    }
+    return found;
+}
+
+LTB_JOYSTICKS_KERNEL auto changed_buttons(
+    std::size_t          count,
+    unsigned char const* previous,
+    unsigned char const* current,
+    std::uint32_t*       changed
+) -> std::size_t
+{
+    auto found = 0UL;
+    auto i     = 0UL;
+    for ( ; i + Lanes::byte_width <= count; i += Lanes::byte_width )
+    {
+        found += append_lanes( Lanes::changed_bytes( previous + i, current + i ), i, changed + found );
+    }
+    for ( ; i < count; ++i )
+    {
+        found += append_lanes( Scalar::changed_bytes( previous + i, current + i ), i, changed + found );
+    }
+    return found;
+}
+
+// Encoding
+
+template < typename L >
+LTB_JOYSTICKS_KERNEL inline auto to_fixed( std::size_t i, float const* axes, std::int16_t* fixed ) -> void
+{
+    // Clamping with `max` first turns NaNs into -1.
+    auto const clamped = L::min( L::max( L::load( axes + i ), L::broadcast( -1.f ) ), L::broadcast( 1.f ) );
+    L::store_fixed( fixed + i, L::mul( clamped, L::broadcast( axis_quantization_scale ) ) );
+}
+
+LTB_JOYSTICKS_KERNEL auto to_fixed_axes( float const* axes, std::size_t count, std::int16_t* fixed ) -> void
+{
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        to_fixed< Lanes >( i, axes, fixed );
+    }
+    for ( ; i < count; ++i )
+    {
+        to_fixed< Scalar >( i, axes, fixed );
+    }
+}
+
+LTB_JOYSTICKS_KERNEL auto from_fixed_axes( std::int16_t const* fixed, std::size_t count, float* axes ) -> void
+{
+    // A multiply rather than a divide, the same as `dequantize_axes`.
+    constexpr auto scale = 1.f / axis_quantization_scale;
+
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        Lanes::store( axes + i, Lanes::mul( Lanes::load_fixed( fixed + i ), Lanes::broadcast( scale ) ) );
+    }
+    for ( ; i < count; ++i )
+    {
+        Scalar::store( axes + i, Scalar::load_fixed( fixed + i ) * scale );
+    }
+}
+
+LTB_JOYSTICKS_KERNEL auto dequantize_axes( std::uint32_t const* values, std::size_t count, float* axes ) -> void
+{
+    constexpr auto scale = 1.f / axis_quantization_scale;
+
+    auto i = 0UL;
+    for ( ; i + Lanes::width <= count; i += Lanes::width )
+    {
+        auto const value = Lanes::to_float( Lanes::load_int( values + i ) );
+        Lanes::store( axes + i, Lanes::mul( value, Lanes::broadcast( scale ) ) );
+    }
+    for ( ; i < count; ++i )
+    {
+        Scalar::store( axes + i, Scalar::to_float( Scalar::load_int( values + i ) ) * scale );
+    }
+}
+
+constexpr auto kernels = NumericKernels{
+    level,
+    map_axis_lanes,
+    map_stick_lanes,
+    polar_lanes,
+    ema_lanes,
+    one_euro_lanes,
+    biquad_lanes,
+    changed_axes,
+    changed_buttons,
+    to_fixed_axes,
+    from_fixed_axes,
+    dequantize_axes,
+};
@@ -0,0 +1,247 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/recording_format.hpp"
+
+// project
+#include "ltb/joy/fixed_point.hpp"
+#include "ltb/utils/crc32c.hpp"
+
+// standard
+#include <algorithm>
+#include <cstring>
+
+namespace ltb::joy
+{
+namespace
+{
+
+auto write( std::vector< std::byte >& bytes, std::size_t& offset, void const* data, std::size_t size ) -> void
+{
+    if ( size > 0UL )
+    {
+        std::memcpy( bytes.data( ) + offset, data, size );
+        offset += size;
+    }
+}
+
+} // namespace
+
+auto begin_record(
+    RecordType                type,
+    int                       device_id,
+    std::int64_t              timestamp_us,
+    std::size_t               payload_size,
+    std::vector< std::byte >& bytes
+) -> std::size_t
+{
+    auto const unpadded_size = sizeof( RecordHeader ) + payload_size;
+    auto const size          = ( unpadded_size + record_alignment - 1UL ) / record_alignment * record_alignment;
+
+    auto header         = RecordHeader{ };
+    header.type         = type;
+    header.device_id    = static_cast< std::uint16_t >( device_id );
+    header.size         = static_cast< std::uint32_t >( size );
+    header.timestamp_us = timestamp_us;
+
+    auto const offset = bytes.size( );
+    bytes.resize( offset + size ); // zero-fills the padding
+    std::memcpy( bytes.data( ) + offset, &header, sizeof( header ) );
+
+    return offset + sizeof( RecordHeader );
+}
+
+auto RecordIndexBuilder::add( RecordHeader const& header, std::uint64_t offset ) -> void
+{
+    max_timestamp_us_ = std::max( max_timestamp_us_, header.timestamp_us );
+
+    // A group is only usable once every device in it has reached its timestamp.
+    auto const keyframe = header.type == RecordType::Keyframe;
+    if ( keyframe && !in_keyframe_ )
+    {
+        keyframes_.push_back( { header.timestamp_us, record_count_, offset } );
+    }
+    else if ( keyframe )
+    {
+        keyframes_.back( ).max_timestamp_us = std::max( keyframes_.back( ).max_timestamp_us, header.timestamp_us );
+    }
+    in_keyframe_ = keyframe;
+
+    if ( record_count_ % record_index_stride == 0UL )
+    {
+        entries_.push_back( { max_timestamp_us_, record_count_, offset } );
+    }
+    ++record_count_;
+}
+
+auto RecordIndexBuilder::footer( std::uint64_t records_end, std::vector< std::uint32_t > const& checksums ) const
+    -> RecordingFooter
+{
+    auto footer                  = RecordingFooter{ };
+    footer.keyframe_index_offset = records_end + sizeof( RecordIndexEntry ) * entries_.size( );
+    footer.keyframe_count        = keyframes_.size( );
+    if ( !checksums.empty( ) )
+    {
+        footer.checksum_offset     = footer.keyframe_index_offset + sizeof( RecordIndexEntry ) * keyframes_.size( );
+        footer.checksum_count      = static_cast< std::uint32_t >( checksums.size( ) );
+        footer.checksum_block_size = checksum_block_size;
+        footer.checksum_table_crc  = utils::crc32c( checksums.data( ), sizeof( std::uint32_t ) * checksums.size( ) );
+    }
+    footer.index_offset          = records_end;
+    footer.index_count           = entries_.size( );
+    footer.record_count          = record_count_;
+    footer.end_time_us           = ( record_count_ > 0UL ) ? max_timestamp_us_ : 0;
+    return footer;
+}
+
+auto RecordIndexBuilder::entries( ) const -> std::vector< RecordIndexEntry > const&
+{
+    return entries_;
+}
+
+auto RecordIndexBuilder::keyframes( ) const -> std::vector< RecordIndexEntry > const&
+{
+    return keyframes_;
+}
+
+auto ChecksumBuilder::add( void const* data, std::size_t size ) -> void
+{
+    auto const* bytes = static_cast< std::byte const* >( data );
+    while ( size > 0UL )
+    {
+        auto const count = std::min( static_cast< std::uint64_t >( size ), checksum_block_size - block_used_ );
+        crc_             = utils::crc32c( bytes, count, crc_ );
+        block_used_ += count;
+        bytes += count;
+        size -= count;
+
+        if ( block_used_ == checksum_block_size )
+        {
+            checksums_.push_back( crc_ );
+            crc_        = 0U;
+            block_used_ = 0UL;
+        }
+    }
+}
+
+auto ChecksumBuilder::finish( ) -> std::vector< std::uint32_t > const&
+{
+    if ( block_used_ > 0UL )
+    {
+        checksums_.push_back( crc_ );
+        crc_        = 0U;
+        block_used_ = 0UL;
+    }
+    return checksums_;
+}
+
+auto same_device( DeviceIdentity const& identity, Joystick const& joystick ) -> bool
+{
+    return identity.guid == joystick.guid && identity.name == joystick.name;
+}
+
+auto set_device_identity( Joystick const& joystick, DeviceIdentity& identity ) -> void
+{
+    identity.guid.assign( joystick.guid );
+    identity.name.assign( joystick.name );
+}
+
+auto append_device_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void
+{
+    auto payload      = DevicePayload{ };
+    payload.name_size = static_cast< std::uint16_t >( joystick.name.size( ) );
+    payload.guid_size = static_cast< std::uint16_t >( joystick.guid.size( ) );
+
+    auto offset = begin_record(
+        RecordType::Device,
+        joystick.device_id,
+        joystick.timestamp_us,
+        sizeof( payload ) + payload.name_size + payload.guid_size,
+        bytes
+    );
+    write( bytes, offset, &payload, sizeof( payload ) );
+    write( bytes, offset, joystick.name.data( ), payload.name_size );
+    write( bytes, offset, joystick.guid.data( ), payload.guid_size );
+}
+
+auto append_snapshot_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void
+{
+    auto payload         = SnapshotPayload{ };
+    payload.axis_count   = static_cast< std::uint16_t >( joystick.axes.size( ) );
+    payload.button_count = static_cast< std::uint16_t >( joystick.buttons.size( ) );
+
+    auto const axes_size = sizeof( float ) * payload.axis_count;
+
+    auto offset = begin_record(
+        RecordType::Snapshot,
+        joystick.device_id,
+        joystick.timestamp_us,
+        sizeof( payload ) + axes_size + payload.button_count,
+        bytes
+    );
+    write( bytes, offset, &payload, sizeof( payload ) );
+    write( bytes, offset, joystick.axes.data( ), axes_size );
+    write( bytes, offset, joystick.buttons.data( ), payload.button_count );
+}
+
+auto append_fixed_snapshot_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void
+{
+    auto payload         = SnapshotPayload{ };
+    payload.axis_count   = static_cast< std::uint16_t >( joystick.axes.size( ) );
+    payload.button_count = static_cast< std::uint16_t >( joystick.buttons.size( ) );
+
+    auto const axes_size = sizeof( std::int16_t ) * payload.axis_count;
+
+    auto offset = begin_record(
+        RecordType::FixedSnapshot,
+        joystick.device_id,
+        joystick.timestamp_us,
+        sizeof( payload ) + axes_size + payload.button_count,
+        bytes
+    );
+    write( bytes, offset, &payload, sizeof( payload ) );
+
+    // Converted in place: records are aligned and the payload is 4 bytes, so the axes are too.
+    auto* axes = reinterpret_cast< std::int16_t* >( bytes.data( ) + offset );
+    to_fixed_axes( joystick.axes.data( ), payload.axis_count, axes );
+    offset += axes_size;
+
+    write( bytes, offset, joystick.buttons.data( ), payload.button_count );
+}
+
+auto append_keyframe_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void
+{
+    auto payload         = KeyframePayload{ };
+    payload.axis_count   = static_cast< std::uint16_t >( joystick.axes.size( ) );
+    payload.button_count = static_cast< std::uint16_t >( joystick.buttons.size( ) );
+    payload.name_size    = static_cast< std::uint16_t >( joystick.name.size( ) );
+    payload.guid_size    = static_cast< std::uint16_t >( joystick.guid.size( ) );
+
+    auto const axes_size = sizeof( float ) * payload.axis_count;
+
+    auto offset = begin_record(
+        RecordType::Keyframe,
+        joystick.device_id,
+        joystick.timestamp_us,
+        sizeof( payload ) + axes_size + payload.button_count + payload.name_size + payload.guid_size,
+        bytes
+    );
+    write( bytes, offset, &payload, sizeof( payload ) );
+    write( bytes, offset, joystick.axes.data( ), axes_size );
+    write( bytes, offset, joystick.buttons.data( ), payload.button_count );
+    write( bytes, offset, joystick.name.data( ), payload.name_size );
+    write( bytes, offset, joystick.guid.data( ), payload.guid_size );
+}
+
+auto append_event_record( InputEvent const& event, std::vector< std::byte >& bytes ) -> void
+{
+    auto payload    = EventPayload{ };
+    payload.control = event.control;
+    payload.type    = event.type;
+    payload.value   = event.value;
+
+    auto offset = begin_record( RecordType::Event, event.device_id, event.timestamp_us, sizeof( payload ), bytes );
+    write( bytes, offset, &payload, sizeof( payload ) );
+}
+
+} // namespace ltb::joy
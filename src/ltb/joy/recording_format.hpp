@@ -0,0 +1,265 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/input_event.hpp"
+
+// standard
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Session files are a `RecordingFileHeader` followed by a stream of records and,
+///        once the recording is finalized, its indices, block checksums and a `RecordingFooter`.
+///
+/// Every record starts with a `RecordHeader` and is padded to `record_alignment` bytes so
+/// all fields can be read in place from a memory-mapped file. Values are stored in the
+/// native (little-endian on every supported platform) byte order.
+constexpr auto recording_magic          = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'O', 'Y', 'R', '\0' };
+constexpr auto recording_footer_magic   = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'E', 'N', 'D', '\0' };
+constexpr auto recording_format_version = std::uint32_t( 1 );
+constexpr auto record_alignment         = std::size_t( 8 );
+
+/// \brief Number of records between consecutive index entries.
+constexpr auto record_index_stride = std::uint64_t( 1024 );
+
+/// \brief Most snapshots stored in one `RecordType::SnapshotBlock`.
+constexpr auto snapshot_block_capacity = std::size_t( 128 );
+
+/// \brief Longest time one snapshot block may cover.
+///
+/// A block is written after its last snapshot, so it can follow records that are up to
+/// this much newer than its own timestamp. Readers that need time order look this far ahead.
+constexpr auto snapshot_block_max_span_us = std::int64_t( 2'000'000 );
+
+/// \brief Recorded time between keyframes, which bounds how much of a recording a seek replays.
+constexpr auto keyframe_interval_us = std::int64_t( 1'000'000 );
+
+/// \brief Finalized recordings store a CRC32C of every this many bytes, so corruption can be
+///        found (and pinned to a block) by checking the blocks in parallel.
+constexpr auto checksum_block_size = std::uint64_t( 1024UL * 1024UL );
+
+/// \brief Block-encoded axes are stored as `round( value * axis_quantization_scale )`,
+///        which is at least as fine as the 16-bit reports joysticks produce.
+constexpr auto axis_quantization_scale = 32767.f;
+
+/// \brief How snapshots are written to a recording.
+enum class SnapshotEncoding
+{
+    Raw,         ///< One `RecordType::Snapshot` per poll with the exact float values
+    DeltaBlocks, ///< Consecutive polls of a device packed into `RecordType::SnapshotBlock`s
+    Fixed16,     ///< One `RecordType::FixedSnapshot` per poll, half the size of `Raw`
+};
+
+struct RecordingFileHeader
+{
+    std::array< char, 8 > magic         = recording_magic;
+    std::uint32_t         version       = recording_format_version;
+    std::uint32_t         header_size   = sizeof( RecordingFileHeader );
+    std::int64_t          start_time_us = 0;
+};
+
+enum class RecordType : std::uint16_t
+{
+    Device        = 1, ///< `DevicePayload` followed by the name and GUID characters
+    Snapshot      = 2, ///< `SnapshotPayload` followed by the axis floats and button bytes
+    Event         = 3, ///< `EventPayload`
+    SnapshotBlock = 4, ///< `SnapshotBlockPayload` followed by the delta-encoded channels
+    Keyframe      = 5, ///< `KeyframePayload` followed by the axis floats, button bytes, name, and GUID
+    FixedSnapshot = 6, ///< `SnapshotPayload` followed by the fixed-point axes and button bytes
+};
+
+struct RecordHeader
+{
+    RecordType    type         = RecordType::Snapshot;
+    std::uint16_t device_id    = 0;
+    std::uint32_t size         = 0; ///< Bytes in the whole record, including this header and padding
+    std::int64_t  timestamp_us = 0;
+};
+
+struct DevicePayload
+{
+    std::uint16_t name_size = 0;
+    std::uint16_t guid_size = 0;
+};
+
+struct SnapshotPayload
+{
+    std::uint16_t axis_count   = 0;
+    std::uint16_t button_count = 0;
+};
+
+/// \brief Consecutive snapshots of one device, timestamped by the first.
+///
+/// The payload is followed by one "channel" per value: the timestamp offset from the first
+/// snapshot, each quantized axis, then each button. Timestamp and axis channels start with
+/// their first value and first difference, followed by the zigzag-encoded second
+/// differences of the rest (the error of predicting each value from the two before it).
+/// Button channels start with their first state, followed by each state XOR the previous.
+/// The residuals are bit-packed at the narrowest width that fits all of a channel's:
+///
+///     std::uint8_t widths[ channels ];    // Bits per packed residual
+///     varint       starts[ ... ];         // Zigzag LEB128, two per channel (one for buttons)
+///     packed       residuals[ channels ]; // sample_count - 2 each (sample_count - 1 for buttons)
+///
+/// Residuals are packed round-robin into four interleaved streams of 32-bit words (the
+/// SIMD-BP128 layout), so each channel takes a whole number of 16-byte groups.
+///
+/// Every block starts a new delta chain, so each one decodes on its own.
+struct SnapshotBlockPayload
+{
+    std::uint16_t sample_count      = 0;
+    std::uint16_t axis_count        = 0;
+    std::uint16_t button_count      = 0;
+    std::uint16_t reserved          = 0;
+    std::int64_t  last_timestamp_us = 0;
+};
+
+/// \brief The full state of one device, so replays can start from here instead of the
+///        beginning of the recording.
+///
+/// Keyframes are written in groups, one record per device, timestamped by the snapshot
+/// each one copies. A group follows every record it accounts for except snapshot blocks
+/// that were still open, which come later and hold some snapshots older than the group.
+struct KeyframePayload
+{
+    std::uint16_t axis_count   = 0;
+    std::uint16_t button_count = 0;
+    std::uint16_t name_size    = 0;
+    std::uint16_t guid_size    = 0;
+};
+
+struct EventPayload
+{
+    std::uint16_t  control  = 0;
+    InputEventType type     = InputEventType::Axis;
+    std::uint8_t   reserved = 0;
+    float          value    = 0.f;
+};
+
+/// \brief Points at every `record_index_stride`th record, or at a keyframe group.
+///
+/// Records are only roughly ordered by time (merged events trail the snapshots polled in
+/// the same frame), so entries store the largest timestamp seen up to and including their
+/// record. That keeps the index sorted and safe to binary search.
+struct RecordIndexEntry
+{
+    std::int64_t  max_timestamp_us = 0;
+    std::uint64_t sequence         = 0; ///< Zero-based position of the record in the file
+    std::uint64_t offset           = 0; ///< Byte offset of the record from the start of the file
+};
+
+/// \brief The last bytes of a finalized recording.
+///
+/// New fields are added to the front so `footer_size` and `magic` are always found at the
+/// very end of the file.
+struct RecordingFooter
+{
+    std::uint64_t         checksum_offset       = 0; ///< Right after the keyframe index, and the bytes covered
+    std::uint32_t         checksum_count        = 0;
+    std::uint32_t         checksum_table_crc    = 0; ///< CRC32C of the checksums themselves
+    std::uint64_t         checksum_block_size   = 0;
+    std::uint64_t         keyframe_index_offset = 0; ///< Right after the sparse index
+    std::uint64_t         keyframe_count        = 0;
+    std::uint64_t         index_offset          = 0; ///< Also where the records end
+    std::uint64_t         index_count           = 0;
+    std::uint64_t         record_count          = 0;
+    std::int64_t          end_time_us           = 0; ///< Largest record timestamp
+    std::uint64_t         footer_size           = sizeof( RecordingFooter );
+    std::array< char, 8 > magic                 = recording_footer_magic;
+};
+
+/// \brief Accumulates index entries as records are written or scanned, in file order.
+class RecordIndexBuilder
+{
+public:
+    auto add( RecordHeader const& header, std::uint64_t offset ) -> void;
+
+    /// \brief Index entries and totals for a file whose records end at `records_end`, with
+    ///        `checksums` (see `ChecksumBuilder`) of everything up to the end of the indices.
+    [[nodiscard]] auto footer( std::uint64_t records_end, std::vector< std::uint32_t > const& checksums ) const
+        -> RecordingFooter;
+
+    [[nodiscard]] auto entries( ) const -> std::vector< RecordIndexEntry > const&;
+
+    /// \brief One entry per keyframe group, stamped with the newest snapshot in the group.
+    [[nodiscard]] auto keyframes( ) const -> std::vector< RecordIndexEntry > const&;
+
+private:
+    std::vector< RecordIndexEntry > entries_          = { };
+    std::vector< RecordIndexEntry > keyframes_        = { };
+    std::uint64_t                   record_count_     = 0;
+    std::int64_t                    max_timestamp_us_ = std::numeric_limits< std::int64_t >::min( );
+    bool                            in_keyframe_      = false; ///< The last record added was part of a keyframe
+};
+
+static_assert( sizeof( RecordingFileHeader ) % record_alignment == 0 );
+static_assert( sizeof( RecordIndexEntry ) % record_alignment == 0 );
+static_assert( sizeof( RecordingFooter ) % record_alignment == 0 );
+static_assert( sizeof( RecordHeader ) == 16 );
+static_assert( sizeof( EventPayload ) == 8 );
+static_assert( sizeof( SnapshotBlockPayload ) == 16 );
+static_assert( sizeof( KeyframePayload ) == 8 );
+
+/// \brief Accumulates the CRC32C of each `checksum_block_size` bytes of a file as it is written.
+class ChecksumBuilder
+{
+public:
+    auto add( void const* data, std::size_t size ) -> void;
+
+    /// \brief Close the partially filled last block and return every checksum so far.
+    auto finish( ) -> std::vector< std::uint32_t > const&;
+
+private:
+    std::vector< std::uint32_t > checksums_  = { };
+    std::uint32_t                crc_        = 0U;
+    std::uint64_t                block_used_ = 0UL;
+};
+
+/// \brief Reserve space for a record of `payload_size` bytes, write its header, and
+///        return the offset of the (zeroed) payload.
+auto begin_record(
+    RecordType                type,
+    int                       device_id,
+    std::int64_t              timestamp_us,
+    std::size_t               payload_size,
+    std::vector< std::byte >& bytes
+) -> std::size_t;
+
+/// \brief Recorders write a new device record whenever this changes for a device ID.
+struct DeviceIdentity
+{
+    std::string guid = { };
+    std::string name = { };
+};
+
+/// \brief Compared in place, so recorders check every device every frame without allocating.
+auto same_device( DeviceIdentity const& identity, Joystick const& joystick ) -> bool;
+
+/// \brief Copy what identifies `joystick` into `identity`, reusing its storage.
+auto set_device_identity( Joystick const& joystick, DeviceIdentity& identity ) -> void;
+
+/// \brief Describes a device so readers can show its name and match it by GUID.
+auto append_device_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void;
+
+/// \brief The full axis and button state of one device.
+auto append_snapshot_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void;
+
+/// \brief The full axis and button state of one device, with the axes in fixed point.
+auto append_fixed_snapshot_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void;
+
+/// \brief The full state of one device, including its name and GUID.
+auto append_keyframe_record( Joystick const& joystick, std::vector< std::byte >& bytes ) -> void;
+
+/// \brief A single control change.
+auto append_event_record( InputEvent const& event, std::vector< std::byte >& bytes ) -> void;
+
+} // namespace ltb::joy
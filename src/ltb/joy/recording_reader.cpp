@@ -0,0 +1,542 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/recording_reader.hpp"
+
+// project
+#include "ltb/joy/fixed_point.hpp"
+
+// standard
+#include <algorithm>
+#include <cstring>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Records are read in place, which the format guarantees is suitably aligned.
+template < typename T >
+auto view_as( std::byte const* data ) -> T const*
+{
+    return reinterpret_cast< T const* >( data );
+}
+
+/// \brief True if `size` bytes hold the fixed part of a `type` payload and every array and
+///        string it declares, so its view only reads bytes that belong to the record.
+auto payload_fits( RecordType type, std::byte const* payload, std::size_t size ) -> bool
+{
+    switch ( type )
+    {
+        case RecordType::Device:
+        {
+            if ( size < sizeof( DevicePayload ) )
+            {
+                return false;
+            }
+            auto const* device = view_as< DevicePayload >( payload );
+            return sizeof( DevicePayload ) + device->name_size + device->guid_size <= size;
+        }
+        case RecordType::Snapshot:
+        case RecordType::FixedSnapshot:
+        {
+            if ( size < sizeof( SnapshotPayload ) )
+            {
+                return false;
+            }
+            auto const* snapshot  = view_as< SnapshotPayload >( payload );
+            auto const  axis_size = ( type == RecordType::Snapshot ) ? sizeof( float ) : sizeof( std::int16_t );
+            return sizeof( SnapshotPayload ) + snapshot->axis_count * axis_size + snapshot->button_count <= size;
+        }
+        case RecordType::Event:
+            return size >= sizeof( EventPayload );
+
+        case RecordType::SnapshotBlock:
+            return size >= sizeof( SnapshotBlockPayload ); // The channels are checked by `decode_snapshot_block`
+
+        case RecordType::Keyframe:
+        {
+            if ( size < sizeof( KeyframePayload ) )
+            {
+                return false;
+            }
+            auto const* keyframe = view_as< KeyframePayload >( payload );
+            return sizeof( KeyframePayload ) + keyframe->axis_count * sizeof( float ) + keyframe->button_count
+                     + keyframe->name_size + keyframe->guid_size
+                <= size;
+        }
+    }
+
+    // Nothing views a record of an unknown type, so only its size matters.
+    return true;
+}
+
+/// \brief True if a complete record starts at `position`, with a payload that fits in it.
+auto record_fits( std::byte const* position, std::byte const* end ) -> bool
+{
+    auto const remaining = static_cast< std::size_t >( end - position );
+    if ( remaining < sizeof( RecordHeader ) )
+    {
+        return false;
+    }
+
+    auto const& header = *view_as< RecordHeader >( position );
+    auto const  size   = std::size_t( header.size );
+    return size >= sizeof( RecordHeader ) && size % record_alignment == 0U && size <= remaining
+        && payload_fits( header.type, position + sizeof( RecordHeader ), size - sizeof( RecordHeader ) );
+}
+
+/// \brief True if every entry points at an aligned offset in `[records_begin, records_end)`
+///        and the entries are sorted by offset, sequence, and time, so seeking through them
+///        stays inside the records.
+auto entries_valid(
+    RecordIndexEntry const* entries,
+    std::uint64_t           count,
+    std::uint64_t           record_count,
+    std::uint64_t           records_begin,
+    std::uint64_t           records_end
+) -> bool
+{
+    for ( auto i = 0UL; i < count; ++i )
+    {
+        auto const& entry = entries[ i ];
+        if ( entry.offset % record_alignment != 0UL || entry.offset < records_begin || entry.offset >= records_end
+             || entry.sequence >= record_count )
+        {
+            return false;
+        }
+        if ( i > 0UL
+             && ( entry.offset <= entries[ i - 1UL ].offset || entry.sequence <= entries[ i - 1UL ].sequence
+                  || entry.max_timestamp_us < entries[ i - 1UL ].max_timestamp_us ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+RecordView::RecordView( std::byte const* data )
+    : data_( data )
+{
+}
+
+auto RecordView::header( ) const -> RecordHeader const&
+{
+    return *view_as< RecordHeader >( data_ );
+}
+
+auto RecordView::type( ) const -> RecordType
+{
+    return header( ).type;
+}
+
+auto RecordView::device_id( ) const -> int
+{
+    return header( ).device_id;
+}
+
+auto RecordView::timestamp_us( ) const -> std::int64_t
+{
+    return header( ).timestamp_us;
+}
+
+auto RecordView::data( ) const -> std::byte const*
+{
+    return data_;
+}
+
+auto RecordView::device( ) const -> DeviceView
+{
+    auto const* payload = view_as< DevicePayload >( this->payload( ) );
+    auto const* chars   = reinterpret_cast< char const* >( payload + 1 );
+
+    return { { chars, payload->name_size }, { chars + payload->name_size, payload->guid_size } };
+}
+
+auto SnapshotView::float_axes( std::vector< float >& scratch ) const -> float const*
+{
+    if ( axes != nullptr )
+    {
+        return axes;
+    }
+    scratch.resize( axis_count );
+    from_fixed_axes( fixed_axes, axis_count, scratch.data( ) );
+    return scratch.data( );
+}
+
+auto SnapshotView::copy_axes( std::vector< float >& output ) const -> void
+{
+    if ( axes != nullptr )
+    {
+        output.assign( axes, axes + axis_count );
+        return;
+    }
+    output.resize( axis_count );
+    from_fixed_axes( fixed_axes, axis_count, output.data( ) );
+}
+
+auto RecordView::snapshot( ) const -> SnapshotView
+{
+    auto const* payload = view_as< SnapshotPayload >( this->payload( ) );
+
+    auto view         = SnapshotView{ };
+    view.axis_count   = payload->axis_count;
+    view.button_count = payload->button_count;
+    if ( type( ) == RecordType::FixedSnapshot )
+    {
+        view.fixed_axes = reinterpret_cast< std::int16_t const* >( payload + 1 );
+        view.buttons    = reinterpret_cast< unsigned char const* >( view.fixed_axes + payload->axis_count );
+    }
+    else
+    {
+        view.axes    = reinterpret_cast< float const* >( payload + 1 );
+        view.buttons = reinterpret_cast< unsigned char const* >( view.axes + payload->axis_count );
+    }
+    return view;
+}
+
+auto RecordView::snapshot_block( ) const -> SnapshotBlockView
+{
+    auto const* payload = view_as< SnapshotBlockPayload >( this->payload( ) );
+    return { *payload, reinterpret_cast< std::byte const* >( payload + 1 ) };
+}
+
+auto RecordView::event( ) const -> InputEvent
+{
+    auto const* payload = view_as< EventPayload >( this->payload( ) );
+
+    auto event         = InputEvent{ };
+    event.timestamp_us = timestamp_us( );
+    event.device_id    = header( ).device_id;
+    event.control      = payload->control;
+    event.type         = payload->type;
+    event.value        = payload->value;
+    return event;
+}
+
+auto RecordView::keyframe( ) const -> KeyframeView
+{
+    auto const* payload = view_as< KeyframePayload >( this->payload( ) );
+    auto const* axes    = reinterpret_cast< float const* >( payload + 1 );
+    auto const* buttons = reinterpret_cast< unsigned char const* >( axes + payload->axis_count );
+    auto const* chars   = reinterpret_cast< char const* >( buttons + payload->button_count );
+
+    auto view                  = KeyframeView{ };
+    view.device.name           = { chars, payload->name_size };
+    view.device.guid           = { chars + payload->name_size, payload->guid_size };
+    view.snapshot.axis_count   = payload->axis_count;
+    view.snapshot.button_count = payload->button_count;
+    view.snapshot.axes         = axes;
+    view.snapshot.buttons      = buttons;
+    return view;
+}
+
+auto RecordView::payload( ) const -> std::byte const*
+{
+    return data_ + sizeof( RecordHeader );
+}
+
+RecordingReader::Iterator::Iterator( std::byte const* position, std::byte const* end )
+    : position_( position )
+    , end_( end )
+{
+    // Stop early at a corrupt record rather than handing out a view that reads past it.
+    if ( position_ != end_ && !record_fits( position_, end_ ) )
+    {
+        position_ = end_;
+    }
+}
+
+auto RecordingReader::Iterator::operator*( ) const -> RecordView
+{
+    return RecordView( position_ );
+}
+
+auto RecordingReader::Iterator::operator++( ) -> Iterator&
+{
+    *this = Iterator( position_ + view_as< RecordHeader >( position_ )->size, end_ );
+    return *this;
+}
+
+auto RecordingReader::Iterator::operator++( int ) -> Iterator
+{
+    auto copy = *this;
+    ++*this;
+    return copy;
+}
+
+auto RecordingReader::Iterator::operator==( Iterator const& other ) const -> bool
+{
+    return position_ == other.position_;
+}
+
+auto RecordingReader::Iterator::operator!=( Iterator const& other ) const -> bool
+{
+    return !( *this == other );
+}
+
+auto RecordingReader::Iterator::position( ) const -> std::byte const*
+{
+    return position_;
+}
+
+auto RecordingReader::open( std::filesystem::path const& path ) -> utils::Expected< RecordingReader >
+{
+    auto file = utils::MappedFile::open( path );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    if ( file->size( ) < sizeof( RecordingFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is too small to be a recording", path.string( ) );
+    }
+
+    auto const* header = view_as< RecordingFileHeader >( file->data( ) );
+    if ( header->magic != recording_magic )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is not a recording", path.string( ) );
+    }
+    if ( header->version != recording_format_version || header->header_size != sizeof( RecordingFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' has unsupported format version {}", path.string( ), header->version );
+    }
+
+    return RecordingReader( std::move( *file ) );
+}
+
+RecordingReader::RecordingReader( utils::MappedFile file )
+    : file_( std::move( file ) )
+{
+    auto const* data = file_.data( );
+    auto const  size = file_.size( );
+
+    records_begin_ = data + sizeof( RecordingFileHeader );
+    records_end_   = data + size;
+
+    // Trust the footer only if it is self-consistent.
+    if ( size >= sizeof( RecordingFileHeader ) + sizeof( RecordingFooter ) )
+    {
+        std::memcpy( &footer_, data + size - sizeof( RecordingFooter ), sizeof( RecordingFooter ) );
+
+        auto const index_end     = footer_.index_offset + footer_.index_count * sizeof( RecordIndexEntry );
+        auto const keyframes_end = index_end + footer_.keyframe_count * sizeof( RecordIndexEntry );
+        auto const checksums_end = keyframes_end + footer_.checksum_count * sizeof( std::uint32_t );
+
+        auto const checksums_valid
+            = footer_.checksum_count == 0U
+           || ( footer_.checksum_offset == keyframes_end && footer_.checksum_block_size > 0UL
+                && ( keyframes_end + footer_.checksum_block_size - 1UL ) / footer_.checksum_block_size
+                       == footer_.checksum_count );
+
+        finalized_ = footer_.magic == recording_footer_magic && footer_.footer_size == sizeof( RecordingFooter )
+                  && footer_.index_count <= size / sizeof( RecordIndexEntry )
+                  && footer_.keyframe_count <= size / sizeof( RecordIndexEntry )
+                  && footer_.index_offset >= sizeof( RecordingFileHeader ) && footer_.index_offset <= size
+                  && footer_.index_offset % record_alignment == 0UL
+                  && ( footer_.keyframe_count == 0UL || footer_.keyframe_index_offset == index_end )
+                  && checksums_valid && checksums_end + sizeof( RecordingFooter ) == size;
+    }
+
+    // The entries are only used if they point into the records in order. Seeking by
+    // sequence also starts from the first entry, which must be the first record.
+    if ( finalized_ )
+    {
+        auto const* entries          = view_as< RecordIndexEntry >( data + footer_.index_offset );
+        auto const* keyframe_entries = entries + footer_.index_count;
+        auto const  records_begin    = std::uint64_t( sizeof( RecordingFileHeader ) );
+        auto const  first_valid      = ( footer_.record_count == 0UL )
+                                         ? footer_.index_count == 0UL
+                                         : footer_.index_count > 0UL && entries->sequence == 0UL
+                                             && entries->offset == records_begin;
+
+        finalized_ = first_valid
+                  && entries_valid(
+                         entries,
+                         footer_.index_count,
+                         footer_.record_count,
+                         records_begin,
+                         footer_.index_offset
+                  )
+                  && entries_valid(
+                         keyframe_entries,
+                         footer_.keyframe_count,
+                         footer_.record_count,
+                         records_begin,
+                         footer_.index_offset
+                  );
+    }
+
+    if ( finalized_ )
+    {
+        records_end_    = data + footer_.index_offset;
+        file_index_     = view_as< RecordIndexEntry >( records_end_ );
+        file_keyframes_ = file_index_ + footer_.index_count;
+        file_checksums_ = view_as< std::uint32_t >( data + footer_.checksum_offset );
+    }
+    else
+    {
+        rebuild_index( );
+    }
+}
+
+auto RecordingReader::header( ) const -> RecordingFileHeader const&
+{
+    return *view_as< RecordingFileHeader >( file_.data( ) );
+}
+
+auto RecordingReader::record_count( ) const -> std::uint64_t
+{
+    return footer_.record_count;
+}
+
+auto RecordingReader::end_time_us( ) const -> std::int64_t
+{
+    return footer_.end_time_us;
+}
+
+auto RecordingReader::was_finalized( ) const -> bool
+{
+    return finalized_;
+}
+
+auto RecordingReader::begin( ) const -> Iterator
+{
+    return Iterator( records_begin_, records_end_ );
+}
+
+auto RecordingReader::end( ) const -> Iterator
+{
+    return Iterator( records_end_, records_end_ );
+}
+
+auto RecordingReader::seek_time( std::int64_t timestamp_us ) const -> Iterator
+{
+    auto const* first = index( );
+    auto const* last  = first + index_count( );
+
+    // Start from the last entry that is known to be entirely before the requested time.
+    auto const* entry = std::lower_bound( first, last, timestamp_us, []( auto const& e, auto time ) {
+        return e.max_timestamp_us < time;
+    } );
+    if ( entry != first )
+    {
+        --entry;
+    }
+
+    auto iterator = ( entry == last ) ? begin( ) : iterator_at( *entry );
+    while ( iterator != end( ) && ( *iterator ).timestamp_us( ) < timestamp_us )
+    {
+        ++iterator;
+    }
+    return iterator;
+}
+
+auto RecordingReader::seek_sequence( std::uint64_t sequence ) const -> Iterator
+{
+    if ( sequence >= record_count( ) )
+    {
+        return end( );
+    }
+
+    auto const* first = index( );
+    auto const* last  = first + index_count( );
+
+    auto const* entry = std::upper_bound( first, last, sequence, []( auto seq, auto const& e ) {
+        return seq < e.sequence;
+    } );
+    --entry; // The first entry is always sequence zero.
+
+    auto iterator = iterator_at( *entry );
+    for ( auto i = entry->sequence; i < sequence; ++i )
+    {
+        ++iterator;
+    }
+    return iterator;
+}
+
+auto RecordingReader::seek_keyframe( std::int64_t timestamp_us ) const -> Iterator
+{
+    auto const* first = keyframes( );
+    auto const* last  = first + keyframe_count( );
+
+    auto const* entry = std::upper_bound( first, last, timestamp_us, []( auto time, auto const& e ) {
+        return time < e.max_timestamp_us;
+    } );
+    return ( entry == first ) ? end( ) : iterator_at( *( entry - 1 ) );
+}
+
+auto RecordingReader::keyframe_count( ) const -> std::size_t
+{
+    return finalized_ ? static_cast< std::size_t >( footer_.keyframe_count ) : rebuilt_keyframes_.size( );
+}
+
+auto RecordingReader::offset_of( Iterator const& iterator ) const -> std::uint64_t
+{
+    return static_cast< std::uint64_t >( iterator.position( ) - file_.data( ) );
+}
+
+auto RecordingReader::checksums( ) const -> std::uint32_t const*
+{
+    return file_checksums_;
+}
+
+auto RecordingReader::checksum_count( ) const -> std::size_t
+{
+    return finalized_ ? static_cast< std::size_t >( footer_.checksum_count ) : 0UL;
+}
+
+auto RecordingReader::footer( ) const -> RecordingFooter const&
+{
+    return footer_;
+}
+
+auto RecordingReader::file( ) const -> utils::MappedFile const&
+{
+    return file_;
+}
+
+auto RecordingReader::rebuild_index( ) -> void
+{
+    auto builder = RecordIndexBuilder{ };
+
+    // Stop at the first incomplete record, which is where an interrupted recording ends, or
+    // at the first corrupt one.
+    auto const* position = records_begin_;
+    while ( record_fits( position, records_end_ ) )
+    {
+        auto const& header = *view_as< RecordHeader >( position );
+        builder.add( header, static_cast< std::uint64_t >( position - file_.data( ) ) );
+        position += header.size;
+    }
+
+    records_end_       = position;
+    footer_            = builder.footer( static_cast< std::uint64_t >( position - file_.data( ) ), { } );
+    rebuilt_index_     = builder.entries( );
+    rebuilt_keyframes_ = builder.keyframes( );
+}
+
+auto RecordingReader::index( ) const -> RecordIndexEntry const*
+{
+    return finalized_ ? file_index_ : rebuilt_index_.data( );
+}
+
+auto RecordingReader::index_count( ) const -> std::size_t
+{
+    return finalized_ ? static_cast< std::size_t >( footer_.index_count ) : rebuilt_index_.size( );
+}
+
+auto RecordingReader::keyframes( ) const -> RecordIndexEntry const*
+{
+    return finalized_ ? file_keyframes_ : rebuilt_keyframes_.data( );
+}
+
+auto RecordingReader::iterator_at( RecordIndexEntry const& entry ) const -> Iterator
+{
+    return Iterator( file_.data( ) + entry.offset, records_end_ );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,185 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// standard
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace ltb::joy
+{
+
+struct DeviceView
+{
+    std::string_view name = { };
+    std::string_view guid = { };
+};
+
+struct SnapshotView
+{
+    std::uint16_t        axis_count   = 0;
+    std::uint16_t        button_count = 0;
+    float const*         axes         = nullptr; ///< Null for `RecordType::FixedSnapshot`...
+    std::int16_t const*  fixed_axes   = nullptr; ///< ...which stores these instead
+    unsigned char const* buttons      = nullptr;
+
+    /// \brief The axes as floats, converted into `scratch` if they are stored in fixed point.
+    [[nodiscard]] auto float_axes( std::vector< float >& scratch ) const -> float const*;
+
+    /// \brief Replace the contents of `output` with the axes as floats.
+    auto copy_axes( std::vector< float >& output ) const -> void;
+};
+
+struct KeyframeView
+{
+    DeviceView   device   = { };
+    SnapshotView snapshot = { };
+};
+
+struct SnapshotBlockView
+{
+    SnapshotBlockPayload payload  = { };
+    std::byte const*     channels = nullptr; ///< The encoded channels following the payload
+};
+
+/// \brief A record read in place from a mapped recording. Valid while the reader is alive.
+class RecordView
+{
+public:
+    explicit RecordView( std::byte const* data );
+
+    [[nodiscard]] auto header( ) const -> RecordHeader const&;
+    [[nodiscard]] auto type( ) const -> RecordType;
+    [[nodiscard]] auto device_id( ) const -> int;
+    [[nodiscard]] auto timestamp_us( ) const -> std::int64_t;
+    [[nodiscard]] auto data( ) const -> std::byte const*;
+
+    /// \brief Only valid for `RecordType::Device`.
+    [[nodiscard]] auto device( ) const -> DeviceView;
+
+    /// \brief Only valid for `RecordType::Snapshot` and `RecordType::FixedSnapshot`.
+    [[nodiscard]] auto snapshot( ) const -> SnapshotView;
+
+    /// \brief Only valid for `RecordType::SnapshotBlock`. See `decode_snapshot_block`.
+    [[nodiscard]] auto snapshot_block( ) const -> SnapshotBlockView;
+
+    /// \brief Only valid for `RecordType::Event`.
+    [[nodiscard]] auto event( ) const -> InputEvent;
+
+    /// \brief Only valid for `RecordType::Keyframe`.
+    [[nodiscard]] auto keyframe( ) const -> KeyframeView;
+
+private:
+    std::byte const* data_;
+
+    [[nodiscard]] auto payload( ) const -> std::byte const*;
+};
+
+/// \brief Iterates a memory-mapped session file in place.
+///
+/// Nothing is copied or allocated per record. Finalized recordings carry a sparse index
+/// that lets `seek` jump to any time or sequence number with a binary search plus a scan
+/// of at most `record_index_stride` records, an index of their keyframes, and checksums
+/// of their contents. Recordings that were never finalized (the app crashed, say) are
+/// scanned once on open to rebuild the index.
+///
+/// Iteration ends early at a record that does not fit in the file, or whose payload
+/// declares more names, axes or buttons than the record holds, so every view handed out
+/// only reads its own record.
+class RecordingReader
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = RecordView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = RecordView;
+
+        Iterator( ) = default;
+        explicit Iterator( std::byte const* position, std::byte const* end );
+
+        auto operator*( ) const -> RecordView;
+        auto operator++( ) -> Iterator&;
+        auto operator++( int ) -> Iterator;
+        auto operator==( Iterator const& other ) const -> bool;
+        auto operator!=( Iterator const& other ) const -> bool;
+
+        [[nodiscard]] auto position( ) const -> std::byte const*;
+
+    private:
+        std::byte const* position_ = nullptr;
+        std::byte const* end_      = nullptr;
+    };
+
+    static auto open( std::filesystem::path const& path ) -> utils::Expected< RecordingReader >;
+
+    [[nodiscard]] auto header( ) const -> RecordingFileHeader const&;
+    [[nodiscard]] auto record_count( ) const -> std::uint64_t;
+    [[nodiscard]] auto end_time_us( ) const -> std::int64_t;
+
+    /// \brief True if the file had an index, false if it had to be rebuilt on open.
+    [[nodiscard]] auto was_finalized( ) const -> bool;
+
+    [[nodiscard]] auto begin( ) const -> Iterator;
+    [[nodiscard]] auto end( ) const -> Iterator;
+
+    /// \brief The first record at or after `timestamp_us`.
+    [[nodiscard]] auto seek_time( std::int64_t timestamp_us ) const -> Iterator;
+
+    /// \brief The record at zero-based position `sequence`.
+    [[nodiscard]] auto seek_sequence( std::uint64_t sequence ) const -> Iterator;
+
+    /// \brief The first record of the last keyframe group whose snapshots are all at or
+    ///        before `timestamp_us`, or `end` if there is none.
+    [[nodiscard]] auto seek_keyframe( std::int64_t timestamp_us ) const -> Iterator;
+
+    [[nodiscard]] auto keyframe_count( ) const -> std::size_t;
+
+    /// \brief Byte offset of `iterator` from the start of the file.
+    [[nodiscard]] auto offset_of( Iterator const& iterator ) const -> std::uint64_t;
+
+    /// \brief CRC32C of each block of `footer( ).checksum_block_size` bytes from the start
+    ///        of the file up to `footer( ).checksum_offset`. Only finalized recordings have
+    ///        them.
+    [[nodiscard]] auto checksums( ) const -> std::uint32_t const*;
+    [[nodiscard]] auto checksum_count( ) const -> std::size_t;
+
+    /// \brief The file's footer, or one describing the rebuilt index if it was not finalized.
+    [[nodiscard]] auto footer( ) const -> RecordingFooter const&;
+
+    [[nodiscard]] auto file( ) const -> utils::MappedFile const&;
+
+private:
+    utils::MappedFile               file_;
+    std::byte const*                records_begin_     = nullptr;
+    std::byte const*                records_end_       = nullptr;
+    RecordIndexEntry const*         file_index_        = nullptr; ///< Points into the mapping when finalized
+    RecordIndexEntry const*         file_keyframes_    = nullptr;
+    std::uint32_t const*            file_checksums_    = nullptr;
+    RecordingFooter                 footer_            = { };
+    bool                            finalized_         = false;
+    std::vector< RecordIndexEntry > rebuilt_index_     = { };
+    std::vector< RecordIndexEntry > rebuilt_keyframes_ = { };
+
+    explicit RecordingReader( utils::MappedFile file );
+
+    auto rebuild_index( ) -> void;
+
+    [[nodiscard]] auto index( ) const -> RecordIndexEntry const*;
+    [[nodiscard]] auto index_count( ) const -> std::size_t;
+    [[nodiscard]] auto keyframes( ) const -> RecordIndexEntry const*;
+
+    [[nodiscard]] auto iterator_at( RecordIndexEntry const& entry ) const -> Iterator;
+};
+
+} // namespace ltb::joy
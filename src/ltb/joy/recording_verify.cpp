@@ -0,0 +1,131 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/recording_verify.hpp"
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+#include "ltb/utils/crc32c.hpp"
+
+// external
+#include <spdlog/spdlog.h>
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock   = std::chrono::steady_clock;
+using Seconds = std::chrono::duration< double >;
+
+/// \brief Corrupt blocks listed in the error before the rest are only counted.
+constexpr auto max_reported_blocks = std::size_t( 8 );
+
+} // namespace
+
+auto verify_recording( std::filesystem::path const& path ) -> utils::Expected< void >
+{
+    auto const start = Clock::now( );
+
+    auto reader = RecordingReader::open( path );
+    if ( !reader )
+    {
+        return tl::make_unexpected( reader.error( ) );
+    }
+    if ( reader->checksum_count( ) == 0UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "'{}' has no checksums to verify (it was {})",
+            path.string( ),
+            reader->was_finalized( ) ? "finalized without them" : "never finalized"
+        );
+    }
+
+    auto const& footer     = reader->footer( );
+    auto const* data       = reader->file( ).data( );
+    auto const* checksums  = reader->checksums( );
+    auto const  count      = reader->checksum_count( );
+    auto const  block_size = footer.checksum_block_size;
+
+    if ( utils::crc32c( checksums, sizeof( std::uint32_t ) * count ) != footer.checksum_table_crc )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' has a corrupt checksum table", path.string( ) );
+    }
+
+    // Each block only writes its own flag, so no task waits on another.
+    auto corrupt = std::vector< unsigned char >( count, 0U );
+
+    auto verify_block = [ & ]( std::size_t block ) {
+        auto const begin = block * block_size;
+        auto const size  = std::min( block_size, footer.checksum_offset - begin );
+        corrupt[ block ] = ( utils::crc32c( data + begin, size ) != checksums[ block ] ) ? 1U : 0U;
+    };
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0UL, count, 1UL ), [ & ]( auto const& range ) {
+        for ( auto i = range.begin( ); i != range.end( ); ++i )
+        {
+            verify_block( i );
+        }
+    } );
+#else
+    for ( auto i = 0UL; i < count; ++i )
+    {
+        verify_block( i );
+    }
+#endif
+
+    auto const seconds = Seconds( Clock::now( ) - start ).count( );
+    auto const bytes   = static_cast< double >( footer.checksum_offset );
+
+    auto ranges        = std::string{ };
+    auto corrupt_count = std::size_t( 0 );
+    for ( auto i = 0UL; i < count; ++i )
+    {
+        if ( corrupt[ i ] == 0U )
+        {
+            continue;
+        }
+        if ( ++corrupt_count <= max_reported_blocks )
+        {
+            auto const begin = i * block_size;
+            ranges += fmt::format( " [{}, {})", begin, std::min( begin + block_size, footer.checksum_offset ) );
+        }
+    }
+
+    if ( corrupt_count > 0UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "'{}' has {} corrupt block(s) of {}:{}{}",
+            path.string( ),
+            corrupt_count,
+            count,
+            ranges,
+            ( corrupt_count > max_reported_blocks ) ? " ..." : ""
+        );
+    }
+
+    spdlog::info(
+        "Verified {} blocks ({:.1f} MiB) of '{}' in {:.1f} ms ({:.2f} GiB/s, {} CRC32C)",
+        count,
+        bytes / ( 1024.0 * 1024.0 ),
+        path.string( ),
+        seconds * 1e3,
+        bytes / ( 1024.0 * 1024.0 * 1024.0 ) / std::max( seconds, 1e-9 ),
+        utils::crc32c_is_hardware( ) ? "SSE4.2" : "software"
+    );
+    return { };
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,23 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <filesystem>
+
+namespace ltb::joy
+{
+
+/// \brief Check every block checksum of the recording at `path`, failing with the byte
+///        ranges of any corrupt blocks.
+///
+/// Blocks are checked in parallel (with TBB), so large recordings are limited by how fast
+/// they can be read rather than by checksumming. Recordings without checksums (those that
+/// were never finalized) fail, since nothing about them can be verified.
+auto verify_recording( std::filesystem::path const& path ) -> utils::Expected< void >;
+
+} // namespace ltb::joy
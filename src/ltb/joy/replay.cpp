@@ -0,0 +1,327 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/replay.hpp"
+
+// external
+#include <GLFW/glfw3.h>
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace ltb::joy
+{
+
+VirtualClock::VirtualClock( std::int64_t start_us )
+    : now_us_( start_us )
+{
+}
+
+auto VirtualClock::now_us( ) const -> std::int64_t
+{
+    return now_us_;
+}
+
+auto VirtualClock::advance_by( std::int64_t delta_us ) -> void
+{
+    now_us_ += delta_us;
+}
+
+auto VirtualClock::advance_to( std::int64_t time_us ) -> void
+{
+    now_us_ = std::max( now_us_, time_us );
+}
+
+auto ReplaySource::open( std::filesystem::path const& path, double speed, std::int64_t step_us )
+    -> utils::Expected< ReplaySource >
+{
+    auto reader = RecordingReader::open( path );
+    if ( !reader )
+    {
+        return tl::make_unexpected( reader.error( ) );
+    }
+    return ReplaySource( std::move( *reader ), speed, step_us );
+}
+
+ReplaySource::ReplaySource( RecordingReader reader, double speed, std::int64_t step_us )
+    : reader_( std::move( reader ) )
+    , position_( reader_.begin( ) )
+    , start_us_( ( position_ == reader_.end( ) ) ? 0 : ( *position_ ).timestamp_us( ) )
+    , clock_( start_us_ )
+    , speed_( speed )
+    , step_us_( step_us )
+{
+}
+
+auto ReplaySource::poll( ) -> std::vector< Joystick >
+{
+    events_.clear( );
+
+    if ( speed_ == as_fast_as_possible )
+    {
+        read_until( clock_.now_us( ) + snapshot_block_max_span_us );
+
+        // Jump to whichever comes first: something already queued or the next unread record.
+        auto next_us = std::numeric_limits< std::int64_t >::max( );
+        if ( !pending_.empty( ) )
+        {
+            next_us = pending_.top( ).timestamp_us;
+        }
+        if ( position_ != reader_.end( ) )
+        {
+            next_us = std::min( next_us, ( *position_ ).timestamp_us( ) );
+        }
+        if ( !finished( ) )
+        {
+            clock_.advance_to( next_us );
+        }
+    }
+    else
+    {
+        clock_.advance_by( std::llround( speed_ * static_cast< double >( step_us_ ) ) );
+    }
+
+    read_until( clock_.now_us( ) + snapshot_block_max_span_us );
+
+    while ( !pending_.empty( ) && pending_.top( ).timestamp_us <= clock_.now_us( ) )
+    {
+        auto const next = pending_.top( );
+        pending_.pop( );
+        apply( next );
+    }
+
+    auto joysticks = std::vector< Joystick >{ };
+    joysticks.reserve( devices_.size( ) );
+    for ( auto const& [ device_id, joystick ] : devices_ )
+    {
+        joysticks.emplace_back( joystick );
+    }
+    return joysticks;
+}
+
+auto ReplaySource::events( ) const -> std::vector< InputEvent > const&
+{
+    return events_;
+}
+
+auto ReplaySource::finished( ) const -> bool
+{
+    return position_ == reader_.end( ) && pending_.empty( );
+}
+
+auto ReplaySource::start_us( ) const -> std::int64_t
+{
+    return start_us_;
+}
+
+auto ReplaySource::clock( ) const -> VirtualClock const&
+{
+    return clock_;
+}
+
+auto ReplaySource::speed( ) const -> double
+{
+    return speed_;
+}
+
+auto ReplaySource::reader( ) const -> RecordingReader const&
+{
+    return reader_;
+}
+
+auto ReplaySource::corrupt_block_count( ) const -> std::uint64_t
+{
+    return corrupt_block_count_;
+}
+
+auto ReplaySource::set_step_us( std::int64_t step_us ) -> void
+{
+    step_us_ = step_us;
+}
+
+auto ReplaySource::seek( std::int64_t time_us ) -> void
+{
+    devices_.clear( );
+    events_.clear( );
+    seek_floors_us_.clear( );
+    pending_ = { };
+    free_blocks_.clear( );
+    for ( auto i = 0UL; i < blocks_.size( ); ++i )
+    {
+        free_blocks_.emplace_back( i );
+    }
+
+    time_us   = std::max( time_us, start_us_ );
+    clock_    = VirtualClock( time_us );
+    position_ = reader_.seek_keyframe( time_us );
+
+    if ( position_ == reader_.end( ) )
+    {
+        position_ = reader_.begin( );
+    }
+    for ( ; position_ != reader_.end( ) && ( *position_ ).type( ) == RecordType::Keyframe; ++position_ )
+    {
+        auto const record   = *position_;
+        auto const keyframe = record.keyframe( );
+        auto&      joystick = devices_[ record.device_id( ) ];
+
+        joystick.device_id    = record.device_id( );
+        joystick.name         = std::string( keyframe.device.name );
+        joystick.guid         = std::string( keyframe.device.guid );
+        joystick.timestamp_us = record.timestamp_us( );
+        joystick.axes.assign( keyframe.snapshot.axes, keyframe.snapshot.axes + keyframe.snapshot.axis_count );
+        joystick.buttons.assign(
+            keyframe.snapshot.buttons,
+            keyframe.snapshot.buttons + keyframe.snapshot.button_count
+        );
+        seek_floors_us_[ record.device_id( ) ] = record.timestamp_us( );
+    }
+
+    // Catch up from the keyframe, dropping the events on the way so only those after the
+    // new time are reported.
+    read_until( time_us + snapshot_block_max_span_us );
+    while ( !pending_.empty( ) && pending_.top( ).timestamp_us <= time_us )
+    {
+        auto const next = pending_.top( );
+        pending_.pop( );
+        apply( next );
+    }
+    events_.clear( );
+}
+
+auto ReplaySource::Pending::operator>( Pending const& other ) const -> bool
+{
+    return std::tie( timestamp_us, sequence, sample ) > std::tie( other.timestamp_us, other.sequence, other.sample );
+}
+
+auto ReplaySource::read_until( std::int64_t time_us ) -> void
+{
+    for ( ; position_ != reader_.end( ) && ( *position_ ).timestamp_us( ) <= time_us; ++position_ )
+    {
+        auto const record  = *position_;
+        auto       pending = Pending{ record.timestamp_us( ), sequence_++, record.data( ), 0UL, 0UL };
+
+        if ( record.type( ) == RecordType::SnapshotBlock )
+        {
+            if ( free_blocks_.empty( ) )
+            {
+                free_blocks_.emplace_back( blocks_.size( ) );
+                blocks_.emplace_back( );
+            }
+            pending.block = free_blocks_.back( );
+            free_blocks_.pop_back( );
+
+            // A block that does not decode is skipped like an empty one, and counted.
+            auto& block   = blocks_[ pending.block ];
+            auto  decoded = decode_snapshot_block( record, block );
+            if ( !decoded )
+            {
+                ++corrupt_block_count_;
+            }
+            if ( !decoded || block.sample_count == 0UL )
+            {
+                free_blocks_.emplace_back( pending.block );
+                continue;
+            }
+            pending.timestamp_us = block.timestamps_us.front( );
+        }
+
+        pending_.push( pending );
+    }
+}
+
+auto ReplaySource::apply( Pending const& pending ) -> void
+{
+    auto const record = RecordView( pending.record );
+    if ( record.type( ) != RecordType::SnapshotBlock )
+    {
+        apply( record );
+        return;
+    }
+
+    // Blocks are applied one snapshot at a time, queueing the next when this one is done.
+    auto const& block = blocks_[ pending.block ];
+    if ( !before_seek( block.device_id, pending.timestamp_us ) )
+    {
+        block.copy_sample( pending.sample, devices_[ block.device_id ] );
+    }
+
+    auto const next_sample = pending.sample + 1UL;
+    if ( next_sample < block.sample_count )
+    {
+        auto next         = pending;
+        next.timestamp_us = block.timestamps_us[ next_sample ];
+        next.sample       = next_sample;
+        pending_.push( next );
+    }
+    else
+    {
+        free_blocks_.emplace_back( pending.block );
+    }
+}
+
+auto ReplaySource::apply( RecordView const& record ) -> void
+{
+    if ( record.type( ) != RecordType::Device && before_seek( record.device_id( ), record.timestamp_us( ) ) )
+    {
+        return;
+    }
+
+    auto& joystick     = devices_[ record.device_id( ) ];
+    joystick.device_id = record.device_id( );
+
+    switch ( record.type( ) )
+    {
+        case RecordType::Device:
+        {
+            auto const device = record.device( );
+            joystick.name     = std::string( device.name );
+            joystick.guid     = std::string( device.guid );
+            break;
+        }
+        case RecordType::Snapshot:
+        case RecordType::FixedSnapshot:
+        {
+            auto const snapshot   = record.snapshot( );
+            joystick.timestamp_us = record.timestamp_us( );
+            snapshot.copy_axes( joystick.axes );
+            joystick.buttons.assign( snapshot.buttons, snapshot.buttons + snapshot.button_count );
+            break;
+        }
+        case RecordType::Event:
+        {
+            auto const event      = record.event( );
+            auto const control    = static_cast< std::size_t >( event.control );
+            joystick.timestamp_us = std::max( joystick.timestamp_us, event.timestamp_us );
+
+            if ( event.type == InputEventType::Axis )
+            {
+                joystick.axes.resize( std::max( joystick.axes.size( ), control + 1UL ) );
+                joystick.axes[ control ] = event.value;
+            }
+            else
+            {
+                joystick.buttons.resize( std::max( joystick.buttons.size( ), control + 1UL ) );
+                joystick.buttons[ control ] = ( event.value != 0.f ) ? GLFW_PRESS : GLFW_RELEASE;
+            }
+            events_.emplace_back( event );
+            break;
+        }
+        case RecordType::SnapshotBlock:
+            break; // Applied a snapshot at a time by the overload taking `Pending`
+
+        case RecordType::Keyframe:
+            break; // Repeats snapshots already applied, and is only needed by `seek`
+    }
+}
+
+auto ReplaySource::before_seek( int device_id, std::int64_t timestamp_us ) const -> bool
+{
+    auto const floor = seek_floors_us_.find( device_id );
+    return floor != seek_floors_us_.end( ) && timestamp_us <= floor->second;
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,127 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// standard
+#include <map>
+#include <queue>
+
+namespace ltb::joy
+{
+
+/// \brief Recorded time as seen by a replay. It only moves when the replay advances it,
+///        so identical replays produce identical results regardless of wall-clock timing.
+class VirtualClock
+{
+public:
+    explicit VirtualClock( std::int64_t start_us );
+
+    [[nodiscard]] auto now_us( ) const -> std::int64_t;
+
+    auto advance_by( std::int64_t delta_us ) -> void;
+    auto advance_to( std::int64_t time_us ) -> void;
+
+private:
+    std::int64_t now_us_;
+};
+
+/// \brief Plays a recorded session back as if the devices were being polled live.
+///
+/// Each `poll` advances the virtual clock by `speed` times the configured step, or, when
+/// the speed is `as_fast_as_possible`, straight to the next recorded timestamp. Every
+/// record up to the new time is applied and the resulting device states are returned in
+/// the same form as `poll_joystick_info`.
+///
+/// Snapshot blocks are written after the snapshots they hold, so records are read
+/// `snapshot_block_max_span_us` ahead of the clock and applied in timestamp order.
+///
+/// Snapshot blocks that do not decode are skipped, along with the snapshots they hold,
+/// and counted by `corrupt_block_count`.
+///
+/// `seek` restores the device states from the nearest keyframe at or before the target
+/// time and replays only the records after it, so it never decodes more than
+/// `keyframe_interval_us` of the recording.
+class ReplaySource
+{
+public:
+    static constexpr auto as_fast_as_possible = 0.0;
+
+    static auto open( std::filesystem::path const& path, double speed, std::int64_t step_us )
+        -> utils::Expected< ReplaySource >;
+
+    auto poll( ) -> std::vector< Joystick >;
+
+    /// \brief Recorded input events applied by the last `poll`, in timestamp order.
+    [[nodiscard]] auto events( ) const -> std::vector< InputEvent > const&;
+
+    [[nodiscard]] auto finished( ) const -> bool;
+    [[nodiscard]] auto start_us( ) const -> std::int64_t;
+    [[nodiscard]] auto clock( ) const -> VirtualClock const&;
+    [[nodiscard]] auto speed( ) const -> double;
+    [[nodiscard]] auto reader( ) const -> RecordingReader const&;
+
+    /// \brief Snapshot blocks skipped because they did not decode, counted again if a seek
+    ///        reads them again.
+    [[nodiscard]] auto corrupt_block_count( ) const -> std::uint64_t;
+
+    /// \brief Virtual time covered by each `poll` at 1x. Takes effect on the next `poll`.
+    auto set_step_us( std::int64_t step_us ) -> void;
+
+    /// \brief Move the clock to `time_us`, forwards or backwards, with every device in the
+    ///        state it was recorded in at that time.
+    ///
+    /// Devices only exist from the keyframe on, so one that disconnected before it is not
+    /// listed even though a replay that got here by polling would still show it. Recordings
+    /// without keyframes are replayed from the start instead.
+    auto seek( std::int64_t time_us ) -> void;
+
+private:
+    RecordingReader           reader_;
+    RecordingReader::Iterator position_;
+    std::int64_t              start_us_;
+    VirtualClock              clock_;
+    double                    speed_;
+    std::int64_t              step_us_;
+    std::map< int, Joystick > devices_ = { }; ///< Ordered by id so the output order is stable
+    std::vector< InputEvent > events_  = { };
+
+    /// \brief Time of each device's keyframe after a seek. Records at or before it are
+    ///        already part of the keyframe, but blocks holding them can follow it in the file.
+    std::map< int, std::int64_t > seek_floors_us_ = { };
+
+    /// \brief A record, or one snapshot of a decoded block, waiting for the clock to reach it.
+    struct Pending
+    {
+        std::int64_t     timestamp_us = 0;
+        std::uint64_t    sequence     = 0; ///< Position in the file, so ties apply in file order
+        std::byte const* record       = nullptr;
+        std::size_t      block        = 0; ///< Slot in `blocks_` if `record` is a snapshot block
+        std::size_t      sample       = 0;
+
+        auto operator>( Pending const& other ) const -> bool;
+    };
+
+    std::priority_queue< Pending, std::vector< Pending >, std::greater<> > pending_             = { };
+    std::uint64_t                                                          sequence_            = 0;
+    std::vector< SnapshotBlock >                                           blocks_              = { };
+    std::vector< std::size_t >                                             free_blocks_         = { };
+    std::uint64_t                                                          corrupt_block_count_ = 0;
+
+    explicit ReplaySource( RecordingReader reader, double speed, std::int64_t step_us );
+
+    /// \brief Queue every unread record with a timestamp up to `time_us`.
+    auto read_until( std::int64_t time_us ) -> void;
+
+    auto apply( Pending const& pending ) -> void;
+    auto apply( RecordView const& record ) -> void;
+
+    /// \brief Whether state of `device_id` from `timestamp_us` was restored by the last seek.
+    [[nodiscard]] auto before_seek( int device_id, std::int64_t timestamp_us ) const -> bool;
+};
+
+} // namespace ltb::joy
@@ -0,0 +1,672 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/session_catalog.hpp"
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// external
+#include <spdlog/spdlog.h>
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+// system
+#if defined( _WIN32 )
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// standard
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration< double, std::milli >;
+
+template < typename T >
+auto view_as( std::byte const* data ) -> T const*
+{
+    // Every table starts at a multiple of 8 bytes in a page-aligned mapping.
+    return reinterpret_cast< T const* >( data );
+}
+
+/// \brief One session's entries before they are laid out in a catalog file.
+struct ScannedDevice
+{
+    CatalogDevice            entry = { };
+    std::string              name  = { };
+    std::string              guid  = { };
+    std::vector< AxisRange > axes  = { };
+
+    /// \brief Widen the ranges by a snapshot whose axis `a` is `axes[ a * stride ]`.
+    auto add( float const* values, std::size_t count, std::size_t stride, std::size_t button_count ) -> void
+    {
+        if ( axes.size( ) < count )
+        {
+            axes.resize(
+                count,
+                { std::numeric_limits< float >::infinity( ), -std::numeric_limits< float >::infinity( ) }
+            );
+        }
+        for ( auto a = 0UL; a < count; ++a )
+        {
+            auto const value = values[ a * stride ];
+            axes[ a ].min    = std::min( axes[ a ].min, value );
+            axes[ a ].max    = std::max( axes[ a ].max, value );
+        }
+        entry.button_count = std::max( entry.button_count, static_cast< std::uint16_t >( button_count ) );
+        ++entry.snapshot_count;
+    }
+};
+
+struct ScannedSession
+{
+    CatalogSession               entry   = { };
+    std::string                  path    = { }; ///< Relative to the catalog's directory, with '/' separators
+    std::vector< ScannedDevice > devices = { };
+};
+
+/// \brief A file under the catalog's directory that may be a recording, or that was ignored
+///        because it is not one.
+struct Candidate
+{
+    std::filesystem::path path          = { };
+    std::string           relative_path = { };
+    std::uint64_t         file_size     = 0;
+    std::int64_t          modified_time = 0;
+};
+
+/// \brief Catalogs, pyramid sidecars and half-written files are never recordings.
+auto may_be_recording( std::filesystem::path const& path ) -> bool
+{
+    auto const extension = path.extension( );
+    return path.filename( ) != catalog_file_name && extension != ".pyramid" && extension != ".tmp";
+}
+
+auto scan_session( Candidate const& candidate ) -> utils::Expected< ScannedSession >
+{
+    auto reader = RecordingReader::open( candidate.path );
+    if ( !reader )
+    {
+        return tl::make_unexpected( reader.error( ) );
+    }
+
+    auto  session       = ScannedSession{ };
+    auto& entry         = session.entry;
+    session.path        = candidate.relative_path;
+    entry.file_size     = candidate.file_size;
+    entry.modified_time = candidate.modified_time;
+    entry.start_time_us = std::numeric_limits< std::int64_t >::max( );
+    entry.end_time_us   = std::numeric_limits< std::int64_t >::min( );
+
+    // The entry each device ID currently refers to.
+    auto current   = std::unordered_map< int, std::size_t >{ };
+    auto device_at = [ &session, &current ]( int device_id ) -> ScannedDevice& {
+        auto const [ iter, inserted ] = current.emplace( device_id, session.devices.size( ) );
+        if ( inserted )
+        {
+            session.devices.emplace_back( ).entry.device_id = device_id;
+        }
+        return session.devices[ iter->second ];
+    };
+    auto block   = SnapshotBlock{ };
+    auto scratch = std::vector< float >{ };
+
+    for ( auto const record : *reader )
+    {
+        ++entry.record_count;
+        entry.start_time_us = std::min( entry.start_time_us, record.timestamp_us( ) );
+        entry.end_time_us   = std::max( entry.end_time_us, record.timestamp_us( ) );
+
+        switch ( record.type( ) )
+        {
+            case RecordType::Device:
+            {
+                auto const view  = record.device( );
+                auto const known = current.find( record.device_id( ) );
+                auto const reused
+                    = known != current.end( ) && session.devices[ known->second ].entry.snapshot_count > 0UL
+                   && ( session.devices[ known->second ].name != view.name
+                        || session.devices[ known->second ].guid != view.guid );
+                if ( reused )
+                {
+                    current.erase( known );
+                }
+                auto& device = device_at( record.device_id( ) );
+                device.name  = std::string( view.name );
+                device.guid  = std::string( view.guid );
+                break;
+            }
+            case RecordType::Snapshot:
+            case RecordType::FixedSnapshot:
+            {
+                auto const  snapshot = record.snapshot( );
+                auto const* values   = snapshot.float_axes( scratch );
+                device_at( record.device_id( ) ).add( values, snapshot.axis_count, 1UL, snapshot.button_count );
+                ++entry.snapshot_count;
+                break;
+            }
+            case RecordType::SnapshotBlock:
+            {
+                if ( !decode_snapshot_block( record, block ) )
+                {
+                    break; // Corrupt, so its snapshots are left out
+                }
+                auto& device = device_at( record.device_id( ) );
+                for ( auto s = 0UL; s < block.sample_count; ++s )
+                {
+                    device.add( block.axes.data( ) + s, block.axis_count, block.sample_count, block.button_count );
+                }
+                entry.snapshot_count += block.sample_count;
+                break;
+            }
+            case RecordType::Event:
+                ++entry.event_count;
+                break;
+            case RecordType::Keyframe:
+                break; // Repeats snapshots recorded before it
+        }
+    }
+
+    if ( entry.record_count == 0UL )
+    {
+        entry.start_time_us = entry.end_time_us = 0;
+    }
+    return session;
+}
+
+/// \brief Copy an up-to-date session out of an existing catalog.
+auto copy_session( SessionCatalog const& catalog, std::size_t index ) -> ScannedSession
+{
+    auto const& entry = catalog.session( index );
+
+    auto session  = ScannedSession{ };
+    session.entry = entry;
+    session.path  = catalog.session_path( index ).lexically_relative( catalog.directory( ) ).generic_string( );
+
+    auto const* devices = catalog.devices( entry );
+    for ( auto d = 0UL; d < entry.device_count; ++d )
+    {
+        auto& device = session.devices.emplace_back( );
+        device.entry = devices[ d ];
+        device.name  = std::string( catalog.device_name( devices[ d ] ) );
+        device.guid  = std::string( catalog.device_guid( devices[ d ] ) );
+
+        auto const* axes = catalog.axis_ranges( devices[ d ] );
+        device.axes.assign( axes, axes + devices[ d ].axis_count );
+    }
+    return session;
+}
+
+/// \brief `<catalog>.<process>_<call>.tmp`, so updates in other processes or threads never
+///        write the same temporary file.
+auto temporary_catalog_path( std::filesystem::path const& directory ) -> std::filesystem::path
+{
+    static auto next = std::atomic< std::uint64_t >{ 0 };
+#if defined( _WIN32 )
+    auto const process = _getpid( );
+#else
+    auto const process = ::getpid( );
+#endif
+    auto path = catalog_path( directory );
+    path += fmt::format( ".{}_{}.tmp", process, next++ );
+    return path;
+}
+
+auto write_catalog(
+    std::filesystem::path const&         directory,
+    std::vector< ScannedSession > const& sessions,
+    std::vector< Candidate > const&      ignored_files
+) -> utils::Expected< void >
+{
+    auto header          = CatalogFileHeader{ };
+    header.session_count = sessions.size( );
+    header.ignored_count = ignored_files.size( );
+
+    auto entries = std::vector< CatalogSession >{ };
+    auto devices = std::vector< CatalogDevice >{ };
+    auto axes    = std::vector< AxisRange >{ };
+    auto ignored = std::vector< CatalogIgnored >{ };
+    auto strings = std::string{ };
+
+    for ( auto const& session : sessions )
+    {
+        auto& entry        = entries.emplace_back( session.entry );
+        entry.path_offset  = strings.size( );
+        entry.path_size    = static_cast< std::uint32_t >( session.path.size( ) );
+        entry.first_device = devices.size( );
+        entry.device_count = static_cast< std::uint32_t >( session.devices.size( ) );
+        strings += session.path;
+
+        for ( auto const& device : session.devices )
+        {
+            auto& device_entry          = devices.emplace_back( device.entry );
+            device_entry.name_size      = static_cast< std::uint16_t >( device.name.size( ) );
+            device_entry.guid_size      = static_cast< std::uint16_t >( device.guid.size( ) );
+            device_entry.strings_offset = strings.size( );
+            device_entry.first_axis     = axes.size( );
+            device_entry.axis_count     = static_cast< std::uint16_t >( device.axes.size( ) );
+            strings += device.name;
+            strings += device.guid;
+            axes.insert( axes.end( ), device.axes.begin( ), device.axes.end( ) );
+        }
+    }
+    for ( auto const& file : ignored_files )
+    {
+        auto& entry         = ignored.emplace_back( );
+        entry.path_offset   = strings.size( );
+        entry.path_size     = static_cast< std::uint32_t >( file.relative_path.size( ) );
+        entry.file_size     = file.file_size;
+        entry.modified_time = file.modified_time;
+        strings += file.relative_path;
+    }
+    header.device_count = devices.size( );
+    header.axis_count   = axes.size( );
+    header.strings_size = strings.size( );
+
+    auto const devices_offset = sizeof( header ) + sizeof( CatalogSession ) * entries.size( );
+    auto const axes_offset    = devices_offset + sizeof( CatalogDevice ) * devices.size( );
+    auto const ignored_offset = axes_offset + sizeof( AxisRange ) * axes.size( );
+    auto const strings_offset = ignored_offset + sizeof( CatalogIgnored ) * ignored.size( );
+
+    auto const output_path = catalog_path( directory );
+    auto const temp_path   = temporary_catalog_path( directory );
+
+    {
+        auto file = utils::WritableMappedFile::create( temp_path, strings_offset + strings.size( ) );
+        if ( !file )
+        {
+            return tl::make_unexpected( file.error( ) );
+        }
+        auto* output = file->data( );
+
+        std::memcpy( output, &header, sizeof( header ) );
+        std::memcpy( output + sizeof( header ), entries.data( ), sizeof( CatalogSession ) * entries.size( ) );
+        std::memcpy( output + devices_offset, devices.data( ), sizeof( CatalogDevice ) * devices.size( ) );
+        std::memcpy( output + axes_offset, axes.data( ), sizeof( AxisRange ) * axes.size( ) );
+        std::memcpy( output + ignored_offset, ignored.data( ), sizeof( CatalogIgnored ) * ignored.size( ) );
+        std::memcpy( output + strings_offset, strings.data( ), strings.size( ) );
+    }
+
+    auto error_code = std::error_code{ };
+    std::filesystem::rename( temp_path, output_path, error_code );
+    if ( error_code )
+    {
+        auto ignored_error = std::error_code{ };
+        std::filesystem::remove( temp_path, ignored_error );
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to replace '{}': {}", output_path.string( ), error_code.message( ) );
+    }
+    return { };
+}
+
+auto contains_ignoring_case( std::string_view text, std::string_view part ) -> bool
+{
+    auto const match = std::search( text.begin( ), text.end( ), part.begin( ), part.end( ), []( char a, char b ) {
+        return std::tolower( static_cast< unsigned char >( a ) ) == std::tolower( static_cast< unsigned char >( b ) );
+    } );
+    return match != text.end( ) || part.empty( );
+}
+
+} // namespace
+
+auto catalog_path( std::filesystem::path const& directory ) -> std::filesystem::path
+{
+    return directory / catalog_file_name;
+}
+
+auto SessionCatalog::open( std::filesystem::path const& directory ) -> utils::Expected< SessionCatalog >
+{
+    auto const path = catalog_path( directory );
+
+    auto file = utils::MappedFile::open( path );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    auto const* data = file->data( );
+    auto const  size = file->size( );
+
+    if ( size < sizeof( CatalogFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is too small to be a session catalog", path.string( ) );
+    }
+
+    auto const* header = view_as< CatalogFileHeader >( data );
+    if ( header->magic != catalog_magic || header->version != catalog_format_version
+         || header->header_size != sizeof( CatalogFileHeader ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is not a supported session catalog", path.string( ) );
+    }
+
+    // Everything the accessors read has to be inside the file. Checking each count first
+    // keeps the sizes below from overflowing.
+    auto valid = header->session_count <= size / sizeof( CatalogSession )
+              && header->device_count <= size / sizeof( CatalogDevice )
+              && header->axis_count <= size / sizeof( AxisRange )
+              && header->ignored_count <= size / sizeof( CatalogIgnored ) && header->strings_size <= size;
+    valid = valid
+         && sizeof( CatalogFileHeader ) + sizeof( CatalogSession ) * header->session_count
+                    + sizeof( CatalogDevice ) * header->device_count + sizeof( AxisRange ) * header->axis_count
+                    + sizeof( CatalogIgnored ) * header->ignored_count + header->strings_size
+                == size;
+
+    auto const* sessions = view_as< CatalogSession >( data + sizeof( CatalogFileHeader ) );
+    auto const* devices  = view_as< CatalogDevice >(
+        data + sizeof( CatalogFileHeader ) + sizeof( CatalogSession ) * ( valid ? header->session_count : 0UL )
+    );
+    for ( auto s = 0UL; valid && s < header->session_count; ++s )
+    {
+        auto const& session = sessions[ s ];
+        valid               = session.path_offset + session.path_size <= header->strings_size
+             && session.first_device + session.device_count <= header->device_count;
+    }
+    for ( auto d = 0UL; valid && d < header->device_count; ++d )
+    {
+        auto const& device = devices[ d ];
+        valid              = device.strings_offset + device.name_size + device.guid_size <= header->strings_size
+             && device.first_axis + device.axis_count <= header->axis_count;
+    }
+    auto const* ignored = view_as< CatalogIgnored >(
+        reinterpret_cast< std::byte const* >( devices + ( valid ? header->device_count : 0UL ) )
+        + sizeof( AxisRange ) * ( valid ? header->axis_count : 0UL )
+    );
+    for ( auto i = 0UL; valid && i < header->ignored_count; ++i )
+    {
+        valid = ignored[ i ].path_offset + ignored[ i ].path_size <= header->strings_size;
+    }
+    if ( !valid )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "'{}' is corrupt", path.string( ) );
+    }
+
+    return SessionCatalog( directory, std::move( *file ) );
+}
+
+auto SessionCatalog::update( std::filesystem::path const& directory, std::filesystem::path const& skip )
+    -> utils::Expected< SessionCatalog >
+{
+    auto const start = Clock::now( );
+
+    // A missing or unreadable catalog just means every recording is scanned.
+    auto const previous = open( directory );
+    auto       known    = std::unordered_map< std::string, std::size_t >{ };
+    auto       ignoring = std::unordered_map< std::string, std::size_t >{ };
+    if ( previous )
+    {
+        for ( auto i = 0UL; i < previous->session_count( ); ++i )
+        {
+            auto const& session = previous->session( i );
+            known.emplace( previous->string( session.path_offset, session.path_size ), i );
+        }
+        for ( auto i = 0UL; i < previous->ignored_count( ); ++i )
+        {
+            auto const& file = previous->ignored( i );
+            ignoring.emplace( previous->string( file.path_offset, file.path_size ), i );
+        }
+    }
+
+    auto sessions   = std::vector< ScannedSession >{ };
+    auto ignored    = std::vector< Candidate >{ };
+    auto candidates = std::vector< Candidate >{ };
+    auto error_code = std::error_code{ };
+
+    auto iter = std::filesystem::recursive_directory_iterator(
+        directory,
+        std::filesystem::directory_options::skip_permission_denied,
+        error_code
+    );
+    for ( ; !error_code && iter != std::filesystem::recursive_directory_iterator( ); iter.increment( error_code ) )
+    {
+        auto const& entry = *iter;
+        if ( !entry.is_regular_file( error_code ) || !may_be_recording( entry.path( ) ) )
+        {
+            continue;
+        }
+        if ( !skip.empty( ) && entry.path( ).lexically_normal( ) == skip.lexically_normal( ) )
+        {
+            continue;
+        }
+
+        auto candidate          = Candidate{ entry.path( ) };
+        candidate.relative_path = entry.path( ).lexically_relative( directory ).generic_string( );
+        candidate.file_size     = entry.file_size( error_code );
+        candidate.modified_time = entry.last_write_time( error_code ).time_since_epoch( ).count( );
+        if ( error_code )
+        {
+            continue; // Removed since it was listed
+        }
+
+        auto const existing = known.find( candidate.relative_path );
+        auto const skipped  = ignoring.find( candidate.relative_path );
+        if ( existing != known.end( ) && previous->session( existing->second ).file_size == candidate.file_size
+             && previous->session( existing->second ).modified_time == candidate.modified_time )
+        {
+            sessions.emplace_back( copy_session( *previous, existing->second ) );
+        }
+        else if ( skipped != ignoring.end( ) && previous->ignored( skipped->second ).file_size == candidate.file_size
+                  && previous->ignored( skipped->second ).modified_time == candidate.modified_time )
+        {
+            ignored.emplace_back( std::move( candidate ) );
+        }
+        else
+        {
+            candidates.emplace_back( std::move( candidate ) );
+        }
+    }
+    if ( error_code )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to list '{}': {}", directory.string( ), error_code.message( ) );
+    }
+
+    // Each candidate only writes its own slot, so no task waits on another.
+    auto scanned = std::vector< std::optional< ScannedSession > >( candidates.size( ) );
+    auto scan    = [ &candidates, &scanned ]( std::size_t i ) {
+        if ( auto session = scan_session( candidates[ i ] ) )
+        {
+            scanned[ i ] = std::move( *session );
+        }
+    };
+
+#if defined( LTB_JOYSTICKS_USE_TBB )
+    tbb::parallel_for( tbb::blocked_range< std::size_t >( 0UL, candidates.size( ), 1UL ), [ & ]( auto const& range ) {
+        for ( auto i = range.begin( ); i != range.end( ); ++i )
+        {
+            scan( i );
+        }
+    } );
+#else
+    for ( auto i = 0UL; i < candidates.size( ); ++i )
+    {
+        scan( i );
+    }
+#endif
+
+    auto const unchanged_count = sessions.size( ) + ignored.size( );
+    for ( auto i = 0UL; i < candidates.size( ); ++i )
+    {
+        if ( scanned[ i ] )
+        {
+            sessions.emplace_back( std::move( *scanned[ i ] ) );
+        }
+        else
+        {
+            ignored.emplace_back( std::move( candidates[ i ] ) );
+        }
+    }
+    std::sort( sessions.begin( ), sessions.end( ), []( auto const& a, auto const& b ) { return a.path < b.path; } );
+    std::sort( ignored.begin( ), ignored.end( ), []( auto const& a, auto const& b ) {
+        return a.relative_path < b.relative_path;
+    } );
+
+    auto written = write_catalog( directory, sessions, ignored );
+    if ( !written )
+    {
+        return tl::make_unexpected( written.error( ) );
+    }
+
+    spdlog::info(
+        "Cataloged {} sessions under '{}' in {:.1f} ms ({} scanned, {} unchanged, {} ignored)",
+        sessions.size( ),
+        directory.string( ),
+        Milliseconds( Clock::now( ) - start ).count( ),
+        candidates.size( ),
+        unchanged_count,
+        ignored.size( )
+    );
+    return open( directory );
+}
+
+auto SessionCatalog::directory( ) const -> std::filesystem::path const&
+{
+    return directory_;
+}
+
+auto SessionCatalog::session_count( ) const -> std::size_t
+{
+    return static_cast< std::size_t >( header( ).session_count );
+}
+
+auto SessionCatalog::session( std::size_t index ) const -> CatalogSession const&
+{
+    return sessions_[ index ];
+}
+
+auto SessionCatalog::session_path( std::size_t index ) const -> std::filesystem::path
+{
+    auto const& session = sessions_[ index ];
+    return directory_ / std::filesystem::path( string( session.path_offset, session.path_size ) );
+}
+
+auto SessionCatalog::devices( CatalogSession const& session ) const -> CatalogDevice const*
+{
+    return devices_ + session.first_device;
+}
+
+auto SessionCatalog::device_name( CatalogDevice const& device ) const -> std::string_view
+{
+    return string( device.strings_offset, device.name_size );
+}
+
+auto SessionCatalog::device_guid( CatalogDevice const& device ) const -> std::string_view
+{
+    return string( device.strings_offset + device.name_size, device.guid_size );
+}
+
+auto SessionCatalog::axis_ranges( CatalogDevice const& device ) const -> AxisRange const*
+{
+    return axes_ + device.first_axis;
+}
+
+auto SessionCatalog::ignored_count( ) const -> std::size_t
+{
+    return static_cast< std::size_t >( header( ).ignored_count );
+}
+
+auto SessionCatalog::ignored( std::size_t index ) const -> CatalogIgnored const&
+{
+    return ignored_[ index ];
+}
+
+auto SessionCatalog::find( CatalogQuery const& query ) const -> std::vector< std::size_t >
+{
+    auto matches = std::vector< std::size_t >{ };
+
+    for ( auto i = 0UL; i < session_count( ); ++i )
+    {
+        auto const& session = sessions_[ i ];
+        if ( session.end_time_us - session.start_time_us < query.min_duration_us )
+        {
+            continue;
+        }
+
+        auto const* devices = this->devices( session );
+        auto const* last    = devices + session.device_count;
+        auto const  has_device
+            = query.device.empty( ) || std::any_of( devices, last, [ this, &query ]( auto const& device ) {
+                  return contains_ignoring_case( device_name( device ), query.device )
+                      || contains_ignoring_case( device_guid( device ), query.device );
+              } );
+        if ( has_device )
+        {
+            matches.push_back( i );
+        }
+    }
+    return matches;
+}
+
+SessionCatalog::SessionCatalog( std::filesystem::path directory, utils::MappedFile file )
+    : directory_( std::move( directory ) )
+    , file_( std::move( file ) )
+{
+    auto const& header = this->header( );
+    sessions_          = view_as< CatalogSession >( file_.data( ) + sizeof( CatalogFileHeader ) );
+    devices_           = reinterpret_cast< CatalogDevice const* >( sessions_ + header.session_count );
+    axes_              = reinterpret_cast< AxisRange const* >( devices_ + header.device_count );
+    ignored_           = reinterpret_cast< CatalogIgnored const* >( axes_ + header.axis_count );
+    strings_           = reinterpret_cast< char const* >( ignored_ + header.ignored_count );
+}
+
+auto SessionCatalog::header( ) const -> CatalogFileHeader const&
+{
+    return *view_as< CatalogFileHeader >( file_.data( ) );
+}
+
+auto SessionCatalog::string( std::uint64_t offset, std::size_t size ) const -> std::string_view
+{
+    return { strings_ + offset, size };
+}
+
+auto query_catalog( std::filesystem::path const& directory, CatalogQuery const& query ) -> utils::Expected< void >
+{
+    auto catalog = SessionCatalog::update( directory );
+    if ( !catalog )
+    {
+        return tl::make_unexpected( catalog.error( ) );
+    }
+
+    auto const start   = Clock::now( );
+    auto const matches = catalog->find( query );
+    auto const find_ms = Milliseconds( Clock::now( ) - start ).count( );
+
+    for ( auto const index : matches )
+    {
+        auto const& session = catalog->session( index );
+        auto const* devices = catalog->devices( session );
+
+        auto names = std::string{ };
+        for ( auto d = 0UL; d < session.device_count; ++d )
+        {
+            names += fmt::format( "{}{}", ( d > 0UL ) ? ", " : "", catalog->device_name( devices[ d ] ) );
+        }
+        spdlog::info(
+            "{} | {:.1f} s | {} snapshots, {} events | {}",
+            catalog->session_path( index ).string( ),
+            static_cast< double >( session.end_time_us - session.start_time_us ) * 1e-6,
+            session.snapshot_count,
+            session.event_count,
+            names
+        );
+    }
+    spdlog::info( "{} of {} sessions matched in {:.3f} ms", matches.size( ), catalog->session_count( ), find_ms );
+    return { };
+}
+
+} // namespace ltb::joy
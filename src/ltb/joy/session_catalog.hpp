@@ -0,0 +1,166 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// standard
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Catalog files summarize every recording under a directory so sessions can be
+///        found without opening them. All tables are fixed-size and searched in place:
+///
+///     CatalogFileHeader
+///     CatalogSession[ session_count ] // Sorted by path
+///     CatalogDevice[ device_count ]   // Grouped by session
+///     AxisRange[ axis_count ]         // Grouped by device
+///     CatalogIgnored[ ignored_count ] // Sorted by path
+///     char strings[ strings_size ]    // Paths, names and GUIDs, referenced by offset
+///
+/// Integers are in the native byte order of the recordings they summarize, see `recording_magic`.
+constexpr auto catalog_magic          = std::array< char, 8 >{ 'L', 'T', 'B', 'J', 'C', 'A', 'T', '\0' };
+constexpr auto catalog_format_version = std::uint32_t( 1 );
+constexpr auto catalog_file_name      = std::string_view( "sessions.ltbcat" );
+
+struct CatalogFileHeader
+{
+    std::array< char, 8 > magic         = catalog_magic;
+    std::uint32_t         version       = catalog_format_version;
+    std::uint32_t         header_size   = sizeof( CatalogFileHeader );
+    std::uint64_t         session_count = 0;
+    std::uint64_t         device_count  = 0;
+    std::uint64_t         axis_count    = 0;
+    std::uint64_t         ignored_count = 0;
+    std::uint64_t         strings_size  = 0;
+};
+
+struct CatalogSession
+{
+    std::uint64_t path_offset    = 0; ///< Relative to the catalog's directory
+    std::uint32_t path_size      = 0;
+    std::uint32_t device_count   = 0;
+    std::uint64_t first_device   = 0;
+    std::uint64_t file_size      = 0; ///< With `modified_time`, tells when the entry is stale
+    std::int64_t  modified_time  = 0; ///< `std::filesystem::file_time_type` ticks
+    std::int64_t  start_time_us  = 0; ///< Earliest record
+    std::int64_t  end_time_us    = 0; ///< Latest record
+    std::uint64_t record_count   = 0;
+    std::uint64_t snapshot_count = 0; ///< Including every snapshot in a block
+    std::uint64_t event_count    = 0;
+};
+
+/// \brief A device described in a session. A device ID reused by a different device gets
+///        a new entry.
+struct CatalogDevice
+{
+    std::int32_t  device_id      = 0;
+    std::uint16_t name_size      = 0;
+    std::uint16_t guid_size      = 0;
+    std::uint64_t strings_offset = 0; ///< The name followed immediately by the GUID
+    std::uint64_t first_axis     = 0;
+    std::uint16_t axis_count     = 0;
+    std::uint16_t button_count   = 0;
+    std::uint32_t reserved       = 0;
+    std::uint64_t snapshot_count = 0;
+};
+
+/// \brief A file under the directory that failed to open as a recording. It is not opened
+///        again until its size or modification time changes.
+struct CatalogIgnored
+{
+    std::uint64_t path_offset   = 0; ///< Relative to the catalog's directory
+    std::uint32_t path_size     = 0;
+    std::uint32_t reserved      = 0;
+    std::uint64_t file_size     = 0;
+    std::int64_t  modified_time = 0; ///< `std::filesystem::file_time_type` ticks
+};
+
+/// \brief Every value an axis took in a session. `min > max` if it was never polled.
+struct AxisRange
+{
+    float min = 0.f;
+    float max = 0.f;
+};
+
+static_assert( sizeof( CatalogFileHeader ) == 56 );
+static_assert( sizeof( CatalogSession ) == 80 );
+static_assert( sizeof( CatalogDevice ) == 40 );
+static_assert( sizeof( CatalogIgnored ) == 32 );
+static_assert( sizeof( AxisRange ) == 8 );
+
+struct CatalogQuery
+{
+    std::string  device          = { }; ///< Part of a device name or GUID. Empty matches every session
+    std::int64_t min_duration_us = 0;
+};
+
+/// \brief `<directory>/sessions.ltbcat`, the catalog of the recordings under `directory`.
+auto catalog_path( std::filesystem::path const& directory ) -> std::filesystem::path;
+
+/// \brief A memory-mapped catalog file.
+///
+/// `update` lists the directory and only decodes recordings that are new or have changed
+/// since the last update (by size and modification time), in parallel with TBB. Anything
+/// under the directory that is not a recording is listed as ignored, so it is only opened
+/// again once it changes.
+class SessionCatalog
+{
+public:
+    /// \brief Open the catalog of `directory` without checking whether it is up to date.
+    static auto open( std::filesystem::path const& directory ) -> utils::Expected< SessionCatalog >;
+
+    /// \brief Bring the catalog of `directory` up to date, creating it if it is missing,
+    ///        and open it.
+    ///
+    /// The new catalog is written to a temporary file, unique to this process and call, that
+    /// replaces the old one when it is complete. Readers never see a partial catalog and
+    /// concurrent updates never write the same file. `skip`, if set, is a recording under
+    /// `directory` that is still being written. It is left out until an update after it is
+    /// finished.
+    static auto update( std::filesystem::path const& directory, std::filesystem::path const& skip = { } )
+        -> utils::Expected< SessionCatalog >;
+
+    [[nodiscard]] auto directory( ) const -> std::filesystem::path const&;
+    [[nodiscard]] auto session_count( ) const -> std::size_t;
+    [[nodiscard]] auto session( std::size_t index ) const -> CatalogSession const&;
+    [[nodiscard]] auto session_path( std::size_t index ) const -> std::filesystem::path;
+    [[nodiscard]] auto devices( CatalogSession const& session ) const -> CatalogDevice const*;
+    [[nodiscard]] auto device_name( CatalogDevice const& device ) const -> std::string_view;
+    [[nodiscard]] auto device_guid( CatalogDevice const& device ) const -> std::string_view;
+    [[nodiscard]] auto axis_ranges( CatalogDevice const& device ) const -> AxisRange const*;
+    [[nodiscard]] auto ignored_count( ) const -> std::size_t;
+    [[nodiscard]] auto ignored( std::size_t index ) const -> CatalogIgnored const&;
+
+    /// \brief Indices of the sessions matching every condition in `query`.
+    [[nodiscard]] auto find( CatalogQuery const& query ) const -> std::vector< std::size_t >;
+
+private:
+    std::filesystem::path directory_;
+    utils::MappedFile     file_;
+    CatalogSession const* sessions_ = nullptr;
+    CatalogDevice const*  devices_  = nullptr;
+    AxisRange const*      axes_     = nullptr;
+    CatalogIgnored const* ignored_  = nullptr;
+    char const*           strings_  = nullptr;
+
+    SessionCatalog( std::filesystem::path directory, utils::MappedFile file );
+
+    [[nodiscard]] auto header( ) const -> CatalogFileHeader const&;
+    [[nodiscard]] auto string( std::uint64_t offset, std::size_t size ) const -> std::string_view;
+};
+
+/// \brief Update the catalog of `directory` and log the sessions matching `query`.
+auto query_catalog( std::filesystem::path const& directory, CatalogQuery const& query ) -> utils::Expected< void >;
+
+} // namespace ltb::joy
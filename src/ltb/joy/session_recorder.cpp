@@ -0,0 +1,604 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/session_recorder.hpp"
+
+// project
+#include "ltb/joy/axis_pyramid.hpp"
+#include "ltb/joy/fixed_point.hpp"
+#include "ltb/joy/session_catalog.hpp"
+#include "ltb/utils/clock.hpp"
+
+// external
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+// standard
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+/// \brief `<stem>.<number><extension>` next to `path`.
+auto segment_path( std::filesystem::path const& path, std::uint64_t number ) -> std::filesystem::path
+{
+    auto segment = path;
+    segment.replace_filename(
+        fmt::format( "{}.{:04}{}", path.stem( ).string( ), number, path.extension( ).string( ) )
+    );
+    return segment;
+}
+
+/// \brief Create a session file and write its header, which starts the file's first checksum block.
+auto create_session_file( std::filesystem::path const& path, utils::WriteBackend backend, ChecksumBuilder& checksums )
+    -> utils::Expected< utils::FileWriter >
+{
+    auto file = utils::FileWriter::create( path, backend );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    auto header          = RecordingFileHeader{ };
+    header.start_time_us = utils::steady_time_us( );
+
+    if ( !file->append( &header, sizeof( header ) ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to write header to '{}'", path.string( ) );
+    }
+    checksums.add( &header, sizeof( header ) );
+    return file;
+}
+
+} // namespace
+
+auto SegmentPolicy::rotates( ) const -> bool
+{
+    return max_segment_bytes > 0UL || max_segment_us > 0;
+}
+
+auto SessionRecorder::open(
+    std::filesystem::path const& path,
+    SnapshotEncoding             encoding,
+    SegmentPolicy                policy,
+    utils::WriteBackend          backend
+) -> utils::Expected< std::unique_ptr< SessionRecorder > >
+{
+    auto const first_path = policy.rotates( ) ? segment_path( path, 0UL ) : path;
+
+    auto checksums = ChecksumBuilder{ };
+    auto file      = create_session_file( first_path, backend, checksums );
+    if ( !file )
+    {
+        return tl::make_unexpected( file.error( ) );
+    }
+
+    spdlog::info(
+        "Recording session to '{}' with {}",
+        first_path.string( ),
+        ( file->backend( ) == utils::WriteBackend::IoUring ) ? "io_uring" : "stdio"
+    );
+    return std::unique_ptr< SessionRecorder >(
+        new SessionRecorder( std::move( *file ), std::move( checksums ), encoding, path, policy )
+    );
+}
+
+SessionRecorder::SessionRecorder(
+    utils::FileWriter     file,
+    ChecksumBuilder       checksums,
+    SnapshotEncoding      encoding,
+    std::filesystem::path path,
+    SegmentPolicy         policy
+)
+    : encoding_( encoding )
+    , path_( std::move( path ) )
+    , policy_( policy )
+    , file_( std::move( file ) )
+    , checksums_( std::move( checksums ) )
+{
+    writer_ = std::thread( [ this ] { write_loop( ); } );
+}
+
+SessionRecorder::~SessionRecorder( )
+{
+    flush_blocks( 0UL );
+    end_frame( );
+    {
+        auto lock = std::lock_guard( mutex_ );
+        stopping_ = true;
+    }
+    chunk_available_.notify_one( );
+    writer_.join( );
+
+    auto const stats = this->stats( );
+    spdlog::info(
+        "Recorded {} records ({} bytes), dropped {}",
+        stats.records_written,
+        stats.bytes_written,
+        stats.records_dropped
+    );
+}
+
+auto SessionRecorder::begin_frame( std::size_t device_count ) -> void
+{
+    // Devices past the new count are gone, so their blocks will not get any more snapshots.
+    flush_blocks( device_count );
+    device_buffers_.resize( device_count );
+    for ( auto& buffer : device_buffers_ )
+    {
+        buffer.chunk.bytes.clear( );
+        buffer.chunk.record_count = 0UL;
+        buffer.device_id = -1;
+        buffer.introduced = false;
+        buffer.serialize_ns = 0;
+        buffer.keyframe.clear( );
+    }
+    keyframe_due_ = last_frame_us_ >= next_keyframe_us_;
+}
+
+auto SessionRecorder::serialize_device( std::size_t device_index, Joystick const& joystick ) -> void
+{
+    auto const start  = Clock::now( );
+    auto&      buffer = device_buffers_[ device_index ];
+    buffer.device_id  = joystick.device_id;
+
+    // `known_devices_` is only modified in `end_frame` so it is safe to read concurrently here.
+    auto known = known_devices_.find( joystick.device_id );
+    if ( known == known_devices_.end( ) || !same_device( known->second, joystick ) )
+    {
+        append_device_record( joystick, buffer.chunk.bytes );
+        ++buffer.chunk.record_count;
+        set_device_identity( joystick, buffer.new_identity );
+        buffer.introduced = true;
+    }
+
+    if ( encoding_ == SnapshotEncoding::DeltaBlocks )
+    {
+        // Blocks are per buffer slot, so a different device showing up in this slot closes
+        // the previous device's block first.
+        buffer.chunk.record_count += buffer.encoder.add( joystick, buffer.chunk.bytes );
+    }
+    else if ( encoding_ == SnapshotEncoding::Fixed16 )
+    {
+        append_fixed_snapshot_record( joystick, buffer.chunk.bytes );
+        ++buffer.chunk.record_count;
+    }
+    else
+    {
+        append_snapshot_record( joystick, buffer.chunk.bytes );
+        ++buffer.chunk.record_count;
+    }
+
+    if ( keyframe_due_ )
+    {
+        if ( encoding_ == SnapshotEncoding::DeltaBlocks )
+        {
+            // Store the axes as the blocks will decode them so seeking lands on the same state.
+            auto quantized = joystick;
+            quantize_axes( quantized.axes );
+            append_keyframe_record( quantized, buffer.keyframe );
+        }
+        else if ( encoding_ == SnapshotEncoding::Fixed16 )
+        {
+            auto rounded = joystick;
+            round_to_fixed_axes( rounded.axes );
+            append_keyframe_record( rounded, buffer.keyframe );
+        }
+        else
+        {
+            append_keyframe_record( joystick, buffer.keyframe );
+        }
+    }
+    buffer.timestamp_us = joystick.timestamp_us;
+
+    buffer.serialize_ns = ( Clock::now( ) - start ).count( );
+}
+
+auto SessionRecorder::record_events( std::vector< InputEvent > const& events ) -> void
+{
+    auto const start = Clock::now( );
+
+    for ( auto const& event : events )
+    {
+        append_event_record( event, pending_.bytes );
+    }
+    pending_.record_count += events.size( );
+
+    frame_cost_ += Clock::now( ) - start;
+}
+
+auto SessionRecorder::end_frame( ) -> void
+{
+    auto const start = Clock::now( );
+
+    for ( auto& buffer : device_buffers_ )
+    {
+        pending_.bytes.insert( pending_.bytes.end( ), buffer.chunk.bytes.begin( ), buffer.chunk.bytes.end( ) );
+        pending_.record_count += buffer.chunk.record_count;
+        frame_cost_ += std::chrono::nanoseconds( buffer.serialize_ns );
+        last_frame_us_ = std::max( last_frame_us_, buffer.timestamp_us );
+
+        if ( buffer.introduced )
+        {
+            introduced_.emplace_back( buffer.device_id, buffer.new_identity );
+        }
+        buffer.chunk.bytes.clear( );
+        buffer.chunk.record_count = 0UL;
+    }
+
+    // A frame's keyframes are kept together, after every block and snapshot they follow, so
+    // the index can point at the whole group.
+    if ( keyframe_due_ )
+    {
+        for ( auto& buffer : device_buffers_ )
+        {
+            pending_.bytes.insert( pending_.bytes.end( ), buffer.keyframe.begin( ), buffer.keyframe.end( ) );
+            pending_.record_count += buffer.keyframe.empty( ) ? 0UL : 1UL;
+            buffer.keyframe.clear( );
+        }
+        next_keyframe_us_ = last_frame_us_ + keyframe_interval_us;
+        keyframe_due_     = false;
+    }
+
+    {
+        auto lock = std::lock_guard( mutex_ );
+
+        if ( !pending_.bytes.empty( ) )
+        {
+            if ( queue_.size( ) < queue_capacity )
+            {
+                queue_.emplace_back( std::move( pending_ ) );
+                producer_stats_.queue_high_water = std::max( producer_stats_.queue_high_water, queue_.size( ) );
+
+                // Devices only count as described once their records are on the way to disk.
+                for ( auto& [ device_id, identity ] : introduced_ )
+                {
+                    known_devices_[ device_id ] = std::move( identity );
+                }
+            }
+            else
+            {
+                // The device records went with the chunk, so the next frame describes them again.
+                producer_stats_.records_dropped += pending_.record_count;
+            }
+            introduced_.clear( );
+
+            // Reuse a buffer the writer has finished with to avoid allocating every frame.
+            if ( free_chunks_.empty( ) )
+            {
+                pending_ = Chunk{ };
+            }
+            else
+            {
+                pending_ = std::move( free_chunks_.back( ) );
+                free_chunks_.pop_back( );
+            }
+        }
+
+        frame_cost_ += Clock::now( ) - start;
+        ++frame_count_;
+
+        auto const cost_us = Microseconds( frame_cost_ ).count( );
+        producer_stats_.mean_frame_cost_us
+            += ( cost_us - producer_stats_.mean_frame_cost_us ) / static_cast< double >( frame_count_ );
+        producer_stats_.max_frame_cost_us = std::max( producer_stats_.max_frame_cost_us, cost_us );
+        frame_cost_                       = { };
+    }
+    chunk_available_.notify_one( );
+}
+
+auto SessionRecorder::stats( ) const -> RecorderStats
+{
+    auto stats = RecorderStats{ };
+    {
+        auto lock = std::lock_guard( mutex_ );
+        stats     = producer_stats_;
+    }
+    stats.records_written = records_written_.load( std::memory_order_relaxed );
+    stats.bytes_written   = bytes_written_.load( std::memory_order_relaxed );
+    stats.max_write_ms    = static_cast< double >( max_write_us_.load( std::memory_order_relaxed ) ) / 1000.0;
+    stats.write_failed    = write_failed_.load( std::memory_order_relaxed );
+
+    stats.segments_finished = segments_finished_.load( std::memory_order_relaxed );
+    stats.segments_evicted  = segments_evicted_.load( std::memory_order_relaxed );
+    return stats;
+}
+
+auto SessionRecorder::flush_blocks( std::size_t first_device ) -> void
+{
+    for ( auto i = first_device; i < device_buffers_.size( ); ++i )
+    {
+        pending_.record_count += device_buffers_[ i ].encoder.flush( pending_.bytes );
+    }
+}
+
+auto SessionRecorder::write_loop( ) -> void
+{
+    auto lock = std::unique_lock( mutex_ );
+
+    while ( true )
+    {
+        chunk_available_.wait( lock, [ this ] { return stopping_ || !queue_.empty( ); } );
+
+        if ( queue_.empty( ) )
+        {
+            break; // stopping and fully drained
+        }
+
+        auto chunk = std::move( queue_.front( ) );
+        queue_.pop_front( );
+
+        // Never hold the lock during disk I/O or the producer could stall on it.
+        lock.unlock( );
+        auto const written = !write_failed_ && write_chunk( chunk );
+        lock.lock( );
+
+        if ( !written && !write_failed_ )
+        {
+            write_failed_ = true;
+            spdlog::error( "Session recording write failed: {}", std::strerror( errno ) );
+        }
+        if ( !written )
+        {
+            // Every chunk from the failed one on is discarded instead of written.
+            producer_stats_.records_dropped += chunk.record_count;
+        }
+
+        chunk.bytes.clear( );
+        chunk.record_count = 0UL;
+        free_chunks_.emplace_back( std::move( chunk ) );
+    }
+
+    lock.unlock( );
+
+    // A footer is only written if every record made it to disk, otherwise readers fall
+    // back to scanning whatever was written.
+    if ( !write_failed_ && !write_footer( ) )
+    {
+        spdlog::error( "Failed to write session recording index: {}", std::strerror( errno ) );
+    }
+    if ( !file_.close( ) && !write_failed_ )
+    {
+        spdlog::error( "Failed to close session recording: {}", std::strerror( errno ) );
+    }
+    if ( !write_failed_ )
+    {
+        build_pyramid( policy_.rotates( ) ? segment_path( path_, segment_number_ ) : path_, { } );
+    }
+    if ( pyramid_builder_.joinable( ) )
+    {
+        pyramid_builder_.join( );
+    }
+}
+
+auto SessionRecorder::write_chunk( Chunk const& chunk ) -> bool
+{
+    if ( !write_records( chunk.bytes.data( ), chunk.bytes.size( ) ) )
+    {
+        return false;
+    }
+
+    records_written_.fetch_add( chunk.record_count, std::memory_order_relaxed );
+    bytes_written_.fetch_add( chunk.bytes.size( ), std::memory_order_relaxed );
+
+    // Chunks hold whole frames, so segments always split between frames.
+    auto const full_by_size = policy_.max_segment_bytes > 0UL && file_offset_ >= policy_.max_segment_bytes;
+    auto const full_by_time
+        = policy_.max_segment_us > 0 && segment_end_us_ - segment_start_us_ >= policy_.max_segment_us;
+
+    if ( ( full_by_size || full_by_time ) && !rotate_segment( ) )
+    {
+        return false;
+    }
+    evict_segments( );
+    return true;
+}
+
+auto SessionRecorder::write_records( std::byte const* records, std::size_t size ) -> bool
+{
+    auto const start = Clock::now( );
+
+    if ( !append( records, size ) )
+    {
+        return false;
+    }
+
+    auto const write_us = std::chrono::duration_cast< std::chrono::microseconds >( Clock::now( ) - start ).count( );
+    if ( write_us > max_write_us_.load( std::memory_order_relaxed ) )
+    {
+        max_write_us_.store( write_us, std::memory_order_relaxed );
+    }
+    // Index the records now, while they are hot in cache, so finalizing is cheap.
+    for ( auto offset = 0UL; offset < size; )
+    {
+        auto header = RecordHeader{ };
+        std::memcpy( &header, records + offset, sizeof( header ) );
+
+        if ( file_offset_ + offset == sizeof( RecordingFileHeader ) )
+        {
+            segment_start_us_ = header.timestamp_us;
+        }
+        segment_end_us_ = std::max( segment_end_us_, header.timestamp_us );
+
+        if ( header.type == RecordType::Device && policy_.rotates( ) )
+        {
+            device_records_[ header.device_id ].assign( records + offset, records + offset + header.size );
+        }
+
+        index_.add( header, file_offset_ + offset );
+        offset += header.size;
+    }
+    file_offset_ += size;
+    return true;
+}
+
+auto SessionRecorder::append( void const* data, std::size_t size ) -> bool
+{
+    // Checksumming here costs a fraction of the write, and the bytes are still in cache.
+    if ( !file_.append( data, size ) )
+    {
+        return false;
+    }
+    checksums_.add( data, size );
+    return true;
+}
+
+auto SessionRecorder::write_footer( ) -> bool
+{
+    auto const& entries   = index_.entries( );
+    auto const& keyframes = index_.keyframes( );
+
+    if ( !append( entries.data( ), sizeof( RecordIndexEntry ) * entries.size( ) )
+         || !append( keyframes.data( ), sizeof( RecordIndexEntry ) * keyframes.size( ) ) )
+    {
+        return false;
+    }
+
+    auto const& checksums = checksums_.finish( );
+    auto const  footer    = index_.footer( file_offset_, checksums );
+
+    return file_.append( checksums.data( ), sizeof( std::uint32_t ) * checksums.size( ) )
+        && file_.append( &footer, sizeof( footer ) );
+}
+
+auto SessionRecorder::rotate_segment( ) -> bool
+{
+    if ( !write_footer( ) )
+    {
+        return false;
+    }
+
+    auto finished = Segment{ segment_path( path_, segment_number_ ), file_offset_ };
+    finished.size += sizeof( RecordIndexEntry ) * ( index_.entries( ).size( ) + index_.keyframes( ).size( ) )
+                   + sizeof( std::uint32_t ) * checksums_.finish( ).size( ) + sizeof( RecordingFooter );
+    if ( !file_.close( ) )
+    {
+        return false;
+    }
+
+    build_pyramid( finished.path, segment_path( path_, segment_number_ + 1UL ) );
+
+    finished_bytes_ += finished.size;
+    finished_segments_.emplace_back( std::move( finished ) );
+    segments_finished_.fetch_add( 1UL, std::memory_order_relaxed );
+
+    ++segment_number_;
+    checksums_ = ChecksumBuilder{ };
+    auto file  = create_session_file( segment_path( path_, segment_number_ ), file_.backend( ), checksums_ );
+    if ( !file )
+    {
+        spdlog::error( "{}", file.error( ).error_message( ) );
+        return false;
+    }
+    file_        = std::move( *file );
+    index_       = RecordIndexBuilder{ };
+    file_offset_ = sizeof( RecordingFileHeader );
+
+    // Describe every device again so each segment can be replayed on its own. The copies
+    // are stamped with the end of the previous segment so they do not stretch this one.
+    auto descriptions = std::vector< std::byte >{ };
+    for ( auto const& [ device_id, record ] : device_records_ )
+    {
+        auto const offset = descriptions.size( );
+        descriptions.insert( descriptions.end( ), record.begin( ), record.end( ) );
+
+        auto header = RecordHeader{ };
+        std::memcpy( &header, descriptions.data( ) + offset, sizeof( header ) );
+        header.timestamp_us = segment_end_us_;
+        std::memcpy( descriptions.data( ) + offset, &header, sizeof( header ) );
+    }
+    return write_records( descriptions.data( ), descriptions.size( ) );
+}
+
+auto SessionRecorder::evict_segments( ) -> void
+{
+    if ( policy_.disk_budget_bytes == 0UL )
+    {
+        return;
+    }
+
+    // The segment being written is never evicted, even if it alone is over budget.
+    while ( !finished_segments_.empty( ) && finished_bytes_ + file_offset_ > policy_.disk_budget_bytes )
+    {
+        auto const& oldest = finished_segments_.front( );
+
+        // The segment's pyramid may still be being built, and must not be left behind.
+        if ( pyramid_builder_.joinable( ) )
+        {
+            pyramid_builder_.join( );
+        }
+
+        auto error_code = std::error_code{ };
+        std::filesystem::remove( oldest.path, error_code );
+        if ( error_code )
+        {
+            spdlog::warn( "Failed to evict '{}': {}", oldest.path.string( ), error_code.message( ) );
+        }
+        std::filesystem::remove( pyramid_path( oldest.path ), error_code );
+
+        finished_bytes_ -= oldest.size;
+        finished_segments_.pop_front( );
+        segments_evicted_.fetch_add( 1UL, std::memory_order_relaxed );
+    }
+}
+
+auto SessionRecorder::build_pyramid( std::filesystem::path segment, std::filesystem::path active ) -> void
+{
+    // Building reads the whole segment back, so it runs beside the writer instead of
+    // holding up the queue. At most one build runs at a time.
+    if ( pyramid_builder_.joinable( ) )
+    {
+        pyramid_builder_.join( );
+    }
+    pyramid_builder_ = std::thread( [ segment = std::move( segment ), active = std::move( active ) ] {
+        auto const built = build_axis_pyramid( segment );
+        if ( !built )
+        {
+            spdlog::warn( "No pyramid for '{}': {}", segment.string( ), built.error( ).error_message( ) );
+        }
+
+        // Directories are only cataloged once someone has asked for it with `--catalog`. The
+        // segment after this one has no footer yet and grows while it is read, so it waits.
+        auto const directory  = segment.has_parent_path( ) ? segment.parent_path( ) : std::filesystem::path( "." );
+        auto       error_code = std::error_code{ };
+        if ( std::filesystem::exists( catalog_path( directory ), error_code ) )
+        {
+            if ( auto const catalog = SessionCatalog::update( directory, active ); !catalog )
+            {
+                spdlog::warn( "Catalog not updated: {}", catalog.error( ).error_message( ) );
+            }
+        }
+    } );
+}
+
+auto configure_recorder_gui( RecorderStats const& stats ) -> void
+{
+    ImGui::Text(
+        "Recording: %llu records, %.1f MiB, %llu dropped | %.1f us/frame (max %.1f) | slowest write %.2f ms%s",
+        static_cast< unsigned long long >( stats.records_written ),
+        static_cast< double >( stats.bytes_written ) / ( 1024.0 * 1024.0 ),
+        static_cast< unsigned long long >( stats.records_dropped ),
+        stats.mean_frame_cost_us,
+        stats.max_frame_cost_us,
+        stats.max_write_ms,
+        stats.write_failed ? " | WRITE FAILED" : ""
+    );
+
+    if ( stats.segments_finished > 0UL )
+    {
+        ImGui::Text(
+            "Segments: %llu finished, %llu evicted",
+            static_cast< unsigned long long >( stats.segments_finished ),
+            static_cast< unsigned long long >( stats.segments_evicted )
+        );
+    }
+}
+
+} // namespace ltb::joy
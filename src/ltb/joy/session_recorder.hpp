@@ -0,0 +1,203 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/file_writer.hpp"
+
+// standard
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace ltb::joy
+{
+
+struct RecorderStats
+{
+    std::uint64_t records_written    = 0;
+    std::uint64_t records_dropped    = 0; ///< Lost because the writer fell too far behind or a write failed
+    std::uint64_t bytes_written      = 0;
+    std::size_t   queue_high_water   = 0; ///< Most chunks waiting for the writer at once
+    double        mean_frame_cost_us = 0.0; ///< Time the recorder spends on the calling threads per frame
+    double        max_frame_cost_us  = 0.0;
+    double        max_write_ms       = 0.0; ///< Longest single disk write, absorbed by the writer thread
+    std::uint64_t segments_finished  = 0;
+    std::uint64_t segments_evicted   = 0; ///< Deleted to stay within the disk budget
+    bool          write_failed       = false;
+};
+
+/// \brief When a recording is split into a new segment file, and how much disk the
+///        segments may use in total.
+///
+/// Segments are named `<stem>.<number><extension>` after the recording path and are
+/// complete, indexed session files that can each be replayed on their own.
+struct SegmentPolicy
+{
+    std::uint64_t max_segment_bytes = 0; ///< Zero never rotates by size
+    std::int64_t  max_segment_us    = 0; ///< Zero never rotates by duration
+    std::uint64_t disk_budget_bytes = 0; ///< Zero keeps every segment. Pyramid sidecars are not counted
+
+    [[nodiscard]] auto rotates( ) const -> bool;
+};
+
+/// \brief Records polled snapshots and input events to a binary session file.
+///
+/// Records are serialized on the calling threads into a per-frame chunk that is handed to
+/// a background writer through a bounded queue. Nothing on the calling side ever waits on
+/// the disk: if the writer falls behind and the queue fills, whole chunks are dropped and
+/// counted instead. Every `keyframe_interval_us` the full state of each device is also
+/// written as a keyframe so replays can seek without decoding from the start. Rotating
+/// segments, including writing their indices and deleting old ones, also happens on the
+/// writer thread. Each finished file gets an axis pyramid sidecar (see
+/// `build_axis_pyramid`) so it can be browsed without decoding it.
+class SessionRecorder
+{
+public:
+    static auto open(
+        std::filesystem::path const& path,
+        SnapshotEncoding             encoding,
+        SegmentPolicy                policy  = { },
+        utils::WriteBackend          backend = utils::WriteBackend::Stdio
+    ) -> utils::Expected< std::unique_ptr< SessionRecorder > >;
+
+    ~SessionRecorder( );
+
+    SessionRecorder( SessionRecorder const& )                    = delete;
+    auto operator=( SessionRecorder const& ) -> SessionRecorder& = delete;
+
+    /// \brief Size the per-device buffers used by `serialize_device`.
+    auto begin_frame( std::size_t device_count ) -> void;
+
+    /// \brief Serialize one device's snapshot. Safe to call concurrently for different
+    ///        device indices, which lets it run as the pipeline's serialization stage.
+    auto serialize_device( std::size_t device_index, Joystick const& joystick ) -> void;
+
+    auto record_events( std::vector< InputEvent > const& events ) -> void;
+
+    /// \brief Hand everything serialized this frame to the writer thread.
+    auto end_frame( ) -> void;
+
+    [[nodiscard]] auto stats( ) const -> RecorderStats;
+
+private:
+    struct Chunk
+    {
+        std::vector< std::byte > bytes        = { };
+        std::uint64_t            record_count = 0;
+    };
+
+    struct DeviceBuffer
+    {
+        Chunk                         chunk        = { };
+        int                           device_id    = -1;
+        bool                          introduced   = false; ///< This frame described the device
+        DeviceIdentity                new_identity = { };    ///< Only meaningful if `introduced`
+        std::chrono::nanoseconds::rep serialize_ns = 0;
+        SnapshotBlockEncoder          encoder      = { }; ///< Persists across frames for `DeltaBlocks`
+        std::vector< std::byte >      keyframe     = { }; ///< Written after every other record of the frame
+        std::int64_t                  timestamp_us = 0;
+    };
+
+    static constexpr auto queue_capacity = std::size_t( 256 );
+
+    struct Segment
+    {
+        std::filesystem::path path = { };
+        std::uint64_t         size = 0;
+    };
+
+    SessionRecorder(
+        utils::FileWriter     file,
+        ChecksumBuilder       checksums,
+        SnapshotEncoding      encoding,
+        std::filesystem::path path,
+        SegmentPolicy         policy
+    );
+
+    SnapshotEncoding      encoding_;
+    std::filesystem::path path_; ///< The recording path segment names are derived from
+    SegmentPolicy         policy_;
+
+    // Only touched by the threads producing records.
+    std::vector< DeviceBuffer >                     device_buffers_   = { };
+    std::unordered_map< int, DeviceIdentity >       known_devices_    = { };
+    Chunk                                           pending_          = { };
+    std::vector< std::pair< int, DeviceIdentity > > introduced_       = { }; ///< Described by `pending_`, not yet known
+    std::chrono::steady_clock::duration             frame_cost_       = { };
+    std::uint64_t                                   frame_count_      = 0;
+    std::int64_t                                    last_frame_us_    = 0; ///< Latest snapshot of the previous frame
+    std::int64_t                                    next_keyframe_us_ = std::numeric_limits< std::int64_t >::min( );
+    bool                                            keyframe_due_     = false;
+
+    // Shared with the writer thread.
+    mutable std::mutex           mutex_             = { };
+    std::condition_variable      chunk_available_   = { };
+    std::deque< Chunk >          queue_             = { };
+    std::vector< Chunk >         free_chunks_       = { };
+    bool                         stopping_          = false;
+    RecorderStats                producer_stats_    = { }; ///< Guarded by `mutex_` so `stats` can read it
+    std::atomic< std::uint64_t > records_written_   = { 0UL };
+    std::atomic< std::uint64_t > bytes_written_     = { 0UL };
+    std::atomic< std::int64_t >  max_write_us_      = { 0 };
+    std::atomic< bool >          write_failed_      = { false };
+    std::atomic< std::uint64_t > segments_finished_ = { 0UL };
+    std::atomic< std::uint64_t > segments_evicted_  = { 0UL };
+
+    // Only touched by the writer thread (and `open` before it starts).
+    using DeviceRecords = std::unordered_map< int, std::vector< std::byte > >;
+
+    utils::FileWriter            file_              = { };
+    RecordIndexBuilder           index_             = { };
+    ChecksumBuilder              checksums_         = { }; ///< Covers the header, records and indices
+    std::uint64_t                file_offset_       = sizeof( RecordingFileHeader );
+    std::uint64_t                segment_number_    = 0;
+    std::int64_t                 segment_start_us_  = 0;
+    std::int64_t                 segment_end_us_    = 0;
+    DeviceRecords                device_records_    = { }; ///< The latest of each device, repeated in every segment
+    std::deque< Segment >        finished_segments_ = { }; ///< Still on disk, oldest first
+    std::uint64_t                finished_bytes_    = 0;
+
+    std::thread writer_;
+
+    /// \brief Builds the pyramid of the last finished segment beside the writer thread.
+    std::thread pyramid_builder_;
+
+    /// \brief Close every partially filled snapshot block of devices `first_device` and up.
+    auto flush_blocks( std::size_t first_device ) -> void;
+
+    auto write_loop( ) -> void;
+    auto write_chunk( Chunk const& chunk ) -> bool;
+    auto write_records( std::byte const* records, std::size_t size ) -> bool;
+
+    /// \brief Append to the current file and include the bytes in its checksums.
+    auto append( void const* data, std::size_t size ) -> bool;
+
+    auto write_footer( ) -> bool;
+
+    /// \brief Finalize the current segment, start the next one, and evict old segments
+    ///        until the recording fits in its disk budget.
+    auto rotate_segment( ) -> bool;
+
+    /// \brief Delete the oldest finished segments while the recording is over its budget.
+    auto evict_segments( ) -> void;
+
+    /// \brief Start building the pyramid of a finished segment, after the previous one is done.
+    ///        `active` is the segment written next, if any, which the catalog leaves out.
+    auto build_pyramid( std::filesystem::path segment, std::filesystem::path active ) -> void;
+};
+
+auto configure_recorder_gui( RecorderStats const& stats ) -> void;
+
+} // namespace ltb::joy
@@ -0,0 +1,318 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/settings.hpp"
+
+// standard
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Parse `text` into `value`, rejecting anything that is not a number of at least `minimum`.
+template < typename T >
+auto parse_number( std::string_view flag, utils::Expected< std::string_view > const& text, T minimum, T& value )
+    -> utils::Expected< void >
+{
+    if ( !text )
+    {
+        return tl::make_unexpected( text.error( ) );
+    }
+
+    auto parsed = T{ };
+    auto valid  = false;
+
+    if constexpr ( std::is_floating_point_v< T > )
+    {
+        // Floating point std::from_chars is still missing from some standard libraries.
+        auto const copy = std::string{ *text };
+        char*      end  = nullptr;
+        parsed          = static_cast< T >( std::strtod( copy.c_str( ), &end ) );
+        valid           = !copy.empty( ) && end == copy.c_str( ) + copy.size( );
+    }
+    else
+    {
+        auto const* end    = text->data( ) + text->size( );
+        auto const  result = std::from_chars( text->data( ), end, parsed );
+        valid              = result.ec == std::errc{ } && result.ptr == end;
+    }
+
+    if ( !valid )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Invalid value '{}' for {}", *text, flag );
+    }
+    if ( parsed < minimum )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "{} must be at least {}", flag, minimum );
+    }
+
+    value = parsed;
+    return { };
+}
+
+auto parse_path( utils::Expected< std::string_view > const& text, std::filesystem::path& path )
+    -> utils::Expected< void >
+{
+    if ( !text )
+    {
+        return tl::make_unexpected( text.error( ) );
+    }
+    path = std::filesystem::path( *text );
+    return { };
+}
+
+auto parse_encoding( utils::Expected< std::string_view > const& text, SnapshotEncoding& encoding )
+    -> utils::Expected< void >
+{
+    if ( !text )
+    {
+        return tl::make_unexpected( text.error( ) );
+    }
+    if ( *text == "raw" )
+    {
+        encoding = SnapshotEncoding::Raw;
+    }
+    else if ( *text == "delta" )
+    {
+        encoding = SnapshotEncoding::DeltaBlocks;
+    }
+    else if ( *text == "fixed16" )
+    {
+        encoding = SnapshotEncoding::Fixed16;
+    }
+    else
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "Unknown recording encoding '{}', expected 'raw', 'delta' or 'fixed16'",
+            *text
+        );
+    }
+    return { };
+}
+
+auto parse_writer( utils::Expected< std::string_view > const& text, utils::WriteBackend& backend )
+    -> utils::Expected< void >
+{
+    if ( !text )
+    {
+        return tl::make_unexpected( text.error( ) );
+    }
+    if ( *text == "stdio" )
+    {
+        backend = utils::WriteBackend::Stdio;
+    }
+    else if ( *text == "io_uring" )
+    {
+        backend = utils::WriteBackend::IoUring;
+    }
+    else
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Unknown recording writer '{}', expected 'stdio' or 'io_uring'", *text );
+    }
+    return { };
+}
+
+} // namespace
+
+auto parse_settings( int argc, char const* const* argv ) -> utils::Expected< Settings >
+{
+    auto settings = Settings{ };
+
+    for ( auto i = 1; i < argc; ++i )
+    {
+        auto const flag = std::string_view{ argv[ i ] };
+
+        auto next_value = [ & ]( ) -> utils::Expected< std::string_view > {
+            if ( i + 1 >= argc )
+            {
+                return LTB_MAKE_UNEXPECTED_ERROR( "Missing value for {}", flag );
+            }
+            return std::string_view{ argv[ ++i ] };
+        };
+
+        auto result = utils::Expected< void >{ };
+
+        if ( flag == "--simulated-devices" )
+        {
+            result = parse_number( flag, next_value( ), 0, settings.simulated_device_count );
+        }
+        else if ( flag == "--record" )
+        {
+            result = parse_path( next_value( ), settings.record_path );
+        }
+        else if ( flag == "--record-encoding" )
+        {
+            result = parse_encoding( next_value( ), settings.record_encoding );
+        }
+        else if ( flag == "--record-segment-mib" )
+        {
+            result = parse_number( flag, next_value( ), std::size_t( 0 ), settings.record_segment_mib );
+        }
+        else if ( flag == "--record-segment-seconds" )
+        {
+            result = parse_number( flag, next_value( ), 0.0, settings.record_segment_seconds );
+        }
+        else if ( flag == "--record-budget-mib" )
+        {
+            result = parse_number( flag, next_value( ), std::size_t( 0 ), settings.record_budget_mib );
+        }
+        else if ( flag == "--record-writer" )
+        {
+            result = parse_writer( next_value( ), settings.record_writer );
+        }
+        else if ( flag == "--benchmark-writers" )
+        {
+            settings.benchmark_writers = true;
+        }
+        else if ( flag == "--flight-recorder" )
+        {
+            result = parse_path( next_value( ), settings.flight_recorder_path );
+        }
+        else if ( flag == "--flight-recorder-mib" )
+        {
+            result = parse_number( flag, next_value( ), std::size_t( 1 ), settings.flight_recorder_mib );
+        }
+        else if ( flag == "--extract-flight-recording" )
+        {
+            result = parse_path( next_value( ), settings.extract_path );
+        }
+        else if ( flag == "--idle" )
+        {
+            settings.idle_mode = true;
+        }
+        else if ( flag == "--late-latch" )
+        {
+            settings.late_latch = true;
+        }
+        else if ( flag == "--predict" )
+        {
+            settings.predict = true;
+        }
+        else if ( flag == "--capture-threads" )
+        {
+            settings.capture_threads = true;
+        }
+        else if ( flag == "--capture-rate" )
+        {
+            result = parse_number( flag, next_value( ), 1.0, settings.capture_rate_hz );
+        }
+        else if ( flag == "--reorder-window-us" )
+        {
+            result = parse_number( flag, next_value( ), std::int64_t( 0 ), settings.reorder_window_us );
+        }
+        else if ( flag == "--calibration" )
+        {
+            result = parse_path( next_value( ), settings.calibration_path );
+        }
+        else if ( flag == "--export-statistics" )
+        {
+            result = parse_path( next_value( ), settings.statistics_path );
+        }
+        else if ( flag == "--filter" )
+        {
+            result = next_value( ).and_then( parse_filter_type ).map( [ &settings ]( FilterType type ) {
+                settings.filter_type = type;
+            } );
+        }
+        else if ( flag == "--replay" )
+        {
+            result = parse_path( next_value( ), settings.replay_path );
+        }
+        else if ( flag == "--replay-speed" )
+        {
+            auto const value = next_value( );
+            if ( value && *value == "max" )
+            {
+                settings.replay_speed = 0.0;
+            }
+            else
+            {
+                result = parse_number( flag, value, 0.0, settings.replay_speed );
+            }
+        }
+        else if ( flag == "--export-columns" )
+        {
+            result = parse_path( next_value( ), settings.export_path );
+        }
+        else if ( flag == "--verify" )
+        {
+            result = parse_path( next_value( ), settings.verify_path );
+        }
+        else if ( flag == "--catalog" )
+        {
+            result = parse_path( next_value( ), settings.catalog_path );
+        }
+        else if ( flag == "--catalog-device" )
+        {
+            result = next_value( ).map( [ &settings ]( std::string_view text ) {
+                settings.catalog_device = std::string( text );
+            } );
+        }
+        else if ( flag == "--catalog-min-seconds" )
+        {
+            result = parse_number( flag, next_value( ), 0.0, settings.catalog_min_seconds );
+        }
+        else if ( flag == "--headless" )
+        {
+            settings.headless = true;
+        }
+        else if ( flag == "--simd" )
+        {
+            result = next_value( ).and_then( utils::parse_simd_level ).map( [ &settings ]( utils::SimdLevel level ) {
+                settings.simd_level = level;
+            } );
+        }
+        else
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR( "Unknown argument '{}'", flag );
+        }
+
+        if ( !result )
+        {
+            return tl::make_unexpected( result.error( ) );
+        }
+    }
+
+    if ( settings.idle_mode && settings.late_latch )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--idle and --late-latch cannot be used together" );
+    }
+    if ( settings.headless && settings.replay_path.empty( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--headless requires --replay" );
+    }
+    if ( settings.record_budget_mib > 0UL && settings.record_segment_mib == 0UL
+         && settings.record_segment_seconds == 0.0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "--record-budget-mib requires --record-segment-mib or --record-segment-seconds"
+        );
+    }
+    if ( !settings.export_path.empty( ) && settings.replay_path.empty( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--export-columns requires --replay to name the session to convert" );
+    }
+    if ( settings.benchmark_writers && settings.record_path.empty( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--benchmark-writers requires --record to name where to write" );
+    }
+    if ( !settings.extract_path.empty( ) && settings.record_path.empty( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--extract-flight-recording requires --record to name the output" );
+    }
+    if ( ( !settings.catalog_device.empty( ) || settings.catalog_min_seconds > 0.0 )
+         && settings.catalog_path.empty( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "--catalog-device and --catalog-min-seconds require --catalog" );
+    }
+
+    return settings;
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,126 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/axis_filters.hpp"
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/utils/cpu_dispatch.hpp"
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/file_writer.hpp"
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace ltb::joy
+{
+
+/// \brief Runtime options parsed from the command line.
+struct Settings
+{
+    /// \brief Number of fake devices to generate in addition to any connected joysticks.
+    int simulated_device_count = 0;
+
+    /// \brief Delay the start of each frame so input is sampled as late as possible
+    ///        before the vsync deadline. Not compatible with `idle_mode`.
+    bool late_latch = false;
+
+    /// \brief Extrapolate every axis to when each frame will be displayed and show the
+    ///        prediction beside the processed values, with its measured error.
+    bool predict = false;
+
+    /// \brief Capture every simulated device on its own thread and merge all input events
+    ///        into one timestamp-ordered stream.
+    bool capture_threads = false;
+
+    /// \brief Record every polled snapshot and input event to this file, if set.
+    std::filesystem::path record_path = { };
+
+    /// \brief How recorded snapshots are stored. Delta blocks are many times smaller but
+    ///        quantize axes to 16 bits.
+    SnapshotEncoding record_encoding = SnapshotEncoding::DeltaBlocks;
+
+    /// \brief Split the recording into a new segment file once the current one reaches this
+    ///        size or covers this much time. Zero disables either limit.
+    std::size_t record_segment_mib     = 0UL;
+    double      record_segment_seconds = 0.0;
+
+    /// \brief Delete the oldest segments once they use more disk than this. Zero keeps all of them.
+    std::size_t record_budget_mib = 0UL;
+
+    /// \brief How recordings are written to disk. io_uring falls back to stdio where unavailable.
+    utils::WriteBackend record_writer = utils::WriteBackend::Stdio;
+
+    /// \brief Compare the recording writers at `capture_rate_hz` and exit. Requires `record_path`.
+    bool benchmark_writers = false;
+
+    /// \brief Keep the most recent input in a fixed-size ring file that survives crashes, if set.
+    std::filesystem::path flight_recorder_path = { };
+
+    /// \brief Size of the flight recorder's ring, which bounds how much input it retains.
+    std::size_t flight_recorder_mib = 64UL;
+
+    /// \brief Copy the input retained by this flight recording to `record_path` and exit, if set.
+    std::filesystem::path extract_path = { };
+
+    /// \brief Only redraw when input changes or the window receives an event.
+    bool idle_mode = false;
+
+    /// \brief How often each capture thread samples its device. Idle mode also wakes up
+    ///        at this rate to poll connected devices.
+    double capture_rate_hz = 1000.0;
+
+    /// \brief How long merged events are held back so late producers can still be ordered.
+    std::int64_t reorder_window_us = 2000;
+
+    /// \brief Where the calibration learned for each device model is kept between runs, if
+    ///        set. Off by default so a run never writes into the working directory unasked.
+    ///        Replays never load or save it.
+    std::filesystem::path calibration_path = { };
+
+    /// \brief Write the running statistics of every axis here as CSV on exit (or from the
+    ///        GUI), if set.
+    std::filesystem::path statistics_path = { };
+
+    /// \brief Filter applied to every axis without one set in the GUI.
+    FilterType filter_type = FilterType::None;
+
+    /// \brief Play this recording back instead of polling devices, if set.
+    std::filesystem::path replay_path = { };
+
+    /// \brief Multiple of recorded time to replay at. Zero replays as fast as possible.
+    double replay_speed = 1.0;
+
+    /// \brief Convert the `replay_path` recording to a columnar file here and exit, if set.
+    std::filesystem::path export_path = { };
+
+    /// \brief Check the block checksums of this recording and exit, if set.
+    std::filesystem::path verify_path = { };
+
+    /// \brief Update the session catalog of this directory, list the matching sessions, and
+    ///        exit, if set.
+    std::filesystem::path catalog_path = { };
+
+    /// \brief Only list cataloged sessions with a device whose name or GUID contains this.
+    std::string catalog_device = { };
+
+    /// \brief Only list cataloged sessions lasting at least this long.
+    double catalog_min_seconds = 0.0;
+
+    /// \brief Replay without opening a window and report throughput. Requires `replay_path`.
+    bool headless = false;
+
+    /// \brief Run the numeric kernels built for this instruction set instead of the most
+    ///        capable one the CPU supports, to compare them.
+    std::optional< utils::SimdLevel > simd_level = std::nullopt;
+};
+
+/// \brief Parse the command line arguments passed to `main`.
+auto parse_settings( int argc, char const* const* argv ) -> utils::Expected< Settings >;
+
+} // namespace ltb::joy
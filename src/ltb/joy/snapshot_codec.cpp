@@ -0,0 +1,638 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/snapshot_codec.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+// standard
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#define LTB_JOYSTICKS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Packed residuals are split across this many 32-bit lanes, see `pack`.
+constexpr auto lane_count = std::size_t( 4 );
+
+auto zigzag( std::int64_t value ) -> std::uint64_t
+{
+    return ( static_cast< std::uint64_t >( value ) << 1U ) ^ static_cast< std::uint64_t >( value >> 63 );
+}
+
+auto unzigzag( std::uint64_t value ) -> std::int64_t
+{
+    return static_cast< std::int64_t >( value >> 1U ) ^ -static_cast< std::int64_t >( value & 1U );
+}
+
+auto bit_width( std::uint64_t value ) -> std::uint32_t
+{
+    auto width = 0U;
+    while ( value != 0UL )
+    {
+        value >>= 1U;
+        ++width;
+    }
+    return width;
+}
+
+auto append_varint( std::uint64_t value, std::vector< std::byte >& bytes ) -> void
+{
+    while ( value >= 0x80UL )
+    {
+        bytes.push_back( static_cast< std::byte >( ( value & 0x7fUL ) | 0x80UL ) );
+        value >>= 7U;
+    }
+    bytes.push_back( static_cast< std::byte >( value ) );
+}
+
+/// \brief Read a varint that ends before `end`, advancing `data` past it.
+auto read_varint( std::byte const*& data, std::byte const* end ) -> utils::Expected< std::uint64_t >
+{
+    auto value = std::uint64_t{ 0 };
+    auto shift = 0U;
+    auto byte  = std::uint64_t{ 0 };
+    do
+    {
+        if ( data == end )
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR( "Varint runs past the end of the record" );
+        }
+        byte = std::to_integer< std::uint64_t >( *data++ );
+        value |= ( byte & 0x7fUL ) << shift;
+        shift += 7U;
+    } while ( ( byte & 0x80UL ) != 0UL && shift < 64U );
+    return value;
+}
+
+auto round_up( std::size_t value, std::size_t multiple ) -> std::size_t
+{
+    return ( value + multiple - 1UL ) / multiple * multiple;
+}
+
+/// \brief Bytes used by `count` values packed `width` bits wide.
+auto packed_size( std::size_t count, std::uint32_t width ) -> std::size_t
+{
+    auto const values_per_lane = ( count + lane_count - 1UL ) / lane_count;
+    auto const words_per_lane  = ( values_per_lane * width + 31UL ) / 32UL;
+    return words_per_lane * lane_count * sizeof( std::uint32_t );
+}
+
+/// \brief Residuals packed for channel `channel` of a block: second differences after the
+///        first two values of the timestamps and axes, toggles after the first of a button.
+auto residual_count( std::size_t channel, std::size_t axis_count, std::size_t sample_count ) -> std::size_t
+{
+    return ( channel > axis_count ) ? sample_count - 1UL : std::max( sample_count, 2UL ) - 2UL;
+}
+
+/// \brief Append `count` values packed `width` bits wide.
+///
+/// Value `i` goes to lane `i % 4`, where each lane is a stream of 32-bit words filled
+/// least significant bit first, and the lanes' words are interleaved. Every value then
+/// sits at the same bit offset as its three neighbours, so a decoder can unpack four
+/// consecutive values with one set of vector shifts.
+auto pack( std::uint64_t const* values, std::size_t count, std::uint32_t width, std::vector< std::byte >& bytes )
+    -> void
+{
+    auto const offset = bytes.size( );
+    bytes.resize( offset + packed_size( count, width ) );
+    if ( width == 0U )
+    {
+        return;
+    }
+
+    for ( auto lane = 0UL; lane < lane_count; ++lane )
+    {
+        auto word   = 0UL;
+        auto buffer = std::uint64_t{ 0 };
+        auto bits   = 0U;
+
+        auto const flush_word = [ & ] {
+            auto const value  = static_cast< std::uint32_t >( buffer );
+            auto const target = offset + ( word * lane_count + lane ) * sizeof( value );
+            std::memcpy( bytes.data( ) + target, &value, sizeof( value ) );
+            ++word;
+        };
+
+        for ( auto i = lane; i < count; i += lane_count )
+        {
+            buffer |= values[ i ] << bits;
+            bits += width;
+            if ( bits >= 32U )
+            {
+                flush_word( );
+                buffer >>= 32U;
+                bits -= 32U;
+            }
+        }
+        if ( bits > 0U )
+        {
+            flush_word( );
+        }
+    }
+}
+
+#ifdef LTB_JOYSTICKS_SSE2
+
+/// \brief Read the four consecutive values starting at `index` of `pack`ed data.
+auto unpack( __m128i const* words, std::size_t index, std::uint32_t width, __m128i mask ) -> __m128i
+{
+    if ( width == 0U )
+    {
+        return _mm_setzero_si128( );
+    }
+
+    auto const bit    = static_cast< std::uint32_t >( ( index / lane_count ) * width );
+    auto const offset = bit % 32U;
+    auto       values = _mm_srl_epi32( _mm_loadu_si128( words + bit / 32U ), _mm_cvtsi32_si128( int( offset ) ) );
+    if ( offset + width > 32U )
+    {
+        auto const high = _mm_loadu_si128( words + bit / 32U + 1U );
+        values          = _mm_or_si128( values, _mm_sll_epi32( high, _mm_cvtsi32_si128( int( 32U - offset ) ) ) );
+    }
+    return _mm_and_si128( values, mask );
+}
+
+auto lane_mask( std::uint32_t width ) -> __m128i
+{
+    return _mm_set1_epi32( ( width >= 32U ) ? -1 : static_cast< int >( ( 1U << width ) - 1U ) );
+}
+
+/// \brief Broadcast the last lane, which carries a running sum into the next pass.
+auto last_lane( __m128i values ) -> __m128i
+{
+    return _mm_shuffle_epi32( values, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+}
+
+#else
+
+/// \brief Read the four consecutive values starting at `index` of `pack`ed data.
+auto unpack( std::byte const* data, std::size_t index, std::uint32_t width )
+    -> std::array< std::uint32_t, lane_count >
+{
+    auto values = std::array< std::uint32_t, lane_count >{ };
+    if ( width == 0U )
+    {
+        return values;
+    }
+
+    auto const bit  = ( index / lane_count ) * width;
+    auto const word = bit / 32UL;
+    auto const mask = ( width >= 32U ) ? 0xffffffffUL : ( ( 1UL << width ) - 1UL );
+
+    for ( auto lane = 0UL; lane < lane_count; ++lane )
+    {
+        auto low  = std::uint32_t{ 0 };
+        auto high = std::uint32_t{ 0 };
+        std::memcpy( &low, data + ( word * lane_count + lane ) * sizeof( low ), sizeof( low ) );
+        if ( bit % 32UL + width > 32UL )
+        {
+            std::memcpy( &high, data + ( ( word + 1UL ) * lane_count + lane ) * sizeof( high ), sizeof( high ) );
+        }
+        auto const both = ( std::uint64_t( high ) << 32U ) | low;
+        values[ lane ]  = static_cast< std::uint32_t >( ( both >> ( bit % 32UL ) ) & mask );
+    }
+    return values;
+}
+
+#endif
+
+/// \brief Rebuild a channel of `count` values from its first value, its first difference,
+///        and `count - 2` packed second differences.
+///
+/// That is an unpack, a zigzag decode, and two running sums (second differences to
+/// differences to values), fused into one pass over four values at a time. `values` must
+/// have room for `count` rounded up to a whole number of passes.
+auto decode_second_differences(
+    std::byte const* data,
+    std::uint32_t    width,
+    std::uint32_t    first,
+    std::uint32_t    first_difference,
+    std::size_t      count,
+    std::uint32_t*   values
+) -> void
+{
+    values[ 0 ] = first;
+    values[ 1 ] = first + first_difference;
+
+#ifdef LTB_JOYSTICKS_SSE2
+    auto const  one        = _mm_set1_epi32( 1 );
+    auto const  mask       = lane_mask( width );
+    auto const* words      = reinterpret_cast< __m128i const* >( data );
+    auto        difference = _mm_set1_epi32( static_cast< int >( first_difference ) );
+    auto        value      = _mm_set1_epi32( static_cast< int >( values[ 1 ] ) );
+
+    for ( auto i = 0UL; i + 2UL < count; i += lane_count )
+    {
+        auto residuals = unpack( words, i, width, mask );
+
+        // Zigzag decode: ( r >> 1 ) ^ -( r & 1 )
+        residuals = _mm_xor_si128(
+            _mm_srli_epi32( residuals, 1 ),
+            _mm_sub_epi32( _mm_setzero_si128( ), _mm_and_si128( residuals, one ) )
+        );
+
+        // Two in-register prefix sums, each continuing from the last lane of the previous pass.
+        residuals  = _mm_add_epi32( residuals, _mm_slli_si128( residuals, 4 ) );
+        residuals  = _mm_add_epi32( residuals, _mm_slli_si128( residuals, 8 ) );
+        difference = _mm_add_epi32( residuals, difference );
+
+        auto sums = _mm_add_epi32( difference, _mm_slli_si128( difference, 4 ) );
+        sums      = _mm_add_epi32( sums, _mm_slli_si128( sums, 8 ) );
+        value     = _mm_add_epi32( sums, value );
+
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( values + 2UL + i ), value );
+
+        difference = last_lane( difference );
+        value      = last_lane( value );
+    }
+#else
+    auto difference = first_difference;
+    auto value      = values[ 1 ];
+
+    for ( auto i = 0UL; i + 2UL < count; i += lane_count )
+    {
+        auto const residuals = unpack( data, i, width );
+        for ( auto lane = 0UL; lane < lane_count; ++lane )
+        {
+            difference += ( residuals[ lane ] >> 1U ) ^ ( 0U - ( residuals[ lane ] & 1U ) );
+            value += difference;
+            values[ 2UL + i + lane ] = value;
+        }
+    }
+#endif
+}
+
+/// \brief Rebuild a channel of `count` values from its first value and `count - 1` packed
+///        toggles, each the XOR of a value and the one before it.
+auto decode_toggles(
+    std::byte const* data,
+    std::uint32_t    width,
+    std::uint32_t    first,
+    std::size_t      count,
+    std::uint32_t*   values
+) -> void
+{
+    values[ 0 ] = first;
+
+#ifdef LTB_JOYSTICKS_SSE2
+    auto const  mask  = lane_mask( width );
+    auto const* words = reinterpret_cast< __m128i const* >( data );
+    auto        value = _mm_set1_epi32( static_cast< int >( first ) );
+
+    for ( auto i = 0UL; i + 1UL < count; i += lane_count )
+    {
+        auto toggles = unpack( words, i, width, mask );
+        toggles      = _mm_xor_si128( toggles, _mm_slli_si128( toggles, 4 ) );
+        toggles      = _mm_xor_si128( toggles, _mm_slli_si128( toggles, 8 ) );
+        value        = _mm_xor_si128( toggles, value );
+
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( values + 1UL + i ), value );
+        value = last_lane( value );
+    }
+#else
+    auto value = first;
+
+    for ( auto i = 0UL; i + 1UL < count; i += lane_count )
+    {
+        auto const toggles = unpack( data, i, width );
+        for ( auto lane = 0UL; lane < lane_count; ++lane )
+        {
+            value ^= toggles[ lane ];
+            values[ 1UL + i + lane ] = value;
+        }
+    }
+#endif
+}
+
+auto to_timestamps( std::uint32_t const* values, std::size_t count, std::int64_t first_us, std::int64_t* timestamps_us )
+    -> void
+{
+    auto i = 0UL;
+#ifdef LTB_JOYSTICKS_SSE2
+    auto const first = _mm_set1_epi64x( first_us );
+    for ( ; i + lane_count <= count; i += lane_count )
+    {
+        // Sign-extend the offsets to 64 bits before adding them to the first timestamp.
+        auto const v    = _mm_loadu_si128( reinterpret_cast< __m128i const* >( values + i ) );
+        auto const sign = _mm_srai_epi32( v, 31 );
+        auto*      out  = reinterpret_cast< __m128i* >( timestamps_us + i );
+        _mm_storeu_si128( out, _mm_add_epi64( first, _mm_unpacklo_epi32( v, sign ) ) );
+        _mm_storeu_si128( out + 1, _mm_add_epi64( first, _mm_unpackhi_epi32( v, sign ) ) );
+    }
+#endif
+    for ( ; i < count; ++i )
+    {
+        timestamps_us[ i ] = first_us + static_cast< std::int32_t >( values[ i ] );
+    }
+}
+
+auto to_buttons( std::uint32_t const* values, std::size_t count, unsigned char* buttons ) -> void
+{
+    auto i = 0UL;
+#ifdef LTB_JOYSTICKS_SSE2
+    constexpr auto bytes_per_pass = sizeof( __m128i );
+    for ( ; i + bytes_per_pass <= count; i += bytes_per_pass )
+    {
+        auto const* in = reinterpret_cast< __m128i const* >( values + i );
+        auto const  lo = _mm_packs_epi32( _mm_loadu_si128( in ), _mm_loadu_si128( in + 1 ) );
+        auto const  hi = _mm_packs_epi32( _mm_loadu_si128( in + 2 ), _mm_loadu_si128( in + 3 ) );
+        _mm_storeu_si128( reinterpret_cast< __m128i* >( buttons + i ), _mm_packus_epi16( lo, hi ) );
+    }
+#endif
+    for ( ; i < count; ++i )
+    {
+        buttons[ i ] = static_cast< unsigned char >( values[ i ] );
+    }
+}
+
+auto quantize( float axis ) -> std::int32_t
+{
+    return static_cast< std::int32_t >( std::lround( std::clamp( axis, -1.f, 1.f ) * axis_quantization_scale ) );
+}
+
+} // namespace
+
+auto quantize_axes( std::vector< float >& axes ) -> void
+{
+    // The same multiply `NumericKernels::dequantize_axes` does, so the values match bit for bit.
+    constexpr auto scale = 1.f / axis_quantization_scale;
+    for ( auto& axis : axes )
+    {
+        axis = static_cast< float >( quantize( axis ) ) * scale;
+    }
+}
+
+auto SnapshotBlockEncoder::add( Joystick const& joystick, std::vector< std::byte >& bytes ) -> std::uint64_t
+{
+    auto records = std::uint64_t{ 0 };
+    if ( !accepts( joystick ) )
+    {
+        records += flush( bytes );
+    }
+
+    if ( empty( ) )
+    {
+        device_id_    = joystick.device_id;
+        axis_count_   = static_cast< std::uint16_t >( joystick.axes.size( ) );
+        button_count_ = static_cast< std::uint16_t >( joystick.buttons.size( ) );
+    }
+
+    timestamps_us_.emplace_back( joystick.timestamp_us );
+    std::transform( joystick.axes.begin( ), joystick.axes.end( ), std::back_inserter( values_ ), quantize );
+    values_.insert( values_.end( ), joystick.buttons.begin( ), joystick.buttons.end( ) );
+
+    if ( timestamps_us_.size( ) == snapshot_block_capacity )
+    {
+        records += flush( bytes );
+    }
+    return records;
+}
+
+auto SnapshotBlockEncoder::flush( std::vector< std::byte >& bytes ) -> std::uint64_t
+{
+    if ( empty( ) )
+    {
+        return 0UL;
+    }
+
+    auto const sample_count  = timestamps_us_.size( );
+    auto const value_count   = std::size_t( axis_count_ ) + button_count_;
+    auto const channel_count = 1UL + value_count;
+    auto const first_time_us = timestamps_us_.front( );
+
+    auto payload              = SnapshotBlockPayload{ };
+    payload.sample_count      = static_cast< std::uint16_t >( sample_count );
+    payload.axis_count        = axis_count_;
+    payload.button_count      = button_count_;
+    payload.last_timestamp_us = timestamps_us_.back( );
+
+    // Channel widths and first values go up front so a decoder can find every channel
+    // without unpacking the ones before it.
+    encoded_.assign( channel_count, std::byte{ 0 } );
+    packed_.clear( );
+
+    for ( auto c = 0UL; c < channel_count; ++c )
+    {
+        channel_.resize( sample_count );
+        for ( auto s = 0UL; s < sample_count; ++s )
+        {
+            channel_[ s ] = ( c == 0UL ) ? timestamps_us_[ s ] - first_time_us : values_[ s * value_count + c - 1UL ];
+        }
+
+        // Buttons only ever toggle, so they store which ones changed. Everything else stores
+        // how far each value is from a straight line through the two before it.
+        residuals_.clear( );
+        append_varint( zigzag( channel_[ 0 ] ), encoded_ );
+        if ( c > axis_count_ )
+        {
+            for ( auto i = 1UL; i < sample_count; ++i )
+            {
+                residuals_.emplace_back( static_cast< std::uint64_t >( channel_[ i ] ^ channel_[ i - 1UL ] ) );
+            }
+        }
+        else
+        {
+            auto const first_difference = ( sample_count > 1UL ) ? channel_[ 1 ] - channel_[ 0 ] : 0;
+            append_varint( zigzag( first_difference ), encoded_ );
+            for ( auto i = 2UL; i < sample_count; ++i )
+            {
+                residuals_.emplace_back( zigzag( channel_[ i ] - 2 * channel_[ i - 1UL ] + channel_[ i - 2UL ] ) );
+            }
+        }
+
+        auto width = 0U;
+        for ( auto residual : residuals_ )
+        {
+            width = std::max( width, bit_width( residual ) );
+        }
+        encoded_[ c ] = static_cast< std::byte >( width );
+        pack( residuals_.data( ), residuals_.size( ), width, packed_ );
+    }
+    encoded_.insert( encoded_.end( ), packed_.begin( ), packed_.end( ) );
+
+    auto offset = begin_record(
+        RecordType::SnapshotBlock,
+        device_id_,
+        first_time_us,
+        sizeof( payload ) + encoded_.size( ),
+        bytes
+    );
+    std::memcpy( bytes.data( ) + offset, &payload, sizeof( payload ) );
+    std::memcpy( bytes.data( ) + offset + sizeof( payload ), encoded_.data( ), encoded_.size( ) );
+
+    timestamps_us_.clear( );
+    values_.clear( );
+    return 1UL;
+}
+
+auto SnapshotBlockEncoder::empty( ) const -> bool
+{
+    return timestamps_us_.empty( );
+}
+
+auto SnapshotBlockEncoder::accepts( Joystick const& joystick ) const -> bool
+{
+    return empty( )
+        || ( joystick.device_id == device_id_ && joystick.axes.size( ) == axis_count_
+             && joystick.buttons.size( ) == button_count_
+             && std::abs( joystick.timestamp_us - timestamps_us_.front( ) ) <= snapshot_block_max_span_us );
+}
+
+auto SnapshotBlock::copy_sample( std::size_t sample, Joystick& joystick ) const -> void
+{
+    joystick.device_id    = device_id;
+    joystick.timestamp_us = timestamps_us[ sample ];
+
+    joystick.axes.resize( axis_count );
+    for ( auto a = 0UL; a < axis_count; ++a )
+    {
+        joystick.axes[ a ] = axes[ a * sample_count + sample ];
+    }
+
+    joystick.buttons.resize( button_count );
+    for ( auto b = 0UL; b < button_count; ++b )
+    {
+        joystick.buttons[ b ] = buttons[ b * sample_count + sample ];
+    }
+}
+
+auto validate_snapshot_block( RecordView const& record ) -> utils::Expected< void >
+{
+    auto const* const end = record.data( ) + record.header( ).size;
+    if ( record.header( ).size < sizeof( RecordHeader ) + sizeof( SnapshotBlockPayload ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Snapshot block of {} bytes is too small", record.header( ).size );
+    }
+
+    auto const view          = record.snapshot_block( );
+    auto const sample_count  = std::size_t( view.payload.sample_count );
+    auto const channel_count = 1UL + view.payload.axis_count + view.payload.button_count;
+
+    if ( sample_count > snapshot_block_capacity )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Snapshot block claims {} samples", sample_count );
+    }
+    if ( sample_count == 0UL )
+    {
+        return { };
+    }
+    if ( channel_count > static_cast< std::size_t >( end - view.channels ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Snapshot block claims {} channels", channel_count );
+    }
+
+    auto const* widths   = view.channels;
+    auto const* position = view.channels + channel_count;
+
+    for ( auto c = 0UL; c < channel_count; ++c )
+    {
+        auto const start_count = ( c > view.payload.axis_count ) ? 1UL : 2UL;
+        for ( auto i = 0UL; i < start_count; ++i )
+        {
+            if ( auto start = read_varint( position, end ); !start )
+            {
+                return tl::make_unexpected( start.error( ) );
+            }
+        }
+    }
+
+    for ( auto c = 0UL; c < channel_count; ++c )
+    {
+        auto const width = std::to_integer< std::uint32_t >( widths[ c ] );
+        auto const size  = packed_size( residual_count( c, view.payload.axis_count, sample_count ), width );
+        if ( width > 32U || size > static_cast< std::size_t >( end - position ) )
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR( "Channel {} of a snapshot block does not fit its record", c );
+        }
+        position += size;
+    }
+    return { };
+}
+
+auto decode_snapshot_block( RecordView const& record, SnapshotBlock& block ) -> utils::Expected< void >
+{
+    if ( auto valid = validate_snapshot_block( record ); !valid )
+    {
+        return valid;
+    }
+
+    auto const* const end           = record.data( ) + record.header( ).size;
+    auto const        view          = record.snapshot_block( );
+    auto const        sample_count  = std::size_t( view.payload.sample_count );
+    auto const        channel_count = 1UL + view.payload.axis_count + view.payload.button_count;
+
+    block.device_id    = record.device_id( );
+    block.sample_count = sample_count;
+    block.axis_count   = view.payload.axis_count;
+    block.button_count = view.payload.button_count;
+    block.timestamps_us.resize( sample_count );
+    block.axes.resize( block.axis_count * sample_count );
+    block.buttons.resize( block.button_count * sample_count );
+    if ( sample_count == 0UL )
+    {
+        return { };
+    }
+
+    auto const* widths   = view.channels;
+    auto const* position = view.channels + channel_count;
+
+    // The packed residuals start after the last starting value, so read all of those first.
+    block.scratch.resize( 2UL * channel_count + 2UL + round_up( sample_count, lane_count ) );
+    auto* starts = block.scratch.data( );
+    auto* values = starts + 2UL * channel_count;
+
+    for ( auto c = 0UL; c < channel_count; ++c )
+    {
+        auto const start_count = ( c > block.axis_count ) ? 1UL : 2UL;
+        for ( auto i = 0UL; i < start_count; ++i )
+        {
+            starts[ 2UL * c + i ] = static_cast< std::uint32_t >( unzigzag( *read_varint( position, end ) ) );
+        }
+    }
+
+    for ( auto c = 0UL; c < channel_count; ++c )
+    {
+        auto const width = std::to_integer< std::uint32_t >( widths[ c ] );
+
+        if ( c > block.axis_count )
+        {
+            decode_toggles( position, width, starts[ 2UL * c ], sample_count, values );
+        }
+        else
+        {
+            auto const* start = starts + 2UL * c;
+            decode_second_differences( position, width, start[ 0 ], start[ 1 ], sample_count, values );
+        }
+        position += packed_size( residual_count( c, block.axis_count, sample_count ), width );
+
+        if ( c == 0UL )
+        {
+            to_timestamps( values, sample_count, record.timestamp_us( ), block.timestamps_us.data( ) );
+        }
+        else if ( c <= block.axis_count )
+        {
+            auto* const axes = block.axes.data( ) + ( c - 1UL ) * sample_count;
+            numeric_kernels( ).dequantize_axes( values, sample_count, axes );
+        }
+        else
+        {
+            to_buttons( values, sample_count, block.buttons.data( ) + ( c - 1UL - block.axis_count ) * sample_count );
+        }
+    }
+    return { };
+}
+
+} // namespace ltb::joy
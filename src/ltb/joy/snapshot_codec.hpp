@@ -0,0 +1,73 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_reader.hpp"
+
+namespace ltb::joy
+{
+
+/// \brief Collects consecutive snapshots of one device into `RecordType::SnapshotBlock`s.
+///
+/// Smoothly moving axes are close to linear over a few polls, so the second differences
+/// stored by a block usually fit in a handful of bits and unchanged controls take none.
+class SnapshotBlockEncoder
+{
+public:
+    /// \brief Add a snapshot to the current block. Returns the number of block records
+    ///        appended to `bytes`, which happens when the block fills up or when the
+    ///        snapshot cannot join it (a different device or layout, or too much time passed).
+    auto add( Joystick const& joystick, std::vector< std::byte >& bytes ) -> std::uint64_t;
+
+    /// \brief Append the current block, if it has any snapshots, and start a new one.
+    auto flush( std::vector< std::byte >& bytes ) -> std::uint64_t;
+
+    [[nodiscard]] auto empty( ) const -> bool;
+
+private:
+    int                          device_id_     = -1;
+    std::uint16_t                axis_count_    = 0;
+    std::uint16_t                button_count_  = 0;
+    std::vector< std::int64_t >  timestamps_us_ = { };
+    std::vector< std::int32_t >  values_        = { }; ///< Quantized axes then buttons, a snapshot at a time
+    std::vector< std::int64_t >  channel_       = { }; ///< Scratch space for one channel...
+    std::vector< std::uint64_t > residuals_     = { }; ///< ...its zigzag-encoded residuals...
+    std::vector< std::byte >     packed_        = { }; ///< ...and every channel's packed residuals
+    std::vector< std::byte >     encoded_       = { }; ///< Scratch space for the whole encoded payload
+
+    [[nodiscard]] auto accepts( Joystick const& joystick ) const -> bool;
+};
+
+/// \brief A decoded `RecordType::SnapshotBlock`, stored one control at a time.
+struct SnapshotBlock
+{
+    int                          device_id     = 0;
+    std::size_t                  sample_count  = 0;
+    std::size_t                  axis_count    = 0;
+    std::size_t                  button_count  = 0;
+    std::vector< std::int64_t >  timestamps_us = { };
+    std::vector< float >         axes          = { }; ///< `axes[ axis * sample_count + sample ]`
+    std::vector< unsigned char > buttons       = { }; ///< `buttons[ button * sample_count + sample ]`
+    std::vector< std::uint32_t > scratch       = { }; ///< Reused by `decode_snapshot_block`
+
+    /// \brief Copy one snapshot of the block into `joystick`, leaving its name and GUID alone.
+    auto copy_sample( std::size_t sample, Joystick& joystick ) const -> void;
+};
+
+/// \brief Round `axes` to the values a snapshot block would decode them as.
+auto quantize_axes( std::vector< float >& axes ) -> void;
+
+/// \brief Check that every count, width and packed channel of `record` fits in the
+///        record, without decoding it.
+auto validate_snapshot_block( RecordView const& record ) -> utils::Expected< void >;
+
+/// \brief Decode `record` into `block`, reusing its storage.
+///
+/// Each channel is unpacked, zigzag decoded, and summed back into values four at a time
+/// in one SSE2 pass where SSE2 is available, with a scalar fallback elsewhere. A block that
+/// fails `validate_snapshot_block` is an error and is not read.
+auto decode_snapshot_block( RecordView const& record, SnapshotBlock& block ) -> utils::Expected< void >;
+
+} // namespace ltb::joy
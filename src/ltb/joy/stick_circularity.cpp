@@ -0,0 +1,289 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/stick_circularity.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+
+// external
+#include <imgui.h>
+
+// standard
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+using Clock        = std::chrono::steady_clock;
+using Microseconds = std::chrono::duration< double, std::micro >;
+
+constexpr auto two_pi = 6.2831853f;
+
+/// \brief Side of the square each stick's outline is drawn in.
+constexpr auto plot_size = 128.f;
+
+/// \brief The bin of `angle` (in radians, within +-pi), rounding so bin 0 is centered on +x.
+auto bin_of( float angle ) -> std::size_t
+{
+    constexpr auto bins            = static_cast< float >( circularity_angle_bins );
+    constexpr auto bins_per_radian = bins / two_pi;
+
+    // Offsetting by a full turn keeps the position positive, so truncating rounds it.
+    auto const position = static_cast< std::size_t >( angle * bins_per_radian + bins + 0.5f );
+    return position % circularity_angle_bins;
+}
+
+} // namespace
+
+auto StickCircularity::bins_reached( ) const -> std::size_t
+{
+    return static_cast< std::size_t >(
+        std::count_if( max_radius.begin( ), max_radius.end( ), []( float radius ) { return radius > 0.f; } )
+    );
+}
+
+auto StickCircularity::circularity_error( ) const -> float
+{
+    auto sum_squares = 0.f;
+    auto reached     = 0UL;
+    for ( auto const radius : max_radius )
+    {
+        if ( radius > 0.f )
+        {
+            sum_squares += ( radius - 1.f ) * ( radius - 1.f );
+            ++reached;
+        }
+    }
+    return ( reached > 0UL ) ? std::sqrt( sum_squares / static_cast< float >( reached ) ) : 0.f;
+}
+
+auto StickCircularity::outer_deadzone( ) const -> float
+{
+    auto weakest = 1.f;
+    for ( auto const radius : max_radius )
+    {
+        if ( radius > 0.f )
+        {
+            weakest = std::min( weakest, radius );
+        }
+    }
+    return 1.f - weakest;
+}
+
+auto StickCircularityTracker::process( std::vector< Joystick > const& joysticks, AxisMapper const& mapper ) -> void
+{
+    auto const start = Clock::now( );
+
+    // Stick pairs can be added in the mapping GUI at any time, so they are found every frame.
+    find_sticks( joysticks, mapper );
+    if ( !layout_matches( joysticks ) )
+    {
+        rebuild( joysticks );
+    }
+
+    lane_stick_.clear( );
+    x_.clear( );
+    y_.clear( );
+    for ( auto s = 0UL; s < wanted_.size( ); ++s )
+    {
+        auto const& stick    = wanted_[ s ];
+        auto const& joystick = joysticks[ stick.device_index ];
+        if ( joystick.timestamp_us != last_sample_us_[ s ] )
+        {
+            last_sample_us_[ s ] = joystick.timestamp_us;
+            lane_stick_.push_back( static_cast< std::uint32_t >( s ) );
+            x_.push_back( joystick.axes[ stick.x_axis ] );
+            y_.push_back( joystick.axes[ stick.y_axis ] );
+        }
+    }
+
+    magnitude_.resize( x_.size( ) );
+    angle_.resize( x_.size( ) );
+    numeric_kernels( ).polar_lanes( x_.size( ), x_.data( ), y_.data( ), magnitude_.data( ), angle_.data( ) );
+
+    for ( auto lane = 0UL; lane < lane_stick_.size( ); ++lane )
+    {
+        auto& stick = sticks_[ lane_stick_[ lane ] ];
+        ++stick.sample_count;
+
+        // Written so NaNs are skipped too.
+        auto const magnitude = magnitude_[ lane ];
+        if ( magnitude >= circularity_min_radius )
+        {
+            auto& radius = stick.max_radius[ bin_of( angle_[ lane ] ) ];
+            radius       = std::max( radius, magnitude );
+        }
+    }
+
+    stats_.last_us = Microseconds( Clock::now( ) - start ).count( );
+    stats_.max_us  = std::max( stats_.max_us, stats_.last_us );
+}
+
+auto StickCircularityTracker::reset( ) -> void
+{
+    for ( auto& stick : sticks_ )
+    {
+        stick.sample_count = 0UL;
+        stick.max_radius   = { };
+    }
+    stats_.max_us = 0.0;
+}
+
+auto StickCircularityTracker::sticks( ) const -> std::vector< StickCircularity > const&
+{
+    return sticks_;
+}
+
+auto StickCircularityTracker::stats( ) const -> CircularityStats const&
+{
+    return stats_;
+}
+
+auto StickCircularityTracker::find_sticks( std::vector< Joystick > const& joysticks, AxisMapper const& mapper ) -> void
+{
+    wanted_.clear( );
+    for ( auto d = 0UL; d < joysticks.size( ); ++d )
+    {
+        auto const  axis_count = joysticks[ d ].axes.size( );
+        auto const& pairs      = mapper.mapping( joysticks[ d ].guid ).sticks;
+
+        if ( pairs.empty( ) && axis_count >= 2UL )
+        {
+            wanted_.push_back( { d, 0UL, 1UL } );
+        }
+        for ( auto const& pair : pairs )
+        {
+            if ( pair.x_axis < axis_count && pair.y_axis < axis_count )
+            {
+                wanted_.push_back( { d, pair.x_axis, pair.y_axis } );
+            }
+        }
+    }
+}
+
+auto StickCircularityTracker::layout_matches( std::vector< Joystick > const& joysticks ) const -> bool
+{
+    if ( wanted_.size( ) != sticks_.size( ) )
+    {
+        return false;
+    }
+    for ( auto s = 0UL; s < sticks_.size( ); ++s )
+    {
+        auto const& stick    = sticks_[ s ];
+        auto const& joystick = joysticks[ wanted_[ s ].device_index ];
+        if ( stick.device_id != joystick.device_id || stick.guid != joystick.guid
+             || stick.x_axis != wanted_[ s ].x_axis || stick.y_axis != wanted_[ s ].y_axis )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto StickCircularityTracker::rebuild( std::vector< Joystick > const& joysticks ) -> void
+{
+    // Sticks that are still connected keep what they have traced.
+    auto previous = std::move( sticks_ );
+    sticks_.clear( );
+
+    for ( auto const& wanted : wanted_ )
+    {
+        auto const& joystick = joysticks[ wanted.device_index ];
+        auto const  match    = std::find_if( previous.begin( ), previous.end( ), [ & ]( auto const& stick ) {
+            return stick.device_id == joystick.device_id && stick.guid == joystick.guid
+                && stick.x_axis == wanted.x_axis && stick.y_axis == wanted.y_axis;
+        } );
+
+        if ( match != previous.end( ) )
+        {
+            sticks_.push_back( std::move( *match ) );
+        }
+        else
+        {
+            auto stick      = StickCircularity{ };
+            stick.device_id = joystick.device_id;
+            stick.name      = joystick.name;
+            stick.guid      = joystick.guid;
+            stick.x_axis    = wanted.x_axis;
+            stick.y_axis    = wanted.y_axis;
+            sticks_.push_back( std::move( stick ) );
+        }
+    }
+
+    last_sample_us_.assign( sticks_.size( ), -1 );
+    stats_.stick_count = sticks_.size( );
+}
+
+auto configure_circularity_gui( StickCircularityTracker& tracker ) -> void
+{
+    auto const& stats = tracker.stats( );
+    ImGui::Text(
+        "Circularity: %zu sticks | %.1f us/frame (max %.1f)",
+        stats.stick_count,
+        stats.last_us,
+        stats.max_us
+    );
+
+    if ( !ImGui::TreeNode( "Stick circularity" ) )
+    {
+        return;
+    }
+    if ( ImGui::Button( "Reset circularity" ) )
+    {
+        tracker.reset( );
+    }
+
+    auto* draw = ImGui::GetWindowDrawList( );
+
+    auto const background = IM_COL32( 32, 32, 32, 255 );
+    auto const reference  = IM_COL32( 90, 90, 90, 255 );
+    auto const outline    = IM_COL32( 80, 140, 220, 255 );
+
+    auto const& sticks = tracker.sticks( );
+    for ( auto s = 0UL; s < sticks.size( ); ++s )
+    {
+        auto const& stick = sticks[ s ];
+        ImGui::Text(
+            "%s (%zu, %zu): %zu of %zu directions, error %.3f, outer deadzone %.3f",
+            stick.name.c_str( ),
+            stick.x_axis,
+            stick.y_axis,
+            stick.bins_reached( ),
+            circularity_angle_bins,
+            static_cast< double >( stick.circularity_error( ) ),
+            static_cast< double >( stick.outer_deadzone( ) )
+        );
+
+        // Scaled so the corners of a square gate still fit.
+        auto const origin = ImGui::GetCursorScreenPos( );
+        auto const center = ImVec2{ origin.x + plot_size * 0.5f, origin.y + plot_size * 0.5f };
+        auto const scale  = plot_size * 0.5f / 1.5f;
+        ImGui::Dummy( { plot_size, plot_size } );
+
+        draw->AddRectFilled( origin, { origin.x + plot_size, origin.y + plot_size }, background );
+        draw->AddCircle( center, scale, reference );
+
+        auto const point = [ & ]( std::size_t bin ) {
+            auto const angle  = static_cast< float >( bin ) * two_pi / static_cast< float >( circularity_angle_bins );
+            auto const radius = stick.max_radius[ bin ] * scale;
+            return ImVec2{ center.x + radius * std::cos( angle ), center.y - radius * std::sin( angle ) };
+        };
+        for ( auto bin = 0UL; bin < circularity_angle_bins; ++bin )
+        {
+            auto const next = ( bin + 1UL ) % circularity_angle_bins;
+            if ( stick.max_radius[ bin ] > 0.f && stick.max_radius[ next ] > 0.f )
+            {
+                draw->AddLine( point( bin ), point( next ), outline );
+            }
+        }
+    }
+
+    ImGui::TreePop( );
+}
+
+} // namespace ltb::joy
@@ -0,0 +1,106 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/axis_mapping.hpp"
+#include "ltb/joy/joysticks.hpp"
+
+// standard
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ltb::joy
+{
+
+/// \brief Angle bins of `StickCircularity::max_radius`. Bin 0 is centered on +x, so the
+///        axes and diagonals (where gates are usually farthest from round) each fall in the
+///        middle of a bin.
+constexpr auto circularity_angle_bins = std::size_t( 64 );
+
+/// \brief Samples closer to the center than this are not binned, so noise at rest does not
+///        mark bins as reached.
+constexpr auto circularity_min_radius = 0.5f;
+
+/// \brief The shape of one stick's gate, traced by the farthest raw sample in every direction.
+struct StickCircularity
+{
+    int                                         device_id    = -1;
+    std::string                                 name         = { };
+    std::string                                 guid         = { };
+    std::size_t                                 x_axis       = 0;
+    std::size_t                                 y_axis       = 1;
+    std::uint64_t                               sample_count = 0; ///< Since the tracker was last reset
+    std::array< float, circularity_angle_bins > max_radius   = { }; ///< Counter-clockwise from +x. Zero if unreached
+
+    [[nodiscard]] auto bins_reached( ) const -> std::size_t;
+
+    /// \brief Root mean square distance of the reached bins from the unit circle. Zero for a
+    ///        round gate, and about 0.2 for a square one.
+    [[nodiscard]] auto circularity_error( ) const -> float;
+
+    /// \brief How far short of full deflection the weakest reached direction falls, which is
+    ///        the `AxisMapping::outer_deadzone` the stick needs to reach full output in every
+    ///        direction. Only complete once every bin has been reached.
+    [[nodiscard]] auto outer_deadzone( ) const -> float;
+};
+
+struct CircularityStats
+{
+    std::size_t stick_count = 0;
+    double      last_us     = 0.0;
+    double      max_us      = 0.0;
+};
+
+/// \brief Stick QA that runs alongside the statistics stage: converts every stick of every
+///        device to magnitude and angle, and keeps the farthest magnitude seen in each angle
+///        bin.
+///
+/// Sticks are the `StickPair`s of each device's mapping, or axes 0 and 1 if it has none. Every
+/// stick position sampled this frame is gathered into one batch and converted by a single
+/// `numeric_kernels( )` loop, leaving only a compare per sample to update the bins. Like the
+/// statistics stage, polls that repeat a device's last sample are skipped.
+class StickCircularityTracker
+{
+public:
+    auto process( std::vector< Joystick > const& joysticks, AxisMapper const& mapper ) -> void;
+
+    /// \brief Forget every sample seen so far.
+    auto reset( ) -> void;
+
+    [[nodiscard]] auto sticks( ) const -> std::vector< StickCircularity > const&;
+    [[nodiscard]] auto stats( ) const -> CircularityStats const&;
+
+private:
+    struct StickAxes
+    {
+        std::size_t device_index = 0; ///< Into the joysticks being processed
+        std::size_t x_axis       = 0;
+        std::size_t y_axis       = 1;
+    };
+
+    std::vector< StickCircularity > sticks_         = { };
+    std::vector< std::int64_t >     last_sample_us_ = { }; ///< Per stick
+    std::vector< StickAxes >        wanted_         = { }; ///< The sticks of this frame's devices
+
+    // One lane per stick sampled this frame.
+    std::vector< std::uint32_t > lane_stick_ = { };
+    std::vector< float >         x_          = { };
+    std::vector< float >         y_          = { };
+    std::vector< float >         magnitude_  = { };
+    std::vector< float >         angle_      = { };
+
+    CircularityStats stats_ = { };
+
+    auto find_sticks( std::vector< Joystick > const& joysticks, AxisMapper const& mapper ) -> void;
+    [[nodiscard]] auto layout_matches( std::vector< Joystick > const& joysticks ) const -> bool;
+    auto               rebuild( std::vector< Joystick > const& joysticks ) -> void;
+};
+
+/// \brief Show how round each stick's gate is, with a plot of its traced outline.
+auto configure_circularity_gui( StickCircularityTracker& tracker ) -> void;
+
+} // namespace ltb::joy
@@ -4,15 +4,68 @@
 
 // project
 #include "ltb/joy/app.hpp"
+#include "ltb/joy/columnar_export.hpp"
+#include "ltb/joy/flight_recorder.hpp"
+#include "ltb/joy/headless.hpp"
+#include "ltb/joy/recording_verify.hpp"
+#include "ltb/joy/session_catalog.hpp"
+#include "ltb/utils/cpu_dispatch.hpp"
+
+// external
 #include <spdlog/spdlog.h>
 
+// standard
+#include <cmath>
+
 using namespace ltb;
 
-auto main( ) -> int
+auto main( int argc, char* argv[] ) -> int
 {
-    return joy::MainWindow{ }
-        .run( )
-        .map( []( auto* ) { return EXIT_SUCCESS; } )
+    return joy::parse_settings( argc, argv )
+        .and_then( []( joy::Settings settings ) -> utils::Expected< void > {
+            if ( settings.simd_level )
+            {
+                if ( auto requested = utils::request_simd_level( *settings.simd_level ); !requested )
+                {
+                    return requested;
+                }
+            }
+            spdlog::info(
+                "Numeric kernels: {} (CPU supports {})",
+                utils::simd_level_name( utils::simd_level( ) ),
+                utils::simd_level_name( utils::supported_simd_level( ) )
+            );
+
+            if ( !settings.extract_path.empty( ) )
+            {
+                return joy::extract_flight_recording( settings.extract_path, settings.record_path );
+            }
+            if ( !settings.verify_path.empty( ) )
+            {
+                return joy::verify_recording( settings.verify_path );
+            }
+            if ( !settings.catalog_path.empty( ) )
+            {
+                return joy::query_catalog(
+                    settings.catalog_path,
+                    { settings.catalog_device, std::llround( settings.catalog_min_seconds * 1e6 ) }
+                );
+            }
+            if ( !settings.export_path.empty( ) )
+            {
+                return joy::export_columns( settings.replay_path, settings.export_path );
+            }
+            if ( settings.benchmark_writers )
+            {
+                return joy::run_writer_benchmark( settings );
+            }
+            if ( settings.headless )
+            {
+                return joy::run_headless( settings );
+            }
+            return joy::MainWindow{ std::move( settings ) }.run( ).map( []( auto* ) { } );
+        } )
+        .map( []( ) { return EXIT_SUCCESS; } )
         .map_error( []( utils::Error&& error ) {
             spdlog::error( "{}", error.debug_error_message( ) );
             return error;
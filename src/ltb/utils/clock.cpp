@@ -0,0 +1,18 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/clock.hpp"
+
+// standard
+#include <chrono>
+
+namespace ltb::utils
+{
+
+auto steady_time_us( ) -> std::int64_t
+{
+    using namespace std::chrono;
+    return duration_cast< microseconds >( steady_clock::now( ).time_since_epoch( ) ).count( );
+}
+
+} // namespace ltb::utils
@@ -0,0 +1,15 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstdint>
+
+namespace ltb::utils
+{
+
+/// \brief Microseconds on a monotonic clock shared by every thread in the process.
+auto steady_time_us( ) -> std::int64_t;
+
+} // namespace ltb::utils
@@ -0,0 +1,121 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/cpu_dispatch.hpp"
+
+// standard
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#if defined( _MSC_VER ) && defined( _M_X64 )
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace ltb::utils
+{
+namespace
+{
+
+constexpr auto level_names = std::array< std::string_view, 4 >{ "scalar", "sse4.2", "avx2", "avx512" };
+
+/// \brief Set by `request_simd_level`, and read once by `simd_level`.
+auto requested_level = std::atomic< int >{ -1 };
+auto level_resolved  = std::atomic< bool >{ false };
+
+auto detect_simd_level( ) -> SimdLevel
+{
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+    // These also check that the OS saves the wider registers.
+    __builtin_cpu_init( );
+    if ( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" )
+         && __builtin_cpu_supports( "avx512dq" ) && __builtin_cpu_supports( "avx512vl" ) )
+    {
+        return SimdLevel::Avx512;
+    }
+    if ( __builtin_cpu_supports( "avx2" ) )
+    {
+        return SimdLevel::Avx2;
+    }
+    if ( __builtin_cpu_supports( "sse4.2" ) )
+    {
+        return SimdLevel::Sse42;
+    }
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+    auto registers = std::array< int, 4 >{ };
+    __cpuidex( registers.data( ), 1, 0 );
+    auto const sse42   = ( registers[ 2 ] & ( 1 << 20 ) ) != 0;
+    auto const osxsave = ( registers[ 2 ] & ( 1 << 27 ) ) != 0;
+
+    // XCR0 says which register files the OS saves: SSE and AVX state, then the AVX-512 state.
+    auto const xcr0    = osxsave ? _xgetbv( 0 ) : 0ULL;
+    auto const os_avx  = ( xcr0 & 0x6ULL ) == 0x6ULL;
+    auto const os_zmm  = ( xcr0 & 0xe6ULL ) == 0xe6ULL;
+
+    __cpuidex( registers.data( ), 7, 0 );
+    auto const ebx = registers[ 1 ];
+    if ( os_zmm && ( ebx & ( 1 << 16 ) ) && ( ebx & ( 1 << 17 ) ) && ( ebx & ( 1 << 30 ) ) && ( ebx & ( 1 << 31 ) ) )
+    {
+        return SimdLevel::Avx512;
+    }
+    if ( os_avx && ( ebx & ( 1 << 5 ) ) )
+    {
+        return SimdLevel::Avx2;
+    }
+    if ( sse42 )
+    {
+        return SimdLevel::Sse42;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+} // namespace
+
+auto simd_level_name( SimdLevel level ) -> std::string_view
+{
+    return level_names[ static_cast< std::size_t >( level ) ];
+}
+
+auto parse_simd_level( std::string_view text ) -> Expected< SimdLevel >
+{
+    auto const name = std::find( level_names.begin( ), level_names.end( ), text );
+    if ( name == level_names.end( ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "Unknown SIMD level '{}', expected 'scalar', 'sse4.2', 'avx2' or 'avx512'",
+            text
+        );
+    }
+    return static_cast< SimdLevel >( name - level_names.begin( ) );
+}
+
+auto supported_simd_level( ) -> SimdLevel
+{
+    static auto const supported = detect_simd_level( );
+    return supported;
+}
+
+auto request_simd_level( SimdLevel level ) -> Expected< void >
+{
+    if ( level_resolved )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Kernels were already dispatched to {}", simd_level_name( simd_level( ) ) );
+    }
+    requested_level = static_cast< int >( level );
+    return { };
+}
+
+auto simd_level( ) -> SimdLevel
+{
+    static auto const level = [] {
+        level_resolved       = true;
+        auto const supported = supported_simd_level( );
+        auto const requested = requested_level.load( );
+        return ( requested < 0 ) ? supported : std::min( static_cast< SimdLevel >( requested ), supported );
+    }( );
+    return level;
+}
+
+} // namespace ltb::utils
@@ -0,0 +1,43 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <string_view>
+
+namespace ltb::utils
+{
+
+/// \brief Instruction sets numeric kernels are built for, from least to most capable.
+/// Each level assumes every level before it.
+enum class SimdLevel
+{
+    Scalar, ///< Plain C++, which runs anywhere
+    Sse42,  ///< 128-bit vectors
+    Avx2,   ///< 256-bit vectors with gathers
+    Avx512, ///< 512-bit vectors with mask registers (AVX-512 F, BW, DQ and VL)
+};
+
+/// \brief The name `parse_simd_level` accepts for `level`.
+auto simd_level_name( SimdLevel level ) -> std::string_view;
+
+auto parse_simd_level( std::string_view text ) -> Expected< SimdLevel >;
+
+/// \brief The most capable level this CPU (and OS) supports. Always `Scalar` on other
+///        architectures and compilers the kernels are not built for.
+auto supported_simd_level( ) -> SimdLevel;
+
+/// \brief Use `level` instead of the most capable supported level, for A/B comparisons.
+///        Levels the CPU does not support fall back to the most capable one it does.
+///
+/// Must be called before the first `simd_level`, since kernels are chosen once and kept.
+auto request_simd_level( SimdLevel level ) -> Expected< void >;
+
+/// \brief The level kernels are dispatched to, resolved on the first call.
+auto simd_level( ) -> SimdLevel;
+
+} // namespace ltb::utils
@@ -0,0 +1,136 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/crc32c.hpp"
+
+// standard
+#include <array>
+#include <cstring>
+
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define LTB_JOYSTICKS_SSE42_CRC
+#include <nmmintrin.h>
+#endif
+
+namespace ltb::utils
+{
+namespace
+{
+
+/// \brief The reflected Castagnoli polynomial.
+constexpr auto crc32c_polynomial = std::uint32_t( 0x82F63B78U );
+
+using CrcTables = std::array< std::array< std::uint32_t, 256 >, 8 >;
+
+/// \brief Tables for slicing-by-8: entry `[ k ][ b ]` is the CRC of byte `b` followed by
+///        `k` zero bytes, so eight input bytes can be folded in with eight lookups.
+constexpr auto make_crc_tables( ) -> CrcTables
+{
+    auto tables = CrcTables{ };
+    for ( auto b = 0U; b < 256U; ++b )
+    {
+        auto crc = b;
+        for ( auto bit = 0; bit < 8; ++bit )
+        {
+            crc = ( crc >> 1U ) ^ ( ( crc & 1U ) ? crc32c_polynomial : 0U );
+        }
+        tables[ 0 ][ b ] = crc;
+    }
+    for ( auto k = 1UL; k < tables.size( ); ++k )
+    {
+        for ( auto b = 0UL; b < 256UL; ++b )
+        {
+            auto const previous = tables[ k - 1UL ][ b ];
+            tables[ k ][ b ]    = ( previous >> 8U ) ^ tables[ 0 ][ previous & 0xFFU ];
+        }
+    }
+    return tables;
+}
+
+constexpr auto crc_tables = make_crc_tables( );
+
+auto crc32c_slice_by_8( std::byte const* data, std::size_t size, std::uint32_t crc ) -> std::uint32_t
+{
+    auto const& t = crc_tables;
+
+    for ( ; size >= 8UL; data += 8, size -= 8UL )
+    {
+        auto low  = std::uint32_t( 0 );
+        auto high = std::uint32_t( 0 );
+        std::memcpy( &low, data, sizeof( low ) );
+        std::memcpy( &high, data + 4, sizeof( high ) );
+        low ^= crc;
+
+        crc = t[ 7 ][ low & 0xFFU ] ^ t[ 6 ][ ( low >> 8U ) & 0xFFU ] ^ t[ 5 ][ ( low >> 16U ) & 0xFFU ]
+            ^ t[ 4 ][ low >> 24U ] ^ t[ 3 ][ high & 0xFFU ] ^ t[ 2 ][ ( high >> 8U ) & 0xFFU ]
+            ^ t[ 1 ][ ( high >> 16U ) & 0xFFU ] ^ t[ 0 ][ high >> 24U ];
+    }
+    for ( ; size > 0UL; ++data, --size )
+    {
+        crc = ( crc >> 8U ) ^ t[ 0 ][ ( crc ^ static_cast< std::uint32_t >( *data ) ) & 0xFFU ];
+    }
+    return crc;
+}
+
+#if defined( LTB_JOYSTICKS_SSE42_CRC )
+
+/// \brief Compiled for SSE4.2 on its own so the rest of the build still runs on any x86-64.
+__attribute__( ( target( "sse4.2" ) ) ) auto crc32c_sse42( std::byte const* data, std::size_t size, std::uint32_t crc )
+    -> std::uint32_t
+{
+    auto wide = std::uint64_t( crc );
+    for ( ; size >= 8UL; data += 8, size -= 8UL )
+    {
+        auto value = std::uint64_t( 0 );
+        std::memcpy( &value, data, sizeof( value ) );
+        wide = _mm_crc32_u64( wide, value );
+    }
+
+    crc = static_cast< std::uint32_t >( wide );
+    for ( ; size > 0UL; ++data, --size )
+    {
+        crc = _mm_crc32_u8( crc, static_cast< unsigned char >( *data ) );
+    }
+    return crc;
+}
+
+auto has_sse42( ) -> bool
+{
+    static auto const supported = __builtin_cpu_supports( "sse4.2" ) != 0;
+    return supported;
+}
+
+#endif
+
+} // namespace
+
+auto crc32c( void const* data, std::size_t size, std::uint32_t crc ) -> std::uint32_t
+{
+    auto const* bytes = static_cast< std::byte const* >( data );
+
+    // The register holds the complement so a checksum can be continued where it left off.
+    crc = ~crc;
+#if defined( LTB_JOYSTICKS_SSE42_CRC )
+    if ( has_sse42( ) )
+    {
+        return ~crc32c_sse42( bytes, size, crc );
+    }
+#endif
+    return ~crc32c_slice_by_8( bytes, size, crc );
+}
+
+auto crc32c_software( void const* data, std::size_t size, std::uint32_t crc ) -> std::uint32_t
+{
+    return ~crc32c_slice_by_8( static_cast< std::byte const* >( data ), size, ~crc );
+}
+
+auto crc32c_is_hardware( ) -> bool
+{
+#if defined( LTB_JOYSTICKS_SSE42_CRC )
+    return has_sse42( );
+#else
+    return false;
+#endif
+}
+
+} // namespace ltb::utils
@@ -0,0 +1,27 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstddef>
+#include <cstdint>
+
+namespace ltb::utils
+{
+
+/// \brief CRC32C (Castagnoli) of `size` bytes, continuing from `crc`, the checksum of
+///        everything before them. Zero starts a new checksum.
+///
+/// Uses the SSE4.2 `crc32` instruction when the CPU has it, which is fast enough that
+/// checking a file is limited by reading it, and a table-driven fallback otherwise.
+auto crc32c( void const* data, std::size_t size, std::uint32_t crc = 0U ) -> std::uint32_t;
+
+/// \brief `crc32c` with the table-driven fallback whatever the CPU has, so the two can be
+///        checked against each other.
+auto crc32c_software( void const* data, std::size_t size, std::uint32_t crc = 0U ) -> std::uint32_t;
+
+/// \brief Whether `crc32c` uses the `crc32` instruction on this CPU.
+auto crc32c_is_hardware( ) -> bool;
+
+} // namespace ltb::utils
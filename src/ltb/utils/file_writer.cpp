@@ -0,0 +1,82 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/file_writer.hpp"
+
+// external
+#include <spdlog/spdlog.h>
+
+// standard
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace ltb::utils
+{
+
+auto FileWriter::create( std::filesystem::path const& path, WriteBackend backend ) -> Expected< FileWriter >
+{
+    auto writer = FileWriter{ };
+
+    if ( backend == WriteBackend::IoUring )
+    {
+        auto uring = UringWriter::create( path );
+        if ( uring )
+        {
+            writer.uring_ = std::move( *uring );
+            return writer;
+        }
+
+        // Recorders create a file per segment, so only mention the fallback once.
+        static auto warned = std::atomic< bool >{ false };
+        if ( !warned.exchange( true ) )
+        {
+            spdlog::warn( "{}; writing with stdio instead", uring.error( ).error_message( ) );
+        }
+    }
+
+    writer.file_ = std::shared_ptr< std::FILE >( std::fopen( path.string( ).c_str( ), "wb" ), []( auto* p ) {
+        if ( p )
+        {
+            std::fclose( p );
+        }
+    } );
+
+    if ( writer.file_ == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+    return writer;
+}
+
+auto FileWriter::append( void const* data, std::size_t size ) -> bool
+{
+    if ( uring_ )
+    {
+        return uring_->append( data, size );
+    }
+    return std::fwrite( data, 1UL, size, file_.get( ) ) == size;
+}
+
+auto FileWriter::close( ) -> bool
+{
+    if ( uring_ )
+    {
+        return uring_->close( );
+    }
+    if ( file_ == nullptr )
+    {
+        return true;
+    }
+
+    auto const flushed = std::fflush( file_.get( ) ) == 0;
+    file_.reset( );
+    return flushed;
+}
+
+auto FileWriter::backend( ) const -> WriteBackend
+{
+    return uring_ ? WriteBackend::IoUring : WriteBackend::Stdio;
+}
+
+} // namespace ltb::utils
@@ -0,0 +1,48 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+#include "ltb/utils/uring_writer.hpp"
+
+// standard
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+
+namespace ltb::utils
+{
+
+/// \brief How `FileWriter` gets bytes to disk.
+enum class WriteBackend
+{
+    Stdio,   ///< Buffered `std::fwrite`, available everywhere
+    IoUring, ///< `UringWriter`, falling back to `Stdio` where it is unavailable
+};
+
+/// \brief Appends to a new file through one of the `WriteBackend`s.
+///
+/// Copies share the same file, which is closed when the last copy is destroyed if `close`
+/// was not called first.
+class FileWriter
+{
+public:
+    /// \brief Create (or truncate) the file at `path`.
+    static auto create( std::filesystem::path const& path, WriteBackend backend ) -> Expected< FileWriter >;
+
+    auto append( void const* data, std::size_t size ) -> bool;
+
+    /// \brief Flush everything appended so far and close the file.
+    auto close( ) -> bool;
+
+    /// \brief The backend actually in use, which may differ from the one requested.
+    [[nodiscard]] auto backend( ) const -> WriteBackend;
+
+private:
+    std::shared_ptr< std::FILE >   file_  = nullptr;
+    std::shared_ptr< UringWriter > uring_ = nullptr;
+};
+
+} // namespace ltb::utils
@@ -0,0 +1,216 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/mapped_file.hpp"
+
+// system
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// standard
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace ltb::utils
+{
+
+auto MappedFile::open( std::filesystem::path const& path ) -> Expected< MappedFile >
+{
+    auto error_code = std::error_code{ };
+    auto size       = std::filesystem::file_size( path, error_code );
+    if ( error_code )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}': {}", path.string( ), error_code.message( ) );
+    }
+
+    auto mapped  = MappedFile{ };
+    mapped.size_ = static_cast< std::size_t >( size );
+
+    if ( mapped.size_ == 0UL )
+    {
+        return mapped; // Nothing to map.
+    }
+
+#if defined( _WIN32 )
+    auto* file = ::CreateFileW(
+        path.c_str( ),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}'", path.string( ) );
+    }
+
+    auto* mapping = ::CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    ::CloseHandle( file ); // The mapping keeps its own reference to the file.
+    if ( mapping == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}'", path.string( ) );
+    }
+
+    auto const* view = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    ::CloseHandle( mapping );
+    if ( view == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}'", path.string( ) );
+    }
+
+    mapped.data_ = std::shared_ptr< std::byte const >( static_cast< std::byte const* >( view ), []( auto* p ) {
+        ::UnmapViewOfFile( p );
+    } );
+#else
+    auto const file = ::open( path.c_str( ), O_RDONLY );
+    if ( file < 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+
+    auto* view = ::mmap( nullptr, mapped.size_, PROT_READ, MAP_SHARED, file, 0 );
+    ::close( file ); // The mapping keeps its own reference to the file.
+    if ( view == MAP_FAILED )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+
+    // Recordings are mostly read front to back.
+    ::madvise( view, mapped.size_, MADV_SEQUENTIAL );
+
+    auto const size_to_unmap = mapped.size_;
+    auto const unmap         = [ size_to_unmap ]( auto* p ) {
+        ::munmap( const_cast< std::byte* >( p ), size_to_unmap );
+    };
+    mapped.data_ = std::shared_ptr< std::byte const >( static_cast< std::byte const* >( view ), unmap );
+#endif
+
+    return mapped;
+}
+
+auto MappedFile::data( ) const -> std::byte const*
+{
+    return data_.get( );
+}
+
+auto MappedFile::size( ) const -> std::size_t
+{
+    return size_;
+}
+
+auto WritableMappedFile::create( std::filesystem::path const& path, std::size_t size )
+    -> Expected< WritableMappedFile >
+{
+    if ( size == 0UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Cannot map an empty file '{}'", path.string( ) );
+    }
+
+    auto mapped  = WritableMappedFile{ };
+    mapped.size_ = size;
+
+#if defined( _WIN32 )
+    auto* file = ::CreateFileW(
+        path.c_str( ),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ,
+        nullptr,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to create '{}'", path.string( ) );
+    }
+
+    // Mapping more than the file holds extends it with zeros.
+    auto const size_64 = static_cast< std::uint64_t >( size );
+    auto*      mapping = ::CreateFileMappingW(
+        file,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast< DWORD >( size_64 >> 32U ),
+        static_cast< DWORD >( size_64 & 0xFFFF'FFFFU ),
+        nullptr
+    );
+    ::CloseHandle( file );
+    if ( mapping == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}'", path.string( ) );
+    }
+
+    auto* view = ::MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, 0 );
+    ::CloseHandle( mapping );
+    if ( view == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}'", path.string( ) );
+    }
+
+    mapped.data_ = std::shared_ptr< std::byte >( static_cast< std::byte* >( view ), []( auto* p ) {
+        ::UnmapViewOfFile( p );
+    } );
+#else
+    auto const file = ::open( path.c_str( ), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if ( file < 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to create '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+
+    if ( ::ftruncate( file, static_cast< off_t >( size ) ) != 0 )
+    {
+        auto const error = errno;
+        ::close( file );
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to resize '{}': {}", path.string( ), std::strerror( error ) );
+    }
+
+    auto* view = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0 );
+    ::close( file );
+    if ( view == MAP_FAILED )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+
+    auto const size_to_unmap = size;
+    auto const unmap         = [ size_to_unmap ]( auto* p ) { ::munmap( p, size_to_unmap ); };
+    mapped.data_             = std::shared_ptr< std::byte >( static_cast< std::byte* >( view ), unmap );
+#endif
+
+    return mapped;
+}
+
+auto WritableMappedFile::data( ) const -> std::byte*
+{
+    return data_.get( );
+}
+
+auto WritableMappedFile::size( ) const -> std::size_t
+{
+    return size_;
+}
+
+auto WritableMappedFile::flush( ) const -> Expected< void >
+{
+#if defined( _WIN32 )
+    if ( ::FlushViewOfFile( data_.get( ), size_ ) == 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to flush mapped file" );
+    }
+#else
+    if ( ::msync( data_.get( ), size_, MS_SYNC ) != 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to flush mapped file: {}", std::strerror( errno ) );
+    }
+#endif
+    return { };
+}
+
+} // namespace ltb::utils
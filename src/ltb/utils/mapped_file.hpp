@@ -0,0 +1,56 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace ltb::utils
+{
+
+/// \brief A read-only memory mapping of an entire file.
+///
+/// Copies share the same mapping, which is released when the last copy is destroyed.
+class MappedFile
+{
+public:
+    static auto open( std::filesystem::path const& path ) -> Expected< MappedFile >;
+
+    [[nodiscard]] auto data( ) const -> std::byte const*;
+    [[nodiscard]] auto size( ) const -> std::size_t;
+
+private:
+    /// \brief Unmaps (and closes any handles) on destruction.
+    std::shared_ptr< std::byte const > data_ = nullptr;
+    std::size_t                        size_ = 0UL;
+};
+
+/// \brief A shared, writable memory mapping of a file created with a fixed size.
+///
+/// Stores land in the page cache as soon as they are made, so whatever was written before
+/// the process crashes or is killed is still in the file afterwards. Copies share the
+/// same mapping.
+class WritableMappedFile
+{
+public:
+    /// \brief Create (or truncate) the file at `path` and map `size` zeroed bytes of it.
+    static auto create( std::filesystem::path const& path, std::size_t size ) -> Expected< WritableMappedFile >;
+
+    [[nodiscard]] auto data( ) const -> std::byte*;
+    [[nodiscard]] auto size( ) const -> std::size_t;
+
+    /// \brief Write dirty pages back to disk, which is only needed to survive losing power.
+    auto flush( ) const -> Expected< void >;
+
+private:
+    std::shared_ptr< std::byte > data_ = nullptr;
+    std::size_t                  size_ = 0UL;
+};
+
+} // namespace ltb::utils
@@ -0,0 +1,123 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace ltb::utils
+{
+
+/// \brief A fixed capacity, lock-free queue that any number of threads may push to
+///        while a single thread pops.
+///
+/// Each cell carries a sequence number that tells producers and the consumer whose turn
+/// it is, so pushes only contend on the shared tail counter (Vyukov's bounded queue).
+template < typename T >
+class BoundedMpscQueue
+{
+public:
+    /// \brief `capacity` is rounded up to the next power of two.
+    explicit BoundedMpscQueue( std::size_t capacity );
+
+    /// \brief Returns false without blocking if the queue is full.
+    auto try_push( T const& value ) -> bool;
+
+    /// \brief Must only be called from the consumer thread.
+    auto try_pop( ) -> std::optional< T >;
+
+    [[nodiscard]] auto capacity( ) const -> std::size_t;
+
+private:
+    struct Cell
+    {
+        std::atomic< std::size_t > sequence;
+        T                          value;
+    };
+
+    // Keep the producer and consumer counters on separate cache lines.
+    static constexpr auto cache_line_size = std::size_t( 64 );
+
+    std::size_t               mask_;
+    std::unique_ptr< Cell[] > cells_;
+
+    alignas( cache_line_size ) std::atomic< std::size_t > tail_ = { 0UL };
+    alignas( cache_line_size ) std::size_t head_                = 0UL;
+};
+
+template < typename T >
+BoundedMpscQueue< T >::BoundedMpscQueue( std::size_t capacity )
+{
+    auto size = std::size_t( 2 );
+    while ( size < capacity )
+    {
+        size <<= 1UL;
+    }
+    mask_  = size - 1UL;
+    cells_ = std::make_unique< Cell[] >( size );
+
+    for ( auto i = 0UL; i < size; ++i )
+    {
+        cells_[ i ].sequence.store( i, std::memory_order_relaxed );
+    }
+}
+
+template < typename T >
+auto BoundedMpscQueue< T >::try_push( T const& value ) -> bool
+{
+    auto position = tail_.load( std::memory_order_relaxed );
+
+    while ( true )
+    {
+        auto&      cell     = cells_[ position & mask_ ];
+        auto const sequence = cell.sequence.load( std::memory_order_acquire );
+        auto const diff     = static_cast< std::ptrdiff_t >( sequence ) - static_cast< std::ptrdiff_t >( position );
+
+        if ( diff == 0 )
+        {
+            if ( tail_.compare_exchange_weak( position, position + 1UL, std::memory_order_relaxed ) )
+            {
+                cell.value = value;
+                cell.sequence.store( position + 1UL, std::memory_order_release );
+                return true;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            return false; // full
+        }
+        else
+        {
+            position = tail_.load( std::memory_order_relaxed );
+        }
+    }
+}
+
+template < typename T >
+auto BoundedMpscQueue< T >::try_pop( ) -> std::optional< T >
+{
+    auto&      cell     = cells_[ head_ & mask_ ];
+    auto const sequence = cell.sequence.load( std::memory_order_acquire );
+
+    if ( sequence != head_ + 1UL )
+    {
+        return std::nullopt; // empty, or the producer has not finished writing yet
+    }
+
+    auto value = std::optional< T >( std::move( cell.value ) );
+    cell.sequence.store( head_ + mask_ + 1UL, std::memory_order_release );
+    ++head_;
+    return value;
+}
+
+template < typename T >
+auto BoundedMpscQueue< T >::capacity( ) const -> std::size_t
+{
+    return mask_ + 1UL;
+}
+
+} // namespace ltb::utils
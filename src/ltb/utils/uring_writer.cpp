@@ -0,0 +1,355 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/utils/uring_writer.hpp"
+
+// system
+#if defined( LTB_JOYSTICKS_USE_IO_URING )
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// standard
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace ltb::utils
+{
+
+#if defined( LTB_JOYSTICKS_USE_IO_URING )
+
+namespace
+{
+
+auto io_uring_setup( unsigned entries, io_uring_params* params ) -> int
+{
+    return static_cast< int >( ::syscall( __NR_io_uring_setup, entries, params ) );
+}
+
+auto io_uring_enter( int ring, unsigned to_submit, unsigned min_complete, unsigned flags ) -> int
+{
+    return static_cast< int >( ::syscall( __NR_io_uring_enter, ring, to_submit, min_complete, flags, nullptr, 0 ) );
+}
+
+auto io_uring_register( int ring, unsigned opcode, void* arguments, unsigned argument_count ) -> int
+{
+    return static_cast< int >( ::syscall( __NR_io_uring_register, ring, opcode, arguments, argument_count ) );
+}
+
+/// \brief Whether the kernel behind `ring` can run `IORING_OP_WRITE`. Rings exist from
+///        Linux 5.1, but plain writes and the probe that reports them only from 5.6.
+auto supports_write( int ring ) -> bool
+{
+    constexpr auto op_count = unsigned( IORING_OP_WRITE ) + 1U;
+
+    auto  storage = std::vector< std::byte >( sizeof( io_uring_probe ) + op_count * sizeof( io_uring_probe_op ) );
+    auto* probe   = reinterpret_cast< io_uring_probe* >( storage.data( ) );
+    if ( io_uring_register( ring, IORING_REGISTER_PROBE, probe, op_count ) < 0 )
+    {
+        return false;
+    }
+    return probe->last_op >= IORING_OP_WRITE && ( probe->ops[ IORING_OP_WRITE ].flags & IO_URING_OP_SUPPORTED ) != 0U;
+}
+
+/// \brief Ring indices shared with the kernel.
+auto shared_index( std::uint32_t* index ) -> std::atomic< std::uint32_t >&
+{
+    static_assert( sizeof( std::atomic< std::uint32_t > ) == sizeof( std::uint32_t ) );
+    static_assert( std::atomic< std::uint32_t >::is_always_lock_free );
+    return *reinterpret_cast< std::atomic< std::uint32_t >* >( index );
+}
+
+auto map_ring( int ring, std::size_t size, off_t offset ) -> std::shared_ptr< std::byte >
+{
+    auto* view = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, offset );
+    if ( view == MAP_FAILED )
+    {
+        return nullptr;
+    }
+    return std::shared_ptr< std::byte >( static_cast< std::byte* >( view ), [ size ]( auto* p ) {
+        ::munmap( p, size );
+    } );
+}
+
+template < typename T >
+auto at( std::shared_ptr< std::byte > const& mapping, std::uint32_t offset ) -> T*
+{
+    return reinterpret_cast< T* >( mapping.get( ) + offset );
+}
+
+} // namespace
+
+auto UringWriter::create( std::filesystem::path const& path, UringWriterOptions const& options )
+    -> Expected< std::unique_ptr< UringWriter > >
+{
+    if ( options.buffer_count == 0UL || options.buffer_size == 0UL || options.buffer_size % direct_alignment != 0UL )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR(
+            "io_uring buffers must be a non-zero multiple of {} bytes",
+            direct_alignment
+        );
+    }
+
+    auto writer          = std::unique_ptr< UringWriter >( new UringWriter( ) );
+    writer->buffer_size_ = options.buffer_size;
+
+    auto params      = io_uring_params{ };
+    writer->ring_.fd = io_uring_setup( static_cast< unsigned >( options.buffer_count ), &params );
+    if ( writer->ring_.fd < 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "io_uring is unavailable: {}", std::strerror( errno ) );
+    }
+    if ( !supports_write( writer->ring_.fd ) )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "io_uring is unavailable: the kernel cannot write with it" );
+    }
+
+    auto&      ring    = writer->ring_;
+    auto       sq_size = params.sq_off.array + params.sq_entries * sizeof( std::uint32_t );
+    auto       cq_size = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+    auto const single  = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0U;
+    if ( single )
+    {
+        sq_size = cq_size = std::max( sq_size, cq_size );
+    }
+
+    ring.sq   = map_ring( ring.fd, sq_size, IORING_OFF_SQ_RING );
+    ring.cq   = single ? ring.sq : map_ring( ring.fd, cq_size, IORING_OFF_CQ_RING );
+    ring.sqes = map_ring( ring.fd, params.sq_entries * sizeof( io_uring_sqe ), IORING_OFF_SQES );
+    if ( ring.sq == nullptr || ring.cq == nullptr || ring.sqes == nullptr )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to map io_uring queues: {}", std::strerror( errno ) );
+    }
+
+    ring.sq_tail  = at< std::uint32_t >( ring.sq, params.sq_off.tail );
+    ring.sq_mask  = at< std::uint32_t >( ring.sq, params.sq_off.ring_mask );
+    ring.sq_array = at< std::uint32_t >( ring.sq, params.sq_off.array );
+    ring.cq_head  = at< std::uint32_t >( ring.cq, params.cq_off.head );
+    ring.cq_tail  = at< std::uint32_t >( ring.cq, params.cq_off.tail );
+    ring.cq_mask  = at< std::uint32_t >( ring.cq, params.cq_off.ring_mask );
+    ring.cqes     = at< std::byte >( ring.cq, params.cq_off.cqes );
+
+    // Not every filesystem supports direct I/O (tmpfs, for one), so fall back to buffered.
+    writer->file_   = ::open( path.c_str( ), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644 );
+    writer->direct_ = writer->file_ >= 0;
+    if ( writer->file_ < 0 )
+    {
+        writer->file_ = ::open( path.c_str( ), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    }
+    if ( writer->file_ < 0 )
+    {
+        return LTB_MAKE_UNEXPECTED_ERROR( "Failed to open '{}': {}", path.string( ), std::strerror( errno ) );
+    }
+
+    for ( auto i = 0UL; i < options.buffer_count; ++i )
+    {
+        auto* data = static_cast< std::byte* >( std::aligned_alloc( direct_alignment, options.buffer_size ) );
+        if ( data == nullptr )
+        {
+            return LTB_MAKE_UNEXPECTED_ERROR( "Failed to allocate io_uring buffers" );
+        }
+        writer->buffers_.push_back( { std::shared_ptr< std::byte >( data, []( auto* p ) { std::free( p ); } ) } );
+    }
+
+    return writer;
+}
+
+UringWriter::~UringWriter( )
+{
+    if ( file_ >= 0 )
+    {
+        close( );
+    }
+    if ( ring_.fd >= 0 )
+    {
+        ::close( ring_.fd );
+    }
+}
+
+auto UringWriter::append( void const* data, std::size_t size ) -> bool
+{
+    auto const* bytes = static_cast< std::byte const* >( data );
+
+    while ( size > 0UL && !failed_ )
+    {
+        auto&      buffer = buffers_[ current_ ];
+        auto const count  = std::min( size, buffer_size_ - buffer.used );
+        std::memcpy( buffer.data.get( ) + buffer.used, bytes, count );
+
+        buffer.used += count;
+        file_size_ += count;
+        bytes += count;
+        size -= count;
+
+        if ( buffer.used == buffer_size_ && !submit_current( ) )
+        {
+            failed_ = true;
+        }
+    }
+    return !failed_;
+}
+
+auto UringWriter::close( ) -> bool
+{
+    if ( file_ < 0 )
+    {
+        return !failed_;
+    }
+    if ( buffers_.empty( ) )
+    {
+        // `create` failed after opening the file, so nothing was written to it.
+        ::close( file_ );
+        file_ = -1;
+        return false;
+    }
+
+    // Direct writes must cover whole blocks, so the last one is padded and the file is
+    // truncated back to its real size once everything has landed.
+    auto& last = buffers_[ current_ ];
+    if ( last.used > 0UL && !failed_ )
+    {
+        auto const used = last.used;
+        if ( direct_ )
+        {
+            auto const padded = ( used + direct_alignment - 1UL ) / direct_alignment * direct_alignment;
+            std::memset( last.data.get( ) + used, 0, padded - used );
+            last.used = padded;
+        }
+        failed_ = !submit_current( );
+    }
+
+    if ( !complete( static_cast< unsigned >( in_flight_ ) ) )
+    {
+        failed_ = true;
+    }
+    if ( direct_ && ::ftruncate( file_, static_cast< off_t >( file_size_ ) ) != 0 )
+    {
+        failed_ = true;
+    }
+
+    ::close( file_ );
+    file_ = -1;
+    return !failed_;
+}
+
+auto UringWriter::is_direct( ) const -> bool
+{
+    return direct_;
+}
+
+auto UringWriter::submit_current( ) -> bool
+{
+    auto& buffer = buffers_[ current_ ];
+
+    // Every buffer has its own submission entry, so the queue can never overflow.
+    auto const tail  = *ring_.sq_tail;
+    auto const index = tail & *ring_.sq_mask;
+    auto*      entry = reinterpret_cast< io_uring_sqe* >( ring_.sqes.get( ) ) + index;
+
+    std::memset( entry, 0, sizeof( *entry ) );
+    entry->opcode    = IORING_OP_WRITE;
+    entry->fd        = file_;
+    entry->addr      = reinterpret_cast< std::uint64_t >( buffer.data.get( ) );
+    entry->len       = static_cast< std::uint32_t >( buffer.used );
+    entry->off       = submitted_;
+    entry->user_data = current_;
+
+    ring_.sq_array[ index ] = index;
+    shared_index( ring_.sq_tail ).store( tail + 1U, std::memory_order_release );
+
+    if ( io_uring_enter( ring_.fd, 1U, 0U, 0U ) < 0 )
+    {
+        return false;
+    }
+
+    submitted_ += buffer.used;
+    buffer.in_flight = true;
+    ++in_flight_;
+
+    // Move on to the next buffer, waiting for its previous write if it is still in flight.
+    current_ = ( current_ + 1UL ) % buffers_.size( );
+    while ( buffers_[ current_ ].in_flight )
+    {
+        if ( !complete( 1U ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto UringWriter::complete( unsigned min_complete ) -> bool
+{
+    auto ok = true;
+
+    if ( min_complete > 0U && io_uring_enter( ring_.fd, 0U, min_complete, IORING_ENTER_GETEVENTS ) < 0 )
+    {
+        return false;
+    }
+
+    auto       head = *ring_.cq_head;
+    auto const tail = shared_index( ring_.cq_tail ).load( std::memory_order_acquire );
+    for ( ; head != tail; ++head )
+    {
+        auto const* entry  = reinterpret_cast< io_uring_cqe const* >( ring_.cqes ) + ( head & *ring_.cq_mask );
+        auto&       buffer = buffers_[ entry->user_data ];
+
+        // Short writes to regular files only happen when the disk is full.
+        if ( entry->res < 0 || static_cast< std::size_t >( entry->res ) != buffer.used )
+        {
+            errno = ( entry->res < 0 ) ? -entry->res : ENOSPC;
+            ok    = false;
+        }
+        buffer.used      = 0UL;
+        buffer.in_flight = false;
+        --in_flight_;
+    }
+    shared_index( ring_.cq_head ).store( head, std::memory_order_release );
+    return ok;
+}
+
+#else
+
+auto UringWriter::create( std::filesystem::path const&, UringWriterOptions const& )
+    -> Expected< std::unique_ptr< UringWriter > >
+{
+    return LTB_MAKE_UNEXPECTED_ERROR( "io_uring support was not built" );
+}
+
+UringWriter::~UringWriter( ) = default;
+
+auto UringWriter::append( void const*, std::size_t ) -> bool
+{
+    return false;
+}
+
+auto UringWriter::close( ) -> bool
+{
+    return false;
+}
+
+auto UringWriter::is_direct( ) const -> bool
+{
+    return false;
+}
+
+auto UringWriter::submit_current( ) -> bool
+{
+    return false;
+}
+
+auto UringWriter::complete( unsigned ) -> bool
+{
+    return false;
+}
+
+#endif
+
+} // namespace ltb::utils
@@ -0,0 +1,98 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/utils/expected.hpp"
+
+// standard
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace ltb::utils
+{
+
+struct UringWriterOptions
+{
+    std::size_t buffer_count = 8UL;             ///< Writes kept in flight at once
+    std::size_t buffer_size  = 1024UL * 1024UL; ///< A multiple of `UringWriter::direct_alignment`
+};
+
+/// \brief Appends to a new file through io_uring, keeping several aligned buffers in flight.
+///
+/// Appends are copied into the current buffer, and each full buffer is submitted as one
+/// write while the next one fills. The caller only waits when every buffer is still being
+/// written. The file is opened with `O_DIRECT` where the filesystem supports it, which
+/// keeps large recordings from pushing everything else out of the page cache.
+///
+/// Talks to the kernel with raw system calls so there is nothing extra to link. Only
+/// available on Linux builds with `LTB_JOYSTICKS_USE_IO_URING`; `create` fails otherwise,
+/// and also when the kernel does not allow io_uring (it is often disabled in containers) or
+/// is too old to write with it (before 5.6).
+class UringWriter
+{
+public:
+    static constexpr auto direct_alignment = std::size_t( 4096 );
+
+    static auto create( std::filesystem::path const& path, UringWriterOptions const& options = { } )
+        -> Expected< std::unique_ptr< UringWriter > >;
+
+    ~UringWriter( );
+
+    UringWriter( UringWriter const& )                    = delete;
+    auto operator=( UringWriter const& ) -> UringWriter& = delete;
+
+    auto append( void const* data, std::size_t size ) -> bool;
+
+    /// \brief Write whatever is buffered, wait for every write to finish, and close the file.
+    auto close( ) -> bool;
+
+    [[nodiscard]] auto is_direct( ) const -> bool;
+
+private:
+    struct Buffer
+    {
+        std::shared_ptr< std::byte > data      = nullptr;
+        std::size_t                  used      = 0UL;
+        bool                         in_flight = false;
+    };
+
+    struct Ring
+    {
+        int                          fd       = -1;
+        std::shared_ptr< std::byte > sq       = nullptr;
+        std::shared_ptr< std::byte > cq       = nullptr; ///< Shares `sq`'s mapping on newer kernels
+        std::shared_ptr< std::byte > sqes     = nullptr;
+        std::uint32_t*               sq_tail  = nullptr;
+        std::uint32_t*               sq_mask  = nullptr;
+        std::uint32_t*               sq_array = nullptr;
+        std::uint32_t*               cq_head  = nullptr;
+        std::uint32_t*               cq_tail  = nullptr;
+        std::uint32_t*               cq_mask  = nullptr;
+        std::byte*                   cqes     = nullptr;
+    };
+
+    int                   file_        = -1;
+    bool                  direct_      = false;
+    Ring                  ring_        = { };
+    std::vector< Buffer > buffers_     = { };
+    std::size_t           current_     = 0UL; ///< The buffer being filled
+    std::size_t           buffer_size_ = 0UL;
+    std::uint64_t         submitted_   = 0UL; ///< File offset of the next write
+    std::uint64_t         file_size_   = 0UL; ///< Bytes appended so far
+    std::size_t           in_flight_   = 0UL;
+    bool                  failed_      = false;
+
+    UringWriter( ) = default;
+
+    auto submit_current( ) -> bool;
+
+    /// \brief Reap finished writes, waiting for at least `min_complete` of them.
+    auto complete( unsigned min_complete ) -> bool;
+};
+
+} // namespace ltb::utils
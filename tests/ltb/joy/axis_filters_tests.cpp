@@ -0,0 +1,354 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/axis_filters.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto two_pi = 6.283185307179586;
+
+/// \brief The rate the biquads are designed for before one is measured, so tests sampled
+///        at it are never redesigned.
+constexpr auto sample_rate_hz   = 1'000.0;
+constexpr auto sample_period_us = std::int64_t( 1'000 );
+
+constexpr auto pad_guid   = "03000000de280000ff11000001000000";
+constexpr auto stick_guid = "030000006d04000015c2000010010000";
+
+auto filter_of( FilterType type, float cutoff_hz ) -> AxisFilter
+{
+    auto filter      = AxisFilter{ };
+    filter.type      = type;
+    filter.cutoff_hz = cutoff_hz;
+    return filter;
+}
+
+/// \brief A new frame of every device, with nothing processed yet.
+auto frame_of( std::vector< Joystick > joysticks, std::size_t frame ) -> std::vector< Joystick >
+{
+    for ( auto& joystick : joysticks )
+    {
+        joystick.timestamp_us = static_cast< std::int64_t >( frame ) * sample_period_us;
+        for ( auto a = 0UL; a < joystick.axes.size( ); ++a )
+        {
+            auto const t       = static_cast< double >( frame + a * 7UL ) + joystick.device_id * 3.0;
+            joystick.axes[ a ] = static_cast< float >( 0.8 * std::sin( t * 0.02 ) + 0.15 * std::sin( t * 0.9 ) );
+        }
+        joystick.processed_axes.clear( );
+    }
+    return joysticks;
+}
+
+auto test_joystick( std::string const& guid, int device_id, std::size_t axis_count ) -> Joystick
+{
+    auto joystick      = Joystick{ };
+    joystick.guid      = guid;
+    joystick.device_id = device_id;
+    joystick.axes      = std::vector< float >( axis_count );
+    return joystick;
+}
+
+/// \brief One axis filtered in double precision, started at its first input like the bank.
+class ReferenceFilter
+{
+public:
+    explicit ReferenceFilter( AxisFilter filter )
+        : filter_( filter )
+    {
+        // The low-pass from Robert Bristow-Johnson's "Audio EQ Cookbook".
+        auto const w0    = two_pi * double( filter.cutoff_hz ) / sample_rate_hz;
+        auto const alpha = std::sin( w0 ) / ( 2.0 * double( filter.q ) );
+        auto const a0    = 1.0 + alpha;
+        b0_              = ( 1.0 - std::cos( w0 ) ) * 0.5 / a0;
+        b1_              = ( 1.0 - std::cos( w0 ) ) / a0;
+        a1_              = -2.0 * std::cos( w0 ) / a0;
+        a2_              = ( 1.0 - alpha ) / a0;
+    }
+
+    auto operator( )( double input ) -> double
+    {
+        auto const dt = 1.0 / sample_rate_hz;
+        if ( !started_ )
+        {
+            started_  = true;
+            previous_ = input;
+            z1_       = input * ( 1.0 - b0_ );
+            z2_       = input * ( b0_ - a2_ );
+        }
+
+        switch ( filter_.type )
+        {
+            case FilterType::None:
+                return input;
+            case FilterType::Ema:
+                previous_ = smooth( previous_, input, dt * two_pi * double( filter_.cutoff_hz ) );
+                return previous_;
+            case FilterType::OneEuro:
+            {
+                auto const speed   = ( input - previous_ ) / dt;
+                auto const speed_w = dt * two_pi * double( filter_.derivative_cutoff_hz );
+                derivative_        = smooth( derivative_, speed, speed_w );
+                auto const cutoff  = double( filter_.min_cutoff_hz ) + double( filter_.beta ) * std::abs( derivative_ );
+                previous_          = smooth( previous_, input, dt * two_pi * cutoff );
+                return previous_;
+            }
+            case FilterType::Biquad:
+            {
+                auto const output = b0_ * input + z1_;
+                z1_               = b1_ * input - a1_ * output + z2_;
+                z2_               = b0_ * input - a2_ * output;
+                return output;
+            }
+        }
+        return input;
+    }
+
+private:
+    AxisFilter filter_;
+    bool       started_    = false;
+    double     previous_   = 0.0;
+    double     derivative_ = 0.0;
+    double     b0_         = 0.0;
+    double     b1_         = 0.0;
+    double     a1_         = 0.0;
+    double     a2_         = 0.0;
+    double     z1_         = 0.0;
+    double     z2_         = 0.0;
+
+    static auto smooth( double previous, double input, double w ) -> double
+    {
+        return previous + w / ( 1.0 + w ) * ( input - previous );
+    }
+};
+
+/// \brief Every filter type, unevenly mixed across more axes than any SIMD level has lanes.
+auto mixed_filters( ) -> DeviceFilters
+{
+    auto one_euro          = filter_of( FilterType::OneEuro, 0.f );
+    one_euro.min_cutoff_hz = 2.f;
+    one_euro.beta          = 0.3f;
+
+    auto filters = DeviceFilters{ };
+    for ( auto a = 0UL; a < 23UL; ++a )
+    {
+        auto const cutoff_hz = 5.f + static_cast< float >( a );
+        switch ( a % 5UL )
+        {
+            case 0UL:
+            case 3UL:
+                filters.axes.push_back( filter_of( FilterType::Ema, cutoff_hz ) );
+                break;
+            case 1UL:
+                filters.axes.push_back( one_euro );
+                break;
+            case 2UL:
+                filters.axes.push_back( filter_of( FilterType::Biquad, cutoff_hz ) );
+                break;
+            default:
+                filters.axes.push_back( filter_of( FilterType::None, cutoff_hz ) );
+                break;
+        }
+    }
+    return filters;
+}
+
+auto matches_reference_filters( ) -> void
+{
+    auto const filters = mixed_filters( );
+    auto       bank    = FilterBank{ };
+    bank.set_filters( pad_guid, filters );
+
+    // The stick has fewer axes than the pad has filters, and uses the default past its own.
+    bank.set_default_filter( filter_of( FilterType::Biquad, 40.f ) );
+    auto stick_filters = DeviceFilters{ };
+    stick_filters.axes = { filter_of( FilterType::Ema, 3.f ) };
+    bank.set_filters( stick_guid, stick_filters );
+
+    auto const devices = std::vector< Joystick >{
+        test_joystick( pad_guid, 0, filters.axes.size( ) ),
+        test_joystick( stick_guid, 1, 3UL ),
+    };
+
+    auto references = std::vector< ReferenceFilter >{ };
+    for ( auto const& filter : filters.axes )
+    {
+        references.emplace_back( filter );
+    }
+    references.emplace_back( stick_filters.axes[ 0 ] );
+    references.emplace_back( bank.default_filter( ) );
+    references.emplace_back( bank.default_filter( ) );
+
+    auto error     = 0.0;
+    auto unchanged = true;
+    for ( auto f = 0UL; f < 2'000UL; ++f )
+    {
+        auto joysticks = frame_of( devices, f );
+        bank.process( joysticks );
+
+        auto r = 0UL;
+        for ( auto const& joystick : joysticks )
+        {
+            for ( auto a = 0UL; a < joystick.axes.size( ); ++a, ++r )
+            {
+                auto const target = references[ r ]( double( joystick.axes[ a ] ) );
+                error             = std::max( error, std::abs( double( joystick.processed_axes[ a ] ) - target ) );
+            }
+        }
+        for ( auto a = 4UL; a < filters.axes.size( ); a += 5UL )
+        {
+            unchanged = unchanged && joysticks[ 0 ].processed_axes[ a ] == joysticks[ 0 ].axes[ a ];
+        }
+    }
+    LTB_CHECK( error < 1e-4 );
+    LTB_CHECK( unchanged );
+
+    auto const& stats = bank.stats( );
+    LTB_CHECK( stats.ema_count == 9UL + 1UL );
+    LTB_CHECK( stats.one_euro_count == 5UL );
+    LTB_CHECK( stats.biquad_count == 5UL + 2UL );
+    LTB_CHECK( std::abs( stats.sample_rate_hz - sample_rate_hz ) < 1e-6 );
+    LTB_CHECK( bank.devices( ).size( ) == 2UL );
+}
+
+/// \brief Steady-state amplitude of a sine at `frequency_hz` through `filter`.
+auto gain_at( AxisFilter const& filter, double frequency_hz ) -> double
+{
+    auto bank = FilterBank{ };
+    bank.set_default_filter( filter );
+
+    auto joysticks = std::vector< Joystick >{ test_joystick( pad_guid, 0, 1UL ) };
+    auto peak      = 0.0;
+    for ( auto f = 0UL; f < 4'000UL; ++f )
+    {
+        joysticks[ 0 ].timestamp_us = static_cast< std::int64_t >( f ) * sample_period_us;
+        joysticks[ 0 ].axes[ 0 ]    = float( std::sin( two_pi * frequency_hz * double( f ) / sample_rate_hz ) );
+        joysticks[ 0 ].processed_axes.clear( );
+        bank.process( joysticks );
+        if ( f >= 3'000UL )
+        {
+            peak = std::max( peak, std::abs( double( joysticks[ 0 ].processed_axes[ 0 ] ) ) );
+        }
+    }
+    return peak;
+}
+
+auto has_low_pass_responses( ) -> void
+{
+    // The biquad is maximally flat: -3 dB at its cutoff and falling at 40 dB per decade.
+    auto const biquad = filter_of( FilterType::Biquad, 20.f );
+    LTB_CHECK( std::abs( gain_at( biquad, 1.0 ) - 1.0 ) < 1e-2 );
+    LTB_CHECK( std::abs( gain_at( biquad, 20.0 ) - std::sqrt( 0.5 ) ) < 2e-2 );
+    LTB_CHECK( gain_at( biquad, 200.0 ) < 1.5e-2 );
+
+    // The EMA falls at 20 dB per decade.
+    auto const ema = filter_of( FilterType::Ema, 20.f );
+    LTB_CHECK( std::abs( gain_at( ema, 1.0 ) - 1.0 ) < 1e-2 );
+    LTB_CHECK( std::abs( gain_at( ema, 20.0 ) - std::sqrt( 0.5 ) ) < 5e-2 );
+    LTB_CHECK( gain_at( ema, 200.0 ) < 0.15 );
+
+    // One-Euro smooths a still axis at its minimum cutoff and follows fast movement.
+    auto one_euro          = filter_of( FilterType::OneEuro, 0.f );
+    one_euro.min_cutoff_hz = 1.f;
+    one_euro.beta          = 0.f;
+    auto const still       = gain_at( one_euro, 10.0 );
+    one_euro.beta          = 1.f;
+    LTB_CHECK( still < 0.2 );
+    LTB_CHECK( gain_at( one_euro, 10.0 ) > 0.9 );
+
+    // The filters start at their first input rather than ramping up from zero.
+    for ( auto const type : { FilterType::Ema, FilterType::OneEuro, FilterType::Biquad } )
+    {
+        auto bank = FilterBank{ };
+        bank.set_default_filter( filter_of( type, 5.f ) );
+        auto joysticks = std::vector< Joystick >{ test_joystick( pad_guid, 0, 1UL ) };
+        joysticks[ 0 ].axes[ 0 ] = 0.75f;
+        bank.process( joysticks );
+        LTB_CHECK( std::abs( joysticks[ 0 ].processed_axes[ 0 ] - 0.75f ) < 1e-6f );
+    }
+}
+
+/// \brief Editing one device's filters, even to another type, leaves every other lane as it
+///        would have been.
+auto keeps_state_of_other_devices( ) -> void
+{
+    auto const filters = mixed_filters( );
+    auto const devices = std::vector< Joystick >{
+        test_joystick( pad_guid, 0, filters.axes.size( ) ),
+        test_joystick( stick_guid, 1, 2UL ),
+    };
+
+    auto stick_filters = DeviceFilters{ };
+    stick_filters.axes = { filter_of( FilterType::Biquad, 10.f ), filter_of( FilterType::Ema, 10.f ) };
+
+    auto edited    = FilterBank{ };
+    auto untouched = FilterBank{ };
+    for ( auto* bank : { &edited, &untouched } )
+    {
+        bank->set_filters( pad_guid, filters );
+        bank->set_filters( stick_guid, stick_filters );
+    }
+
+    auto error = 0.0;
+    for ( auto f = 0UL; f < 1'000UL; ++f )
+    {
+        if ( f == 300UL )
+        {
+            stick_filters.axes[ 0 ].cutoff_hz = 30.f; // Same type, updated in place
+            edited.set_filters( stick_guid, stick_filters );
+        }
+        if ( f == 600UL )
+        {
+            stick_filters.axes[ 1 ].type = FilterType::OneEuro; // Lanes are laid out again
+            edited.set_filters( stick_guid, stick_filters );
+        }
+
+        auto joysticks = frame_of( devices, f );
+        auto expected  = joysticks;
+        edited.process( joysticks );
+        untouched.process( expected );
+        for ( auto a = 0UL; a < joysticks[ 0 ].axes.size( ); ++a )
+        {
+            auto const difference = joysticks[ 0 ].processed_axes[ a ] - expected[ 0 ].processed_axes[ a ];
+            error                 = std::max( error, std::abs( double( difference ) ) );
+        }
+    }
+    LTB_CHECK( error < 1e-6 );
+    LTB_CHECK( edited.stats( ).one_euro_count == untouched.stats( ).one_euro_count + 1UL );
+}
+
+auto parses_to( std::string_view text, FilterType type ) -> bool
+{
+    auto const parsed = parse_filter_type( text );
+    return parsed && *parsed == type;
+}
+
+auto parses_filter_types( ) -> void
+{
+    LTB_CHECK( parses_to( "none", FilterType::None ) );
+    LTB_CHECK( parses_to( "ema", FilterType::Ema ) );
+    LTB_CHECK( parses_to( "one-euro", FilterType::OneEuro ) );
+    LTB_CHECK( parses_to( "biquad", FilterType::Biquad ) );
+    LTB_CHECK( !parse_filter_type( "kalman" ) );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::matches_reference_filters( );
+    ltb::joy::has_low_pass_responses( );
+    ltb::joy::keeps_state_of_other_devices( );
+    ltb::joy::parses_filter_types( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,272 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/axis_mapping.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Curves are sampled into tables, so smooth ones are only matched this closely.
+constexpr auto curve_tolerance = 1e-4;
+
+constexpr auto pad_guid   = "03000000de280000ff11000001000000";
+constexpr auto stick_guid = "030000006d04000015c2000010010000";
+
+/// \brief More axes than any SIMD level has lanes, so both the vector and scalar loops run.
+constexpr auto pad_axis_count = 21UL;
+
+auto test_joystick( std::string const& guid, int device_id, std::vector< float > axes ) -> Joystick
+{
+    auto joystick      = Joystick{ };
+    joystick.name      = "Test Device";
+    joystick.guid      = guid;
+    joystick.device_id = device_id;
+    joystick.axes      = std::move( axes );
+    return joystick;
+}
+
+/// \brief Every input from -1 to 1 in steps of `1 / 64` across `pad_axis_count` axes, so
+///        inputs land exactly on the deadzone edges used below.
+auto sweep( std::size_t first ) -> std::vector< float >
+{
+    auto axes = std::vector< float >( pad_axis_count );
+    for ( auto a = 0UL; a < axes.size( ); ++a )
+    {
+        auto const step = static_cast< long >( ( first + a ) % 129UL ) - 64L;
+        axes[ a ]       = static_cast< float >( step ) / 64.f;
+    }
+    return axes;
+}
+
+/// \brief The value `mapping` should give `value`, computed from the curve itself rather
+///        than its table.
+auto expected( AxisMapping const& mapping, float deadzone, double value ) -> double
+{
+    auto const range = std::max( 1.0 - double( deadzone ) - double( mapping.outer_deadzone ), 1e-6 );
+    auto const input = std::clamp( ( std::abs( value ) - double( deadzone ) ) / range, 0.0, 1.0 );
+    if ( input <= 0.0 )
+    {
+        return 0.0;
+    }
+
+    auto curve = input;
+    if ( mapping.curve == ResponseCurve::Power )
+    {
+        curve = std::pow( input, double( mapping.exponent ) );
+    }
+    else if ( mapping.curve == ResponseCurve::Table )
+    {
+        auto const position = input * double( mapping.table.size( ) - 1UL );
+        auto const index    = std::min( static_cast< std::size_t >( position ), mapping.table.size( ) - 2UL );
+        auto const fraction = position - double( index );
+        curve = mapping.table[ index ] + fraction * double( mapping.table[ index + 1UL ] - mapping.table[ index ] );
+    }
+    auto const anti = double( mapping.anti_deadzone );
+    return std::copysign( anti + ( 1.0 - anti ) * std::clamp( curve, 0.0, 1.0 ), value );
+}
+
+/// \brief Largest difference between `actual` and what each axis mapping should give.
+auto max_error(
+    std::vector< float > const&       inputs,
+    std::vector< float > const&       actual,
+    std::vector< AxisMapping > const& mappings,
+    std::vector< float > const&       deadzones
+) -> double
+{
+    auto error = 0.0;
+    for ( auto a = 0UL; a < inputs.size( ); ++a )
+    {
+        auto const& mapping = mappings[ a % mappings.size( ) ];
+        auto const  target  = expected( mapping, deadzones[ a % deadzones.size( ) ], double( inputs[ a ] ) );
+        error               = std::max( error, std::abs( double( actual[ a ] ) - target ) );
+    }
+    return error;
+}
+
+auto passes_through_without_mapping( ) -> void
+{
+    auto mapper    = AxisMapper{ };
+    auto joysticks = std::vector< Joystick >{ test_joystick( pad_guid, 0, sweep( 0UL ) ) };
+    mapper.process( joysticks );
+    LTB_CHECK( joysticks[ 0 ].processed_axes == joysticks[ 0 ].axes );
+
+    // Values from earlier stages are what gets mapped, or passed through.
+    joysticks[ 0 ].processed_axes = sweep( 5UL );
+    mapper.process( joysticks );
+    LTB_CHECK( joysticks[ 0 ].processed_axes == sweep( 5UL ) );
+    LTB_CHECK( mapper.stats( ).axis_count == pad_axis_count );
+    LTB_CHECK( mapper.devices( ).size( ) == 1UL );
+}
+
+auto maps_every_curve( ) -> void
+{
+    auto linear           = AxisMapping{ };
+    linear.deadzone       = 0.125f;
+    linear.outer_deadzone = 0.0625f;
+    linear.anti_deadzone  = 0.2f;
+
+    auto power     = AxisMapping{ };
+    power.deadzone = 0.25f;
+    power.curve    = ResponseCurve::Power;
+    power.exponent = 3.f;
+
+    auto table           = AxisMapping{ };
+    table.outer_deadzone = 0.25f;
+    table.curve          = ResponseCurve::Table;
+    table.table          = { 0.f, 0.5f, 0.6f, 0.7f, 1.f }; // Points on table samples, so it is exact
+
+    auto squared     = power;
+    squared.exponent = 2.f;
+
+    auto mapping = DeviceMapping{ };
+    for ( auto a = 0UL; a < pad_axis_count; ++a )
+    {
+        mapping.axes.push_back( std::vector< AxisMapping >{ linear, power, table, squared }[ a % 4UL ] );
+    }
+    auto const deadzones = std::vector< float >{ linear.deadzone, power.deadzone, table.deadzone, squared.deadzone };
+
+    auto mapper = AxisMapper{ };
+    mapper.set_mapping( pad_guid, mapping );
+    LTB_CHECK( mapper.mapping( pad_guid ).axes.size( ) == pad_axis_count );
+    LTB_CHECK( mapper.mapping( stick_guid ).axes.empty( ) );
+
+    auto error = 0.0;
+    for ( auto first = 0UL; first < 129UL; ++first )
+    {
+        auto joysticks = std::vector< Joystick >{ test_joystick( pad_guid, 0, sweep( first ) ) };
+        mapper.process( joysticks );
+        auto const& pad = joysticks[ 0 ];
+        error           = std::max( error, max_error( pad.axes, pad.processed_axes, mapping.axes, deadzones ) );
+    }
+    LTB_CHECK( error < curve_tolerance );
+    LTB_CHECK( mapper.stats( ).table_count == 4UL );
+
+    // Deadzone edges are exact: zero inside, and full deflection past the outer deadzone.
+    auto joysticks = std::vector< Joystick >{ test_joystick( pad_guid, 0, std::vector< float >( pad_axis_count ) ) };
+    joysticks[ 0 ].axes[ 0 ] = linear.deadzone;
+    joysticks[ 0 ].axes[ 1 ] = -power.deadzone;
+    joysticks[ 0 ].axes[ 2 ] = -( 1.f - table.outer_deadzone );
+    joysticks[ 0 ].axes[ 4 ] = 1.f - linear.outer_deadzone;
+    joysticks[ 0 ].axes[ 6 ] = 0.5f * ( 1.f - table.outer_deadzone );
+    mapper.process( joysticks );
+
+    auto const& processed = joysticks[ 0 ].processed_axes;
+    LTB_CHECK( processed[ 0 ] == 0.f );
+    LTB_CHECK( processed[ 1 ] == 0.f );
+    LTB_CHECK( processed[ 2 ] == -1.f );
+    LTB_CHECK( processed[ 4 ] == 1.f );
+    LTB_CHECK( std::abs( processed[ 6 ] - 0.6f ) < 1e-5f );
+}
+
+auto maps_sticks_by_distance( ) -> void
+{
+    auto stick                  = StickPair{ };
+    stick.x_axis                = 1UL;
+    stick.y_axis                = 0UL;
+    stick.mapping.deadzone      = 0.2f;
+    stick.mapping.anti_deadzone = 0.1f;
+    stick.mapping.curve         = ResponseCurve::Power;
+    stick.mapping.exponent      = 2.f;
+
+    auto mapping = DeviceMapping{ };
+    mapping.sticks.push_back( stick );
+    mapping.sticks.push_back( { 2UL, 2UL, { } } ); // Ignored: both axes are the same
+    mapping.axes.resize( 3UL );
+    mapping.axes[ 0 ].deadzone = 0.9f; // Replaced by the stick's mapping
+    mapping.axes[ 2 ].deadzone = 0.5f;
+
+    auto mapper = AxisMapper{ };
+    mapper.set_mapping( stick_guid, mapping );
+
+    auto error = 0.0;
+    for ( auto step = 0; step < 400; ++step )
+    {
+        auto const angle    = static_cast< float >( step ) * 0.1f;
+        auto const distance = static_cast< float >( step % 40 ) / 39.f;
+        auto const x        = distance * std::cos( angle );
+        auto const y        = distance * std::sin( angle );
+
+        auto joysticks = std::vector< Joystick >{ test_joystick( stick_guid, 3, { y, x, 0.25f } ) };
+        mapper.process( joysticks );
+        auto const& processed = joysticks[ 0 ].processed_axes;
+
+        // The magnitude is mapped like an axis, and the direction is kept.
+        auto const target = expected( stick.mapping, stick.mapping.deadzone, double( std::hypot( x, y ) ) );
+        auto const scale  = ( distance > 0.f ) ? target / double( std::hypot( x, y ) ) : 0.0;
+        error             = std::max( error, std::abs( double( processed[ 1 ] ) - double( x ) * scale ) );
+        error             = std::max( error, std::abs( double( processed[ 0 ] ) - double( y ) * scale ) );
+        LTB_CHECK( processed[ 2 ] == 0.f );
+    }
+    LTB_CHECK( error < curve_tolerance );
+    LTB_CHECK( mapper.stats( ).stick_count == 1UL );
+
+    // The deadzone is round: a diagonal inside it reads as zero on both axes.
+    auto joysticks = std::vector< Joystick >{ test_joystick( stick_guid, 3, { 0.14f, 0.14f, 0.f } ) };
+    mapper.process( joysticks );
+    LTB_CHECK( joysticks[ 0 ].processed_axes[ 0 ] == 0.f && joysticks[ 0 ].processed_axes[ 1 ] == 0.f );
+}
+
+auto widens_with_auto_deadzones( ) -> void
+{
+    auto mapping = DeviceMapping{ };
+    mapping.axes.resize( 2UL );
+    mapping.axes[ 0 ].deadzone = 0.1f;
+    mapping.axes[ 1 ].deadzone = 0.4f;
+
+    auto mapper = AxisMapper{ };
+    mapper.set_mapping( pad_guid, mapping );
+    mapper.set_auto_deadzones( pad_guid, { 0.3f, 0.2f, 0.5f } );
+
+    // Two devices of the same model are mapped the same way, and others are left alone.
+    auto joysticks = std::vector< Joystick >{
+        test_joystick( pad_guid, 0, { 0.25f, 0.35f, 0.45f } ),
+        test_joystick( stick_guid, 1, { 0.25f, 0.35f } ),
+        test_joystick( pad_guid, 2, { 0.35f, 0.45f, 0.55f } ),
+    };
+    mapper.process( joysticks );
+    LTB_CHECK( joysticks[ 0 ].processed_axes == std::vector< float >( { 0.f, 0.f, 0.f } ) );
+    LTB_CHECK( joysticks[ 1 ].processed_axes == joysticks[ 1 ].axes );
+    LTB_CHECK( joysticks[ 2 ].processed_axes[ 0 ] > 0.f );
+    LTB_CHECK( joysticks[ 2 ].processed_axes[ 1 ] > 0.f );
+    LTB_CHECK( joysticks[ 2 ].processed_axes[ 2 ] > 0.f );
+    LTB_CHECK( mapper.devices( ).size( ) == 2UL );
+
+    auto const error = max_error(
+        joysticks[ 2 ].axes,
+        joysticks[ 2 ].processed_axes,
+        { mapping.axes[ 0 ], mapping.axes[ 1 ], AxisMapping{ } },
+        { 0.3f, 0.4f, 0.5f }
+    );
+    LTB_CHECK( error < curve_tolerance );
+
+    // A new mapping takes effect on the next frame.
+    mapper.set_mapping( pad_guid, { } );
+    mapper.set_auto_deadzones( pad_guid, { } );
+    for ( auto& joystick : joysticks )
+    {
+        joystick.processed_axes.clear( );
+    }
+    mapper.process( joysticks );
+    LTB_CHECK( joysticks[ 0 ].processed_axes == joysticks[ 0 ].axes );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::passes_through_without_mapping( );
+    ltb::joy::maps_every_curve( );
+    ltb::joy::maps_sticks_by_distance( );
+    ltb::joy::widens_with_auto_deadzones( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,241 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/axis_predictor.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto pad_guid   = "03000000de280000ff11000001000000";
+constexpr auto stick_guid = "030000006d04000015c2000010010000";
+
+constexpr auto sample_interval_us = std::int64_t( 1'000 );
+constexpr auto start_us           = std::int64_t( 1'000'000 );
+
+auto test_joystick( int device_id, std::string const& guid ) -> Joystick
+{
+    auto joystick      = Joystick{ };
+    joystick.name      = "Test Pad";
+    joystick.guid      = guid;
+    joystick.device_id = device_id;
+    joystick.axes      = std::vector< float >( 2UL );
+    return joystick;
+}
+
+/// \brief Sample `joystick` every millisecond from `first` to `last`, with its axes at
+///        `position( axis, seconds )`, predicting each sample `horizon_us` ahead.
+auto play(
+    AxisPredictor&                                       predictor,
+    Joystick&                                            joystick,
+    std::int64_t                                         first,
+    std::int64_t                                         last,
+    std::int64_t                                         horizon_us,
+    std::function< float( std::size_t, double ) > const& position
+) -> void
+{
+    auto joysticks = std::vector< Joystick >{ joystick };
+    for ( auto s = first; s < last; ++s )
+    {
+        auto& device        = joysticks[ 0 ];
+        device.timestamp_us = start_us + s * sample_interval_us;
+        for ( auto a = 0UL; a < device.axes.size( ); ++a )
+        {
+            device.axes[ a ] = position( a, static_cast< double >( device.timestamp_us ) * 1e-6 );
+        }
+        predictor.process( joysticks, device.timestamp_us + horizon_us );
+    }
+    joystick = joysticks[ 0 ];
+}
+
+/// \brief Axis 0 rises and axis 1 falls, each at a steady speed.
+auto ramp( std::size_t axis, double seconds ) -> float
+{
+    auto const t = seconds - static_cast< double >( start_us ) * 1e-6;
+    return static_cast< float >( ( axis == 0UL ) ? -0.5 + 0.5 * t : 0.25 - 0.25 * t );
+}
+
+auto near( double actual, double expected, double tolerance ) -> bool
+{
+    return std::abs( actual - expected ) <= tolerance;
+}
+
+auto accumulates_errors( ) -> void
+{
+    auto error = PredictionError{ };
+    LTB_CHECK( error.predicted_rms( ) == 0.0 && error.held_rms( ) == 0.0 );
+
+    error.add( 0.5f, 0.25f, 0.5f );
+    error.add( 0.25f, 0.75f, 0.5f );
+    LTB_CHECK( error.sample_count == 2UL );
+    LTB_CHECK( error.predicted_squares == 0.0625 && error.held_squares == 0.125 );
+    LTB_CHECK( error.predicted_rms( ) == std::sqrt( 0.03125 ) && error.held_rms( ) == 0.25 );
+}
+
+auto scores_steady_motion( ) -> void
+{
+    // A horizon between samples scores each prediction against values interpolated halfway
+    // between the two samples around it.
+    constexpr auto horizon_us = std::int64_t( 2'500 );
+    constexpr auto scored     = 100UL;
+
+    auto predictor = AxisPredictor{ };
+    auto pad       = test_joystick( 0, pad_guid );
+
+    // Steady motion is predicted exactly once the first difference has been taken, and
+    // holding the last sample is always as far behind as the axis moves in the horizon.
+    play( predictor, pad, 0, 10, horizon_us, ramp );
+    predictor.reset( );
+    LTB_CHECK( predictor.stats( ).overall.sample_count == 0UL );
+    play( predictor, pad, 10, 10 + std::int64_t( scored ), horizon_us, ramp );
+
+    LTB_CHECK( near( predictor.stats( ).horizon_ms, 2.5, 1e-9 ) );
+    LTB_CHECK( near( pad.predicted_axes[ 0 ], ramp( 0UL, double( pad.timestamp_us + horizon_us ) * 1e-6 ), 1e-5 ) );
+
+    auto const& errors = predictor.errors( );
+    if ( !LTB_CHECK( errors.size( ) == 1UL && errors.count( 0 ) == 1UL ) )
+    {
+        return;
+    }
+    auto const& device = errors.at( 0 );
+    LTB_CHECK( device.name == "Test Pad" );
+    if ( !LTB_CHECK( device.axes.size( ) == 2UL ) )
+    {
+        return;
+    }
+    LTB_CHECK( device.axes[ 0 ].sample_count == scored && device.axes[ 1 ].sample_count == scored );
+    LTB_CHECK( device.overall.sample_count == 2UL * scored );
+    LTB_CHECK( predictor.stats( ).overall.sample_count == 2UL * scored );
+
+    LTB_CHECK( device.axes[ 0 ].predicted_rms( ) < 1e-5 );
+    LTB_CHECK( device.axes[ 1 ].predicted_rms( ) < 1e-5 );
+    LTB_CHECK( near( device.axes[ 0 ].held_rms( ), 0.5 * 2.5e-3, 1e-5 ) );
+    LTB_CHECK( near( device.axes[ 1 ].held_rms( ), 0.25 * 2.5e-3, 1e-5 ) );
+
+    auto const both = std::sqrt( ( 0.5 * 0.5 + 0.25 * 0.25 ) / 2.0 ) * 2.5e-3;
+    LTB_CHECK( near( device.overall.held_rms( ), both, 1e-5 ) );
+    LTB_CHECK( device.overall.held_squares == predictor.stats( ).overall.held_squares );
+
+    // Polling again without a new sample or a later display time scores nothing twice.
+    auto joysticks = std::vector< Joystick >{ pad };
+    for ( auto poll = 0; poll < 3; ++poll )
+    {
+        predictor.process( joysticks, pad.timestamp_us + horizon_us );
+    }
+    play( predictor, pad, 10 + std::int64_t( scored ), 20 + std::int64_t( scored ), horizon_us, ramp );
+    LTB_CHECK( predictor.errors( ).at( 0 ).axes[ 0 ].sample_count == scored + 10UL );
+}
+
+auto predicts_curved_motion( ) -> void
+{
+    // A stick swept back and forth is predicted closer than it is held, and predictions that
+    // overshoot the turning points are clamped to the axis range.
+    auto const sweep = []( std::size_t axis, double seconds ) {
+        return static_cast< float >( std::sin( 6.0 * seconds + double( axis ) ) );
+    };
+    auto predictor = AxisPredictor{ };
+    auto pad       = test_joystick( 0, pad_guid );
+    auto extreme   = 0.f;
+    for ( auto s = std::int64_t( 0 ); s < 3'000; ++s )
+    {
+        play( predictor, pad, s, s + 1, 20'000, sweep );
+        for ( auto const value : pad.predicted_axes )
+        {
+            extreme = std::max( extreme, std::abs( value ) );
+        }
+    }
+    LTB_CHECK( extreme == 1.f );
+
+    auto const& overall = predictor.stats( ).overall;
+    LTB_CHECK( overall.sample_count > 5'000UL );
+    LTB_CHECK( overall.predicted_rms( ) < 0.25 * overall.held_rms( ) );
+}
+
+auto limits_horizons( ) -> void
+{
+    auto predictor = AxisPredictor{ };
+    auto pad       = test_joystick( 0, pad_guid );
+
+    // Displays far past the last sample are predicted no further than the limit, and displays
+    // before it are not predicted at all.
+    play( predictor, pad, 0, 10, 10 * max_prediction_us, ramp );
+    LTB_CHECK( near( predictor.stats( ).horizon_ms, double( max_prediction_us ) * 1e-3, 1e-9 ) );
+    LTB_CHECK( near( pad.predicted_axes[ 0 ], pad.axes[ 0 ] + 0.5f * 0.05f, 1e-3 ) );
+
+    auto later = AxisPredictor{ };
+    play( later, pad, 0, 100, -sample_interval_us, ramp );
+    LTB_CHECK( predictor.stats( ).horizon_ms > 0.0 && later.stats( ).horizon_ms == 0.0 );
+    LTB_CHECK( pad.predicted_axes == pad.axes );
+    LTB_CHECK( later.stats( ).overall.sample_count == 0UL );
+}
+
+auto drops_unmeasured_predictions( ) -> void
+{
+    auto predictor = AxisPredictor{ };
+    auto pad       = test_joystick( 0, pad_guid );
+    play( predictor, pad, 0, 2, 0, ramp );
+
+    // More displays between two samples than can be kept drop the oldest predictions.
+    auto joysticks = std::vector< Joystick >{ pad };
+    for ( auto display = 1; display <= 100; ++display )
+    {
+        predictor.process( joysticks, pad.timestamp_us + display );
+    }
+    play( predictor, pad, 2, 3, 0, ramp );
+    LTB_CHECK( predictor.errors( ).at( 0 ).axes[ 0 ].sample_count == prediction_history );
+
+    // Predictions across a gap in the samples are never scored.
+    play( predictor, pad, 3, 4, 500, ramp );
+    play( predictor, pad, 1'000, 1'002, 500, ramp );
+    LTB_CHECK( predictor.errors( ).at( 0 ).axes[ 0 ].sample_count == prediction_history + 1UL );
+
+    // Another device reconnecting with the same ID starts over.
+    auto stick = test_joystick( 0, stick_guid );
+    play( predictor, stick, 2'000, 2'001, 500, ramp );
+    LTB_CHECK( predictor.errors( ).at( 0 ).axes[ 0 ].sample_count == 0UL );
+    LTB_CHECK( predictor.stats( ).device_count == 1UL );
+}
+
+auto predicts_processed_axes( ) -> void
+{
+    auto predictor = AxisPredictor{ };
+    auto pad       = test_joystick( 0, pad_guid );
+
+    // Whatever the pipeline produced is what is predicted, and it has no motion here.
+    auto joysticks                = std::vector< Joystick >{ pad };
+    joysticks[ 0 ].processed_axes = { 0.5f, -0.5f };
+    for ( auto s = std::int64_t( 0 ); s < 20; ++s )
+    {
+        joysticks[ 0 ].timestamp_us = start_us + s * sample_interval_us;
+        joysticks[ 0 ].axes         = { ramp( 0UL, double( joysticks[ 0 ].timestamp_us ) * 1e-6 ), 0.f };
+        predictor.process( joysticks, joysticks[ 0 ].timestamp_us + 4'000 );
+    }
+    LTB_CHECK( joysticks[ 0 ].predicted_axes == joysticks[ 0 ].processed_axes );
+
+    auto const& overall = predictor.stats( ).overall;
+    LTB_CHECK( overall.sample_count > 0UL && overall.predicted_squares == 0.0 && overall.held_squares == 0.0 );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::accumulates_errors( );
+    ltb::joy::scores_steady_motion( );
+    ltb::joy::predicts_curved_motion( );
+    ltb::joy::limits_horizons( );
+    ltb::joy::drops_unmeasured_predictions( );
+    ltb::joy::predicts_processed_axes( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,233 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/test_recordings.hpp"
+
+// project
+#include "ltb/joy/axis_pyramid.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto start_time_us = std::int64_t( 5'000'000 );
+
+/// \brief A power of two, so bucket boundaries fall exactly on sample times.
+constexpr auto sample_period_us = std::int64_t( 1'024 );
+
+/// \brief Not a multiple of `pyramid_base_samples`, so the last bucket is partial.
+constexpr auto pad_samples   = 1'000UL;
+constexpr auto stick_samples = 300UL;
+
+auto pad_axis( std::size_t sample, std::size_t axis ) -> float
+{
+    auto const t = static_cast< float >( sample );
+    return ( axis == 0UL ) ? std::sin( t * 0.05f ) : static_cast< float >( sample % 37UL ) / 36.f - 0.5f;
+}
+
+/// \brief A pad written as plain snapshots and a stick written as delta blocks, with the
+///        stick's values quantized like the blocks store them.
+auto test_recording( std::vector< std::vector< float > >& stick_axes ) -> std::vector< std::byte >
+{
+    auto bytes = testing::recording_header( start_time_us );
+
+    auto pad      = Joystick{ };
+    pad.name      = "Test Pad";
+    pad.guid      = "03000000de280000ff11000001000000";
+    pad.device_id = 2;
+    pad.axes      = { 0.f, 0.f };
+
+    auto stick      = Joystick{ };
+    stick.name      = "Test Stick";
+    stick.guid      = "030000006d04000015c2000010010000";
+    stick.device_id = 9;
+
+    append_device_record( pad, bytes );
+    append_device_record( stick, bytes );
+
+    auto encoder = SnapshotBlockEncoder{ };
+    for ( auto s = 0UL; s < pad_samples; ++s )
+    {
+        pad.timestamp_us = start_time_us + static_cast< std::int64_t >( s ) * sample_period_us;
+        pad.axes         = { pad_axis( s, 0UL ), pad_axis( s, 1UL ) };
+        append_snapshot_record( pad, bytes );
+
+        if ( s < stick_samples )
+        {
+            stick.timestamp_us = pad.timestamp_us + 1;
+            stick.axes         = { static_cast< float >( s ) / static_cast< float >( stick_samples ) };
+            encoder.add( stick, bytes );
+            quantize_axes( stick.axes );
+            stick_axes.push_back( stick.axes );
+        }
+    }
+    encoder.flush( bytes );
+    testing::finalize_recording( bytes );
+    return bytes;
+}
+
+auto is_empty( AxisSummary const& summary ) -> bool
+{
+    return summary.min > summary.max;
+}
+
+auto builds_and_summarizes( ) -> void
+{
+    auto       stick_axes = std::vector< std::vector< float > >{ };
+    auto const path       = testing::temporary_recording( "pyramid.ltbrec", test_recording( stick_axes ) );
+    testing::temporary_paths.push_back( pyramid_path( path ) );
+
+    LTB_CHECK( !AxisPyramid::open( path ) );
+    auto const pyramid = AxisPyramid::open_or_build( path );
+    if ( !LTB_CHECK( pyramid ) || !LTB_CHECK( pyramid->device_count( ) == 2UL ) )
+    {
+        return;
+    }
+    LTB_CHECK( pyramid->header( ).start_time_us == start_time_us );
+    LTB_CHECK( pyramid->header( ).source_size == std::filesystem::file_size( path ) );
+    LTB_CHECK( pyramid->begin_time_us( ) == start_time_us );
+
+    auto const& pad = pyramid->device( 0UL );
+    LTB_CHECK( pyramid->device_name( 0UL ) == "Test Pad" );
+    LTB_CHECK( pad.device_id == 2 );
+    LTB_CHECK( pad.axis_count == 2U );
+    LTB_CHECK( pad.sample_count == pad_samples );
+    LTB_CHECK( pad.last_time_us == start_time_us + std::int64_t( pad_samples - 1UL ) * sample_period_us );
+    LTB_CHECK( pyramid->end_time_us( ) == pad.last_time_us );
+
+    // 63 level 0 buckets halve to one in six more levels.
+    auto const base_count = ( pad_samples + pyramid_base_samples - 1UL ) / pyramid_base_samples;
+    LTB_CHECK( pad.level_count == 7U );
+
+    auto const& stick = pyramid->device( 1UL );
+    LTB_CHECK( pyramid->device_name( 1UL ) == "Test Stick" );
+    LTB_CHECK( stick.sample_count == stick_samples );
+    LTB_CHECK( stick.axis_count == 1U );
+
+    // One bucket over everything is read from the top level and is exact.
+    auto whole = std::vector< AxisSummary >( 1 );
+    for ( auto a = 0UL; a < pad.axis_count; ++a )
+    {
+        pyramid->summarize( 0UL, a, start_time_us, pad.last_time_us + 1, whole );
+
+        auto min  = std::numeric_limits< float >::infinity( );
+        auto max  = -min;
+        auto mean = 0.0;
+        for ( auto s = 0UL; s < pad_samples; ++s )
+        {
+            min = std::min( min, pad_axis( s, a ) );
+            max = std::max( max, pad_axis( s, a ) );
+            mean += static_cast< double >( pad_axis( s, a ) ) / static_cast< double >( pad_samples );
+        }
+        LTB_CHECK( whole[ 0 ].min == min );
+        LTB_CHECK( whole[ 0 ].max == max );
+        LTB_CHECK( std::abs( static_cast< double >( whole[ 0 ].mean ) - mean ) < 1e-5 );
+    }
+
+    // One output bucket per level 0 bucket reads level 0, and each covers the same samples.
+    auto       buckets = std::vector< AxisSummary >( base_count );
+    auto const end_us  = start_time_us + std::int64_t( base_count * pyramid_base_samples ) * sample_period_us;
+    pyramid->summarize( 0UL, 0UL, start_time_us, end_us, buckets );
+    for ( auto b = 0UL; b < base_count; ++b )
+    {
+        auto const last = std::min( ( b + 1UL ) * pyramid_base_samples, pad_samples );
+        auto       min  = std::numeric_limits< float >::infinity( );
+        auto       max  = -min;
+        for ( auto s = b * pyramid_base_samples; s < last; ++s )
+        {
+            min = std::min( min, pad_axis( s, 0UL ) );
+            max = std::max( max, pad_axis( s, 0UL ) );
+        }
+        LTB_CHECK( buckets[ b ].min == min );
+        LTB_CHECK( buckets[ b ].max == max );
+    }
+
+    // Block-encoded snapshots are summarized like any others.
+    pyramid->summarize( 1UL, 0UL, start_time_us, pad.last_time_us + 1, whole );
+    LTB_CHECK( whole[ 0 ].min == stick_axes.front( )[ 0 ] );
+    LTB_CHECK( whole[ 0 ].max == stick_axes.back( )[ 0 ] );
+
+    // Time before the first snapshot and axes the device does not have are empty.
+    auto before = std::vector< AxisSummary >( 4 );
+    pyramid->summarize( 0UL, 0UL, 0, start_time_us, before );
+    LTB_CHECK( std::all_of( before.begin( ), before.end( ), is_empty ) );
+    pyramid->summarize( 1UL, 1UL, start_time_us, pad.last_time_us, before );
+    LTB_CHECK( std::all_of( before.begin( ), before.end( ), is_empty ) );
+}
+
+auto rebuilds_stale_pyramid( ) -> void
+{
+    auto       stick_axes = std::vector< std::vector< float > >{ };
+    auto       bytes      = test_recording( stick_axes );
+    auto const path       = testing::temporary_recording( "pyramid_stale.ltbrec", bytes );
+    testing::temporary_paths.push_back( pyramid_path( path ) );
+    LTB_CHECK( build_axis_pyramid( path ) );
+    LTB_CHECK( AxisPyramid::open( path ) );
+
+    // A recording that changed size no longer matches its pyramid.
+    bytes.resize( bytes.size( ) + 8UL );
+    LTB_CHECK( testing::write_file( path, bytes ) );
+    LTB_CHECK( !AxisPyramid::open( path ) );
+
+    auto const rebuilt = AxisPyramid::open_or_build( path );
+    LTB_CHECK( rebuilt && rebuilt->header( ).source_size == bytes.size( ) );
+}
+
+auto rejects_corrupt_pyramid( ) -> void
+{
+    auto       stick_axes = std::vector< std::vector< float > >{ };
+    auto const path       = testing::temporary_recording( "pyramid_corrupt.ltbrec", test_recording( stick_axes ) );
+    auto const sidecar    = pyramid_path( path );
+    testing::temporary_paths.push_back( sidecar );
+    if ( !LTB_CHECK( build_axis_pyramid( path ) ) )
+    {
+        return;
+    }
+
+    auto valid = std::vector< std::byte >( std::filesystem::file_size( sidecar ) );
+    {
+        auto file = std::ifstream( sidecar, std::ios::binary );
+        file.read( reinterpret_cast< char* >( valid.data( ) ), static_cast< std::streamsize >( valid.size( ) ) );
+    }
+
+    auto device_at = []( std::vector< std::byte >& bytes ) {
+        return reinterpret_cast< PyramidDevice* >( bytes.data( ) + sizeof( PyramidFileHeader ) );
+    };
+
+    auto bytes = valid;
+    reinterpret_cast< PyramidFileHeader* >( bytes.data( ) )->version = pyramid_format_version + 1U;
+    LTB_CHECK( testing::write_file( sidecar, bytes ) && !AxisPyramid::open( path ) );
+
+    bytes                           = valid;
+    device_at( bytes )->level_count = 0U;
+    LTB_CHECK( testing::write_file( sidecar, bytes ) && !AxisPyramid::open( path ) );
+
+    bytes = valid;
+    device_at( bytes )->levels_offset += 4UL;
+    LTB_CHECK( testing::write_file( sidecar, bytes ) && !AxisPyramid::open( path ) );
+
+    bytes = valid;
+    device_at( bytes )->sample_count *= 4UL;
+    LTB_CHECK( testing::write_file( sidecar, bytes ) && !AxisPyramid::open( path ) );
+
+    bytes.assign( valid.begin( ), valid.end( ) - 8 );
+    LTB_CHECK( testing::write_file( sidecar, bytes ) && !AxisPyramid::open( path ) );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::builds_and_summarizes( );
+    ltb::joy::rebuilds_stale_pyramid( );
+    ltb::joy::rejects_corrupt_pyramid( );
+    return ltb::testing::exit_code( );
+}
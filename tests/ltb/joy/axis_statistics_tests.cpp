@@ -0,0 +1,194 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/axis_statistics.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto sample_count = 5'000UL;
+
+/// \brief Noise on a large offset, where summing squares would lose the variance, with
+///        long rising and falling runs that grow the window deques to their full length.
+auto sample_value( std::size_t sample, std::size_t axis ) -> float
+{
+    auto const noise = static_cast< float >( ( sample * 7919UL + axis * 104729UL ) % 1'000UL ) * 1e-3f - 0.5f;
+    if ( axis == 0UL )
+    {
+        return 1'000.f + noise * 0.01f;
+    }
+    auto const ramp = static_cast< float >( sample % 2'400UL );
+    return ( ( sample / 2'400UL ) % 2UL == 0UL ) ? ramp * 1e-3f : -ramp * 1e-3f + noise * 1e-4f;
+}
+
+auto test_joystick( int device_id, std::string const& guid, std::size_t axis_count ) -> Joystick
+{
+    auto joystick      = Joystick{ };
+    joystick.name      = "Test Pad";
+    joystick.guid      = guid;
+    joystick.device_id = device_id;
+    joystick.axes      = std::vector< float >( axis_count );
+    return joystick;
+}
+
+/// \brief The statistics of `values`, computed directly in two passes.
+auto reference_statistics( std::vector< float > const& values ) -> AxisStatistics
+{
+    auto const count = static_cast< double >( values.size( ) );
+
+    auto statistics         = AxisStatistics{ };
+    statistics.sample_count = values.size( );
+    for ( auto const value : values )
+    {
+        statistics.mean += double( value ) / count;
+    }
+
+    auto squares     = 0.0;
+    auto changes     = std::vector< double >{ };
+    auto change_mean = 0.0;
+    for ( auto s = 0UL; s < values.size( ); ++s )
+    {
+        squares += ( double( values[ s ] ) - statistics.mean ) * ( double( values[ s ] ) - statistics.mean );
+        if ( s > 0UL )
+        {
+            changes.push_back( double( values[ s ] - values[ s - 1UL ] ) );
+            change_mean += changes.back( ) / ( count - 1.0 );
+        }
+    }
+    auto change_squares = 0.0;
+    for ( auto const change : changes )
+    {
+        change_squares += ( change - change_mean ) * ( change - change_mean );
+    }
+    statistics.standard_deviation = ( count > 1.0 ) ? std::sqrt( squares / ( count - 1.0 ) ) : 0.0;
+    statistics.jitter             = ( count > 2.0 ) ? std::sqrt( change_squares / ( count - 2.0 ) ) : 0.0;
+
+    auto const window_size = std::min( values.size( ), statistics_window_samples );
+    auto const window      = values.end( ) - static_cast< long >( window_size );
+    statistics.window_min = *std::min_element( window, values.end( ) );
+    statistics.window_max = *std::max_element( window, values.end( ) );
+    return statistics;
+}
+
+/// \brief Whether `actual` matches `expected` to within `tolerance` of the axis' scale.
+auto close( AxisStatistics const& actual, AxisStatistics const& expected, double tolerance ) -> bool
+{
+    auto const near = [ tolerance ]( double a, double b ) {
+        return std::abs( a - b ) <= tolerance * std::max( 1.0, std::abs( b ) );
+    };
+    return actual.sample_count == expected.sample_count && near( actual.mean, expected.mean )
+        && near( actual.standard_deviation, expected.standard_deviation ) && near( actual.jitter, expected.jitter )
+        && actual.window_min == expected.window_min && actual.window_max == expected.window_max;
+}
+
+auto matches_direct_statistics( ) -> void
+{
+    auto tracker   = AxisStatisticsTracker{ };
+    auto joysticks = std::vector< Joystick >{ test_joystick( 4, "03000000de280000ff11000001000000", 2UL ) };
+    auto history   = std::vector< std::vector< float > >( 2UL );
+
+    auto mismatches = 0UL;
+    for ( auto s = 0UL; s < sample_count; ++s )
+    {
+        joysticks[ 0 ].timestamp_us = static_cast< std::int64_t >( s ) * 1'000;
+        for ( auto a = 0UL; a < history.size( ); ++a )
+        {
+            joysticks[ 0 ].axes[ a ] = sample_value( s, a );
+            history[ a ].push_back( joysticks[ 0 ].axes[ a ] );
+        }
+        tracker.process( joysticks );
+
+        // A poll that repeats the last sample is not counted again.
+        if ( s % 10UL == 0UL )
+        {
+            tracker.process( joysticks );
+        }
+
+        if ( s < 3UL || s % 97UL == 0UL || s + 1UL == sample_count )
+        {
+            for ( auto a = 0UL; a < history.size( ); ++a )
+            {
+                auto const& actual = joysticks[ 0 ].axis_statistics[ a ];
+                if ( !close( actual, reference_statistics( history[ a ] ), 1e-9 ) )
+                {
+                    ++mismatches;
+                    std::fprintf( stderr, "    sample %zu axis %zu\n", s, a );
+                }
+            }
+        }
+    }
+    LTB_CHECK( mismatches == 0UL );
+    LTB_CHECK( tracker.stats( ).device_count == 1UL );
+
+    // Another device reconnecting with the same ID starts over.
+    joysticks[ 0 ]              = test_joystick( 4, "030000006d04000015c2000010010000", 2UL );
+    joysticks[ 0 ].axes         = { 0.25f, -0.5f };
+    joysticks[ 0 ].timestamp_us = 1;
+    tracker.process( joysticks );
+    LTB_CHECK( close( joysticks[ 0 ].axis_statistics[ 1 ], reference_statistics( { -0.5f } ), 0.0 ) );
+
+    tracker.reset( );
+    LTB_CHECK( tracker.stats( ).device_count == 0UL );
+}
+
+auto exports_every_axis( ) -> void
+{
+    auto tracker   = AxisStatisticsTracker{ };
+    auto joysticks = std::vector< Joystick >{
+        test_joystick( 1, "03000000de280000ff11000001000000", 2UL ),
+        test_joystick( 0, "030000006d04000015c2000010010000", 3UL ),
+    };
+    joysticks[ 1 ].name = "Stick, \"Pro\"";
+    for ( auto s = 0UL; s < 10UL; ++s )
+    {
+        for ( auto& joystick : joysticks )
+        {
+            joystick.timestamp_us = static_cast< std::int64_t >( s );
+            std::fill( joystick.axes.begin( ), joystick.axes.end( ), static_cast< float >( s ) * 0.1f );
+        }
+        tracker.process( joysticks );
+    }
+
+    auto const path = testing::temporary_path( "statistics.csv" );
+    if ( !LTB_CHECK( tracker.export_csv( path ) ) )
+    {
+        return;
+    }
+
+    auto lines = std::vector< std::string >{ };
+    auto file  = std::ifstream( path );
+    for ( auto line = std::string{ }; std::getline( file, line ); )
+    {
+        lines.push_back( line );
+    }
+
+    // One row per axis, ordered by device ID, with quotes in names escaped.
+    if ( LTB_CHECK( lines.size( ) == 1UL + 3UL + 2UL ) )
+    {
+        LTB_CHECK( lines[ 0 ].rfind( "device_id,name,guid,axis,samples", 0UL ) == 0UL );
+        auto const stick = std::string( "0,\"Stick, \"\"Pro\"\"\",\"030000006d04000015c2000010010000\",0,10," );
+        LTB_CHECK( lines[ 1 ].rfind( stick, 0UL ) == 0UL );
+        LTB_CHECK( lines[ 3 ].rfind( "0,", 0UL ) == 0UL );
+        LTB_CHECK( lines[ 4 ].rfind( "1,\"Test Pad\",", 0UL ) == 0UL );
+    }
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::matches_direct_statistics( );
+    ltb::joy::exports_every_axis( );
+    return ltb::testing::exit_code( );
+}
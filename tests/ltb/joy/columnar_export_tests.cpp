@@ -0,0 +1,226 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/test_recordings.hpp"
+
+// project
+#include "ltb/joy/columnar_export.hpp"
+#include "ltb/joy/fixed_point.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+#include "ltb/utils/mapped_file.hpp"
+
+// standard
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto start_time_us = std::int64_t( 1'700'000'000'000'000 );
+
+/// \brief Polled often enough that the session spans several export chunks.
+constexpr auto frame_count = 6'000UL;
+
+/// \brief A session and every row its export should have, by device ID.
+struct TestSession
+{
+    std::vector< std::byte >                 bytes    = { };
+    std::map< int, std::vector< Joystick > > expected = { };
+};
+
+/// \brief Two devices: one written as alternating plain and fixed-point snapshots, with more
+///        buttons than one mask holds, and one written as delta blocks. Keyframes and events
+///        are mixed in and must not add rows.
+auto test_session( ) -> TestSession
+{
+    auto session  = TestSession{ };
+    session.bytes = testing::recording_header( start_time_us );
+
+    auto pad      = Joystick{ };
+    pad.name      = "Test Pad";
+    pad.guid      = "03000000de280000ff11000001000000";
+    pad.device_id = 1;
+    pad.buttons   = std::vector< unsigned char >( 40, 0 );
+
+    auto stick      = Joystick{ };
+    stick.name      = "Test Stick";
+    stick.guid      = "030000006d04000015c2000010010000";
+    stick.device_id = 7;
+    stick.buttons   = { 0, 0, 0 };
+
+    auto event      = InputEvent{ };
+    event.device_id = pad.device_id;
+    event.type      = InputEventType::Button;
+    event.value     = 1.f;
+
+    auto encoder = SnapshotBlockEncoder{ };
+
+    append_device_record( pad, session.bytes );
+    append_device_record( stick, session.bytes );
+
+    for ( auto f = 0UL; f < frame_count; ++f )
+    {
+        auto const t = static_cast< float >( f );
+
+        pad.timestamp_us  = start_time_us + static_cast< std::int64_t >( f * 1'000UL );
+        pad.axes          = { std::sin( t * 0.01f ), std::cos( t * 0.02f ), ( f % 2UL == 0UL ) ? 1.f : -1.f };
+        pad.buttons[ 0 ]  = static_cast< unsigned char >( ( f / 7UL ) % 2UL );
+        pad.buttons[ 35 ] = static_cast< unsigned char >( ( f / 3UL ) % 2UL );
+
+        auto expected = pad;
+        if ( f % 2UL == 0UL )
+        {
+            append_snapshot_record( pad, session.bytes );
+        }
+        else
+        {
+            append_fixed_snapshot_record( pad, session.bytes );
+            round_to_fixed_axes( expected.axes );
+        }
+        session.expected[ pad.device_id ].push_back( expected );
+
+        stick.timestamp_us = pad.timestamp_us + 3;
+        stick.axes         = { std::sin( t * 0.003f ) * 0.5f, -0.25f };
+        stick.buttons[ 2 ] = static_cast< unsigned char >( ( f / 50UL ) % 2UL );
+        encoder.add( stick, session.bytes );
+
+        expected = stick;
+        quantize_axes( expected.axes );
+        session.expected[ stick.device_id ].push_back( expected );
+
+        if ( f % 1'000UL == 999UL )
+        {
+            event.timestamp_us = pad.timestamp_us;
+            append_event_record( event, session.bytes );
+            encoder.flush( session.bytes );
+            append_keyframe_record( pad, session.bytes );
+            append_keyframe_record( stick, session.bytes );
+        }
+    }
+    encoder.flush( session.bytes );
+    testing::finalize_recording( session.bytes );
+    return session;
+}
+
+template < typename T >
+auto values_at( utils::MappedFile const& file, std::uint64_t offset ) -> T const*
+{
+    return reinterpret_cast< T const* >( file.data( ) + offset );
+}
+
+/// \brief Buttons `32 * index` up to `32 * index + 31` of `joystick` as a bitmask.
+auto button_mask( Joystick const& joystick, std::size_t index ) -> std::uint32_t
+{
+    auto mask = 0U;
+    for ( auto b = 0UL; b < 32UL && index * 32UL + b < joystick.buttons.size( ); ++b )
+    {
+        mask |= ( joystick.buttons[ index * 32UL + b ] != 0U ) ? 1U << b : 0U;
+    }
+    return mask;
+}
+
+/// \brief Rows of `column` that differ from the snapshots they were exported from.
+auto mismatched_rows(
+    utils::MappedFile const&       file,
+    ColumnDescriptor const&        column,
+    std::vector< Joystick > const& expected
+) -> std::size_t
+{
+    auto mismatches = 0UL;
+    for ( auto row = 0UL; row < column.row_count; ++row )
+    {
+        auto const& joystick = expected[ row ];
+        switch ( column.type )
+        {
+            case ColumnType::Timestamps:
+                mismatches += values_at< std::int64_t >( file, column.offset )[ row ] != joystick.timestamp_us;
+                break;
+            case ColumnType::Axis:
+                mismatches += values_at< float >( file, column.offset )[ row ] != joystick.axes[ column.index ];
+                break;
+            case ColumnType::Buttons:
+                mismatches += values_at< std::uint32_t >( file, column.offset )[ row ]
+                           != button_mask( joystick, column.index );
+                break;
+        }
+    }
+    return mismatches;
+}
+
+auto exports_every_row( ) -> void
+{
+    auto const session     = test_session( );
+    auto const input_path  = testing::temporary_recording( "columnar_input.ltbrec", session.bytes );
+    auto const output_path = testing::temporary_path( "columnar_output.ltbcol" );
+    if ( !LTB_CHECK( export_columns( input_path, output_path ) ) )
+    {
+        return;
+    }
+
+    auto const file = utils::MappedFile::open( output_path );
+    if ( !LTB_CHECK( file ) || !LTB_CHECK( file->size( ) > sizeof( ColumnarFileHeader ) + sizeof( ColumnarFooter ) ) )
+    {
+        return;
+    }
+
+    auto const& header = *values_at< ColumnarFileHeader >( *file, 0UL );
+    auto const& footer = *values_at< ColumnarFooter >( *file, file->size( ) - sizeof( ColumnarFooter ) );
+    LTB_CHECK( header.magic == columnar_magic );
+    LTB_CHECK( header.version == columnar_format_version );
+    LTB_CHECK( header.start_time_us == start_time_us );
+    LTB_CHECK( footer.magic == columnar_footer_magic );
+    LTB_CHECK( footer.footer_size == sizeof( ColumnarFooter ) );
+    if ( !LTB_CHECK( footer.device_count == session.expected.size( ) ) )
+    {
+        return;
+    }
+
+    auto const* devices = values_at< ColumnarDevice >( *file, footer.devices_offset );
+    auto const* columns = values_at< ColumnDescriptor >( *file, footer.columns_offset );
+    for ( auto d = 0UL; d < footer.device_count; ++d )
+    {
+        auto const& device   = devices[ d ];
+        auto const& expected = session.expected.at( device.device_id );
+        auto const* strings  = values_at< char >( *file, device.strings_offset );
+        LTB_CHECK( std::string( strings, device.name_size ) == expected.front( ).name );
+        LTB_CHECK( std::string( strings + device.name_size, device.guid_size ) == expected.front( ).guid );
+        if ( !LTB_CHECK( device.row_count == expected.size( ) ) )
+        {
+            continue;
+        }
+
+        auto const mask_count = ( expected.front( ).buttons.size( ) + 31UL ) / 32UL;
+        LTB_CHECK( device.column_count == 1UL + expected.front( ).axes.size( ) + mask_count );
+
+        for ( auto c = device.first_column; c < device.first_column + device.column_count; ++c )
+        {
+            auto const& column = columns[ c ];
+            LTB_CHECK( column.offset % column_alignment == 0UL );
+            LTB_CHECK( column.device_id == device.device_id );
+            LTB_CHECK( column.row_count == device.row_count );
+            if ( !LTB_CHECK( mismatched_rows( *file, column, expected ) == 0UL ) )
+            {
+                std::fprintf( stderr, "    device %d column %u\n", device.device_id, c );
+            }
+        }
+    }
+}
+
+auto rejects_missing_session( ) -> void
+{
+    auto const missing = testing::temporary_path( "columnar_missing.ltbrec" );
+    LTB_CHECK( !export_columns( missing, testing::temporary_path( "columnar_missing.ltbcol" ) ) );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::exports_every_row( );
+    ltb::joy::rejects_missing_session( );
+    return ltb::testing::exit_code( );
+}
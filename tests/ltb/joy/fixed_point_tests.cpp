@@ -0,0 +1,137 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/fixed_point.hpp"
+#include "ltb/joy/recording_format.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Longer than the widest vector, so every test covers whole vectors and a remainder.
+constexpr auto value_count = 67UL;
+
+/// \brief Test values across [-1, 1], with a few outside it.
+auto test_value( std::size_t i ) -> float
+{
+    return -1.25f + 2.5f * static_cast< float >( i ) / float( value_count - 1UL );
+}
+
+/// \brief The fixed-point value of `value`, computed directly.
+auto expected_fixed( float value ) -> std::int16_t
+{
+    auto const clamped = std::isnan( value ) ? -1.f : std::min( std::max( value, -1.f ), 1.f );
+    return static_cast< std::int16_t >( std::nearbyint( clamped * axis_quantization_scale ) );
+}
+
+/// \brief A value exactly halfway between the fixed-point values `step` and `step + 1`.
+auto halfway_value( int step ) -> float
+{
+    auto const halfway = static_cast< float >( step ) + 0.5f;
+    auto       value   = halfway / axis_quantization_scale;
+    for ( auto nudge = 0; nudge < 8 && value * axis_quantization_scale != halfway; ++nudge )
+    {
+        value = std::nextafter( value, ( value * axis_quantization_scale < halfway ) ? 2.f : -2.f );
+    }
+    return value;
+}
+
+auto to_fixed( std::vector< float > const& axes ) -> std::vector< std::int16_t >
+{
+    auto fixed = std::vector< std::int16_t >( axes.size( ) );
+    to_fixed_axes( axes.data( ), axes.size( ), fixed.data( ) );
+    return fixed;
+}
+
+auto converts_to_fixed( ) -> void
+{
+    // Every length up to `value_count`, so the remainder loop runs for every lane count.
+    auto mismatches = 0UL;
+    for ( auto count = 0UL; count <= value_count; ++count )
+    {
+        auto axes = std::vector< float >( count );
+        for ( auto i = 0UL; i < count; ++i )
+        {
+            axes[ i ] = test_value( i + count );
+        }
+        auto const fixed = to_fixed( axes );
+        for ( auto i = 0UL; i < count; ++i )
+        {
+            mismatches += ( fixed[ i ] == expected_fixed( axes[ i ] ) ) ? 0UL : 1UL;
+        }
+    }
+    LTB_CHECK( mismatches == 0UL );
+
+    // Out of range values clamp, and NaNs become -1.
+    auto const nan      = std::numeric_limits< float >::quiet_NaN( );
+    auto const infinity = std::numeric_limits< float >::infinity( );
+    auto const clamped  = to_fixed( { 1.5f, -2.f, infinity, -infinity, nan, 0.f, -0.f, 1.f, -1.f } );
+    auto const expected_clamped = std::vector< std::int16_t >{
+        32767, -32767, 32767, -32767, -32767, 0, 0, 32767, -32767,
+    };
+    LTB_CHECK( clamped == expected_clamped );
+
+    // Values exactly halfway between two steps round to the even one.
+    auto halfway = std::vector< float >{ };
+    for ( auto const step : { 0, 1, 2, -1, -2, 32765, -32766 } )
+    {
+        halfway.push_back( halfway_value( step ) );
+        LTB_CHECK( halfway.back( ) * axis_quantization_scale == static_cast< float >( step ) + 0.5f );
+    }
+    auto const expected_halfway = std::vector< std::int16_t >{ 0, 2, 2, 0, -2, 32766, -32766 };
+    LTB_CHECK( to_fixed( halfway ) == expected_halfway );
+}
+
+auto round_trips_axes( ) -> void
+{
+    // Every fixed-point value survives a round trip through floats exactly.
+    auto fixed = std::vector< std::int16_t >{ };
+    for ( auto value = -32767; value <= 32767; ++value )
+    {
+        fixed.push_back( static_cast< std::int16_t >( value ) );
+    }
+    auto axes = std::vector< float >( fixed.size( ) );
+    from_fixed_axes( fixed.data( ), fixed.size( ), axes.data( ) );
+    LTB_CHECK( to_fixed( axes ) == fixed );
+    LTB_CHECK( axes.front( ) == -1.f && axes[ 32767UL ] == 0.f && axes.back( ) == 1.f );
+
+    // Values in range move by at most half a step, and rounding again changes nothing.
+    auto values = std::vector< float >( value_count );
+    for ( auto i = 0UL; i < value_count; ++i )
+    {
+        values[ i ] = std::sin( static_cast< float >( i ) * 0.37f );
+    }
+    auto rounded = values;
+    round_to_fixed_axes( rounded );
+
+    auto const tolerance = 0.5f / axis_quantization_scale + std::numeric_limits< float >::epsilon( );
+    auto       far       = 0UL;
+    for ( auto i = 0UL; i < value_count; ++i )
+    {
+        far += ( std::abs( rounded[ i ] - values[ i ] ) <= tolerance ) ? 0UL : 1UL;
+    }
+    LTB_CHECK( far == 0UL );
+
+    auto twice = rounded;
+    round_to_fixed_axes( twice );
+    LTB_CHECK( twice == rounded );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::converts_to_fixed( );
+    ltb::joy::round_trips_axes( );
+    return ltb::testing::exit_code( );
+}
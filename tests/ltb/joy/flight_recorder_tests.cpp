@@ -0,0 +1,109 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/flight_recorder.hpp"
+#include "ltb/joy/recording_reader.hpp"
+
+// standard
+#include <map>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+auto test_joysticks( ) -> std::vector< Joystick >
+{
+    auto joysticks = std::vector< Joystick >( 2 );
+    for ( auto d = 0UL; d < joysticks.size( ); ++d )
+    {
+        joysticks[ d ].name      = "Test Pad " + std::to_string( d );
+        joysticks[ d ].guid      = "03000000de280000ff1100000100000" + std::to_string( d );
+        joysticks[ d ].device_id = static_cast< int >( d + 4UL );
+        joysticks[ d ].axes      = { 0.f, 0.f, 0.f, 0.f };
+        joysticks[ d ].buttons   = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    }
+    return joysticks;
+}
+
+/// \brief Record `frames` frames into the smallest ring and extract what it kept.
+auto extract_frames( std::string const& name, std::uint64_t frames ) -> utils::Expected< RecordingReader >
+{
+    auto const ring_path = testing::temporary_path( name + ".ltbring" );
+    auto const rec_path  = testing::temporary_path( name + ".ltbrec" );
+    {
+        auto recorder = FlightRecorder::create( ring_path, 64UL * 1024UL );
+        if ( !LTB_CHECK( recorder ) )
+        {
+            return tl::make_unexpected( recorder.error( ) );
+        }
+
+        auto joysticks = test_joysticks( );
+        for ( auto f = 0UL; f < frames; ++f )
+        {
+            for ( auto& joystick : joysticks )
+            {
+                joystick.timestamp_us = static_cast< std::int64_t >( f * 1'000UL );
+                joystick.axes[ 0 ]    = static_cast< float >( f % 100UL ) * 0.01f;
+            }
+            ( *recorder )->record( joysticks, { } );
+        }
+    }
+
+    if ( auto const extracted = extract_flight_recording( ring_path, rec_path ); !LTB_CHECK( extracted ) )
+    {
+        return tl::make_unexpected( extracted.error( ) );
+    }
+    return RecordingReader::open( rec_path );
+}
+
+/// \brief Every device in the extracted recording is described, with the right name,
+///        before any of its other records.
+auto describes_every_device( std::string const& name, std::uint64_t frames ) -> void
+{
+    auto const reader = extract_frames( name, frames );
+    if ( !LTB_CHECK( reader ) )
+    {
+        return;
+    }
+    LTB_CHECK( reader->record_count( ) > 0UL );
+
+    auto names = std::map< std::uint16_t, std::string >{ };
+    for ( auto iterator = reader->begin( ); iterator != reader->end( ); ++iterator )
+    {
+        auto const record = *iterator;
+        if ( record.type( ) == RecordType::Device )
+        {
+            names[ record.device_id( ) ] = std::string( record.device( ).name );
+        }
+        else if ( !LTB_CHECK( names.count( record.device_id( ) ) > 0UL ) )
+        {
+            std::fprintf( stderr, "    device %d in %s\n", int( record.device_id( ) ), name.c_str( ) );
+            return;
+        }
+    }
+
+    for ( auto const& joystick : test_joysticks( ) )
+    {
+        LTB_CHECK( names[ static_cast< std::uint16_t >( joystick.device_id ) ] == joystick.name );
+    }
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    // Before the ring wraps, then after retiring the first descriptions and many laps later.
+    ltb::joy::describes_every_device( "flight_unwrapped", 10UL );
+    for ( auto frames = 500UL; frames < 1'500UL; frames += 37UL )
+    {
+        ltb::joy::describes_every_device( "flight_wrapped_" + std::to_string( frames ), frames );
+    }
+    ltb::joy::describes_every_device( "flight_many_laps", 20'000UL );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,401 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/axis_mapping.hpp"
+#include "ltb/joy/numeric_kernels.hpp"
+
+// standard
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Past two of the widest byte vectors, so every level runs whole vectors and every
+///        length of remainder.
+constexpr auto max_count = 131UL;
+
+/// \brief Deterministic test values, the same for every level.
+class Random
+{
+public:
+    auto uniform( float low, float high ) -> float
+    {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return low + ( high - low ) * static_cast< float >( state_ >> 40U ) / float( 1U << 24U );
+    }
+
+private:
+    std::uint64_t state_ = 1U;
+};
+
+auto uniform_values( Random& random, std::size_t count, float low, float high ) -> std::vector< float >
+{
+    auto values = std::vector< float >( count );
+    for ( auto& value : values )
+    {
+        value = random.uniform( low, high );
+    }
+    return values;
+}
+
+/// \brief Whether `a` and `b` hold the same bits, which also tells -0 from 0.
+template < typename T >
+auto same( std::vector< T > const& a, std::vector< T > const& b ) -> bool
+{
+    return a.size( ) == b.size( )
+        && ( a.empty( ) || std::memcmp( a.data( ), b.data( ), a.size( ) * sizeof( T ) ) == 0 );
+}
+
+/// \brief Every level this CPU supports, above `Scalar`.
+auto vector_levels( ) -> std::vector< utils::SimdLevel >
+{
+    auto levels = std::vector< utils::SimdLevel >{ };
+    for ( auto level = int( utils::SimdLevel::Sse42 ); level <= int( utils::supported_simd_level( ) ); ++level )
+    {
+        levels.push_back( utils::SimdLevel( level ) );
+    }
+    return levels;
+}
+
+/// \brief Count a mismatch between `level` and the scalar kernels for `count` lanes.
+auto report( bool matches, utils::SimdLevel level, char const* kernel, std::size_t count, std::size_t& mismatches )
+    -> void
+{
+    if ( !matches )
+    {
+        ++mismatches;
+        auto const name = std::string( utils::simd_level_name( level ) );
+        std::fprintf( stderr, "    %s: %s, %zu lanes\n", name.c_str( ), kernel, count );
+    }
+}
+
+/// \brief Mapping parameters for `count` lanes, spread over two curves.
+struct MappingLanes
+{
+    std::vector< float >         deadzone      = { };
+    std::vector< float >         inverse_range = { };
+    std::vector< float >         anti_deadzone = { };
+    std::vector< std::uint32_t > table_offset  = { };
+    std::vector< float >         tables        = { };
+
+    MappingLanes( Random& random, std::size_t count )
+    {
+        for ( auto s = 0UL; s <= curve_table_segments; ++s )
+        {
+            auto const x = static_cast< float >( s ) / float( curve_table_segments );
+            tables.push_back( x * x );
+        }
+        for ( auto s = 0UL; s <= curve_table_segments; ++s )
+        {
+            tables.push_back( std::sqrt( static_cast< float >( s ) / float( curve_table_segments ) ) );
+        }
+        for ( auto i = 0UL; i < count; ++i )
+        {
+            auto const inner = random.uniform( 0.f, 0.2f );
+            auto const outer = random.uniform( 0.f, 0.1f );
+            deadzone.push_back( inner );
+            inverse_range.push_back( 1.f / ( 1.f - inner - outer ) );
+            anti_deadzone.push_back( ( i % 3UL == 0UL ) ? random.uniform( 0.f, 0.2f ) : 0.f );
+            table_offset.push_back( ( i % 2UL == 0UL ) ? 0U : std::uint32_t( curve_table_segments + 1UL ) );
+        }
+    }
+};
+
+auto matches_scalar_mapping( ) -> void
+{
+    auto const& scalar     = numeric_kernels( utils::SimdLevel::Scalar );
+    auto        mismatches = 0UL;
+    for ( auto const level : vector_levels( ) )
+    {
+        auto const& kernels = numeric_kernels( level );
+        LTB_CHECK( kernels.level == level );
+
+        auto random = Random{ };
+        for ( auto count = 0UL; count <= max_count; ++count )
+        {
+            auto const lanes = MappingLanes( random, count );
+
+            // Include the edges of the deadzones and exactly zero, where the sign must survive.
+            auto x = uniform_values( random, count, -1.2f, 1.2f );
+            auto y = uniform_values( random, count, -1.2f, 1.2f );
+            for ( auto i = 0UL; i < count; i += 7UL )
+            {
+                x[ i ] = ( i % 2UL == 0UL ) ? lanes.deadzone[ i ] : -0.f;
+                y[ i ] = 0.f;
+            }
+
+            auto expected_x = x;
+            auto expected_y = y;
+            auto actual_x   = x;
+            auto actual_y   = y;
+
+            auto const map_axis = [ & ]( NumericKernels const& with, std::vector< float >& values ) {
+                with.map_axis_lanes(
+                    count,
+                    values.data( ),
+                    lanes.deadzone.data( ),
+                    lanes.inverse_range.data( ),
+                    lanes.anti_deadzone.data( ),
+                    lanes.table_offset.data( ),
+                    lanes.tables.data( )
+                );
+            };
+            map_axis( scalar, expected_x );
+            map_axis( kernels, actual_x );
+            report( same( actual_x, expected_x ), level, "map_axis_lanes", count, mismatches );
+
+            expected_x = x;
+            actual_x   = x;
+            auto const map_stick
+                = [ & ]( NumericKernels const& with, std::vector< float >& xs, std::vector< float >& ys ) {
+                      with.map_stick_lanes(
+                          count,
+                          xs.data( ),
+                          ys.data( ),
+                          lanes.deadzone.data( ),
+                          lanes.inverse_range.data( ),
+                          lanes.anti_deadzone.data( ),
+                          lanes.table_offset.data( ),
+                          lanes.tables.data( )
+                      );
+                  };
+            map_stick( scalar, expected_x, expected_y );
+            map_stick( kernels, actual_x, actual_y );
+            auto const stick_matches = same( actual_x, expected_x ) && same( actual_y, expected_y );
+            report( stick_matches, level, "map_stick_lanes", count, mismatches );
+
+            auto expected_magnitudes = std::vector< float >( count );
+            auto expected_angles     = std::vector< float >( count );
+            auto actual_magnitudes   = std::vector< float >( count );
+            auto actual_angles       = std::vector< float >( count );
+            scalar.polar_lanes( count, x.data( ), y.data( ), expected_magnitudes.data( ), expected_angles.data( ) );
+            kernels.polar_lanes( count, x.data( ), y.data( ), actual_magnitudes.data( ), actual_angles.data( ) );
+            report(
+                same( actual_magnitudes, expected_magnitudes ) && same( actual_angles, expected_angles ),
+                level,
+                "polar_lanes",
+                count,
+                mismatches
+            );
+        }
+    }
+    LTB_CHECK( mismatches == 0UL );
+}
+
+/// \brief Filter state and parameters for `count` lanes.
+struct FilterLanes
+{
+    std::vector< float > previous   = { };
+    std::vector< float > derivative = { };
+    std::vector< float > dt         = { };
+    std::vector< float > omega      = { };
+    std::vector< float > beta       = { };
+    std::vector< float > b0         = { };
+    std::vector< float > b1         = { };
+    std::vector< float > b2         = { };
+    std::vector< float > a1         = { };
+    std::vector< float > a2         = { };
+
+    FilterLanes( Random& random, std::size_t count )
+        : previous( uniform_values( random, count, -1.f, 1.f ) )
+        , derivative( uniform_values( random, count, -5.f, 5.f ) )
+        , dt( uniform_values( random, count, 1e-4f, 0.02f ) )
+        , omega( uniform_values( random, count, 1.f, 100.f ) )
+        , beta( uniform_values( random, count, 0.f, 1.f ) )
+        , b0( uniform_values( random, count, 0.f, 0.5f ) )
+        , b1( uniform_values( random, count, 0.f, 0.5f ) )
+        , b2( uniform_values( random, count, 0.f, 0.5f ) )
+        , a1( uniform_values( random, count, -1.5f, 0.f ) )
+        , a2( uniform_values( random, count, 0.f, 0.6f ) )
+    {
+    }
+};
+
+auto matches_scalar_filters( ) -> void
+{
+    constexpr auto steps = 20UL;
+
+    auto const& scalar     = numeric_kernels( utils::SimdLevel::Scalar );
+    auto        mismatches = 0UL;
+    for ( auto const level : vector_levels( ) )
+    {
+        auto const& kernels = numeric_kernels( level );
+
+        auto random = Random{ };
+        for ( auto count = 0UL; count <= max_count; ++count )
+        {
+            auto expected = FilterLanes( random, count );
+            auto actual   = expected;
+
+            // Several steps, so state written by one step is read back by the next.
+            auto ema_matches      = true;
+            auto one_euro_matches = true;
+            auto biquad_matches   = true;
+            for ( auto step = 0UL; step < steps; ++step )
+            {
+                auto const input   = uniform_values( random, count, -1.f, 1.f );
+                auto       outputs = std::vector< std::vector< float > >( 2UL, input );
+                auto const run_ema
+                    = [ & ]( NumericKernels const& with, FilterLanes& lanes, std::vector< float >& out ) {
+                          auto* const state = lanes.previous.data( );
+                          with.ema_lanes( count, out.data( ), state, lanes.dt.data( ), lanes.omega.data( ) );
+                      };
+                run_ema( scalar, expected, outputs[ 0 ] );
+                run_ema( kernels, actual, outputs[ 1 ] );
+                ema_matches = ema_matches && same( outputs[ 1 ], outputs[ 0 ] )
+                            && same( actual.previous, expected.previous );
+
+                outputs = std::vector< std::vector< float > >( 2UL, input );
+                auto const run_one_euro
+                    = [ & ]( NumericKernels const& with, FilterLanes& lanes, std::vector< float >& out ) {
+                          with.one_euro_lanes(
+                              count,
+                              out.data( ),
+                              lanes.previous.data( ),
+                              lanes.derivative.data( ),
+                              lanes.dt.data( ),
+                              lanes.omega.data( ),
+                              lanes.beta.data( ),
+                              lanes.omega.data( )
+                          );
+                      };
+                run_one_euro( scalar, expected, outputs[ 0 ] );
+                run_one_euro( kernels, actual, outputs[ 1 ] );
+                one_euro_matches = one_euro_matches && same( outputs[ 1 ], outputs[ 0 ] )
+                            && same( actual.previous, expected.previous )
+                            && same( actual.derivative, expected.derivative );
+
+                // The biquad keeps its state in `previous` and `derivative` here.
+                outputs = std::vector< std::vector< float > >( 2UL, input );
+                auto const run_biquad
+                    = [ & ]( NumericKernels const& with, FilterLanes& lanes, std::vector< float >& out ) {
+                          with.biquad_lanes(
+                              count,
+                              out.data( ),
+                              lanes.previous.data( ),
+                              lanes.derivative.data( ),
+                              lanes.b0.data( ),
+                              lanes.b1.data( ),
+                              lanes.b2.data( ),
+                              lanes.a1.data( ),
+                              lanes.a2.data( )
+                          );
+                      };
+                run_biquad( scalar, expected, outputs[ 0 ] );
+                run_biquad( kernels, actual, outputs[ 1 ] );
+                biquad_matches = biquad_matches && same( outputs[ 1 ], outputs[ 0 ] )
+                            && same( actual.previous, expected.previous )
+                            && same( actual.derivative, expected.derivative );
+            }
+            report( ema_matches, level, "ema_lanes", count, mismatches );
+            report( one_euro_matches, level, "one_euro_lanes", count, mismatches );
+            report( biquad_matches, level, "biquad_lanes", count, mismatches );
+        }
+    }
+    LTB_CHECK( mismatches == 0UL );
+}
+
+auto changed( NumericKernels const& with, std::vector< float > const& previous, std::vector< float > const& current )
+    -> std::vector< std::uint32_t >
+{
+    auto indices = std::vector< std::uint32_t >( previous.size( ) );
+    indices.resize( with.changed_axes( previous.size( ), previous.data( ), current.data( ), indices.data( ) ) );
+    return indices;
+}
+
+auto changed(
+    NumericKernels const&               with,
+    std::vector< unsigned char > const& previous,
+    std::vector< unsigned char > const& current
+) -> std::vector< std::uint32_t >
+{
+    auto indices = std::vector< std::uint32_t >( previous.size( ) );
+    indices.resize( with.changed_buttons( previous.size( ), previous.data( ), current.data( ), indices.data( ) ) );
+    return indices;
+}
+
+auto matches_scalar_diffs_and_encoding( ) -> void
+{
+    auto const& scalar     = numeric_kernels( utils::SimdLevel::Scalar );
+    auto const  nan        = std::numeric_limits< float >::quiet_NaN( );
+    auto        mismatches = 0UL;
+    for ( auto const level : vector_levels( ) )
+    {
+        auto const& kernels = numeric_kernels( level );
+
+        auto random = Random{ };
+        for ( auto count = 0UL; count <= max_count; ++count )
+        {
+            // About a third of the lanes change, with signed zeros and NaNs mixed in.
+            auto previous = uniform_values( random, count, -1.f, 1.f );
+            auto current  = previous;
+            auto buttons  = std::vector< unsigned char >( count );
+            auto pressed  = std::vector< unsigned char >( count );
+            for ( auto i = 0UL; i < count; ++i )
+            {
+                auto const roll = random.uniform( 0.f, 1.f );
+                current[ i ]    = ( roll < 0.3f ) ? random.uniform( -1.f, 1.f ) : current[ i ];
+                current[ i ]    = ( i % 11UL == 0UL ) ? -0.f : current[ i ];
+                previous[ i ]   = ( i % 22UL == 0UL ) ? 0.f : previous[ i ];
+                current[ i ]    = ( i % 13UL == 5UL ) ? nan : current[ i ];
+                previous[ i ]   = ( i % 26UL == 5UL ) ? nan : previous[ i ];
+                buttons[ i ]    = static_cast< unsigned char >( roll * 4.f );
+                pressed[ i ]    = ( roll < 0.5f ) ? buttons[ i ] : static_cast< unsigned char >( i % 3UL );
+            }
+            auto const axes_match    = changed( kernels, previous, current ) == changed( scalar, previous, current );
+            auto const buttons_match = changed( kernels, buttons, pressed ) == changed( scalar, buttons, pressed );
+            report( axes_match, level, "changed_axes", count, mismatches );
+            report( buttons_match, level, "changed_buttons", count, mismatches );
+
+            // Past both ends of the range, with NaNs and values about halfway between steps.
+            auto axes = uniform_values( random, count, -1.1f, 1.1f );
+            for ( auto i = 0UL; i < count; i += 9UL )
+            {
+                axes[ i ] = ( i % 2UL == 0UL ) ? nan : ( static_cast< float >( int( i ) - 64 ) + 0.5f ) / 32'767.f;
+            }
+            auto expected_fixed = std::vector< std::int16_t >( count );
+            auto actual_fixed   = std::vector< std::int16_t >( count );
+            scalar.to_fixed_axes( axes.data( ), count, expected_fixed.data( ) );
+            kernels.to_fixed_axes( axes.data( ), count, actual_fixed.data( ) );
+            report( actual_fixed == expected_fixed, level, "to_fixed_axes", count, mismatches );
+
+            auto expected_axes = std::vector< float >( count );
+            auto actual_axes   = std::vector< float >( count );
+            scalar.from_fixed_axes( expected_fixed.data( ), count, expected_axes.data( ) );
+            kernels.from_fixed_axes( expected_fixed.data( ), count, actual_axes.data( ) );
+            report( same( actual_axes, expected_axes ), level, "from_fixed_axes", count, mismatches );
+
+            // Decoded blocks hold signed steps in unsigned words.
+            auto quantized = std::vector< std::uint32_t >( count );
+            for ( auto& value : quantized )
+            {
+                auto const step = static_cast< std::int32_t >( random.uniform( -32'767.f, 32'767.f ) );
+                value           = static_cast< std::uint32_t >( step );
+            }
+            scalar.dequantize_axes( quantized.data( ), count, expected_axes.data( ) );
+            kernels.dequantize_axes( quantized.data( ), count, actual_axes.data( ) );
+            report( same( actual_axes, expected_axes ), level, "dequantize_axes", count, mismatches );
+        }
+    }
+    LTB_CHECK( mismatches == 0UL );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    std::fprintf( stderr, "Comparing %zu SIMD level(s) against scalar\n", ltb::joy::vector_levels( ).size( ) );
+    ltb::joy::matches_scalar_mapping( );
+    ltb::joy::matches_scalar_filters( );
+    ltb::joy::matches_scalar_diffs_and_encoding( );
+    return ltb::testing::exit_code( );
+}
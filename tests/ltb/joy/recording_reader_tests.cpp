@@ -0,0 +1,401 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/fixed_point.hpp"
+#include "ltb/joy/recording_reader.hpp"
+
+// standard
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace ltb::joy
+{
+namespace
+{
+
+auto test_joystick( ) -> Joystick
+{
+    auto joystick         = Joystick{ };
+    joystick.name         = "Test Pad";
+    joystick.guid         = "03000000de280000ff11000001000000";
+    joystick.device_id    = 3;
+    joystick.timestamp_us = 1'000;
+    joystick.axes         = { 0.5f, -0.25f, 1.f };
+    joystick.buttons      = { 1, 0 };
+    return joystick;
+}
+
+auto test_event( ) -> InputEvent
+{
+    auto event         = InputEvent{ };
+    event.timestamp_us = 1'500;
+    event.device_id    = 3;
+    event.control      = 1;
+    event.type         = InputEventType::Button;
+    event.value        = 1.f;
+    return event;
+}
+
+auto file_header( ) -> std::vector< std::byte >
+{
+    auto const header = RecordingFileHeader{ };
+    auto       bytes  = std::vector< std::byte >( sizeof( header ) );
+    std::memcpy( bytes.data( ), &header, sizeof( header ) );
+    return bytes;
+}
+
+/// \brief Append the indices and footer a finished recording ends with.
+auto finalize( std::vector< std::byte >& bytes ) -> void
+{
+    auto builder = RecordIndexBuilder{ };
+    for ( auto offset = sizeof( RecordingFileHeader ); offset < bytes.size( ); )
+    {
+        auto header = RecordHeader{ };
+        std::memcpy( &header, bytes.data( ) + offset, sizeof( header ) );
+        builder.add( header, offset );
+        offset += header.size;
+    }
+
+    auto const footer = builder.footer( bytes.size( ), { } );
+    auto const append = [ &bytes ]( void const* data, std::size_t size ) {
+        auto const offset = bytes.size( );
+        bytes.resize( offset + size );
+        std::memcpy( bytes.data( ) + offset, data, size );
+    };
+    append( builder.entries( ).data( ), builder.entries( ).size( ) * sizeof( RecordIndexEntry ) );
+    append( builder.keyframes( ).data( ), builder.keyframes( ).size( ) * sizeof( RecordIndexEntry ) );
+    append( &footer, sizeof( footer ) );
+}
+
+auto open_bytes( std::string const& name, std::vector< std::byte > const& bytes ) -> utils::Expected< RecordingReader >
+{
+    auto const path = testing::temporary_path( name );
+    LTB_CHECK( testing::write_file( path, bytes ) );
+    return RecordingReader::open( path );
+}
+
+auto record_count( RecordingReader const& reader ) -> std::size_t
+{
+    auto count = 0UL;
+    for ( auto iterator = reader.begin( ); iterator != reader.end( ); ++iterator )
+    {
+        ++count;
+    }
+    return count;
+}
+
+auto reads_every_record_type( bool finalized ) -> void
+{
+    auto const joystick = test_joystick( );
+    auto const event    = test_event( );
+
+    auto bytes = file_header( );
+    append_device_record( joystick, bytes );
+    append_snapshot_record( joystick, bytes );
+    append_fixed_snapshot_record( joystick, bytes );
+    append_event_record( event, bytes );
+    append_keyframe_record( joystick, bytes );
+    if ( finalized )
+    {
+        finalize( bytes );
+    }
+
+    auto reader = open_bytes( finalized ? "finalized.ltbrec" : "unfinalized.ltbrec", bytes );
+    if ( !LTB_CHECK( reader ) )
+    {
+        return;
+    }
+    LTB_CHECK( reader->was_finalized( ) == finalized );
+    LTB_CHECK( reader->record_count( ) == 5UL );
+    LTB_CHECK( reader->keyframe_count( ) == 1UL );
+    LTB_CHECK( reader->end_time_us( ) == event.timestamp_us );
+
+    auto iterator = reader->begin( );
+
+    auto const device = ( *iterator ).device( );
+    LTB_CHECK( ( *iterator ).type( ) == RecordType::Device );
+    LTB_CHECK( ( *iterator ).device_id( ) == joystick.device_id );
+    LTB_CHECK( device.name == joystick.name );
+    LTB_CHECK( device.guid == joystick.guid );
+
+    auto axes = std::vector< float >{ };
+    ++iterator;
+    auto const snapshot = ( *iterator ).snapshot( );
+    snapshot.copy_axes( axes );
+    LTB_CHECK( ( *iterator ).type( ) == RecordType::Snapshot );
+    LTB_CHECK( ( *iterator ).timestamp_us( ) == joystick.timestamp_us );
+    LTB_CHECK( axes == joystick.axes );
+    LTB_CHECK( std::vector< unsigned char >( snapshot.buttons, snapshot.buttons + snapshot.button_count )
+               == joystick.buttons );
+
+    auto rounded = joystick.axes;
+    round_to_fixed_axes( rounded );
+    ++iterator;
+    auto const fixed = ( *iterator ).snapshot( );
+    fixed.copy_axes( axes );
+    LTB_CHECK( ( *iterator ).type( ) == RecordType::FixedSnapshot );
+    LTB_CHECK( fixed.axes == nullptr && fixed.fixed_axes != nullptr );
+    LTB_CHECK( axes == rounded );
+    LTB_CHECK( std::vector< unsigned char >( fixed.buttons, fixed.buttons + fixed.button_count ) == joystick.buttons );
+
+    ++iterator;
+    auto const read_event = ( *iterator ).event( );
+    LTB_CHECK( ( *iterator ).type( ) == RecordType::Event );
+    LTB_CHECK( read_event.timestamp_us == event.timestamp_us );
+    LTB_CHECK( read_event.device_id == event.device_id );
+    LTB_CHECK( read_event.control == event.control );
+    LTB_CHECK( read_event.type == event.type );
+    LTB_CHECK( read_event.value == event.value );
+
+    ++iterator;
+    auto const keyframe = ( *iterator ).keyframe( );
+    LTB_CHECK( ( *iterator ).type( ) == RecordType::Keyframe );
+    LTB_CHECK( keyframe.device.name == joystick.name );
+    LTB_CHECK( keyframe.device.guid == joystick.guid );
+    keyframe.snapshot.copy_axes( axes );
+    LTB_CHECK( axes == joystick.axes );
+    LTB_CHECK( reader->seek_keyframe( joystick.timestamp_us ) == iterator );
+
+    ++iterator;
+    LTB_CHECK( iterator == reader->end( ) );
+}
+
+/// \brief Overwrite the `std::uint16_t` at `field` bytes into the payload of the record at `offset`.
+auto corrupt_field( std::vector< std::byte >& bytes, std::size_t offset, std::size_t field ) -> void
+{
+    auto const value = std::uint16_t( 0xffff );
+    std::memcpy( bytes.data( ) + offset + sizeof( RecordHeader ) + field, &value, sizeof( value ) );
+}
+
+/// \brief Appends or damages the record at an offset into a file.
+using RecordEdit = std::function< void( std::vector< std::byte >&, std::size_t ) >;
+
+/// \brief A device record and an event, then a record damaged by `corrupt`, then another
+///        event. Only the first two should be read, whether the file was finalized or not.
+auto stops_at_corrupt_record(
+    std::string const& name,
+    RecordEdit const&  append,
+    RecordEdit const&  corrupt,
+    bool               finalized
+) -> void
+{
+    auto bytes = file_header( );
+    append_device_record( test_joystick( ), bytes );
+    append_event_record( test_event( ), bytes );
+
+    auto const offset = bytes.size( );
+    append( bytes, offset );
+    corrupt( bytes, offset );
+    append_event_record( test_event( ), bytes );
+    if ( finalized )
+    {
+        finalize( bytes );
+    }
+
+    auto reader = open_bytes( name, bytes );
+    if ( LTB_CHECK( reader ) )
+    {
+        if ( !LTB_CHECK( record_count( *reader ) == 2UL ) )
+        {
+            std::fprintf( stderr, "    in %s\n", name.c_str( ) );
+        }
+    }
+}
+
+auto stops_at_corrupt_records( ) -> void
+{
+    auto const device = []( std::vector< std::byte >& bytes, std::size_t ) {
+        append_device_record( test_joystick( ), bytes );
+    };
+    auto const snapshot = []( std::vector< std::byte >& bytes, std::size_t ) {
+        append_snapshot_record( test_joystick( ), bytes );
+    };
+    auto const fixed_snapshot = []( std::vector< std::byte >& bytes, std::size_t ) {
+        append_fixed_snapshot_record( test_joystick( ), bytes );
+    };
+    auto const keyframe = []( std::vector< std::byte >& bytes, std::size_t ) {
+        append_keyframe_record( test_joystick( ), bytes );
+    };
+    auto const field = []( std::size_t field_offset ) {
+        return [ field_offset ]( std::vector< std::byte >& bytes, std::size_t offset ) {
+            corrupt_field( bytes, offset, field_offset );
+        };
+    };
+    auto const record_size = []( std::uint32_t size ) {
+        return [ size ]( std::vector< std::byte >& bytes, std::size_t offset ) {
+            std::memcpy( bytes.data( ) + offset + offsetof( RecordHeader, size ), &size, sizeof( size ) );
+        };
+    };
+
+    for ( auto const finalized : { false, true } )
+    {
+        auto const suffix = std::string( finalized ? "_finalized.ltbrec" : ".ltbrec" );
+
+        auto const name_size = field( offsetof( DevicePayload, name_size ) );
+        auto const guid_size = field( offsetof( DevicePayload, guid_size ) );
+
+        stops_at_corrupt_record( "device_name" + suffix, device, name_size, finalized );
+        stops_at_corrupt_record( "device_guid" + suffix, device, guid_size, finalized );
+        stops_at_corrupt_record(
+            "snapshot_axes" + suffix,
+            snapshot,
+            field( offsetof( SnapshotPayload, axis_count ) ),
+            finalized
+        );
+        stops_at_corrupt_record(
+            "fixed_snapshot_buttons" + suffix,
+            fixed_snapshot,
+            field( offsetof( SnapshotPayload, button_count ) ),
+            finalized
+        );
+        stops_at_corrupt_record(
+            "keyframe_axes" + suffix,
+            keyframe,
+            field( offsetof( KeyframePayload, axis_count ) ),
+            finalized
+        );
+        stops_at_corrupt_record(
+            "keyframe_guid" + suffix,
+            keyframe,
+            field( offsetof( KeyframePayload, guid_size ) ),
+            finalized
+        );
+        stops_at_corrupt_record( "unaligned_size" + suffix, snapshot, record_size( 20U ), finalized );
+        stops_at_corrupt_record( "too_small_for_payload" + suffix, snapshot, record_size( 16U ), finalized );
+    }
+}
+
+auto stops_at_truncated_record( ) -> void
+{
+    auto bytes = file_header( );
+    append_device_record( test_joystick( ), bytes );
+    append_snapshot_record( test_joystick( ), bytes );
+    bytes.resize( bytes.size( ) - record_alignment );
+
+    auto reader = open_bytes( "truncated.ltbrec", bytes );
+    if ( LTB_CHECK( reader ) )
+    {
+        LTB_CHECK( !reader->was_finalized( ) );
+        LTB_CHECK( reader->record_count( ) == 1UL );
+        LTB_CHECK( record_count( *reader ) == 1UL );
+    }
+}
+
+/// \brief A finalized recording of `event_count` events and a keyframe, long enough for
+///        several sparse index entries.
+auto indexed_recording( std::uint64_t event_count ) -> std::vector< std::byte >
+{
+    auto bytes = file_header( );
+    append_keyframe_record( test_joystick( ), bytes );
+    auto event = test_event( );
+    for ( auto e = 0UL; e < event_count; ++e )
+    {
+        event.timestamp_us = test_joystick( ).timestamp_us + static_cast< std::int64_t >( e );
+        append_event_record( event, bytes );
+    }
+    finalize( bytes );
+    return bytes;
+}
+
+/// \brief The index entry `entry` entries into the footer's sparse index, which is followed
+///        directly by the keyframe index.
+auto index_entry( std::vector< std::byte >& bytes, std::size_t entry ) -> RecordIndexEntry*
+{
+    auto footer = RecordingFooter{ };
+    std::memcpy( &footer, bytes.data( ) + bytes.size( ) - sizeof( footer ), sizeof( footer ) );
+    return reinterpret_cast< RecordIndexEntry* >( bytes.data( ) + footer.index_offset ) + entry;
+}
+
+/// \brief Damages a whole file.
+using FileEdit = std::function< void( std::vector< std::byte >& ) >;
+
+/// \brief A footer whose entries point outside the records or out of order is ignored, and
+///        the index is rebuilt from the records instead.
+auto rebuilds_corrupt_index( std::string const& name, FileEdit const& corrupt )
+    -> void
+{
+    auto const event_count = 2UL * record_index_stride + 10UL;
+
+    auto bytes = indexed_recording( event_count );
+    corrupt( bytes );
+
+    auto reader = open_bytes( name + ".ltbrec", bytes );
+    if ( !LTB_CHECK( reader ) )
+    {
+        return;
+    }
+    if ( !LTB_CHECK( !reader->was_finalized( ) ) )
+    {
+        std::fprintf( stderr, "    in %s\n", name.c_str( ) );
+    }
+    LTB_CHECK( reader->record_count( ) == event_count + 1UL );
+    LTB_CHECK( reader->keyframe_count( ) == 1UL );
+    LTB_CHECK( ( *reader->seek_sequence( record_index_stride + 5UL ) ).timestamp_us( )
+               == test_joystick( ).timestamp_us + std::int64_t( record_index_stride + 4UL ) );
+    LTB_CHECK( ( *reader->seek_time( test_joystick( ).timestamp_us + 2000 ) ).timestamp_us( )
+               == test_joystick( ).timestamp_us + 2000 );
+    LTB_CHECK( reader->seek_keyframe( test_joystick( ).timestamp_us ) == reader->begin( ) );
+}
+
+auto rebuilds_corrupt_indices( ) -> void
+{
+    // The uncorrupted file is used as is.
+    auto bytes  = indexed_recording( 2UL * record_index_stride + 10UL );
+    auto reader = open_bytes( "indexed.ltbrec", bytes );
+    if ( LTB_CHECK( reader ) )
+    {
+        LTB_CHECK( reader->was_finalized( ) );
+        LTB_CHECK( reader->seek_keyframe( test_joystick( ).timestamp_us ) == reader->begin( ) );
+    }
+
+    rebuilds_corrupt_index( "index_past_records", []( auto& b ) { index_entry( b, 1UL )->offset = b.size( ); } );
+    rebuilds_corrupt_index( "index_in_header", []( auto& b ) { index_entry( b, 1UL )->offset = 0UL; } );
+    rebuilds_corrupt_index( "index_unaligned", []( auto& b ) { index_entry( b, 1UL )->offset += 4UL; } );
+    rebuilds_corrupt_index( "index_unsorted", []( auto& b ) {
+        std::swap( *index_entry( b, 1UL ), *index_entry( b, 2UL ) );
+    } );
+    rebuilds_corrupt_index( "index_first_sequence", []( auto& b ) { index_entry( b, 0UL )->sequence = 1UL; } );
+    rebuilds_corrupt_index( "index_sequence_past_end", []( auto& b ) { index_entry( b, 2UL )->sequence = ~0UL; } );
+    rebuilds_corrupt_index( "index_time_unsorted", []( auto& b ) { index_entry( b, 2UL )->max_timestamp_us = 0; } );
+    rebuilds_corrupt_index( "keyframe_past_records", []( auto& b ) { index_entry( b, 3UL )->offset = ~0UL; } );
+    rebuilds_corrupt_index( "footer_size", []( auto& b ) {
+        auto const footer_size = std::uint64_t( sizeof( RecordingFooter ) - record_alignment );
+        auto const offset      = b.size( ) - sizeof( RecordingFooter ) + offsetof( RecordingFooter, footer_size );
+        std::memcpy( b.data( ) + offset, &footer_size, sizeof( footer_size ) );
+    } );
+}
+
+auto rejects_files_that_are_not_recordings( ) -> void
+{
+    auto bytes = file_header( );
+    bytes[ 0 ] = std::byte{ 'X' };
+    LTB_CHECK( !open_bytes( "bad_magic.ltbrec", bytes ) );
+
+    auto const version = recording_format_version + 1U;
+    bytes              = file_header( );
+    std::memcpy( bytes.data( ) + offsetof( RecordingFileHeader, version ), &version, sizeof( version ) );
+    LTB_CHECK( !open_bytes( "newer_version.ltbrec", bytes ) );
+
+    bytes = file_header( );
+    bytes.resize( sizeof( RecordingFileHeader ) - 1UL );
+    LTB_CHECK( !open_bytes( "too_small.ltbrec", bytes ) );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::reads_every_record_type( false );
+    ltb::joy::reads_every_record_type( true );
+    ltb::joy::stops_at_corrupt_records( );
+    ltb::joy::stops_at_truncated_record( );
+    ltb::joy::rebuilds_corrupt_indices( );
+    ltb::joy::rejects_files_that_are_not_recordings( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,112 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/test_recordings.hpp"
+
+// project
+#include "ltb/joy/recording_verify.hpp"
+
+// standard
+#include <cmath>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief Enough snapshots to span several checksum blocks.
+constexpr auto snapshot_count = 100'000UL;
+
+/// \brief An unfinalized recording of a device polled `snapshot_count` times.
+auto test_records( ) -> std::vector< std::byte >
+{
+    auto bytes = testing::recording_header( );
+
+    auto pad      = Joystick{ };
+    pad.name      = "Test Pad";
+    pad.guid      = "03000000de280000ff11000001000000";
+    pad.device_id = 1;
+    pad.buttons   = { 0, 1, 0, 1 };
+    append_device_record( pad, bytes );
+
+    for ( auto s = 0UL; s < snapshot_count; ++s )
+    {
+        auto const t     = static_cast< float >( s );
+        pad.timestamp_us = static_cast< std::int64_t >( s * 500UL );
+        pad.axes         = { std::sin( t * 0.01f ), std::cos( t * 0.01f ) };
+        append_snapshot_record( pad, bytes );
+    }
+    return bytes;
+}
+
+auto error_message( utils::Expected< void > const& result ) -> std::string
+{
+    return result ? std::string{ } : result.error( ).error_message( );
+}
+
+auto contains( std::string const& text, std::string const& part ) -> bool
+{
+    return text.find( part ) != std::string::npos;
+}
+
+auto footer_at( std::vector< std::byte >& bytes ) -> RecordingFooter*
+{
+    return reinterpret_cast< RecordingFooter* >( bytes.data( ) + bytes.size( ) - sizeof( RecordingFooter ) );
+}
+
+auto verifies_intact_recording( ) -> void
+{
+    auto bytes = test_records( );
+    testing::finalize_recording( bytes );
+    LTB_CHECK( footer_at( bytes )->checksum_count > 2UL );
+    LTB_CHECK( verify_recording( testing::temporary_recording( "verify_intact.ltbrec", bytes ) ) );
+}
+
+auto reports_corrupt_blocks( ) -> void
+{
+    auto valid = test_records( );
+    testing::finalize_recording( valid );
+
+    // One flipped bit in the second block is reported with that block's range.
+    auto bytes = valid;
+    bytes[ checksum_block_size + 1'000UL ] ^= std::byte( 0x10 );
+
+    auto const second_block = "[" + std::to_string( checksum_block_size ) + ", "
+                            + std::to_string( 2UL * checksum_block_size ) + ")";
+    auto const one_block    = verify_recording( testing::temporary_recording( "verify_one.ltbrec", bytes ) );
+    LTB_CHECK( !one_block );
+    LTB_CHECK( contains( error_message( one_block ), "1 corrupt block(s)" ) );
+    LTB_CHECK( contains( error_message( one_block ), second_block ) );
+
+    // Damage to the first and last blocks of records is reported too.
+    bytes[ sizeof( RecordingFileHeader ) + 200UL ] ^= std::byte( 0x01 );
+    bytes[ footer_at( bytes )->index_offset - 1UL ] ^= std::byte( 0x01 );
+    auto const three_blocks = verify_recording( testing::temporary_recording( "verify_three.ltbrec", bytes ) );
+    LTB_CHECK( contains( error_message( three_blocks ), "3 corrupt block(s)" ) );
+
+    // A corrupt checksum table is caught before any block is compared against it.
+    bytes = valid;
+    bytes[ footer_at( bytes )->checksum_offset ] ^= std::byte( 0x01 );
+    auto const table = verify_recording( testing::temporary_recording( "verify_table.ltbrec", bytes ) );
+    LTB_CHECK( contains( error_message( table ), "corrupt checksum table" ) );
+}
+
+auto rejects_unfinalized_recording( ) -> void
+{
+    auto const path   = testing::temporary_recording( "verify_unfinalized.ltbrec", test_records( ) );
+    auto const result = verify_recording( path );
+    LTB_CHECK( contains( error_message( result ), "never finalized" ) );
+    LTB_CHECK( !verify_recording( testing::temporary_path( "verify_missing.ltbrec" ) ) );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::verifies_intact_recording( );
+    ltb::joy::reports_corrupt_blocks( );
+    ltb::joy::rejects_unfinalized_recording( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,167 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/test_recordings.hpp"
+
+// project
+#include "ltb/joy/replay.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto start_time_us    = std::int64_t( 2'000'000 );
+constexpr auto frame_period_us  = std::int64_t( 1'000 );
+constexpr auto frame_count      = 3'500L;
+constexpr auto frames_per_group = keyframe_interval_us / frame_period_us;
+
+/// \brief The stick is polled just after the pad, so seeks can land between the two.
+constexpr auto stick_offset_us = std::int64_t( 3 );
+
+/// \brief A recording and every snapshot in it, one per frame and device.
+struct TestSession
+{
+    std::vector< std::byte > bytes  = { };
+    std::vector< Joystick >  pads   = { };
+    std::vector< Joystick >  sticks = { };
+};
+
+/// \brief A pad written as plain snapshots and a stick written as delta blocks, with a
+///        keyframe group every second. The stick's block is not flushed before its keyframe,
+///        so samples the keyframe already holds follow it in the file.
+auto test_session( ) -> TestSession
+{
+    auto session  = TestSession{ };
+    session.bytes = testing::recording_header( start_time_us );
+
+    auto pad         = Joystick{ };
+    pad.name         = "Test Pad";
+    pad.guid         = "03000000de280000ff11000001000000";
+    pad.device_id    = 4;
+    pad.timestamp_us = start_time_us;
+    pad.buttons      = { 0, 0 };
+
+    auto stick         = Joystick{ };
+    stick.name         = "Test Stick";
+    stick.guid         = "030000006d04000015c2000010010000";
+    stick.device_id    = 6;
+    stick.timestamp_us = start_time_us;
+
+    append_device_record( pad, session.bytes );
+    append_device_record( stick, session.bytes );
+
+    auto encoder = SnapshotBlockEncoder{ };
+    for ( auto f = 0L; f < frame_count; ++f )
+    {
+        auto const t = static_cast< float >( f );
+
+        pad.timestamp_us = start_time_us + f * frame_period_us;
+        pad.axes         = { std::sin( t * 0.01f ), std::cos( t * 0.003f ) };
+        pad.buttons[ 1 ] = static_cast< unsigned char >( ( f / 11L ) % 2L );
+        append_snapshot_record( pad, session.bytes );
+        session.pads.push_back( pad );
+
+        stick.timestamp_us = pad.timestamp_us + stick_offset_us;
+        stick.axes         = { std::sin( t * 0.002f ) * 0.75f };
+        encoder.add( stick, session.bytes );
+
+        auto stored = stick;
+        quantize_axes( stored.axes );
+        session.sticks.push_back( stored );
+
+        if ( f % frames_per_group == frames_per_group - 1L )
+        {
+            append_keyframe_record( pad, session.bytes );
+            append_keyframe_record( stored, session.bytes );
+        }
+    }
+    encoder.flush( session.bytes );
+    return session;
+}
+
+/// \brief The last of `snapshots` recorded at or before `time_us`.
+auto state_at( std::vector< Joystick > const& snapshots, std::int64_t time_us ) -> Joystick const&
+{
+    auto const frame = ( time_us - snapshots.front( ).timestamp_us ) / frame_period_us;
+    return snapshots[ static_cast< std::size_t >( std::clamp( frame, 0L, frame_count - 1L ) ) ];
+}
+
+auto same_state( Joystick const& actual, Joystick const& expected ) -> bool
+{
+    return actual.device_id == expected.device_id && actual.name == expected.name && actual.guid == expected.guid
+        && actual.timestamp_us == expected.timestamp_us && actual.axes == expected.axes
+        && actual.buttons == expected.buttons;
+}
+
+/// \brief Whether `joysticks` are the pad and stick as recorded at `time_us`.
+auto matches( TestSession const& session, std::vector< Joystick > const& joysticks, std::int64_t time_us ) -> bool
+{
+    return joysticks.size( ) == 2UL && same_state( joysticks[ 0 ], state_at( session.pads, time_us ) )
+        && same_state( joysticks[ 1 ], state_at( session.sticks, time_us ) );
+}
+
+auto seeks_to_recorded_state( bool finalized ) -> void
+{
+    auto session = test_session( );
+    if ( finalized )
+    {
+        testing::finalize_recording( session.bytes );
+    }
+    auto const name   = std::string( finalized ? "replay_finalized.ltbrec" : "replay_unfinalized.ltbrec" );
+    auto       replay = ReplaySource::open( testing::temporary_recording( name, session.bytes ), 1.0, frame_period_us );
+    if ( !LTB_CHECK( replay ) )
+    {
+        return;
+    }
+    LTB_CHECK( replay->reader( ).was_finalized( ) == finalized );
+    LTB_CHECK( replay->reader( ).keyframe_count( ) == static_cast< std::size_t >( frame_count / frames_per_group ) );
+
+    auto const group_us = keyframe_interval_us;
+    auto const end_us   = session.pads.back( ).timestamp_us;
+
+    // Forwards and backwards, onto keyframes, just either side of them, and past the end.
+    for ( auto const offset_us : {
+              std::int64_t( 10'500 ),
+              group_us - frame_period_us + stick_offset_us,
+              group_us - frame_period_us + stick_offset_us - 1,
+              2 * group_us + 250'250,
+              group_us + 1,
+              3 * group_us - frame_period_us + stick_offset_us + 1,
+              end_us - start_time_us,
+              end_us - start_time_us + 5 * group_us,
+              std::int64_t( 400'003 ),
+          } )
+    {
+        auto const time_us = start_time_us + offset_us;
+        replay->seek( time_us );
+        LTB_CHECK( replay->clock( ).now_us( ) == time_us );
+
+        // A seek lands on the recorded state, and polling carries on from there.
+        if ( !LTB_CHECK( matches( session, replay->poll( ), time_us + frame_period_us ) ) )
+        {
+            std::fprintf( stderr, "    seek to +%lld us\n", static_cast< long long >( offset_us ) );
+        }
+        for ( auto p = 0; p < 3; ++p )
+        {
+            auto const joysticks = replay->poll( );
+            LTB_CHECK( matches( session, joysticks, replay->clock( ).now_us( ) ) );
+        }
+    }
+    LTB_CHECK( replay->corrupt_block_count( ) == 0UL );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::seeks_to_recorded_state( true );
+    ltb::joy::seeks_to_recorded_state( false );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,288 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/joy/test_recordings.hpp"
+
+// project
+#include "ltb/joy/session_catalog.hpp"
+#include "ltb/joy/snapshot_codec.hpp"
+
+// standard
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto start_time_us   = std::int64_t( 3'000'000 );
+constexpr auto pad_samples     = 100L;
+constexpr auto pad_period_us   = std::int64_t( 10'000 );
+constexpr auto pad_event_count = 3L;
+
+auto test_pad( ) -> Joystick
+{
+    auto pad         = Joystick{ };
+    pad.name         = "Test Pad";
+    pad.guid         = "03000000de280000ff11000001000000";
+    pad.device_id    = 1;
+    pad.timestamp_us = start_time_us;
+    pad.buttons      = { 0, 0, 0 };
+    return pad;
+}
+
+auto pad_axis( long sample, std::size_t axis ) -> float
+{
+    auto const t = static_cast< float >( sample );
+    return ( axis == 0UL ) ? std::sin( t * 0.1f ) * 0.5f : std::cos( t * 0.05f );
+}
+
+/// \brief A finalized recording of a pad polled `pad_samples` times, with a few events.
+auto pad_recording( ) -> std::vector< std::byte >
+{
+    auto bytes = testing::recording_header( start_time_us );
+    auto pad   = test_pad( );
+    append_device_record( pad, bytes );
+
+    auto event      = InputEvent{ };
+    event.device_id = pad.device_id;
+    event.type      = InputEventType::Button;
+    event.value     = 1.f;
+
+    for ( auto s = 0L; s < pad_samples; ++s )
+    {
+        pad.timestamp_us = start_time_us + s * pad_period_us;
+        pad.axes         = { pad_axis( s, 0UL ), pad_axis( s, 1UL ) };
+        append_snapshot_record( pad, bytes );
+        if ( s % 40L == 1L )
+        {
+            event.timestamp_us = pad.timestamp_us + 1;
+            append_event_record( event, bytes );
+        }
+    }
+    testing::finalize_recording( bytes );
+    return bytes;
+}
+
+/// \brief An unfinalized recording of a stick written as delta blocks, whose device ID is
+///        then reused by a different device. The stick's values are added to `stick_axes`
+///        as the blocks store them.
+auto stick_recording( std::vector< float >& stick_axes ) -> std::vector< std::byte >
+{
+    auto bytes = testing::recording_header( start_time_us );
+
+    auto stick         = Joystick{ };
+    stick.name         = "Flight Stick";
+    stick.guid         = "030000006d04000015c2000010010000";
+    stick.device_id    = 2;
+    stick.timestamp_us = start_time_us;
+    append_device_record( stick, bytes );
+
+    auto encoder = SnapshotBlockEncoder{ };
+    for ( auto s = 0L; s < 50L; ++s )
+    {
+        stick.timestamp_us = start_time_us + s * 1'000;
+        stick.axes         = { static_cast< float >( s ) / 49.f - 0.25f };
+        encoder.add( stick, bytes );
+        quantize_axes( stick.axes );
+        stick_axes.push_back( stick.axes[ 0 ] );
+    }
+    encoder.flush( bytes );
+
+    auto wheel         = stick;
+    wheel.name         = "Racing Wheel";
+    wheel.guid         = "030000004f04000015b3000010010000";
+    wheel.timestamp_us = stick.timestamp_us + 1'000;
+    wheel.axes         = { 0.f, 0.f, 0.f };
+    append_device_record( wheel, bytes );
+    append_snapshot_record( wheel, bytes );
+    return bytes;
+}
+
+auto write_bytes( std::filesystem::path const& path, std::vector< std::byte > const& bytes ) -> bool
+{
+    auto error_code = std::error_code{ };
+    std::filesystem::create_directories( path.parent_path( ), error_code );
+    return testing::write_file( path, bytes );
+}
+
+auto text_bytes( std::string const& text ) -> std::vector< std::byte >
+{
+    auto const* data = reinterpret_cast< std::byte const* >( text.data( ) );
+    return { data, data + text.size( ) };
+}
+
+auto remove_directory( std::filesystem::path const& directory ) -> void
+{
+    auto error_code = std::error_code{ };
+    std::filesystem::remove_all( directory, error_code );
+}
+
+/// \brief Whether a temporary catalog was left behind anywhere under `directory`.
+auto has_temporary_files( std::filesystem::path const& directory ) -> bool
+{
+    auto const iter = std::filesystem::recursive_directory_iterator( directory );
+    return std::any_of( begin( iter ), end( iter ), []( auto const& entry ) {
+        return entry.path( ).extension( ) == ".tmp";
+    } );
+}
+
+auto catalogs_directory( ) -> void
+{
+    auto const directory = testing::temporary_path( "catalog" );
+    LTB_CHECK( !SessionCatalog::open( directory ) );
+
+    auto       stick_axes = std::vector< float >{ };
+    auto const pad_path   = directory / "a" / "pad.ltbrec";
+    LTB_CHECK( write_bytes( pad_path, pad_recording( ) ) );
+    LTB_CHECK( write_bytes( directory / "stick.ltbrec", stick_recording( stick_axes ) ) );
+    LTB_CHECK( write_bytes( directory / "notes.txt", text_bytes( "not a recording" ) ) );
+    LTB_CHECK( write_bytes( directory / "pad.ltbrec.pyramid", text_bytes( "left out by name" ) ) );
+    LTB_CHECK( write_bytes( directory / "recording.ltbrec", pad_recording( ) ) );
+
+    auto catalog = SessionCatalog::update( directory, directory / "recording.ltbrec" );
+    if ( !LTB_CHECK( catalog ) || !LTB_CHECK( catalog->session_count( ) == 2UL ) )
+    {
+        remove_directory( directory );
+        return;
+    }
+    LTB_CHECK( !has_temporary_files( directory ) );
+
+    // Sessions are sorted by path relative to the directory.
+    LTB_CHECK( catalog->session_path( 0UL ) == pad_path );
+    LTB_CHECK( catalog->session_path( 1UL ) == directory / "stick.ltbrec" );
+
+    auto const& pad = catalog->session( 0UL );
+    LTB_CHECK( pad.file_size == std::filesystem::file_size( pad_path ) );
+    LTB_CHECK( pad.start_time_us == start_time_us );
+    LTB_CHECK( pad.end_time_us == start_time_us + ( pad_samples - 1L ) * pad_period_us );
+    LTB_CHECK( pad.snapshot_count == static_cast< std::uint64_t >( pad_samples ) );
+    LTB_CHECK( pad.event_count == static_cast< std::uint64_t >( pad_event_count ) );
+    LTB_CHECK( pad.record_count == 1UL + pad.snapshot_count + pad.event_count );
+    if ( LTB_CHECK( pad.device_count == 1U ) )
+    {
+        auto const& device = catalog->devices( pad )[ 0 ];
+        LTB_CHECK( catalog->device_name( device ) == "Test Pad" );
+        LTB_CHECK( catalog->device_guid( device ) == test_pad( ).guid );
+        LTB_CHECK( device.button_count == 3U );
+        LTB_CHECK( device.snapshot_count == pad.snapshot_count );
+        LTB_CHECK( device.axis_count == 2U );
+        for ( auto a = 0UL; a < device.axis_count; ++a )
+        {
+            auto min = std::numeric_limits< float >::infinity( );
+            auto max = -min;
+            for ( auto s = 0L; s < pad_samples; ++s )
+            {
+                min = std::min( min, pad_axis( s, a ) );
+                max = std::max( max, pad_axis( s, a ) );
+            }
+            LTB_CHECK( catalog->axis_ranges( device )[ a ].min == min );
+            LTB_CHECK( catalog->axis_ranges( device )[ a ].max == max );
+        }
+    }
+
+    // A reused device ID gets a second entry, and block samples are counted one by one.
+    auto const& stick = catalog->session( 1UL );
+    LTB_CHECK( stick.snapshot_count == stick_axes.size( ) + 1UL );
+    if ( LTB_CHECK( stick.device_count == 2U ) )
+    {
+        auto const* devices = catalog->devices( stick );
+        LTB_CHECK( catalog->device_name( devices[ 0 ] ) == "Flight Stick" );
+        LTB_CHECK( catalog->device_name( devices[ 1 ] ) == "Racing Wheel" );
+        LTB_CHECK( devices[ 0 ].snapshot_count == stick_axes.size( ) );
+        LTB_CHECK( devices[ 1 ].axis_count == 3U );
+        LTB_CHECK( catalog->axis_ranges( devices[ 0 ] )[ 0 ].min == stick_axes.front( ) );
+        LTB_CHECK( catalog->axis_ranges( devices[ 0 ] )[ 0 ].max == stick_axes.back( ) );
+    }
+
+    // Only the text file is ignored: the pyramid is left out by name and the skipped
+    // recording is still being written.
+    if ( LTB_CHECK( catalog->ignored_count( ) == 1UL ) )
+    {
+        LTB_CHECK( catalog->ignored( 0UL ).file_size == std::filesystem::file_size( directory / "notes.txt" ) );
+    }
+
+    using Indices = std::vector< std::size_t >;
+    LTB_CHECK( catalog->find( { } ) == Indices( { 0UL, 1UL } ) );
+    LTB_CHECK( catalog->find( { "TEST pad", 0 } ) == Indices( { 0UL } ) );
+    LTB_CHECK( catalog->find( { "4f04", 0 } ) == Indices( { 1UL } ) );
+    LTB_CHECK( catalog->find( { "", pad.end_time_us - pad.start_time_us } ) == Indices( { 0UL } ) );
+    LTB_CHECK( catalog->find( { "wheel", pad.end_time_us - pad.start_time_us } ).empty( ) );
+
+    // An update with nothing changed gives the same catalog, ignored files included.
+    auto const catalog_size = std::filesystem::file_size( catalog_path( directory ) );
+    catalog                 = SessionCatalog::update( directory, directory / "recording.ltbrec" );
+    LTB_CHECK( catalog && catalog->session_count( ) == 2UL && catalog->ignored_count( ) == 1UL );
+    LTB_CHECK( std::filesystem::file_size( catalog_path( directory ) ) == catalog_size );
+
+    // Files that change are scanned again: the ignored file is now a recording, the skipped
+    // recording is finished, and the pad's recording is gone.
+    LTB_CHECK( write_bytes( directory / "notes.txt", pad_recording( ) ) );
+    LTB_CHECK( std::filesystem::remove( pad_path ) );
+    catalog = SessionCatalog::update( directory );
+    if ( LTB_CHECK( catalog ) && LTB_CHECK( catalog->session_count( ) == 3UL ) )
+    {
+        LTB_CHECK( catalog->ignored_count( ) == 0UL );
+        LTB_CHECK( catalog->session_path( 0UL ) == directory / "notes.txt" );
+        LTB_CHECK( catalog->session_path( 1UL ) == directory / "recording.ltbrec" );
+        LTB_CHECK( catalog->find( { "test pad", 0 } ) == Indices( { 0UL, 1UL } ) );
+    }
+    LTB_CHECK( SessionCatalog::open( directory ) );
+    LTB_CHECK( !has_temporary_files( directory ) );
+
+    remove_directory( directory );
+}
+
+auto rejects_corrupt_catalog( ) -> void
+{
+    auto const directory = testing::temporary_path( "catalog_corrupt" );
+    LTB_CHECK( write_bytes( directory / "pad.ltbrec", pad_recording( ) ) );
+    if ( !LTB_CHECK( SessionCatalog::update( directory ) ) )
+    {
+        remove_directory( directory );
+        return;
+    }
+
+    auto const path  = catalog_path( directory );
+    auto       valid = std::vector< std::byte >( std::filesystem::file_size( path ) );
+    {
+        auto file = std::ifstream( path, std::ios::binary );
+        file.read( reinterpret_cast< char* >( valid.data( ) ), static_cast< std::streamsize >( valid.size( ) ) );
+    }
+    auto header_at = []( std::vector< std::byte >& bytes ) {
+        return reinterpret_cast< CatalogFileHeader* >( bytes.data( ) );
+    };
+
+    auto bytes                   = valid;
+    header_at( bytes )->version += 1U;
+    LTB_CHECK( testing::write_file( path, bytes ) && !SessionCatalog::open( directory ) );
+
+    bytes                             = valid;
+    header_at( bytes )->session_count = std::numeric_limits< std::uint64_t >::max( ) / 2UL;
+    LTB_CHECK( testing::write_file( path, bytes ) && !SessionCatalog::open( directory ) );
+
+    bytes = valid;
+    reinterpret_cast< CatalogSession* >( bytes.data( ) + sizeof( CatalogFileHeader ) )->path_offset += 1'000UL;
+    LTB_CHECK( testing::write_file( path, bytes ) && !SessionCatalog::open( directory ) );
+
+    bytes.assign( valid.begin( ), valid.end( ) - 1 );
+    LTB_CHECK( testing::write_file( path, bytes ) && !SessionCatalog::open( directory ) );
+
+    // A corrupt catalog is rebuilt rather than trusted.
+    auto const rebuilt = SessionCatalog::update( directory );
+    LTB_CHECK( rebuilt && rebuilt->session_count( ) == 1UL );
+
+    remove_directory( directory );
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::catalogs_directory( );
+    ltb::joy::rejects_corrupt_catalog( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,196 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/snapshot_codec.hpp"
+
+// standard
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace ltb::joy
+{
+namespace
+{
+
+/// \brief One full block of a device with smoothly moving, jittering, and saturated axes.
+auto test_snapshots( ) -> std::vector< Joystick >
+{
+    auto snapshots = std::vector< Joystick >{ };
+    for ( auto s = 0UL; s < snapshot_block_capacity; ++s )
+    {
+        auto const t = static_cast< float >( s );
+
+        auto& joystick        = snapshots.emplace_back( );
+        joystick.device_id    = 2;
+        joystick.timestamp_us = 5'000'000 + static_cast< std::int64_t >( s * 1'000UL + ( s % 3UL ) * 7UL );
+        joystick.axes         = { std::sin( t * 0.05f ), ( s % 2UL == 0UL ) ? 0.01f : -0.01f, 1.f, -1.f, 0.f };
+        joystick.buttons      = { static_cast< unsigned char >( ( s / 10UL ) % 2UL ), 0, 1 };
+    }
+    return snapshots;
+}
+
+/// \brief The records `SnapshotBlockEncoder` appends for `snapshots`.
+auto encode( std::vector< Joystick > const& snapshots ) -> std::vector< std::byte >
+{
+    auto encoder = SnapshotBlockEncoder{ };
+    auto bytes   = std::vector< std::byte >{ };
+    auto records = std::uint64_t{ 0 };
+    for ( auto const& joystick : snapshots )
+    {
+        records += encoder.add( joystick, bytes );
+    }
+    records += encoder.flush( bytes );
+    LTB_CHECK( records == 1UL );
+    return bytes;
+}
+
+auto round_trips( std::vector< Joystick > const& snapshots ) -> void
+{
+    auto const bytes  = encode( snapshots );
+    auto const record = RecordView( bytes.data( ) );
+    LTB_CHECK( record.type( ) == RecordType::SnapshotBlock );
+    LTB_CHECK( record.header( ).size == bytes.size( ) );
+    LTB_CHECK( record.timestamp_us( ) == snapshots.front( ).timestamp_us );
+
+    auto block = SnapshotBlock{ };
+    if ( !LTB_CHECK( decode_snapshot_block( record, block ) ) )
+    {
+        return;
+    }
+    LTB_CHECK( block.device_id == snapshots.front( ).device_id );
+    LTB_CHECK( block.sample_count == snapshots.size( ) );
+    LTB_CHECK( block.axis_count == snapshots.front( ).axes.size( ) );
+    LTB_CHECK( block.button_count == snapshots.front( ).buttons.size( ) );
+
+    auto decoded = Joystick{ };
+    for ( auto s = 0UL; s < block.sample_count; ++s )
+    {
+        auto expected = snapshots[ s ];
+        quantize_axes( expected.axes );
+
+        block.copy_sample( s, decoded );
+        LTB_CHECK( decoded.device_id == expected.device_id );
+        LTB_CHECK( decoded.timestamp_us == expected.timestamp_us );
+        LTB_CHECK( decoded.axes == expected.axes );
+        LTB_CHECK( decoded.buttons == expected.buttons );
+    }
+}
+
+auto round_trips_every_length( ) -> void
+{
+    auto const snapshots = test_snapshots( );
+    for ( auto count = 1UL; count <= snapshots.size( ); ++count )
+    {
+        round_trips( std::vector< Joystick >( snapshots.begin( ), snapshots.begin( ) + long( count ) ) );
+    }
+}
+
+auto payload_at( std::vector< std::byte >& bytes ) -> SnapshotBlockPayload*
+{
+    return reinterpret_cast< SnapshotBlockPayload* >( bytes.data( ) + sizeof( RecordHeader ) );
+}
+
+auto rejects( std::vector< std::byte > const& bytes, std::string const& what ) -> void
+{
+    auto block = SnapshotBlock{ };
+    if ( !LTB_CHECK( !decode_snapshot_block( RecordView( bytes.data( ) ), block ) ) )
+    {
+        std::fprintf( stderr, "    %s\n", what.c_str( ) );
+    }
+}
+
+auto rejects_corrupt_counts( ) -> void
+{
+    auto const valid = encode( test_snapshots( ) );
+
+    auto bytes                      = valid;
+    payload_at( bytes )->axis_count = 0xffff;
+    rejects( bytes, "axis count past the end" );
+
+    bytes                             = valid;
+    payload_at( bytes )->button_count = 0xffff;
+    rejects( bytes, "button count past the end" );
+
+    bytes                             = valid;
+    payload_at( bytes )->sample_count = std::uint16_t( snapshot_block_capacity + 1UL );
+    rejects( bytes, "more samples than a block holds" );
+
+    bytes                             = valid;
+    payload_at( bytes )->sample_count = 0xffff;
+    rejects( bytes, "sample count past the end" );
+
+    bytes = valid;
+    bytes[ sizeof( RecordHeader ) + sizeof( SnapshotBlockPayload ) ] = std::byte{ 33 };
+    rejects( bytes, "channel wider than 32 bits" );
+}
+
+auto rejects_truncated_blocks( ) -> void
+{
+    auto valid = encode( test_snapshots( ) );
+
+    // Records are padded to `record_alignment`, so any shorter size cuts off encoded bytes.
+    for ( auto size = std::uint32_t( sizeof( RecordHeader ) ); size < valid.size( ); size += record_alignment )
+    {
+        auto bytes = valid;
+        std::memcpy( bytes.data( ) + offsetof( RecordHeader, size ), &size, sizeof( size ) );
+        rejects( bytes, "truncated to " + std::to_string( size ) + " bytes" );
+    }
+
+    // Zero-width channels, but every starting value runs on until the record ends.
+    auto const channels_offset = sizeof( RecordHeader ) + sizeof( SnapshotBlockPayload );
+    auto const channel_count   = 1UL + payload_at( valid )->axis_count + payload_at( valid )->button_count;
+    auto const padded          = ( channels_offset + channel_count + record_alignment - 1UL ) / record_alignment;
+    auto const size            = static_cast< std::uint32_t >( padded * record_alignment );
+
+    auto bytes = std::vector< std::byte >( size, std::byte{ 0xff } );
+    std::memcpy( bytes.data( ), valid.data( ), channels_offset );
+    std::memcpy( bytes.data( ) + offsetof( RecordHeader, size ), &size, sizeof( size ) );
+    std::memset( bytes.data( ) + channels_offset, 0, channel_count );
+    rejects( bytes, "starting values running past the end" );
+}
+
+/// \brief Damaged blocks must decode to something or fail, but never read past their record.
+///        Most useful under a sanitizer.
+auto survives_random_damage( ) -> void
+{
+    auto const valid  = encode( test_snapshots( ) );
+    auto       random = std::mt19937( 1234U );
+    auto       offset = std::uniform_int_distribution< std::size_t >( sizeof( RecordHeader ), valid.size( ) - 1UL );
+    auto       value  = std::uniform_int_distribution< int >( 0, 255 );
+    auto       block  = SnapshotBlock{ };
+
+    for ( auto trial = 0; trial < 10'000; ++trial )
+    {
+        auto bytes = valid;
+        for ( auto flip = 0; flip < 4; ++flip )
+        {
+            bytes[ offset( random ) ] = static_cast< std::byte >( value( random ) );
+        }
+
+        // Copied exactly, so anything read past the record is past the allocation.
+        auto const view = RecordView( bytes.data( ) );
+        if ( decode_snapshot_block( view, block ) )
+        {
+            LTB_CHECK( block.sample_count <= snapshot_block_capacity );
+            LTB_CHECK( block.timestamps_us.size( ) == block.sample_count );
+        }
+    }
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::round_trips_every_length( );
+    ltb::joy::rejects_corrupt_counts( );
+    ltb::joy::rejects_truncated_blocks( );
+    ltb::joy::survives_random_damage( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,294 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/joy/numeric_kernels.hpp"
+#include "ltb/joy/stick_circularity.hpp"
+
+// standard
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace ltb::joy
+{
+namespace
+{
+
+constexpr auto pi        = 3.14159265358979;
+constexpr auto bin_width = 2.0 * pi / double( circularity_angle_bins );
+
+/// \brief The documented accuracy of the polar kernels' angles.
+constexpr auto angle_tolerance = 2e-6;
+
+constexpr auto pad_guid   = "03000000de280000ff11000001000000";
+constexpr auto stick_guid = "030000006d04000015c2000010010000";
+
+auto test_joystick( int device_id, std::string const& guid, std::size_t axis_count ) -> Joystick
+{
+    auto joystick      = Joystick{ };
+    joystick.name      = "Test Pad";
+    joystick.guid      = guid;
+    joystick.device_id = device_id;
+    joystick.axes      = std::vector< float >( axis_count );
+    return joystick;
+}
+
+/// \brief The distance between angles `a` and `b`, across the +-pi seam too.
+auto angle_distance( double a, double b ) -> double
+{
+    auto const difference = std::abs( a - b );
+    return std::min( difference, 2.0 * pi - difference );
+}
+
+auto converts_to_polar( ) -> void
+{
+    // Every direction at a few radii, in one batch longer than the widest vector, plus the
+    // axes, both signs of zero and the center.
+    auto x = std::vector< float >{ 1.f, 0.f, -1.f, 0.f, -1.f, -1.f, 0.f, -0.f, 1e-10f };
+    auto y = std::vector< float >{ 0.f, 1.f, 0.f, -1.f, -0.f, 1e-30f, 0.f, 0.f, 1e-10f };
+    for ( auto i = 0; i < 1'000; ++i )
+    {
+        auto const angle  = -pi + 2.0 * pi * double( i ) / 999.0;
+        auto const radius = 0.05 + 1.5 * double( i % 7 ) / 6.0;
+        x.push_back( static_cast< float >( radius * std::cos( angle ) ) );
+        y.push_back( static_cast< float >( radius * std::sin( angle ) ) );
+    }
+
+    auto magnitudes = std::vector< float >( x.size( ) );
+    auto angles     = std::vector< float >( x.size( ) );
+    numeric_kernels( ).polar_lanes( x.size( ), x.data( ), y.data( ), magnitudes.data( ), angles.data( ) );
+
+    // The center has no direction, so it is left to the checks below.
+    auto far = 0UL;
+    for ( auto i = 8UL; i < x.size( ); ++i )
+    {
+        auto const expected_magnitude = std::hypot( double( x[ i ] ), double( y[ i ] ) );
+        auto const expected_angle     = std::atan2( double( y[ i ] ), double( x[ i ] ) );
+        auto const magnitude_error    = std::abs( double( magnitudes[ i ] ) - expected_magnitude );
+        if ( magnitude_error > 1e-6 * std::max( expected_magnitude, 1e-30 )
+             || angle_distance( double( angles[ i ] ), expected_angle ) > angle_tolerance
+             || std::abs( angles[ i ] ) > float( pi ) )
+        {
+            ++far;
+            std::fprintf( stderr, "    (%g, %g) -> %g\n", double( x[ i ] ), double( y[ i ] ), double( angles[ i ] ) );
+        }
+    }
+    LTB_CHECK( far == 0UL );
+
+    // The axes land exactly, and the center (of either sign) is at zero degrees.
+    LTB_CHECK( angles[ 0 ] == 0.f && magnitudes[ 0 ] == 1.f );
+    LTB_CHECK( std::abs( angles[ 1 ] - float( pi / 2.0 ) ) <= float( angle_tolerance ) );
+    LTB_CHECK( magnitudes[ 6 ] == 0.f && angles[ 6 ] == 0.f );
+    LTB_CHECK( magnitudes[ 7 ] == 0.f && angles[ 7 ] == 0.f );
+}
+
+/// \brief A gate traced by samples spread across every bin (but away from its edges), with
+///        `radius_at` giving the gate's distance from the center in each direction.
+auto trace_gate( std::function< double( double ) > const& radius_at ) -> std::vector< std::pair< float, float > >
+{
+    auto samples = std::vector< std::pair< float, float > >{ };
+    for ( auto bin = 0UL; bin < circularity_angle_bins; ++bin )
+    {
+        for ( auto const offset : { -0.4, -0.2, 0.0, 0.2, 0.4 } )
+        {
+            auto const angle  = ( double( bin ) + offset ) * bin_width;
+            auto const radius = radius_at( angle );
+            samples.emplace_back( float( radius * std::cos( angle ) ), float( radius * std::sin( angle ) ) );
+        }
+    }
+    return samples;
+}
+
+/// \brief The farthest of `samples` in each bin, binned by their exact angles.
+auto expected_radii( std::vector< std::pair< float, float > > const& samples )
+    -> std::array< float, circularity_angle_bins >
+{
+    auto radii = std::array< float, circularity_angle_bins >{ };
+    for ( auto const& [ x, y ] : samples )
+    {
+        auto const radius = std::hypot( double( x ), double( y ) );
+        auto const turns  = std::atan2( double( y ), double( x ) ) / bin_width + double( circularity_angle_bins );
+        auto const bin    = static_cast< std::size_t >( std::lround( turns ) ) % circularity_angle_bins;
+        if ( radius >= double( circularity_min_radius ) )
+        {
+            radii[ bin ] = std::max( radii[ bin ], float( radius ) );
+        }
+    }
+    return radii;
+}
+
+/// \brief Feed `samples` to `tracker` one frame at a time, as the first two axes of `joystick`.
+auto play(
+    std::vector< std::pair< float, float > > const& samples,
+    Joystick&                                       joystick,
+    StickCircularityTracker&                        tracker,
+    AxisMapper const&                               mapper
+) -> void
+{
+    auto joysticks = std::vector< Joystick >{ joystick };
+    for ( auto const& [ x, y ] : samples )
+    {
+        ++joysticks[ 0 ].timestamp_us;
+        joysticks[ 0 ].axes[ 0 ] = x;
+        joysticks[ 0 ].axes[ 1 ] = y;
+        tracker.process( joysticks, mapper );
+    }
+    joystick = joysticks[ 0 ];
+}
+
+auto radii_match( StickCircularity const& stick, std::array< float, circularity_angle_bins > const& expected ) -> bool
+{
+    for ( auto bin = 0UL; bin < circularity_angle_bins; ++bin )
+    {
+        if ( std::abs( stick.max_radius[ bin ] - expected[ bin ] ) > 1e-6f )
+        {
+            auto const actual = double( stick.max_radius[ bin ] );
+            std::fprintf( stderr, "    bin %zu: %g, not %g\n", bin, actual, double( expected[ bin ] ) );
+            return false;
+        }
+    }
+    return true;
+}
+
+auto traces_gates( ) -> void
+{
+    auto const mapper  = AxisMapper{ };
+    auto       tracker = StickCircularityTracker{ };
+    auto       pad     = test_joystick( 0, pad_guid, 2UL );
+
+    // A round gate is perfectly circular and needs no outer deadzone.
+    auto const round = trace_gate( []( double ) { return 1.0; } );
+    play( round, pad, tracker, mapper );
+    if ( !LTB_CHECK( tracker.sticks( ).size( ) == 1UL ) )
+    {
+        return;
+    }
+    auto const& stick = tracker.sticks( ).front( );
+    LTB_CHECK( stick.sample_count == round.size( ) );
+    LTB_CHECK( stick.bins_reached( ) == circularity_angle_bins );
+    LTB_CHECK( radii_match( stick, expected_radii( round ) ) );
+    LTB_CHECK( stick.circularity_error( ) < 1e-6f );
+    LTB_CHECK( stick.outer_deadzone( ) < 1e-6f );
+
+    // A square gate is about 0.2 from round, and its corners only extend the bins they are in.
+    tracker.reset( );
+    LTB_CHECK( stick.sample_count == 0UL && stick.bins_reached( ) == 0UL );
+    auto const square = trace_gate( []( double angle ) {
+        return 1.0 / std::max( std::abs( std::cos( angle ) ), std::abs( std::sin( angle ) ) );
+    } );
+    play( square, pad, tracker, mapper );
+
+    auto const radii = expected_radii( square );
+    LTB_CHECK( radii_match( stick, radii ) );
+
+    auto sum_squares = 0.0;
+    for ( auto const radius : radii )
+    {
+        sum_squares += ( double( radius ) - 1.0 ) * ( double( radius ) - 1.0 );
+    }
+    auto const error = std::sqrt( sum_squares / double( circularity_angle_bins ) );
+    LTB_CHECK( std::abs( double( stick.circularity_error( ) ) - error ) < 1e-6 );
+    LTB_CHECK( error > 0.15 && error < 0.25 );
+    LTB_CHECK( stick.outer_deadzone( ) == 0.f );
+
+    // A gate that falls short in some directions needs an outer deadzone to reach full output.
+    tracker.reset( );
+    auto const dented = trace_gate( []( double angle ) { return ( angle > 1.0 && angle < 2.0 ) ? 0.8 : 1.0; } );
+    play( dented, pad, tracker, mapper );
+    LTB_CHECK( std::abs( stick.outer_deadzone( ) - 0.2f ) < 1e-6f );
+}
+
+auto skips_unusable_samples( ) -> void
+{
+    auto const mapper  = AxisMapper{ };
+    auto       tracker = StickCircularityTracker{ };
+    auto       pad     = test_joystick( 0, pad_guid, 2UL );
+
+    // Samples near the center and NaNs are counted but reach no bins.
+    auto const nan = std::numeric_limits< float >::quiet_NaN( );
+    play( { { 0.3f, 0.3f }, { 0.49f, 0.f }, { nan, 0.f }, { 1.f, nan }, { nan, nan } }, pad, tracker, mapper );
+    if ( !LTB_CHECK( tracker.sticks( ).size( ) == 1UL ) )
+    {
+        return;
+    }
+    auto const& stick = tracker.sticks( ).front( );
+    LTB_CHECK( stick.sample_count == 5UL );
+    LTB_CHECK( stick.bins_reached( ) == 0UL );
+    LTB_CHECK( stick.circularity_error( ) == 0.f && stick.outer_deadzone( ) == 0.f );
+
+    // A poll that repeats the last sample is not counted again.
+    auto joysticks      = std::vector< Joystick >{ pad };
+    joysticks[ 0 ].axes = { 0.9f, 0.f };
+    tracker.process( joysticks, mapper );
+    LTB_CHECK( stick.sample_count == 5UL && stick.bins_reached( ) == 0UL );
+
+    ++joysticks[ 0 ].timestamp_us;
+    tracker.process( joysticks, mapper );
+    LTB_CHECK( stick.sample_count == 6UL && stick.max_radius[ 0 ] == 0.9f );
+}
+
+auto follows_stick_pairs( ) -> void
+{
+    auto mapper  = AxisMapper{ };
+    auto tracker = StickCircularityTracker{ };
+
+    // Devices without stick pairs use axes 0 and 1, and those with fewer axes are skipped.
+    auto joysticks = std::vector< Joystick >{
+        test_joystick( 0, pad_guid, 4UL ),
+        test_joystick( 1, stick_guid, 1UL ),
+    };
+    joysticks[ 0 ].timestamp_us = 1;
+    joysticks[ 0 ].axes         = { 0.f, 1.f, -1.f, 0.f };
+    tracker.process( joysticks, mapper );
+    if ( !LTB_CHECK( tracker.sticks( ).size( ) == 1UL ) )
+    {
+        return;
+    }
+    LTB_CHECK( tracker.sticks( )[ 0 ].device_id == 0 && tracker.sticks( )[ 0 ].x_axis == 0UL );
+    LTB_CHECK( tracker.sticks( )[ 0 ].max_radius[ circularity_angle_bins / 4UL ] == 1.f );
+
+    // Stick pairs replace the default, and pairs past the last axis are skipped.
+    auto mapping   = DeviceMapping{ };
+    mapping.sticks = { StickPair{ 2UL, 3UL, { } }, StickPair{ 0UL, 1UL, { } }, StickPair{ 1UL, 4UL, { } } };
+    mapper.set_mapping( pad_guid, mapping );
+    joysticks[ 0 ].timestamp_us = 2;
+    tracker.process( joysticks, mapper );
+    if ( !LTB_CHECK( tracker.sticks( ).size( ) == 2UL ) )
+    {
+        return;
+    }
+    LTB_CHECK( tracker.stats( ).stick_count == 2UL );
+    LTB_CHECK( tracker.sticks( )[ 0 ].x_axis == 2UL && tracker.sticks( )[ 0 ].y_axis == 3UL );
+    LTB_CHECK( tracker.sticks( )[ 0 ].max_radius[ circularity_angle_bins / 2UL ] == 1.f );
+    LTB_CHECK( tracker.sticks( )[ 0 ].sample_count == 1UL );
+
+    // The stick that was already tracked keeps what it traced.
+    LTB_CHECK( tracker.sticks( )[ 1 ].sample_count == 2UL );
+    LTB_CHECK( tracker.sticks( )[ 1 ].max_radius[ circularity_angle_bins / 4UL ] == 1.f );
+
+    // Another device reconnecting with the same ID starts over.
+    joysticks[ 0 ].guid = stick_guid;
+    tracker.process( joysticks, mapper );
+    if ( LTB_CHECK( tracker.sticks( ).size( ) == 1UL ) )
+    {
+        LTB_CHECK( tracker.sticks( )[ 0 ].guid == stick_guid && tracker.sticks( )[ 0 ].sample_count == 1UL );
+    }
+}
+
+} // namespace
+} // namespace ltb::joy
+
+auto main( ) -> int
+{
+    ltb::joy::converts_to_polar( );
+    ltb::joy::traces_gates( );
+    ltb::joy::skips_unusable_samples( );
+    ltb::joy::follows_stick_pairs( );
+    return ltb::testing::exit_code( );
+}
@@ -0,0 +1,66 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// project
+#include "ltb/joy/recording_format.hpp"
+#include "ltb/testing.hpp"
+
+// standard
+#include <cstring>
+
+namespace ltb::testing
+{
+
+/// \brief The header every recording starts with, ready for records to be appended.
+inline auto recording_header( std::int64_t start_time_us = 0 ) -> std::vector< std::byte >
+{
+    auto header          = joy::RecordingFileHeader{ };
+    header.start_time_us = start_time_us;
+
+    auto bytes = std::vector< std::byte >( sizeof( header ) );
+    std::memcpy( bytes.data( ), &header, sizeof( header ) );
+    return bytes;
+}
+
+/// \brief Append the indices, checksums and footer a recording is finished with, the same
+///        way `SessionRecorder` writes them.
+inline auto finalize_recording( std::vector< std::byte >& bytes ) -> void
+{
+    auto builder = joy::RecordIndexBuilder{ };
+    for ( auto offset = sizeof( joy::RecordingFileHeader ); offset < bytes.size( ); )
+    {
+        auto header = joy::RecordHeader{ };
+        std::memcpy( &header, bytes.data( ) + offset, sizeof( header ) );
+        builder.add( header, offset );
+        offset += header.size;
+    }
+
+    auto const append = [ &bytes ]( void const* data, std::size_t size ) {
+        auto const offset = bytes.size( );
+        bytes.resize( offset + size );
+        std::memcpy( bytes.data( ) + offset, data, size );
+    };
+    auto const records_end = bytes.size( );
+    append( builder.entries( ).data( ), builder.entries( ).size( ) * sizeof( joy::RecordIndexEntry ) );
+    append( builder.keyframes( ).data( ), builder.keyframes( ).size( ) * sizeof( joy::RecordIndexEntry ) );
+
+    auto checksums = joy::ChecksumBuilder{ };
+    checksums.add( bytes.data( ), bytes.size( ) );
+    auto const& table  = checksums.finish( );
+    auto const  footer = builder.footer( records_end, table );
+    append( table.data( ), table.size( ) * sizeof( std::uint32_t ) );
+    append( &footer, sizeof( footer ) );
+}
+
+/// \brief Write `bytes` to a new temporary file named after `name`.
+inline auto temporary_recording( std::string const& name, std::vector< std::byte > const& bytes )
+    -> std::filesystem::path
+{
+    auto path = temporary_path( name );
+    LTB_CHECK( write_file( path, bytes ) );
+    return path;
+}
+
+} // namespace ltb::testing
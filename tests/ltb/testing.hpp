@@ -0,0 +1,86 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// standard
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+/// \brief Report `condition` if it is false, with where it was checked, and keep going.
+#define LTB_CHECK( condition ) ::ltb::testing::check( static_cast< bool >( condition ), #condition, __FILE__, __LINE__ )
+
+namespace ltb::testing
+{
+
+/// \brief Checks that have failed so far in this test executable.
+inline auto failure_count = 0;
+
+inline auto check( bool passed, char const* expression, char const* file, int line ) -> bool
+{
+    if ( !passed )
+    {
+        std::fprintf( stderr, "%s:%d: check failed: %s\n", file, line, expression );
+        ++failure_count;
+    }
+    return passed;
+}
+
+/// \brief Every path handed out by `temporary_path`, removed by `exit_code`.
+inline auto temporary_paths = std::vector< std::filesystem::path >{ };
+
+/// \brief What `main` returns: failure if any check failed. Temporary files are removed
+///        first, so call it once everything that opened them is gone.
+inline auto exit_code( ) -> int
+{
+    for ( auto const& path : temporary_paths )
+    {
+        auto error_code = std::error_code{ };
+        std::filesystem::remove( path, error_code );
+    }
+
+    if ( failure_count > 0 )
+    {
+        std::fprintf( stderr, "%d checks failed\n", failure_count );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/// \brief A new path in the temporary directory for each call. The process ID keeps test
+///        executables that run concurrently apart.
+inline auto temporary_path( std::string const& name ) -> std::filesystem::path
+{
+    static auto next = 0UL;
+#if defined( _WIN32 )
+    auto const process = _getpid( );
+#else
+    auto const process = ::getpid( );
+#endif
+    auto const unique = std::to_string( process ) + "_" + std::to_string( next++ ) + "_";
+    return temporary_paths.emplace_back(
+        std::filesystem::temp_directory_path( ) / ( "ltb_joysticks_tests_" + unique + name )
+    );
+}
+
+/// \brief Replace the file at `path` with `bytes`.
+inline auto write_file( std::filesystem::path const& path, std::vector< std::byte > const& bytes ) -> bool
+{
+    auto file = std::ofstream( path, std::ios::binary | std::ios::trunc );
+    file.write( reinterpret_cast< char const* >( bytes.data( ) ), static_cast< std::streamsize >( bytes.size( ) ) );
+    return file.good( );
+}
+
+} // namespace ltb::testing
@@ -0,0 +1,83 @@
+// ///////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2023 Logan Barnes - All Rights Reserved
+// ///////////////////////////////////////////////////////////////////////////////////////
+#include "ltb/testing.hpp"
+
+// project
+#include "ltb/utils/crc32c.hpp"
+
+// standard
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace ltb::utils
+{
+namespace
+{
+
+auto matches_known_values( ) -> void
+{
+    auto const* digits = "123456789";
+    LTB_CHECK( crc32c( digits, 9UL ) == 0xE3069283U );
+    LTB_CHECK( crc32c_software( digits, 9UL ) == 0xE3069283U );
+
+    auto const zeros = std::vector< std::byte >( 32UL, std::byte( 0 ) );
+    LTB_CHECK( crc32c( zeros.data( ), zeros.size( ) ) == 0x8A9136AAU );
+    LTB_CHECK( crc32c( nullptr, 0UL ) == 0U );
+}
+
+/// \brief Every length and alignment around the 8-byte steps, and a few large buffers.
+auto hardware_matches_software( ) -> void
+{
+    auto random = std::mt19937( 41U );
+    auto bytes  = std::vector< std::byte >( 1UL << 16U );
+    for ( auto& byte : bytes )
+    {
+        byte = static_cast< std::byte >( random( ) );
+    }
+
+    auto mismatches = 0UL;
+    for ( auto offset = 0UL; offset < 8UL; ++offset )
+    {
+        for ( auto size = 0UL; size < 80UL; ++size )
+        {
+            mismatches += crc32c( bytes.data( ) + offset, size ) != crc32c_software( bytes.data( ) + offset, size );
+        }
+    }
+    for ( auto const size : { 1'000UL, 4'093UL, bytes.size( ) - 3UL } )
+    {
+        mismatches += crc32c( bytes.data( ) + 3, size ) != crc32c_software( bytes.data( ) + 3, size );
+    }
+    if ( !LTB_CHECK( mismatches == 0UL ) )
+    {
+        std::fprintf( stderr, "    hardware: %s\n", crc32c_is_hardware( ) ? "yes" : "no" );
+    }
+}
+
+/// \brief A checksum continued across any split matches the checksum of the whole.
+auto continues_across_splits( ) -> void
+{
+    auto const* text  = "The quick brown fox jumps over the lazy dog, twice over.";
+    auto const  size  = std::strlen( text );
+    auto const  whole = crc32c( text, size );
+
+    auto mismatches = 0UL;
+    for ( auto split = 0UL; split <= size; ++split )
+    {
+        mismatches += crc32c( text + split, size - split, crc32c( text, split ) ) != whole;
+        mismatches += crc32c_software( text + split, size - split, crc32c_software( text, split ) ) != whole;
+    }
+    LTB_CHECK( mismatches == 0UL );
+}
+
+} // namespace
+} // namespace ltb::utils
+
+auto main( ) -> int
+{
+    ltb::utils::matches_known_values( );
+    ltb::utils::hardware_matches_software( );
+    ltb::utils::continues_across_splits( );
+    return ltb::testing::exit_code( );
+}